@@ -21,6 +21,10 @@ namespace Chroma
 
     sub_zero=0;
     sub_zero_usedP=false;
+
+    twisted_m_usedP=false;
+    cache_clover=false;
+    link_params=18;
   }
 
   //! Read parameters
@@ -103,6 +107,25 @@ namespace Chroma
       twisted_m_usedP = false;
     }
 
+    if( paramtop.count("CacheClover") != 0 ) { 
+      read(paramtop, "CacheClover", cache_clover);
+    }
+    else { 
+      cache_clover = false;
+    }
+
+    if( paramtop.count("LinkCompression") != 0 ) { 
+      read(paramtop, "LinkCompression", link_params);
+      if (link_params != 18 && link_params != 12 && link_params != 8)
+      {
+	QDPIO::cerr << "Error: LinkCompression must be 18, 12 or 8" << std::endl;
+	QDP_abort(1);
+      }
+    }
+    else { 
+      link_params = 18;
+    }
+
   }
 
   //! Read parameters
@@ -143,6 +166,14 @@ namespace Chroma
       write(xml, "TwistedM", param.twisted_m);
     }
 
+    if (param.cache_clover) { 
+      write(xml, "CacheClover", param.cache_clover);
+    }
+
+    if (param.link_params != 18) { 
+      write(xml, "LinkCompression", param.link_params);
+    }
+
     pop(xml);
   }
 
@@ -35,6 +35,13 @@ namespace Chroma
     Real twisted_m;
     bool twisted_m_usedP;
 
+    // Optionally share the clover term between operators on the same links
+    bool cache_clover;
+
+    // Reals stored per gauge link in the dslash: 18, 12 or 8.
+    // Only EvenOddPrecCloverLinOp on the QDP dslash takes 12 or 8
+    int link_params;
+
   };
 
 
@@ -19,6 +19,7 @@
 
 // Linops I can make
 #include "actions/ferm/linop/lovlapms_w.h"
+#include "actions/ferm/linop/lovlapms_mp_w.h"
 #include "actions/ferm/linop/lovlap_double_pass_w.h"
 #include "actions/ferm/linop/lovddag_w.h"
 #include "actions/ferm/linop/lovddag_double_pass_w.h"
@@ -141,6 +142,26 @@ namespace Chroma
 	// This is now set automagically -- constructor initialisation
       }
 
+      // Mixed precision inner solver parameters. Defaults keep the
+      // targets of the single pass solver.
+      invParamInner.MaxCGSingle = invParamInner.MaxCG;
+      invParamInner.RsdCGSingle = Real(1.0e-5);
+      invParamInner.MaxRefine = 10;
+      invParamInner.PoleRsdRelaxMax = Real(1);
+
+      if( in.count("InnerSolve/MaxCGSingle") == 1 ) { 
+	read(in, "InnerSolve/MaxCGSingle", invParamInner.MaxCGSingle);
+      }
+      if( in.count("InnerSolve/RsdCGSingle") == 1 ) { 
+	read(in, "InnerSolve/RsdCGSingle", invParamInner.RsdCGSingle);
+      }
+      if( in.count("InnerSolve/MaxRefine") == 1 ) { 
+	read(in, "InnerSolve/MaxRefine", invParamInner.MaxRefine);
+      }
+      if( in.count("InnerSolve/PoleRsdRelaxMax") == 1 ) { 
+	read(in, "InnerSolve/PoleRsdRelaxMax", invParamInner.PoleRsdRelaxMax);
+      }
+
       read(in, "IsChiral", isChiralP);
     }
     catch( const std::string &e ) {
@@ -164,6 +185,12 @@ namespace Chroma
     write(xml_out, "RsdCG", p.invParamInner.RsdCG);
     write(xml_out, "ReorthFreq", p.ReorthFreqInner);
     write(xml_out, "SolverType", p.inner_solver_type);
+    if( p.inner_solver_type == OVERLAP_INNER_CG_MIXED_PREC ) { 
+      write(xml_out, "MaxCGSingle", p.invParamInner.MaxCGSingle);
+      write(xml_out, "RsdCGSingle", p.invParamInner.RsdCGSingle);
+      write(xml_out, "MaxRefine", p.invParamInner.MaxRefine);
+      write(xml_out, "PoleRsdRelaxMax", p.invParamInner.PoleRsdRelaxMax);
+    }
     write(xml_out, "ApproximationType", p.approximation_type);
     write(xml_out, "ApproxMin", p.approxMin);
     write(xml_out, "ApproxMax", p.approxMax);
@@ -220,6 +247,16 @@ namespace Chroma
 
       read(fermacttop, fermact_path + "/Mass", params.AuxMass);
       QDPIO::cout << "AuxFermAct Mass: " << params.AuxMass << std::endl;
+
+      // The single precision kernel of the mixed precision inner solver
+      // is an isotropic unpreconditioned Wilson operator
+      if( params.inner_solver_type == OVERLAP_INNER_CG_MIXED_PREC ) { 
+	if( auxfermact != "WILSON" || fermacttop.count(fermact_path + "/AnisoParam") != 0 ) { 
+	  QDPIO::cerr << OvlapPartFrac4DFermActEnv::name 
+		      << ": the MIXED_PREC inner solver needs an isotropic WILSON AuxFermAct" << std::endl;
+	  QDP_abort(1);
+	}
+      }
       // Generic Wilson-Type stuff
       FermionAction<T,P,Q>* S_f =
 	TheFermionActionFactory::Instance().createObject(auxfermact,
@@ -512,6 +549,9 @@ namespace Chroma
     case OVERLAP_INNER_CG_DOUBLE_PASS:
       QDPIO::cout << "Using Neuberger/Chu Double Pass Inner Solver" << std::endl;
       break;
+    case OVERLAP_INNER_CG_MIXED_PREC:
+      QDPIO::cout << "Using Mixed Precision Single Pass Inner Solver" << std::endl;
+      break;
     default:
       QDPIO::cerr << "Unknown inner solver type " << std::endl;
       QDP_abort(1);
@@ -788,6 +828,9 @@ namespace Chroma
     case OVERLAP_INNER_CG_DOUBLE_PASS:
       QDPIO::cout << "Using Neuberger/Chu Double Pass Inner Solver" << std::endl;
       break;
+    case OVERLAP_INNER_CG_MIXED_PREC:
+      QDPIO::cout << "Using Mixed Precision Single Pass Inner Solver" << std::endl;
+      break;
     default:
       QDPIO::cerr << "Unknown inner solver type " << std::endl;
       QDP_abort(1);
@@ -882,6 +925,19 @@ namespace Chroma
 			    params.invParamInner.RsdCG, 
 			    params.ReorthFreqInner);
 	break;
+      case OVERLAP_INNER_CG_MIXED_PREC:
+	return new lovlapms_mp(*Mact, state_, m_q,
+			       numroot, coeffP, resP, rootQ, 
+			       NEig, EigValFunc, state.getEvectors(),
+			       params.invParamInner.MaxCG, 
+			       params.invParamInner.RsdCG, 
+			       params.ReorthFreqInner,
+			       params.AuxMass,
+			       params.invParamInner.MaxCGSingle,
+			       params.invParamInner.RsdCGSingle,
+			       params.invParamInner.MaxRefine,
+			       params.invParamInner.PoleRsdRelaxMax);
+	break;
       case OVERLAP_INNER_CG_DOUBLE_PASS:
 	return new lovlap_double_pass(*Mact, state_, m_q,
 				      numroot, coeffP, resP, rootQ, 
@@ -958,6 +1014,19 @@ namespace Chroma
 			    NEig, EigValFunc, state.getEvectors(),
 			    params.invParamInner.MaxCG, params.invParamInner.RsdCG, params.ReorthFreqInner);
 	break;
+      case OVERLAP_INNER_CG_MIXED_PREC:
+	return new lovlapms_mp(*Mact, state_, params.Mass,
+			       numroot, coeffP, resP, rootQ, 
+			       NEig, EigValFunc, state.getEvectors(),
+			       params.invParamInner.MaxCG, 
+			       params.invParamInner.RsdCG, 
+			       params.ReorthFreqInner,
+			       params.AuxMass,
+			       params.invParamInner.MaxCGSingle,
+			       params.invParamInner.RsdCGSingle,
+			       params.invParamInner.MaxRefine,
+			       params.invParamInner.PoleRsdRelaxMax);
+	break;
       case OVERLAP_INNER_CG_DOUBLE_PASS:
 	return new lovlap_double_pass(*Mact, state_, params.Mass,
 				      numroot, coeffP, resP, rootQ, 
@@ -1027,6 +1096,7 @@ namespace Chroma
       /* This is the operator of the form (1/2)*[(1+mu) + (1-mu)*gamma_5*eps] */
       switch( params.inner_solver_type ) { 
       case OVERLAP_INNER_CG_SINGLE_PASS:
+      case OVERLAP_INNER_CG_MIXED_PREC:
 	return new lg5eps(*Mact, state_,
 			  numroot, coeffP, resP, rootQ, 
 			  NEig, EigValFunc, state.getEvectors(),
@@ -1099,6 +1169,7 @@ namespace Chroma
     /* This is the operator of the form (1/2)*[(1+mu) + (1-mu)*gamma_5*eps] */
     switch( params.inner_solver_type ) { 
     case OVERLAP_INNER_CG_SINGLE_PASS:
+    case OVERLAP_INNER_CG_MIXED_PREC:
       return new lg5eps(*Mact, state_,
 			numroot, coeffP, resP, rootQ, 
 			NEig, EigValFunc, state.getEvectors(),
@@ -1189,6 +1260,7 @@ namespace Chroma
       // This is the operator of the form (1/2)*[(1+mu) + (1-mu)*gamma_5*eps]
       switch( params.inner_solver_type ) { 
       case OVERLAP_INNER_CG_SINGLE_PASS:
+      case OVERLAP_INNER_CG_MIXED_PREC:
 	return new lovddag(*Mact, state_, params.Mass,
 			   numroot, coeffP, resP, rootQ, 
 			   NEig, EigValFunc, state.getEvectors(),
@@ -1260,6 +1332,7 @@ namespace Chroma
       // This is the operator of the form (1/2)*[(1+mu) + (1-mu)*gamma_5*eps]
       switch( params.inner_solver_type ) { 
       case OVERLAP_INNER_CG_SINGLE_PASS:
+      case OVERLAP_INNER_CG_MIXED_PREC:
 	return new lovddag(*Mact, state_, params.Mass,
 			   numroot, coeffP, resP, rootQ, 
 			   NEig, EigValFunc, state.getEvectors(),
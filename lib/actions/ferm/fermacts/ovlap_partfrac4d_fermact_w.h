@@ -47,6 +47,12 @@ namespace Chroma
     {
       Real RsdCG;
       int  MaxCG;
+
+      // Only used by the mixed precision inner solver
+      Real RsdCGSingle;      /*!< target of the single precision solves */
+      int  MaxCGSingle;      /*!< max iterations of a single precision solve */
+      int  MaxRefine;        /*!< max double precision corrections per pole */
+      Real PoleRsdRelaxMax;  /*!< max relaxation of the target of a pole */
     } invParamInner;
     OverlapInnerSolverType inner_solver_type;
 
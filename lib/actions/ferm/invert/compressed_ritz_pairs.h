@@ -0,0 +1,463 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Ritz pairs held in reduced precision
+ *
+ *  The deflation space of EigCG can grow to hundreds of vectors. Here the
+ *  vectors are kept only on the sites of their subset and either in single
+ *  precision, or in 16 bit integers with one scale factor per site and
+ *  vector. All operations on the space (projection, rotation, growth) are
+ *  done a site at a time, decoding into double precision on the fly, so
+ *  the space is never expanded to full lattice vectors.
+ */
+
+#ifndef __compressed_ritz_pairs_h__
+#define __compressed_ritz_pairs_h__
+
+#include "chromabase.h"
+#include "actions/ferm/invert/containers.h"
+
+#include <vector>
+#include <cmath>
+
+namespace Chroma
+{
+
+  namespace LinAlg
+  {
+    //! Storage format of the vectors
+    /*! \ingroup invert */
+    enum CompressedRitzStorage
+    {
+      RITZ_STORE_SINGLE,      /*!< 32 bit floats */
+      RITZ_STORE_HALF         /*!< 16 bit integers with a scale per site and vector */
+    };
+
+
+#ifndef QDP_IS_QDPJIT
+    template<typename T> class CompressedRitzPairs;
+
+    /*! Hide the site loops for the thread dispatcher in here */
+    namespace CompressedRitzPairsEnv
+    {
+      template<typename T>
+      struct Args
+      {
+	CompressedRitzPairs<T>*  store;
+	T*                       x;        /*!< lattice vector read or written */
+	int                      vec;      /*!< stored vector index */
+	int                      nvec;     /*!< number of stored vectors used */
+	const multi1d<T>*        extra;    /*!< full precision vectors appended in a rotation */
+	int                      nextra;
+	const REAL64*            coeffs;   /*!< re,im pairs */
+	REAL64*                  partial;  /*!< 2*nvec doubles per thread */
+      };
+
+      template<typename T>
+      void encodeSiteLoop(int lo, int hi, int myId, Args<T>* a);
+
+      template<typename T>
+      void decodeSiteLoop(int lo, int hi, int myId, Args<T>* a);
+
+      template<typename T>
+      void innerProductSiteLoop(int lo, int hi, int myId, Args<T>* a);
+
+      template<typename T>
+      void axpySiteLoop(int lo, int hi, int myId, Args<T>* a);
+
+      template<typename T>
+      void rotateSiteLoop(int lo, int hi, int myId, Args<T>* a);
+    }
+
+
+    //! Ritz pairs with the vectors held in reduced precision
+    /*! \ingroup invert
+     *
+     * T is a lattice fermion. The vectors are only defined on the subset
+     * given at init and are zero elsewhere.
+     */
+    template<typename T>
+    class CompressedRitzPairs
+    {
+    public:
+      typedef typename WordType<T>::Type_t W;
+
+      //! Reals per site of a vector
+      enum {NR = 2*Nc*Ns};
+
+      multi1d<Double>  eval;
+      int              Neig;
+
+      CompressedRitzPairs() : Neig(0), nmax(0), nsites(0), storage(RITZ_STORE_SINGLE) {}
+
+      //! Make room for N vectors on subset s
+      void init(int N, const Subset& s, CompressedRitzStorage storage_)
+      {
+	storage = storage_;
+	sub     = s;
+	nmax    = N;
+	nsites  = s.numSiteTable();
+	Neig    = 0;
+
+	eval.resize(N);
+
+	const size_t nwords = size_t(nsites)*size_t(nmax)*NR;
+	if (storage == RITZ_STORE_HALF)
+	{
+	  data_half.assign(nwords, 0);
+	  scale.assign(size_t(nsites)*size_t(nmax), 0.0f);
+	  data_single.clear();
+	}
+	else
+	{
+	  data_single.assign(nwords, 0.0f);
+	  data_half.clear();
+	  scale.clear();
+	}
+      }
+
+      //! Maximum number of vectors
+      int size() const {return nmax;}
+
+      //! Subset the vectors are defined on
+      const Subset& subset() const {return sub;}
+
+      //! Storage format
+      CompressedRitzStorage getStorage() const {return storage;}
+
+      //! Bytes used by the vectors
+      size_t bytes() const
+      {
+	return data_single.size()*sizeof(float) + data_half.size()*sizeof(short) + scale.size()*sizeof(float);
+      }
+
+      //! Add a pair, if there is room
+      void AddVector(const Double& e, const T& v)
+      {
+	if (Neig >= nmax)
+	  return;
+
+	eval[Neig] = e;
+	CompressedRitzPairsEnv::Args<T> a = {this, const_cast<T*>(&v), Neig, 0, 0, 0, 0, 0};
+	dispatch_to_threads(nsites, a, CompressedRitzPairsEnv::encodeSiteLoop<T>);
+	++Neig;
+      }
+
+      //! Expand vector i on the subset
+      void expand(T& v, int i) const
+      {
+	v = zero;
+	CompressedRitzPairsEnv::Args<T> a = {const_cast<CompressedRitzPairs<T>*>(this), &v, i, 0, 0, 0, 0, 0};
+	dispatch_to_threads(nsites, a, CompressedRitzPairsEnv::decodeSiteLoop<T>);
+      }
+
+      //! c_i = <v_i, x> for all i < Neig with one global reduction
+      void innerProducts(multi1d<DComplex>& c, const T& x) const
+      {
+	c.resize(Neig);
+	if (Neig == 0)
+	  return;
+
+	const int nthreads = qdpNumThreads();
+	std::vector<REAL64> partial(2*Neig*nthreads, 0.0);
+
+	CompressedRitzPairsEnv::Args<T> a = {const_cast<CompressedRitzPairs<T>*>(this), const_cast<T*>(&x), 0, Neig, 0, 0, 0, &(partial[0])};
+	dispatch_to_threads(nsites, a, CompressedRitzPairsEnv::innerProductSiteLoop<T>);
+
+	std::vector<REAL64> sums(2*Neig, 0.0);
+	for(int t=0; t < nthreads; ++t)
+	  for(int i=0; i < 2*Neig; ++i)
+	    sums[i] += partial[2*Neig*t + i];
+
+	QDPInternal::globalSumArray(&(sums[0]), 2*Neig);
+
+	for(int i=0; i < Neig; ++i)
+	  c[i] = cmplx(Double(sums[2*i]), Double(sums[2*i+1]));
+      }
+
+      //! y += sum_i c_i v_i  in one sweep
+      void axpy(T& y, const multi1d<DComplex>& c) const
+      {
+	const int n = (c.size() < Neig) ? c.size() : Neig;
+	if (n == 0)
+	  return;
+
+	std::vector<REAL64> buf(2*n);
+	for(int i=0; i < n; ++i)
+	{
+	  buf[2*i]   = toDouble(real(c[i]));
+	  buf[2*i+1] = toDouble(imag(c[i]));
+	}
+
+	CompressedRitzPairsEnv::Args<T> a = {const_cast<CompressedRitzPairs<T>*>(this), &y, 0, n, 0, 0, &(buf[0]), 0};
+	dispatch_to_threads(nsites, a, CompressedRitzPairsEnv::axpySiteLoop<T>);
+      }
+
+      //! Deflated initial guess  x += sum_i v_i <v_i, b - A x> / lambda_i
+      void initGuess(const LinearOperator<T>& A, T& x, const T& b) const
+      {
+	T r;
+	A(r, x, PLUS);
+	r[sub] = b - r;
+
+	multi1d<DComplex> c;
+	innerProducts(c, r);
+	for(int i=0; i < Neig; ++i)
+	  c[i] /= eval[i];
+
+	axpy(x, c);
+      }
+
+      //! Replace the vectors by  v'_k = sum_j conj(H(k,j)) w_j
+      /*!
+       * where w is the Neig stored vectors followed by the first nextra
+       * of the full precision vectors extra. Afterwards Neig is
+       * min(Neig + nextra, size()). This is done a site at a time so
+       * the space is never held in full precision.
+       */
+      void rotate(const Matrix<DComplex>& H, const multi1d<T>& extra, int nextra)
+      {
+	const int ntot = Neig + nextra;
+	const int nout = (ntot < nmax) ? ntot : nmax;
+
+	if (H.size() < ntot)
+	{
+	  QDPIO::cerr << __func__ << ": rotation matrix too small" << std::endl;
+	  QDP_abort(1);
+	}
+
+	std::vector<REAL64> buf(2*nout*ntot);
+	for(int k=0; k < nout; ++k)
+	  for(int j=0; j < ntot; ++j)
+	  {
+	    DComplex h = conj(H.mat(k,j));
+	    buf[2*(k*ntot + j)]   = toDouble(real(h));
+	    buf[2*(k*ntot + j)+1] = toDouble(imag(h));
+	  }
+
+	CompressedRitzPairsEnv::Args<T> a = {this, 0, nout, Neig, &extra, nextra, &(buf[0]), 0};
+	dispatch_to_threads(nsites, a, CompressedRitzPairsEnv::rotateSiteLoop<T>);
+
+	Neig = nout;
+      }
+
+      //! Decode vector i at subset site j
+      inline void decode(int j, int i, REAL64* out) const
+      {
+	const size_t off = (size_t(j)*nmax + i)*NR;
+	if (storage == RITZ_STORE_HALF)
+	{
+	  const REAL64 s = scale[size_t(j)*nmax + i];
+	  const short* d = &(data_half[off]);
+	  for(int r=0; r < NR; ++r)
+	    out[r] = s*d[r];
+	}
+	else
+	{
+	  const float* d = &(data_single[off]);
+	  for(int r=0; r < NR; ++r)
+	    out[r] = d[r];
+	}
+      }
+
+      //! Encode vector i at subset site j
+      inline void encode(int j, int i, const REAL64* in)
+      {
+	const size_t off = (size_t(j)*nmax + i)*NR;
+	if (storage == RITZ_STORE_HALF)
+	{
+	  REAL64 m = 0;
+	  for(int r=0; r < NR; ++r)
+	    m = std::max(m, std::fabs(in[r]));
+
+	  const REAL64 s = (m > 0) ? m / 32767.0 : 1.0;
+	  const REAL64 is = 1.0 / s;
+	  short* d = &(data_half[off]);
+	  for(int r=0; r < NR; ++r)
+	    d[r] = (short)std::floor(in[r]*is + 0.5);
+
+	  scale[size_t(j)*nmax + i] = (float)s;
+	}
+	else
+	{
+	  float* d = &(data_single[off]);
+	  for(int r=0; r < NR; ++r)
+	    d[r] = (float)in[r];
+	}
+      }
+
+      //! Lattice site of subset site j
+      inline int site(int j) const {return sub.siteTable()[j];}
+
+    private:
+      Subset                 sub;
+      int                    nmax;
+      int                    nsites;
+      CompressedRitzStorage  storage;
+
+      std::vector<float>     data_single;
+      std::vector<short>     data_half;
+      std::vector<float>     scale;
+    };
+
+
+    namespace CompressedRitzPairsEnv
+    {
+      template<typename T>
+      inline
+      void encodeSiteLoop(int lo, int hi, int myId, Args<T>* a)
+      {
+	typedef typename WordType<T>::Type_t W;
+	REAL64 in[CompressedRitzPairs<T>::NR];
+
+	for(int j=lo; j < hi; ++j)
+	{
+	  const W* x = (const W*)&(a->x->elem(a->store->site(j)));
+	  for(int r=0; r < CompressedRitzPairs<T>::NR; ++r)
+	    in[r] = x[r];
+
+	  a->store->encode(j, a->vec, in);
+	}
+      }
+
+      template<typename T>
+      inline
+      void decodeSiteLoop(int lo, int hi, int myId, Args<T>* a)
+      {
+	typedef typename WordType<T>::Type_t W;
+	REAL64 out[CompressedRitzPairs<T>::NR];
+
+	for(int j=lo; j < hi; ++j)
+	{
+	  a->store->decode(j, a->vec, out);
+
+	  W* x = (W*)&(a->x->elem(a->store->site(j)));
+	  for(int r=0; r < CompressedRitzPairs<T>::NR; ++r)
+	    x[r] = (W)out[r];
+	}
+      }
+
+      template<typename T>
+      inline
+      void innerProductSiteLoop(int lo, int hi, int myId, Args<T>* a)
+      {
+	typedef typename WordType<T>::Type_t W;
+	const int NR = CompressedRitzPairs<T>::NR;
+	REAL64 v[NR];
+	REAL64 x[NR];
+
+	REAL64* c = &(a->partial[2*a->nvec*myId]);
+
+	for(int j=lo; j < hi; ++j)
+	{
+	  // Each site of x is read once and used against all vectors
+	  const W* xs = (const W*)&(a->x->elem(a->store->site(j)));
+	  for(int r=0; r < NR; ++r)
+	    x[r] = xs[r];
+
+	  for(int i=0; i < a->nvec; ++i)
+	  {
+	    a->store->decode(j, i, v);
+
+	    REAL64 re = 0;
+	    REAL64 im = 0;
+	    for(int r=0; r < NR; r += 2)
+	    {
+	      re += v[r]*x[r]   + v[r+1]*x[r+1];
+	      im += v[r]*x[r+1] - v[r+1]*x[r];
+	    }
+
+	    c[2*i]   += re;
+	    c[2*i+1] += im;
+	  }
+	}
+      }
+
+      template<typename T>
+      inline
+      void axpySiteLoop(int lo, int hi, int myId, Args<T>* a)
+      {
+	typedef typename WordType<T>::Type_t W;
+	const int NR = CompressedRitzPairs<T>::NR;
+	REAL64 v[NR];
+	REAL64 y[NR];
+
+	for(int j=lo; j < hi; ++j)
+	{
+	  W* ys = (W*)&(a->x->elem(a->store->site(j)));
+	  for(int r=0; r < NR; ++r)
+	    y[r] = ys[r];
+
+	  for(int i=0; i < a->nvec; ++i)
+	  {
+	    a->store->decode(j, i, v);
+
+	    const REAL64 cr = a->coeffs[2*i];
+	    const REAL64 ci = a->coeffs[2*i+1];
+	    for(int r=0; r < NR; r += 2)
+	    {
+	      y[r]   += cr*v[r]   - ci*v[r+1];
+	      y[r+1] += cr*v[r+1] + ci*v[r];
+	    }
+	  }
+
+	  for(int r=0; r < NR; ++r)
+	    ys[r] = (W)y[r];
+	}
+      }
+
+      template<typename T>
+      inline
+      void rotateSiteLoop(int lo, int hi, int myId, Args<T>* a)
+      {
+	typedef typename WordType<T>::Type_t W;
+	const int NR   = CompressedRitzPairs<T>::NR;
+	const int nold = a->nvec;
+	const int ntot = nold + a->nextra;
+	const int nout = a->vec;
+
+	std::vector<REAL64> w(ntot*NR);
+	std::vector<REAL64> out(NR);
+
+	for(int j=lo; j < hi; ++j)
+	{
+	  // All the vectors at this site
+	  for(int i=0; i < nold; ++i)
+	    a->store->decode(j, i, &(w[i*NR]));
+
+	  const int site = a->store->site(j);
+	  for(int i=0; i < a->nextra; ++i)
+	  {
+	    const W* xs = (const W*)&((*(a->extra))[i].elem(site));
+	    for(int r=0; r < NR; ++r)
+	      w[(nold+i)*NR + r] = xs[r];
+	  }
+
+	  for(int k=0; k < nout; ++k)
+	  {
+	    for(int r=0; r < NR; ++r)
+	      out[r] = 0;
+
+	    for(int i=0; i < ntot; ++i)
+	    {
+	      const REAL64 hr = a->coeffs[2*(k*ntot + i)];
+	      const REAL64 hm = a->coeffs[2*(k*ntot + i)+1];
+	      const REAL64* v = &(w[i*NR]);
+	      for(int r=0; r < NR; r += 2)
+	      {
+		out[r]   += hr*v[r]   - hm*v[r+1];
+		out[r+1] += hr*v[r+1] + hm*v[r];
+	      }
+	    }
+
+	    a->store->encode(j, k, &(out[0]));
+	  }
+	}
+      }
+    }
+#endif
+
+  } // namespace LinAlg
+
+} // namespace Chroma
+
+#endif
@@ -4,6 +4,7 @@
 #define _INV_CONTAINERS__H
 
 #include "chromabase.h"
+#include "named_obj.h"
 
 namespace Chroma
 {
@@ -474,6 +475,24 @@ namespace Chroma
 
   } // namespace LinAlg
 
+
+  //! Size of the eigenpairs held in the named object map
+  /*! \ingroup invert */
+  template<typename T>
+  struct NamedObjectTraits< LinAlg::RitzPairs<T> >
+  {
+    static bool sized() {return NamedObjectTraits< multi1d<T> >::sized();}
+
+    static unsigned long size(const LinAlg::RitzPairs<T>& d) 
+    {
+      return NamedObjectTraits< multi1d<T> >::size(d.evec.vec) + d.eval.vec.size()*sizeof(Double);
+    }
+
+    static bool spillable() {return false;}
+    static void spill(std::ostream& os, const LinAlg::RitzPairs<T>& d) {}
+    static void restore(std::istream& is, LinAlg::RitzPairs<T>& d) {}
+  };
+
 } // namespace Chroma
 
 #endif 
@@ -0,0 +1,291 @@
+/*! \file
+ *  \brief Fermions stored as 16 bit fixed point numbers with a norm per site
+ */
+
+#include "actions/ferm/invert/half_prec_fermion.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Chroma
+{
+#ifndef QDP_IS_QDPJIT
+  //! The site loops of the vector operations
+  struct HalfPrecFermionKernels
+  {
+    static const int nw = HalfPrecFermion::nw;
+
+    struct Args
+    {
+      const int*              site_table;
+      HalfPrecFermion*        hout;
+      REAL32*                 fout;
+      const REAL32*           fin;
+      const HalfPrecFermion*  x;
+      const HalfPrecFermion*  y;
+      const HalfPrecFermion*  z;
+      REAL64                  b[2];
+      REAL64                  c[2];
+      REAL64*                 partial;     /*!< 2 doubles per thread */
+    };
+
+    //! Reals of the site i of the storage
+    static inline void decodeSite(REAL64* v, const HalfPrecFermion& h, int i)
+    {
+      const short* q = &(h.data[nw*i]);
+      const REAL64 f = REAL64(h.norm[i]) / HalfPrecFermion::qmax;
+      for(int k=0; k < nw; ++k)
+	v[k] = f * q[k];
+    }
+
+    //! Store the reals at the site i of the storage
+    template<typename R>
+    static inline void encodeSite(HalfPrecFermion& h, int i, const R* v)
+    {
+      REAL32 nrm = 0;
+      for(int k=0; k < nw; ++k)
+	nrm = std::max(nrm, REAL32(std::fabs(v[k])));
+
+      short* q = &(h.data[nw*i]);
+      h.norm[i] = nrm;
+      if (nrm == 0)
+      {
+	for(int k=0; k < nw; ++k)
+	  q[k] = 0;
+	return;
+      }
+
+      const REAL64 f = HalfPrecFermion::qmax / REAL64(nrm);
+      for(int k=0; k < nw; ++k)
+	q[k] = short(std::lrint(f * v[k]));
+    }
+
+    //! Single precision reals of a site
+    template<typename R>
+    static inline R* fermSite(R* base, int site)
+    {
+      return base + nw*site;
+    }
+
+    static void encodeLoop(int lo, int hi, int myId, Args* a)
+    {
+      for(int i=lo; i < hi; ++i)
+	encodeSite(*(a->hout), i, fermSite(a->fin, a->site_table[i]));
+    }
+
+    static void decodeLoop(int lo, int hi, int myId, Args* a)
+    {
+      const HalfPrecFermion& x = *(a->x);
+      for(int i=lo; i < hi; ++i)
+      {
+	REAL32* out = fermSite(a->fout, a->site_table[i]);
+	const short* q = &(x.data[nw*i]);
+	const REAL32 f = x.norm[i] / HalfPrecFermion::qmax;
+	for(int k=0; k < nw; ++k)
+	  out[k] = f * q[k];
+      }
+    }
+
+    static void innerProductLoop(int lo, int hi, int myId, Args* a)
+    {
+      REAL64 re = 0;
+      REAL64 im = 0;
+      for(int i=lo; i < hi; ++i)
+      {
+	REAL64 x[nw], y[nw];
+	decodeSite(x, *(a->x), i);
+	decodeSite(y, *(a->y), i);
+
+	// conj(x) y
+	for(int k=0; k < nw; k += 2)
+	{
+	  re += x[k]*y[k] + x[k+1]*y[k+1];
+	  im += x[k]*y[k+1] - x[k+1]*y[k];
+	}
+      }
+
+      a->partial[2*myId]   = re;
+      a->partial[2*myId+1] = im;
+    }
+
+    static void xpbyLoop(int lo, int hi, int myId, Args* a)
+    {
+      const REAL64 br = a->b[0], bi = a->b[1];
+      for(int i=lo; i < hi; ++i)
+      {
+	REAL64 x[nw], y[nw];
+	decodeSite(x, *(a->x), i);
+	decodeSite(y, *(a->y), i);
+
+	REAL32* out = fermSite(a->fout, a->site_table[i]);
+	for(int k=0; k < nw; k += 2)
+	{
+	  out[k]   = x[k]   + br*y[k]   - bi*y[k+1];
+	  out[k+1] = x[k+1] + br*y[k+1] + bi*y[k];
+	}
+      }
+    }
+
+    static void xpbypczLoop(int lo, int hi, int myId, Args* a)
+    {
+      const REAL64 br = a->b[0], bi = a->b[1];
+      const REAL64 cr = a->c[0], ci = a->c[1];
+      for(int i=lo; i < hi; ++i)
+      {
+	REAL64 x[nw], y[nw], z[nw];
+	decodeSite(x, *(a->x), i);
+	decodeSite(y, *(a->y), i);
+	decodeSite(z, *(a->z), i);
+
+	REAL64 v[nw];
+	for(int k=0; k < nw; k += 2)
+	{
+	  v[k]   = x[k]   + br*y[k]   - bi*y[k+1] + cr*z[k]   - ci*z[k+1];
+	  v[k+1] = x[k+1] + br*y[k+1] + bi*y[k]   + cr*z[k+1] + ci*z[k];
+	}
+	encodeSite(*(a->hout), i, v);
+      }
+    }
+
+    static void axpyLoop(int lo, int hi, int myId, Args* a)
+    {
+      const REAL64 br = a->b[0], bi = a->b[1];
+      for(int i=lo; i < hi; ++i)
+      {
+	REAL64 x[nw];
+	decodeSite(x, *(a->x), i);
+
+	REAL32* out = fermSite(a->fout, a->site_table[i]);
+	for(int k=0; k < nw; k += 2)
+	{
+	  out[k]   += br*x[k]   - bi*x[k+1];
+	  out[k+1] += br*x[k+1] + bi*x[k];
+	}
+      }
+    }
+
+    //! Args on the subset of x
+    static Args args(const HalfPrecFermion& x)
+    {
+      Args a;
+      a.site_table = x.subset().siteTable().slice();
+      a.hout = 0;
+      a.fout = 0;
+      a.fin = 0;
+      a.x = &x;
+      a.y = 0;
+      a.z = 0;
+      a.b[0] = a.b[1] = 0;
+      a.c[0] = a.c[1] = 0;
+      a.partial = 0;
+      return a;
+    }
+
+    //! Check that the vectors live on the same subset
+    static void check(const HalfPrecFermion& x, const HalfPrecFermion& y)
+    {
+      if (&(x.subset()) != &(y.subset()))
+      {
+	QDPIO::cerr << "HalfPrecFermion: vectors on different subsets" << std::endl;
+	QDP_abort(1);
+      }
+    }
+  };
+
+
+  // Storage for the sites of s, zero
+  HalfPrecFermion::HalfPrecFermion(const Subset& s) :
+    sub(&s), data(nw*s.numSiteTable(), 0), norm(s.numSiteTable(), 0)
+  {
+  }
+
+
+  // this = x
+  void HalfPrecFermion::encode(const LatticeFermionF& x)
+  {
+    HalfPrecFermionKernels::Args a = HalfPrecFermionKernels::args(*this);
+    a.hout = this;
+    a.fin = (const REAL32*)&(x.elem(0));
+    dispatch_to_threads(sub->numSiteTable(), a, HalfPrecFermionKernels::encodeLoop);
+  }
+
+
+  // x = this on the subset
+  void HalfPrecFermion::decode(LatticeFermionF& x) const
+  {
+    HalfPrecFermionKernels::Args a = HalfPrecFermionKernels::args(*this);
+    a.fout = (REAL32*)&(x.elem(0));
+    dispatch_to_threads(sub->numSiteTable(), a, HalfPrecFermionKernels::decodeLoop);
+  }
+
+
+  // < x, y > over the subset
+  DComplex innerProduct(const HalfPrecFermion& x, const HalfPrecFermion& y)
+  {
+    HalfPrecFermionKernels::check(x, y);
+
+    std::vector<REAL64> partial(2*qdpNumThreads(), 0.0);
+    HalfPrecFermionKernels::Args a = HalfPrecFermionKernels::args(x);
+    a.y = &y;
+    a.partial = &(partial[0]);
+    dispatch_to_threads(x.subset().numSiteTable(), a, HalfPrecFermionKernels::innerProductLoop);
+
+    REAL64 sums[2] = {0, 0};
+    for(int t=0; t < partial.size()/2; ++t)
+    {
+      sums[0] += partial[2*t];
+      sums[1] += partial[2*t+1];
+    }
+    QDPInternal::globalSumArray(sums, 2);
+
+    return cmplx(Double(sums[0]), Double(sums[1]));
+  }
+
+
+  // out = x + b*y on the subset
+  void xpby(LatticeFermionF& out, const HalfPrecFermion& x, const DComplex& b, const HalfPrecFermion& y)
+  {
+    HalfPrecFermionKernels::check(x, y);
+
+    HalfPrecFermionKernels::Args a = HalfPrecFermionKernels::args(x);
+    a.fout = (REAL32*)&(out.elem(0));
+    a.y = &y;
+    a.b[0] = toDouble(real(b));
+    a.b[1] = toDouble(imag(b));
+    dispatch_to_threads(x.subset().numSiteTable(), a, HalfPrecFermionKernels::xpbyLoop);
+  }
+
+
+  // out = x + b*y + c*z, out may be y or z
+  void xpbypcz(HalfPrecFermion& out, const HalfPrecFermion& x,
+	       const DComplex& b, const HalfPrecFermion& y,
+	       const DComplex& c, const HalfPrecFermion& z)
+  {
+    HalfPrecFermionKernels::check(x, y);
+    HalfPrecFermionKernels::check(x, z);
+    HalfPrecFermionKernels::check(x, out);
+
+    HalfPrecFermionKernels::Args a = HalfPrecFermionKernels::args(x);
+    a.hout = &out;
+    a.y = &y;
+    a.z = &z;
+    a.b[0] = toDouble(real(b));
+    a.b[1] = toDouble(imag(b));
+    a.c[0] = toDouble(real(c));
+    a.c[1] = toDouble(imag(c));
+    dispatch_to_threads(x.subset().numSiteTable(), a, HalfPrecFermionKernels::xpbypczLoop);
+  }
+
+
+  // out += a*x on the subset
+  void axpy(LatticeFermionF& out, const DComplex& a_, const HalfPrecFermion& x)
+  {
+    HalfPrecFermionKernels::Args a = HalfPrecFermionKernels::args(x);
+    a.fout = (REAL32*)&(out.elem(0));
+    a.b[0] = toDouble(real(a_));
+    a.b[1] = toDouble(imag(a_));
+    dispatch_to_threads(x.subset().numSiteTable(), a, HalfPrecFermionKernels::axpyLoop);
+  }
+#endif
+
+}  // end namespace Chroma
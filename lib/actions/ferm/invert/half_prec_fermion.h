@@ -0,0 +1,79 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Fermions stored as 16 bit fixed point numbers with a norm per site
+ */
+
+#ifndef __half_prec_fermion_h__
+#define __half_prec_fermion_h__
+
+#include "chromabase.h"
+
+#include <vector>
+
+namespace Chroma
+{
+#ifndef QDP_IS_QDPJIT
+  //! A single precision fermion in 16 bit storage
+  /*! \ingroup invert
+   *
+   * A site holds the Ns*Nc*2 reals of the fermion as 16 bit fixed point
+   * numbers in [-1,1] and a float, the largest modulus of the reals of the
+   * site. The relative error of a real is about 2^-15 of the site norm, so
+   * the vectors only suit the inner-most solver of a defect correction.
+   *
+   * Only the sites of the subset are stored, in the order of its site table.
+   * The vector operations decode the sites in registers and accumulate in
+   * double precision; they read and write half the bytes of a LatticeFermionF.
+   */
+  class HalfPrecFermion
+  {
+  public:
+    //! Storage for the sites of s, zero
+    HalfPrecFermion(const Subset& s);
+
+    //! The subset
+    const Subset& subset() const {return *sub;}
+
+    //! this = x
+    void encode(const LatticeFermionF& x);
+
+    //! x = this on the subset
+    void decode(LatticeFermionF& x) const;
+
+    //! Reals in a site
+    static const int nw = Ns*Nc*2;
+
+    //! Fixed point scale
+    static const int qmax = 32767;
+
+  private:
+    friend struct HalfPrecFermionKernels;
+
+    const Subset*       sub;
+    std::vector<short>  data;   /*!< nw numbers per site */
+    std::vector<float>  norm;   /*!< site norms */
+  };
+
+
+  //! < x, y > over the subset
+  /*! \ingroup invert */
+  DComplex innerProduct(const HalfPrecFermion& x, const HalfPrecFermion& y);
+
+  //! out = x + b*y on the subset
+  /*! \ingroup invert */
+  void xpby(LatticeFermionF& out, const HalfPrecFermion& x, const DComplex& b, const HalfPrecFermion& y);
+
+  //! out = x + b*y + c*z, out may be y or z
+  /*! \ingroup invert */
+  void xpbypcz(HalfPrecFermion& out, const HalfPrecFermion& x,
+	       const DComplex& b, const HalfPrecFermion& y,
+	       const DComplex& c, const HalfPrecFermion& z);
+
+  //! out += a*x on the subset
+  /*! \ingroup invert */
+  void axpy(LatticeFermionF& out, const DComplex& a, const HalfPrecFermion& x);
+#endif
+
+}  // end namespace Chroma
+
+#endif
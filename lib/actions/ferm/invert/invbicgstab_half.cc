@@ -0,0 +1,147 @@
+/*! \file
+ *  \brief BiCGStab with the Krylov vectors in 16 bit storage
+ */
+
+#include "chromabase.h"
+#include "actions/ferm/invert/invbicgstab_half.h"
+#include "actions/ferm/invert/half_prec_fermion.h"
+
+namespace Chroma
+{
+
+  SystemSolverResults_t
+  InvBiCGStabHalf(const LinearOperator<LatticeFermionF>& A,
+		  const LatticeFermionF& chi,
+		  LatticeFermionF& psi,
+		  const Real& RsdBiCGStab,
+		  int MaxBiCGStab,
+		  enum PlusMinus isign)
+  {
+    SystemSolverResults_t ret;
+
+#ifndef QDP_IS_QDPJIT
+    START_CODE();
+
+    StopWatch swatch;
+    FlopCounter flopcount;
+    flopcount.reset();
+    const Subset& s = A.subset();
+    bool convP = false;
+    ret.n_count = MaxBiCGStab;
+
+    swatch.reset();
+    swatch.start();
+
+    Double chi_sq = norm2(chi,s);
+    Double rsd_sq = RsdBiCGStab*RsdBiCGStab*chi_sq;
+
+    // Single precision work vectors: the operator input and output
+    LatticeFermionF w;
+    LatticeFermionF t;
+
+    // r = r0 = chi - A psi
+    A(t, psi, isign);
+    flopcount.addFlops(A.nFlops());
+    w[s] = chi - t;
+
+    HalfPrecFermion r(s);
+    HalfPrecFermion r0(s);
+    r.encode(w);
+    r0 = r;
+
+    // p = v = 0
+    HalfPrecFermion p(s);
+    HalfPrecFermion v(s);
+
+    DComplex rho, rho_prev, alpha, omega;
+    rho_prev = Double(1);
+    alpha = Double(1);
+    omega = Double(1);
+
+    for(int k = 1; k <= MaxBiCGStab && !convP ; k++)
+    {
+      // rho_{k+1} = < r_0 | r >
+      rho = innerProduct(r0, r);
+
+      if( toBool( real(rho) == 0 ) && toBool( imag(rho) == 0 ) ) {
+	QDPIO::cout << "BiCGStabHalf breakdown: rho = 0" << std::endl;
+	QDP_abort(1);
+      }
+
+      // p = r + beta(p - omega v)
+      DComplex beta = ( rho / rho_prev ) * (alpha/omega);
+      xpbypcz(p, r, beta, p, -beta*omega, v);
+
+      // v = A p
+      p.decode(w);
+      A(t, w, isign);
+      v.encode(t);
+
+      // alpha = rho_{k+1} / < r_0 | v >
+      DComplex ctmp = innerProduct(r0, v);
+
+      if( toBool( real(ctmp) == 0 ) && toBool( imag(ctmp) == 0 ) ) {
+	QDPIO::cout << "BiCGStabHalf breakdown: <r_0|v> = 0" << std::endl;
+	QDP_abort(1);
+      }
+
+      alpha = rho / ctmp;
+      rho_prev = rho;
+
+      // s = r - alpha v, kept in single precision
+      xpby(w, r, -alpha, v);
+
+      // t = A s
+      A(t, w, isign);
+
+      // omega = < t | s > / < t | t >
+      Double t_norm = norm2(t,s);
+
+      if( toBool(t_norm == 0) ) {
+	QDPIO::cerr << "Breakdown || Ms || = || t || = 0 " << std::endl;
+	QDP_abort(1);
+      }
+
+      omega = innerProduct(t,w,s);
+      omega /= t_norm;
+
+      // psi = psi + omega s + alpha p
+      ComplexF omega_r = omega;
+      psi[s] += omega_r*w;
+      axpy(psi, alpha, p);
+
+      // r = s - omega t
+      w[s] -= omega_r*t;
+      r.encode(w);
+
+      Double r_norm = norm2(w,s);
+
+      if( toBool(r_norm < rsd_sq ) ) {
+	convP = true;
+	ret.resid = sqrt(r_norm);
+	ret.n_count = k;
+      }
+
+      flopcount.addSiteFlops(80*Nc*Ns,s);
+      flopcount.addFlops(2*A.nFlops());
+    }
+
+    swatch.stop();
+
+    QDPIO::cout << "InvBiCGStabHalf: k = " << ret.n_count << " resid = " << ret.resid << std::endl;
+    flopcount.report("invbicgstab_half", swatch.getTimeInSeconds());
+
+    if ( ret.n_count == MaxBiCGStab ) {
+      QDPIO::cerr << "Nonconvergence of BiCGStabHalf. MaxIters reached " << std::endl;
+    }
+
+    END_CODE();
+#else
+    QDPIO::cerr << "InvBiCGStabHalf: not available with QDP-JIT" << std::endl;
+    QDP_abort(1);
+#endif
+
+    return ret;
+  }
+
+}  // end namespace Chroma
@@ -0,0 +1,34 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief BiCGStab with the Krylov vectors in 16 bit storage
+ */
+
+#ifndef __invbicgstab_half_h__
+#define __invbicgstab_half_h__
+
+#include "linearop.h"
+#include "syssolver.h"
+
+namespace Chroma
+{
+
+  //! Bi-CG stabilized with 16 bit Krylov vectors
+  /*! \ingroup invert
+   *
+   * The vectors r, r0, p and v are HalfPrecFermions. A single precision
+   * work vector holds the input and output of A, and the solution psi
+   * is accumulated in single precision. Meant as the inner solver of a
+   * defect correction, e.g. RICHARDSON_MP_CLOVER_INVERTER, where the
+   * outer iteration restores the accuracy.
+   */
+  SystemSolverResults_t
+  InvBiCGStabHalf(const LinearOperator<LatticeFermionF>& A,
+		  const LatticeFermionF& chi,
+		  LatticeFermionF& psi,
+		  const Real& RsdBiCGStab,
+		  int MaxBiCGStab,
+		  enum PlusMinus isign);
+
+}  // end namespace Chroma
+
+#endif
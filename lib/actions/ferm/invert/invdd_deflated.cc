@@ -1,108 +1,572 @@
 /*! \file
- *  \brief Conjugate-Gradient algorithm for a generic Linear Operator
+ *  \brief Domain-decomposed inexact deflation (Luscher's local coherence deflation)
  */
 
 #include "chromabase.h"
 #include "actions/ferm/invert/invdd_deflated.h"
 
+#include <algorithm>
+#include <map>
+#include <set>
 
-namespace Chroma {
-
-	namespace InvDDDeflatedEnv {
-
-
-		/*****************************************************
-		 * A : The linear operator which is to be inverted 
-		 * chi : The source on which to invert
-		 * psi : the result of the inversion
-		 * vecs : The vectors which span the deflation subspace
-		 * blk : The definition of the domain decompostion
-		 * RsdCG : The maximim allowed residual
-		 * MaxCG : The maximum number of iterations
-		 * *******************************************************/
-
-  SystemSolverResults_t 
-ddDeflInv(const LinearOperator<LatticeFermion>& A,
-       const LatticeFermion& chi,
-       LatticeFermion& psi,
-			 const mutli1d<LatticeFermion>& vecs,
-			 const QDP::Set blk,
-       const Real& RsdCG, 
-       int MaxCG) {
-
-		START_CODE();
-
-		//The struct which contains inversion information
-  SystemSolverResults_t  res;
-
-	//First, form the projection of chi onto the deflation subspace
-	int nvecs_per_block = vecs.size();
-	int nblocks = blk.getNumSubsets();
-	multi1d<Complex> chi_little(nblocks * nvecs_per_block);
-	int cntr = 0;
-	for (int v = 0 ; v < nvecs_per_block ; ++v) {
-		LatticeComplex prod = localInnerProduct( vecs[v] , chi);
-		multi1d<Complex> temp = sumMulti( prod, blk);
-		for (int b = 0 ; b < nblocks ; ++b) {
-			chi_little[cntr] = temp[b];
-			cntr++;
-		}
+
+namespace Chroma
+{
+
+#ifndef QDP_IS_QDPJIT
+  namespace InvDDDeflatedEnv
+  {
+    //! Anonymous namespace
+    namespace
+    {
+      //! Lexicographic index, direction 0 fastest
+      int lexIndex(const multi1d<int>& x, const multi1d<int>& n)
+      {
+	int idx = 0;
+	for(int mu=Nd-1; mu >= 0; --mu)
+	  idx = idx*n[mu] + x[mu];
+	return idx;
+      }
+
+      //! Coordinates of a lexicographic index
+      multi1d<int> lexCoords(int idx, const multi1d<int>& n)
+      {
+	multi1d<int> x(Nd);
+	for(int mu=0; mu < Nd; ++mu)
+	{
+	  x[mu] = idx % n[mu];
+	  idx /= n[mu];
+	}
+	return x;
+      }
+
+      //! <a,b> of little vectors, summed over the nodes
+      LittleComplex dot(const LittleVector& a, const LittleVector& b)
+      {
+	LittleComplex d(0,0);
+	for(int i=0; i < a.size(); ++i)
+	  d += std::conj(a[i]) * b[i];
+
+	double sum[2] = {d.real(), d.imag()};
+	QDPInternal::globalSumArray(sum, 2);
+	return LittleComplex(sum[0], sum[1]);
+      }
+
+      //! y += alpha x of little vectors
+      void axpy(LittleVector& y, LittleComplex alpha, const LittleVector& x)
+      {
+	for(int i=0; i < y.size(); ++i)
+	  y[i] += alpha * x[i];
+      }
+    }
+
+
+    //---------------------------------------------------------------------
+    // Full constructor
+    DDBlockGeometry::DDBlockGeometry(const multi1d<int>& blocking, const Subset& s, int range) :
+      block(blocking), blockNum(Nd)
+    {
+      START_CODE();
+
+      if (blocking.size() != Nd)
+      {
+	QDPIO::cerr << "DDBlockGeometry: blocking must have Nd entries" << std::endl;
+	QDP_abort(1);
+      }
+
+      nblocks = 1;
+      nslots = 1;
+      for(int mu=0; mu < Nd; ++mu)
+      {
+	if (block[mu] <= 0 || Layout::lattSize()[mu] % block[mu] != 0)
+	{
+	  QDPIO::cerr << "DDBlockGeometry: block size " << block[mu]
+		      << " does not divide the lattice in direction " << mu << std::endl;
+	  QDP_abort(1);
+	}
+
+	blockNum[mu] = Layout::lattSize()[mu] / block[mu];
+	if (blockNum[mu] != 1 && blockNum[mu] % 2 != 0)
+	{
+	  QDPIO::cerr << "DDBlockGeometry: need 1 or an even number of blocks in direction " << mu
+		      << ", found " << blockNum[mu] << std::endl;
+	  QDP_abort(1);
+	}
+
+	if (Layout::subgridLattSize()[mu] % block[mu] != 0)
+	{
+	  QDPIO::cerr << "DDBlockGeometry: block size " << block[mu]
+		      << " does not divide the node sub-lattice in direction " << mu << std::endl;
+	  QDP_abort(1);
+	}
+
+	if (blockNum[mu] != 1 && block[mu] < 2*range)
+	{
+	  QDPIO::cerr << "DDBlockGeometry: block size " << block[mu] << " in direction " << mu
+		      << " is smaller than twice the operator range " << range << std::endl;
+	  QDP_abort(1);
+	}
+
+	nblocks *= blockNum[mu];
+	nslots *= 3;
+      }
+
+      // Sort the sites of the subset on this node into their blocks
+      const int* tab = s.siteTable().slice();
+      for(int i=0; i < s.numSiteTable(); ++i)
+      {
+	const int site = tab[i];
+	multi1d<int> x = Layout::siteCoords(Layout::nodeNumber(), site);
+
+	multi1d<int> bc(Nd);
+	int up = 0;
+	for(int mu=0; mu < Nd; ++mu)
+	{
+	  bc[mu] = x[mu] / block[mu];
+	  if (x[mu] % block[mu] >= block[mu]/2)
+	    up |= 1 << mu;
+	}
+
+	const int gb = lexIndex(bc, blockNum);
+	std::map<int,int>::const_iterator it = lblock.find(gb);
+	int lb;
+	if (it == lblock.end())
+	{
+	  lb = gblock.size();
+	  lblock[gb] = lb;
+
+	  int col = 0;
+	  for(int mu=0; mu < Nd; ++mu)
+	    col |= (bc[mu] & 1) << mu;
+
+	  gblock.push_back(gb);
+	  local_colour.push_back(col);
+	  bcoord.push_back(bc);
+	  site_list.push_back(std::vector<int>());
+	  upper.push_back(std::vector<int>());
+	}
+	else
+	  lb = it->second;
+
+	site_list[lb].push_back(site);
+	upper[lb].push_back(up);
+      }
+
+      END_CODE();
+    }
+
+
+    // Local index of a block, -1 if it is not on this node
+    int DDBlockGeometry::localBlock(int gb) const
+    {
+      std::map<int,int>::const_iterator it = lblock.find(gb);
+      return (it == lblock.end()) ? -1 : it->second;
+    }
+
+
+    // Node holding a block, the one with its first site
+    int DDBlockGeometry::owner(int gb) const
+    {
+      multi1d<int> x = lexCoords(gb, blockNum);
+      for(int mu=0; mu < Nd; ++mu)
+	x[mu] *= block[mu];
+      return Layout::nodeNumber(x);
+    }
+
+
+    // Whether there are blocks of a colour
+    bool DDBlockGeometry::colourUsed(int c) const
+    {
+      for(int mu=0; mu < Nd; ++mu)
+	if (blockNum[mu] == 1 && ((c >> mu) & 1))
+	  return false;
+      return true;
+    }
+
+
+    // Offset of the block of colour c coupling into the j-th site of a local block
+    int DDBlockGeometry::slot(int lb, int j, int c) const
+    {
+      int sl = 0;
+      int p = 1;
+      for(int mu=0; mu < Nd; ++mu, p *= 3)
+      {
+	const int cb = (c >> mu) & 1;
+	if (blockNum[mu] == 1 && cb)
+	  return -1;
+
+	int e = 0;
+	if (cb != (bcoord[lb][mu] & 1))
+	  e = ((upper[lb][j] >> mu) & 1) ? 1 : -1;
+
+	sl += (e+1)*p;
+      }
+      return sl;
+    }
+
+
+    // Global index of the block at an offset from a block
+    int DDBlockGeometry::neighbour(int gb, int sl) const
+    {
+      multi1d<int> bc = lexCoords(gb, blockNum);
+      for(int mu=0; mu < Nd; ++mu)
+      {
+	const int e = sl % 3 - 1;
+	sl /= 3;
+	bc[mu] = (bc[mu] + e + blockNum[mu]) % blockNum[mu];
+      }
+      return lexIndex(bc, blockNum);
+    }
+
+
+    //---------------------------------------------------------------------
+    // Empty operator on a geometry
+    LittleDiracOp::LittleDiracOp(const DDBlockGeometry& geom_, int nvec_) :
+      geom(geom_), nvec(nvec_), rows(geom_.numLocalBlocks()),
+      index(geom_.numLocalBlocks(), std::vector<int>(geom_.numSlots(), -1)),
+      compressed(false)
+    {
+#if defined(ARCH_PARSCALAR)
+      mh_gather = 0;
+      mh_scatter = 0;
+#endif
+      setupComms();
+    }
+
+
+    // Frees the messages
+    LittleDiracOp::~LittleDiracOp()
+    {
+#if defined(ARCH_PARSCALAR)
+      if (mh_gather != 0)
+	QMP_free_msghandle(mh_gather);
+      if (mh_scatter != 0)
+	QMP_free_msghandle(mh_scatter);
+      for(int i=0; i < msg.size(); ++i)
+	QMP_free_msgmem(msg[i]);
+#endif
+    }
+
+
+    // Find the neighbouring nodes and declare the messages
+    /*
+     * A block b' on another node next to a local block b at some offset
+     * has b next to it at the opposite offset. So the blocks this node
+     * sends to a node and the ones that node sends back are found on
+     * both sides from the geometry alone, and sorted by global index
+     * they come in the same order.
+     */
+    void LittleDiracOp::setupComms()
+    {
+      const int me = Layout::nodeNumber();
+      std::map<int, std::pair< std::set<int>, std::set<int> > > plan;
+
+      for(int lb=0; lb < geom.numLocalBlocks(); ++lb)
+      {
+	const int gb = geom.globalBlock(lb);
+	for(int sl=0; sl < geom.numSlots(); ++sl)
+	{
+	  const int nb = geom.neighbour(gb, sl);
+	  const int node = geom.owner(nb);
+	  if (node == me)
+	    continue;
+
+	  plan[node].first.insert(gb);
+	  plan[node].second.insert(nb);
+	}
+      }
+
+      for(std::map<int, std::pair< std::set<int>, std::set<int> > >::const_iterator p = plan.begin();
+	  p != plan.end(); ++p)
+      {
+	NodeLink l;
+	l.node = p->first;
+
+	for(std::set<int>::const_iterator b = p->second.first.begin(); b != p->second.first.end(); ++b)
+	  l.send_blocks.push_back(geom.localBlock(*b));
+
+	int n = 0;
+	for(std::set<int>::const_iterator b = p->second.second.begin(); b != p->second.second.end(); ++b, ++n)
+	  ghost_index[*b] = std::make_pair(int(links.size()), n*nvec);
+
+	l.send.assign(l.send_blocks.size()*nvec, LittleComplex(0,0));
+	l.ghost.assign(n*nvec, LittleComplex(0,0));
+	links.push_back(l);
+      }
+
+      if (links.empty())
+	return;
+
+#if defined(ARCH_PARSCALAR)
+      // Gathering sends the boundary entries and receives the ghosts,
+      // scattering sends the ghosts back into the boundary buffers
+      std::vector<QMP_msghandle_t> gather;
+      std::vector<QMP_msghandle_t> scatter;
+      for(int i=0; i < links.size(); ++i)
+      {
+	NodeLink& l = links[i];
+	QMP_msgmem_t ms = QMP_declare_msgmem(&(l.send[0]), l.send.size()*sizeof(LittleComplex));
+	QMP_msgmem_t mg = QMP_declare_msgmem(&(l.ghost[0]), l.ghost.size()*sizeof(LittleComplex));
+	msg.push_back(ms);
+	msg.push_back(mg);
+
+	gather.push_back(QMP_declare_send_to(ms, l.node, 0));
+	gather.push_back(QMP_declare_receive_from(mg, l.node, 0));
+	scatter.push_back(QMP_declare_send_to(mg, l.node, 0));
+	scatter.push_back(QMP_declare_receive_from(ms, l.node, 0));
+      }
+
+      bool ok = true;
+      for(int i=0; i < msg.size(); ++i)
+	ok = ok && (msg[i] != 0) && (gather[i] != 0) && (scatter[i] != 0);
+
+      if (ok)
+      {
+	mh_gather = QMP_declare_multiple(&(gather[0]), gather.size());
+	mh_scatter = QMP_declare_multiple(&(scatter[0]), scatter.size());
+      }
+
+      if (! ok || mh_gather == 0 || mh_scatter == 0)
+      {
+	QDPIO::cerr << "LittleDiracOp: failed to declare the messages" << std::endl;
+	QDP_abort(1);
+      }
+#else
+      QDPIO::cerr << "LittleDiracOp: blocks on other nodes need ARCH_PARSCALAR" << std::endl;
+      QDP_abort(1);
+#endif
+    }
+
+
+    // Send and receive the boundary entries, or the sums for them
+    void LittleDiracOp::exchange(bool gather) const
+    {
+#if defined(ARCH_PARSCALAR)
+      if (links.empty())
+	return;
+
+      QMP_msghandle_t mh = gather ? mh_gather : mh_scatter;
+      QMP_status_t err;
+      if ((err = QMP_start(mh)) != QMP_SUCCESS || (err = QMP_wait(mh)) != QMP_SUCCESS)
+      {
+	QDPIO::cerr << "LittleDiracOp: " << QMP_error_string(err) << std::endl;
+	QDP_abort(1);
+      }
+#endif
+    }
+
+
+    // The entries of a local block and offset, allocated on first use
+    LittleComplex* LittleDiracOp::entries(int lb, int sl)
+    {
+      if (compressed)
+      {
+	QDPIO::cerr << "LittleDiracOp: entries of a compressed operator" << std::endl;
+	QDP_abort(1);
+      }
+
+      int& i = index[lb][sl];
+      if (i < 0)
+      {
+	Coupling cp;
+	cp.slot = sl;
+	cp.nb = geom.neighbour(geom.globalBlock(lb), sl);
+
+	const int nlb = geom.localBlock(cp.nb);
+	if (nlb >= 0)
+	{
+	  cp.link = -1;
+	  cp.col = nlb*nvec;
+	}
+	else
+	{
+	  const std::pair<int,int>& g = ghost_index.find(cp.nb)->second;
+	  cp.link = g.first;
+	  cp.col = g.second;
 	}
+	cp.m.assign(nvec*nvec, LittleComplex(0,0));
+
+	i = rows[lb].size();
+	rows[lb].push_back(cp);
+      }
+      return &(rows[lb][i].m[0]);
+    }
 
-	//Next, solve the little dirac equation with chi_little as a source
-	multi1d<Complex> ainv_chi_little;
-	SystemSolverResults_t lres = solve_little( A, chi_little, ainv_chi_little, 
-			vecs, blk, RsdCG, MaxCG);
-
-	//Now Form P_L * \chi
-	///!!!!Could be sped up???
-	LatticeFermion pl_chi = chi;
-	cntr = 0;
-	for (int v = 0 ; v < nvecs_per_block ; ++v) 
-			for (int b = 0 ; b < nblocks ; ++b) {
-				LatticeFermion temp = zero;
-				//Need to restrict the action of A to a subspace, I hope this works
-				A(temp[blk[b]], vecs[v], Plus); 
-				pl_chi[blk[b]] -= temp * ainv_chi_little[cntr];
-				cntr++;
-			}
-
-	//Now send P_L * \chi to a normal solver
-	SystemSolverResults_t dres = any_old_solve(A, psi, pl_chi);
-	
-	//Act with P_R on psi
-	LatticeFermion dpsi = zero;
-	A(dpsi, psi, Plus);
-	multi1d<Complex> dpsi_little(nblocks * nvecs_per_block);
-	cntr = 0;
-	for (int v = 0 ; v < nvecs_per_block ; ++v) {
-		LatticeComplex prod = localInnerProduct( vecs[v] , dpsi);
-		multi1d<Complex> temp = sumMulti( prod, blk);
-		for (int b = 0 ; b < nblocks ; ++b) { 
-			dpsi_little[cntr] = temp[b];	
-			cntr++;
-		}
+
+    // Drop the offsets without entries
+    void LittleDiracOp::compress()
+    {
+      int nkept = 0;
+      for(int lb=0; lb < rows.size(); ++lb)
+      {
+	std::vector<Coupling> kept;
+	for(int i=0; i < rows[lb].size(); ++i)
+	{
+	  const std::vector<LittleComplex>& m = rows[lb][i].m;
+	  bool nonzero = false;
+	  for(int k=0; k < m.size() && ! nonzero; ++k)
+	    nonzero = (m[k] != LittleComplex(0,0));
+
+	  if (nonzero)
+	    kept.push_back(rows[lb][i]);
 	}
+	rows[lb].swap(kept);
+	nkept += rows[lb].size();
+      }
+
+      index.clear();
+      compressed = true;
+
+      int nghost = 0;
+      for(int i=0; i < links.size(); ++i)
+	nghost += links[i].ghost.size() / nvec;
+
+      QDPIO::cout << "LittleDiracOp: " << geom.numBlocks() << " blocks of " << nvec
+		  << " vectors, " << nkept << " couplings and " << nghost
+		  << " blocks of other nodes on node " << Layout::nodeNumber() << std::endl;
+    }
+
+
+    // y = A_l x  or  y = A_l^dag x
+    void LittleDiracOp::apply(LittleVector& y, const LittleVector& x, enum PlusMinus isign) const
+    {
+      y.assign(size(), LittleComplex(0,0));
+
+      if (isign == PLUS)
+      {
+	// Bring in the entries of the neighbours on other nodes
+	for(int l=0; l < links.size(); ++l)
+	  for(int s=0; s < links[l].send_blocks.size(); ++s)
+	    for(int k=0; k < nvec; ++k)
+	      links[l].send[s*nvec + k] = x[links[l].send_blocks[s]*nvec + k];
+
+	exchange(true);
+      }
+      else
+      {
+	for(int l=0; l < links.size(); ++l)
+	  std::fill(links[l].ghost.begin(), links[l].ghost.end(), LittleComplex(0,0));
+      }
+
+      for(int lb=0; lb < rows.size(); ++lb)
+      {
+	for(int c=0; c < rows[lb].size(); ++c)
+	{
+	  const Coupling& cp = rows[lb][c];
+	  const LittleComplex* m = &(cp.m[0]);
+
+	  if (isign == PLUS)
+	  {
+	    // Row lb of A_l, from column nb
+	    const LittleComplex* xs = (cp.link < 0) ? &(x[cp.col]) : &(links[cp.link].ghost[cp.col]);
+	    LittleComplex* yr = &(y[lb*nvec]);
+	    for(int i=0; i < nvec; ++i)
+	      for(int k=0; k < nvec; ++k)
+		yr[i] += m[i*nvec + k] * xs[k];
+	  }
+	  else
+	  {
+	    // Row nb of A_l^dag, from column lb
+	    const LittleComplex* xs = &(x[lb*nvec]);
+	    LittleComplex* yr = (cp.link < 0) ? &(y[cp.col]) : &(links[cp.link].ghost[cp.col]);
+	    for(int i=0; i < nvec; ++i)
+	      for(int k=0; k < nvec; ++k)
+		yr[k] += std::conj(m[i*nvec + k]) * xs[i];
+	  }
+	}
+      }
+
+      if (isign == MINUS)
+      {
+	// Hand the sums on the neighbours on other nodes back
+	exchange(false);
+
+	for(int l=0; l < links.size(); ++l)
+	  for(int s=0; s < links[l].send_blocks.size(); ++s)
+	    for(int k=0; k < nvec; ++k)
+	      y[links[l].send_blocks[s]*nvec + k] += links[l].send[s*nvec + k];
+      }
+    }
+
+
+    // Solve A_l x = b  or  A_l^dag x = b  by restarted GCR
+    SystemSolverResults_t LittleDiracOp::solve(LittleVector& x, const LittleVector& b, enum PlusMinus isign,
+					       double rsd, int max_iter, int nkrylov) const
+    {
+      SystemSolverResults_t res;
+      const int n = size();
+
+      x.assign(n, LittleComplex(0,0));
+
+      const double bnorm = std::sqrt(dot(b,b).real());
+      if (bnorm == 0.0)
+      {
+	res.n_count = 0;
+	res.resid = zero;
+	return res;
+      }
+
+      LittleVector r(b);
+      double rnorm = bnorm;
+      double rcycle = bnorm;
+      std::vector<LittleVector> p(nkrylov);
+      std::vector<LittleVector> ap(nkrylov);
+
+      int iter = 0;
+      while (rnorm > rsd*bnorm && iter < max_iter)
+      {
+	for(int j=0; j < nkrylov && rnorm > rsd*bnorm && iter < max_iter; ++j, ++iter)
+	{
+	  p[j] = r;
+	  apply(ap[j], p[j], isign);
+
+	  // Keep the A p orthonormal
+	  for(int i=0; i < j; ++i)
+	  {
+	    const LittleComplex beta = -dot(ap[i], ap[j]);
+	    axpy(ap[j], beta, ap[i]);
+	    axpy(p[j], beta, p[i]);
+	  }
+
+	  const double apnorm = std::sqrt(dot(ap[j], ap[j]).real());
+	  if (apnorm == 0.0)
+	    break;
+
+	  for(int i=0; i < n; ++i)
+	  {
+	    ap[j][i] /= apnorm;
+	    p[j][i] /= apnorm;
+	  }
+
+	  const LittleComplex alpha = dot(ap[j], r);
+	  axpy(x, alpha, p[j]);
+	  axpy(r, -alpha, ap[j]);
+	  rnorm = std::sqrt(dot(r,r).real());
+	}
+
+	// Restart from the true residual
+	LittleVector ax;
+	apply(ax, x, isign);
+	for(int i=0; i < n; ++i)
+	  r[i] = b[i] - ax[i];
+	const double rtrue = std::sqrt(dot(r,r).real());
+
+	// No progress over a whole cycle
+	if (rtrue >= rcycle)
+	{
+	  QDPIO::cout << "LittleDiracOp: GCR stagnated at rsd = " << rtrue/bnorm << std::endl;
+	  rnorm = rtrue;
+	  break;
+	}
+	rnorm = rcycle = rtrue;
+      }
+
+      res.n_count = iter;
+      res.resid = rnorm;
+      return res;
+    }
+
+  } // namespace InvDDDeflatedEnv
+#endif
 
-	cntr = 0; 
-	for (int v = 0 ; v < nvecs_per_block ; ++v) 
-		for (int b = 0 ; b < nblocks ; ++b) {
-			psi[blk[b]] -= vecs[v] * dpsi_little[cntr];
-			cntr++;
-		}
-		
-	//Add the little solution to the orthogonal compliment solution
-	cntr = 0;
-	for (int v = 0 ; v < nvecs_per_block ; ++v) 
-		for (int b = 0 ; b < nblocks ; ++b)
-		{
-			psi[blk[b]] += ainv_chi_little[cntr] * vecs[v];
-			cntr++;
-		}
-
-   END_CODE();
-  return res;
-}
-
-} //end namespace
-}  // end namespace Chroma
+} // namespace Chroma
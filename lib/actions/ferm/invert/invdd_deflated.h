@@ -1,25 +1,712 @@
 // -*- C++ -*-
 /*! \file
- *  Domain-Decomposed Deflated inverter  
+ *  \brief Domain-decomposed inexact deflation (Luscher's local coherence deflation)
+ *
+ *  The lattice is cut into blocks, and a few global vectors rich in the
+ *  low modes of the operator A are cut into their block-local pieces and
+ *  orthonormalised within each block. These span the deflation space
+ *  V = {psi_{b,k}}, of dimension (number of blocks) x (vectors). The
+ *  little Dirac operator A_l = V^dag A V couples a block only to itself
+ *  and its neighbours, so it is stored as a sparse matrix of small dense
+ *  blocks. A solve of A psi = chi then runs a Krylov solver on the
+ *  projected system
+ *
+ *     P_L A chi' = P_L chi,    P_L = 1 - A V A_l^-1 V^dag
+ *
+ *  and puts the solution back together as
+ *
+ *     psi = V A_l^-1 V^dag chi + (1 - V A_l^-1 V^dag A) chi'
  */
 
 #ifndef __invdd_deflated__
 #define __invdd_deflated__
 
+#include "chromabase.h"
+#include "handle.h"
 #include "linearop.h"
 #include "syssolver.h"
+#include "util/ferm/block_inner_product.h"
 
-namespace Chroma {
+#include <vector>
+#include <complex>
+#include <map>
 
+#if defined(ARCH_PARSCALAR)
+#include <qmp.h>
+#endif
+
+namespace Chroma
+{
+
+#ifndef QDP_IS_QDPJIT
+  namespace InvDDDeflatedEnv
+  {
+    //! Complex coefficients of the little vectors, nvec per local block
+    typedef std::complex<double>  LittleComplex;
+    typedef std::vector<LittleComplex>  LittleVector;
+
+
+    //! Blocking of the lattice and the blocks with sites on this node
+    /*! \ingroup invert
+     *
+     * Blocks are numbered lexicographically, direction 0 fastest, and
+     * must not straddle nodes, so each block lives on one node. The
+     * couplings of the little operator are found with a colouring of the
+     * blocks by the parity of their coordinates. For this the number of
+     * blocks in each direction must be 1 or even, and the operator must
+     * not reach further than half a block, so that all it brings into a
+     * half block from a block of another colour comes from one block.
+     */
+    class DDBlockGeometry
+    {
+    public:
+      //! Full constructor
+      /*!
+       * \param blocking  block extents  ( Read )
+       * \param s         subset of the operator  ( Read )
+       * \param range     reach of the operator in sites  ( Read )
+       */
+      DDBlockGeometry(const multi1d<int>& blocking, const Subset& s, int range);
+
+      //! Blocks of the lattice
+      int numBlocks() const {return nblocks;}
+
+      //! Blocks with sites of the subset on this node
+      int numLocalBlocks() const {return gblock.size();}
+
+      //! Global index of a local block
+      int globalBlock(int lb) const {return gblock[lb];}
+
+      //! Local index of a block, -1 if it is not on this node
+      int localBlock(int gb) const;
+
+      //! Node holding a block
+      int owner(int gb) const;
+
+      //! Local site indices of a local block
+      const std::vector<int>& sites(int lb) const {return site_list[lb];}
+
+      //! Number of colours of the blocks
+      int numColours() const {return 1 << Nd;}
+
+      //! Whether there are blocks of a colour
+      bool colourUsed(int c) const;
+
+      //! Colour of a local block
+      int colour(int lb) const {return local_colour[lb];}
+
+      //! Number of offsets of a neighbouring block
+      int numSlots() const {return nslots;}
+
+      //! Offset of the block of colour c coupling into the j-th site of a local block
+      /*! Returns -1 if there is none */
+      int slot(int lb, int j, int c) const;
+
+      //! Global index of the block at an offset from a block
+      int neighbour(int gb, int slot) const;
+
+    private:
+      multi1d<int>  block;       /*!< block extents */
+      multi1d<int>  blockNum;    /*!< blocks per direction */
+      int           nblocks;
+      int           nslots;
+
+      std::map<int,int>                lblock;        /*!< global -> local block */
+      std::vector<int>                 gblock;        /*!< per local block */
+      std::vector<int>                 local_colour;  /*!< per local block */
+      std::vector< multi1d<int> >      bcoord;        /*!< per local block */
+      std::vector< std::vector<int> >  site_list;     /*!< per local block */
+      std::vector< std::vector<int> >  upper;         /*!< per site, bit mu set in the upper half in mu */
+    };
+
+
+    //! Little Dirac operator  A_l = V^dag A V
+    /*! \ingroup invert
+     *
+     * Each node holds the rows of its blocks, and the little vectors
+     * only the entries of its blocks. An application exchanges the
+     * entries of the blocks next to a node boundary with the nodes
+     * holding their neighbours, and the dagger sends the sums for the
+     * neighbours back to their nodes.
+     */
+    class LittleDiracOp
+    {
+    public:
+      //! Empty operator on a geometry
+      LittleDiracOp(const DDBlockGeometry& geom, int nvec);
+
+      //! Frees the messages
+      ~LittleDiracOp();
+
+      //! Dimension of the little vectors on this node
+      int size() const {return geom.numLocalBlocks()*nvec;}
+
+      //! The nvec x nvec entries of a local block and offset, row major
+      /*! Allocated on first use. Different blocks may be filled by different threads */
+      LittleComplex* entries(int lb, int slot);
+
+      //! Drop the offsets without entries
+      void compress();
+
+      //! y = A_l x  or  y = A_l^dag x
+      void apply(LittleVector& y, const LittleVector& x, enum PlusMinus isign) const;
+
+      //! Solve A_l x = b  or  A_l^dag x = b  by restarted GCR from a zero guess
+      SystemSolverResults_t solve(LittleVector& x, const LittleVector& b, enum PlusMinus isign,
+				  double rsd, int max_iter, int nkrylov) const;
+
+    private:
+      //! Hide copies, they would free the messages twice
+      LittleDiracOp(const LittleDiracOp&);
+      void operator=(const LittleDiracOp&);
+
+      //! Find the neighbouring nodes and declare the messages
+      void setupComms();
+
+      //! Send and receive the boundary entries, or the sums for them
+      void exchange(bool gather) const;
+
+      struct Coupling
+      {
+	int                        slot;
+	int                        nb;    /*!< global neighbour block */
+	int                        link;  /*!< node link holding nb, -1 if it is local */
+	int                        col;   /*!< offset of nb in the local or ghost entries */
+	std::vector<LittleComplex> m;     /*!< nvec x nvec, row major */
+      };
+
+      //! Entries exchanged with one neighbouring node, blocks in global order
+      struct NodeLink
+      {
+	int                                 node;
+	std::vector<int>                    send_blocks;  /*!< local blocks it needs */
+	mutable std::vector<LittleComplex>  send;         /*!< their entries */
+	mutable std::vector<LittleComplex>  ghost;        /*!< entries of its blocks we need */
+      };
+
+      const DDBlockGeometry&               geom;
+      int                                  nvec;
+      std::vector< std::vector<Coupling> > rows;   /*!< per local block */
+      std::vector< std::vector<int> >      index;  /*!< per local block, slot -> coupling while filling */
+      bool                                 compressed;
+
+      std::vector<NodeLink>                     links;
+      std::map<int, std::pair<int,int> >        ghost_index;  /*!< remote block -> link and offset */
+#if defined(ARCH_PARSCALAR)
+      std::vector<QMP_msgmem_t>  msg;
+      QMP_msghandle_t            mh_gather;   /*!< send the boundary entries, receive the ghosts */
+      QMP_msghandle_t            mh_scatter;  /*!< send the sums on the ghosts back */
+#endif
+    };
+
+
+    /*! Hide the site loops for the thread dispatcher in here */
+    template<typename T> class DDDeflationSpace;
+
+    template<typename T>
+    struct BlockArgs
+    {
+      const DDDeflationSpace<T>*  space;
+      T*                          x;
+      const T*                    y;
+      LittleComplex*              c;
+      int                         k;
+      int                         colour;
+      LittleDiracOp*              little;
+    };
+
+    template<typename T>
+    void restrictBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a);
+
+    template<typename T>
+    void prolongBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a);
+
+    template<typename T>
+    void dotBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a);
+
+    template<typename T>
+    void axpyBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a);
+
+    template<typename T>
+    void maskBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a);
+
+    template<typename T>
+    void assembleBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a);
+
+
+    //! Block-local deflation space and its little Dirac operator
+    /*! \ingroup invert */
+    template<typename T>
+    class DDDeflationSpace
+    {
+    public:
+      typedef typename WordType<T>::Type_t W;
+
+      //! Full constructor
+      /*!
+       * \param A_        operator  ( Read )
+       * \param blocking  block extents  ( Read )
+       * \param nvec_     vectors per block  ( Read )
+       * \param range     reach of the operator in sites  ( Read )
+       */
+      DDDeflationSpace(Handle< LinearOperator<T> > A_, const multi1d<int>& blocking,
+		       int nvec_, int range) :
+	A(A_), geom(blocking, A_->subset(), range), nvec(nvec_), vecs(nvec_), little(geom, nvec_),
+	coarse_rsd(1.0e-12), coarse_max_iter(500), coarse_nkrylov(16)
+	{}
+
+      //! Parameters of the little solves
+      void setCoarseParams(double rsd, int max_iter, int nkrylov)
+	{
+	  coarse_rsd = rsd;
+	  coarse_max_iter = max_iter;
+	  coarse_nkrylov = nkrylov;
+	}
+
+      //! Make the deflation vectors and the little operator
+      /*!
+       * The vectors start random and get setup_iter inverse iterations,
+       * each an approximate solve by setup_mr minimal residual steps.
+       * The random number state is restored afterwards.
+       */
+      void generate(int setup_iter, int setup_mr)
+	{
+	  START_CODE();
+
+	  const Subset& s = A->subset();
+
+	  Seed ran_seed;
+	  QDP::RNG::savern(ran_seed);
+	  for(int k=0; k < nvec; ++k)
+	  {
+	    vecs[k] = zero;
+	    gaussian(vecs[k], s);
+	  }
+	  QDP::RNG::setrn(ran_seed);
+	  orthonormalise();
+
+	  T tmp;
+	  for(int it=0; it < setup_iter; ++it)
+	  {
+	    for(int k=0; k < nvec; ++k)
+	    {
+	      approxInverse(tmp, vecs[k], setup_mr);
+	      vecs[k][s] = tmp;
+	    }
+	    orthonormalise();
+	  }
+
+	  blockOrthonormalise();
+	  assemble();
+
+	  END_CODE();
+	}
 
-	namespace InvDDDeflatedEnv {
-	
-SystemSolverResults_t 
-dd_def_inv(const LinearOperator<T>& A,
-       const T& chi,
-       T& psi,
-       const Real& RsdCG, 
-       int MaxCG, int MinCG=0);
+      //! The little operator
+      const LittleDiracOp& littleOp() const {return little;}
+
+      //! Block geometry
+      const DDBlockGeometry& geometry() const {return geom;}
+
+      //! Vectors per block
+      int numVecs() const {return nvec;}
+
+      //! k-th global deflation vector, the sum over blocks of psi_{b,k}
+      const T& vec(int k) const {return vecs[k];}
+
+      //! c = V^dag x, on the local blocks
+      void restrictVec(LittleVector& c, const T& x) const
+	{
+	  c.assign(little.size(), LittleComplex(0,0));
+	  BlockArgs<T> a = {this, 0, &x, &(c[0]), 0, 0, 0};
+	  dispatch_to_threads(geom.numLocalBlocks(), a, restrictBlockLoop<T>);
+	}
+
+      //! x += V c
+      void prolongVec(T& x, const LittleVector& c) const
+	{
+	  BlockArgs<T> a = {this, &x, 0, const_cast<LittleComplex*>(&(c[0])), 0, 0, 0};
+	  dispatch_to_threads(geom.numLocalBlocks(), a, prolongBlockLoop<T>);
+	}
+
+      //! x = A_l^-1 b  or  A_l^-dag b
+      void littleSolve(LittleVector& x, const LittleVector& b, enum PlusMinus isign) const
+	{
+	  SystemSolverResults_t res = little.solve(x, b, isign, coarse_rsd, coarse_max_iter, coarse_nkrylov);
+	  if (res.n_count >= coarse_max_iter)
+	    QDPIO::cout << "DDDeflationSpace: little solve not converged, rsd = " << res.resid << std::endl;
+	}
+
+    private:
+      //! Approximate x = A^-1 v by minimal residual steps from zero
+      void approxInverse(T& x, const T& v, int nsteps) const
+	{
+	  const Subset& s = A->subset();
+	  T r;
+	  T ar;
+
+	  x[s] = zero;
+	  r[s] = v;
+	  for(int i=0; i < nsteps; ++i)
+	  {
+	    (*A)(ar, r, PLUS);
+	    DComplex num = innerProduct(ar, r, s);
+	    Double   den = norm2(ar, s);
+	    if (toDouble(den) == 0.0)
+	      break;
+
+	    Complex alpha = num / den;
+	    x[s] += alpha * r;
+	    r[s] -= alpha * ar;
+	  }
+	}
+
+      //! Global Gram-Schmidt of the vectors
+      void orthonormalise()
+	{
+	  const Subset& s = A->subset();
+	  for(int k=0; k < nvec; ++k)
+	  {
+	    blockProject(vecs[k], vecs, k, s);
+	    vecs[k][s] *= Real(1) / sqrt(norm2(vecs[k], s));
+	  }
+	}
+
+      //! Gram-Schmidt of the block-local pieces within each block, done twice
+      void blockOrthonormalise()
+	{
+	  LittleVector d;
+	  for(int k=0; k < nvec; ++k)
+	  {
+	    for(int pass=0; pass < 2; ++pass)
+	    {
+	      for(int j=0; j < k; ++j)
+	      {
+		blockDot(d, vecs[j], vecs[k]);
+		for(int b=0; b < d.size(); ++b)
+		  d[b] = -d[b];
+		blockAxpy(vecs[k], d, vecs[j]);
+	      }
+	    }
+
+	    blockDot(d, vecs[k], vecs[k]);
+	    for(int b=0; b < d.size(); ++b)
+	    {
+	      if (d[b].real() <= 0.0)
+	      {
+		QDPIO::cerr << "DDDeflationSpace: vector " << k << " vanishes on block "
+			    << geom.globalBlock(b) << std::endl;
+		QDP_abort(1);
+	      }
+	      d[b] = LittleComplex(1.0/std::sqrt(d[b].real()) - 1.0, 0.0);
+	    }
+	    blockAxpy(vecs[k], d, vecs[k]);
+	  }
+	}
+
+      //! d_b = <x, y> on each local block
+      void blockDot(LittleVector& d, const T& x, const T& y) const
+	{
+	  d.assign(geom.numLocalBlocks(), LittleComplex(0,0));
+	  BlockArgs<T> a = {this, const_cast<T*>(&x), &y, &(d[0]), 0, 0, 0};
+	  dispatch_to_threads(geom.numLocalBlocks(), a, dotBlockLoop<T>);
+	}
+
+      //! x += d_b y on each block
+      void blockAxpy(T& x, const LittleVector& d, const T& y) const
+	{
+	  BlockArgs<T> a = {this, &x, &y, const_cast<LittleComplex*>(&(d[0])), 0, 0, 0};
+	  dispatch_to_threads(geom.numLocalBlocks(), a, axpyBlockLoop<T>);
+	}
+
+      //! Fill the little operator, one application of A per vector and colour
+      void assemble()
+	{
+	  T x;
+	  T y;
+	  for(int k=0; k < nvec; ++k)
+	  {
+	    for(int c=0; c < geom.numColours(); ++c)
+	    {
+	      if (! geom.colourUsed(c))
+		continue;
+
+	      // The k-th vectors of the blocks of colour c
+	      x = zero;
+	      BlockArgs<T> m = {this, &x, &(vecs[k]), 0, k, c, 0};
+	      dispatch_to_threads(geom.numLocalBlocks(), m, maskBlockLoop<T>);
+
+	      (*A)(y, x, PLUS);
+
+	      BlockArgs<T> a = {this, 0, &y, 0, k, c, &little};
+	      dispatch_to_threads(geom.numLocalBlocks(), a, assembleBlockLoop<T>);
+	    }
+	  }
+	  little.compress();
+	}
+
+      Handle< LinearOperator<T> > A;
+      DDBlockGeometry  geom;
+      int              nvec;
+      multi1d<T>       vecs;
+      LittleDiracOp    little;
+
+      double  coarse_rsd;
+      int     coarse_max_iter;
+      int     coarse_nkrylov;
+
+      friend void restrictBlockLoop<T>(int, int, int, BlockArgs<T>*);
+      friend void prolongBlockLoop<T>(int, int, int, BlockArgs<T>*);
+      friend void dotBlockLoop<T>(int, int, int, BlockArgs<T>*);
+      friend void axpyBlockLoop<T>(int, int, int, BlockArgs<T>*);
+      friend void maskBlockLoop<T>(int, int, int, BlockArgs<T>*);
+      friend void assembleBlockLoop<T>(int, int, int, BlockArgs<T>*);
+    };
+
+
+    //! Words of a site of a lattice vector
+    template<typename T>
+    inline
+    int siteWords(const T& x)
+    {
+      typedef typename WordType<T>::Type_t W;
+      return sizeof(x.elem(0)) / sizeof(W);
+    }
+
+    //! <a,b> of two sites
+    template<typename W>
+    inline
+    LittleComplex siteDot(const W* a, const W* b, int nr)
+    {
+      double re = 0;
+      double im = 0;
+      for(int i=0; i < nr; i += 2)
+      {
+	re += (double)a[i]*(double)b[i]   + (double)a[i+1]*(double)b[i+1];
+	im += (double)a[i]*(double)b[i+1] - (double)a[i+1]*(double)b[i];
+      }
+      return LittleComplex(re, im);
+    }
+
+    //! c_{b,k} = <psi_k, y> on the blocks [lo,hi), reading each site of y once
+    template<typename T>
+    inline
+    void restrictBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+      const DDDeflationSpace<T>& sp = *(a->space);
+      const int nr = siteWords(*(a->y));
+      const int nvec = sp.nvec;
+
+      for(int lb=lo; lb < hi; ++lb)
+      {
+	LittleComplex* c = a->c + lb*nvec;
+	const std::vector<int>& sites = sp.geom.sites(lb);
+
+	for(int j=0; j < sites.size(); ++j)
+	{
+	  const W* y = (const W*)&(a->y->elem(sites[j]));
+	  for(int k=0; k < nvec; ++k)
+	    c[k] += siteDot((const W*)&(sp.vecs[k].elem(sites[j])), y, nr);
+	}
+      }
+    }
+
+    //! x += sum_k psi_k c_{b,k} on the blocks [lo,hi), writing each site of x once
+    template<typename T>
+    inline
+    void prolongBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+      const DDDeflationSpace<T>& sp = *(a->space);
+      const int nr = siteWords(*(a->x));
+      const int nvec = sp.nvec;
+
+      for(int lb=lo; lb < hi; ++lb)
+      {
+	const LittleComplex* c = a->c + lb*nvec;
+	const std::vector<int>& sites = sp.geom.sites(lb);
+
+	for(int j=0; j < sites.size(); ++j)
+	{
+	  W* x = (W*)&(a->x->elem(sites[j]));
+	  for(int k=0; k < nvec; ++k)
+	  {
+	    const W* v = (const W*)&(sp.vecs[k].elem(sites[j]));
+	    const double cr = c[k].real();
+	    const double ci = c[k].imag();
+	    for(int i=0; i < nr; i += 2)
+	    {
+	      x[i]   += (W)(cr*v[i]   - ci*v[i+1]);
+	      x[i+1] += (W)(cr*v[i+1] + ci*v[i]);
+	    }
+	  }
+	}
+      }
+    }
+
+    //! d_b = <x, y> on the blocks [lo,hi)
+    template<typename T>
+    inline
+    void dotBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+      const DDDeflationSpace<T>& sp = *(a->space);
+      const int nr = siteWords(*(a->y));
+
+      for(int lb=lo; lb < hi; ++lb)
+      {
+	LittleComplex& d = a->c[lb];
+	const std::vector<int>& sites = sp.geom.sites(lb);
+
+	for(int j=0; j < sites.size(); ++j)
+	  d += siteDot((const W*)&(a->x->elem(sites[j])), (const W*)&(a->y->elem(sites[j])), nr);
+      }
+    }
+
+    //! x += d_b y on the blocks [lo,hi). x and y may be the same
+    template<typename T>
+    inline
+    void axpyBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+      const DDDeflationSpace<T>& sp = *(a->space);
+      const int nr = siteWords(*(a->y));
+
+      for(int lb=lo; lb < hi; ++lb)
+      {
+	const LittleComplex d = a->c[lb];
+	const std::vector<int>& sites = sp.geom.sites(lb);
+
+	for(int j=0; j < sites.size(); ++j)
+	{
+	  W* x = (W*)&(a->x->elem(sites[j]));
+	  const W* y = (const W*)&(a->y->elem(sites[j]));
+	  for(int i=0; i < nr; i += 2)
+	  {
+	    const double yr = y[i];
+	    const double yi = y[i+1];
+	    x[i]   += (W)(d.real()*yr - d.imag()*yi);
+	    x[i+1] += (W)(d.real()*yi + d.imag()*yr);
+	  }
+	}
+      }
+    }
+
+    //! x = y on the blocks of one colour among [lo,hi)
+    template<typename T>
+    inline
+    void maskBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+      const DDDeflationSpace<T>& sp = *(a->space);
+      const int nr = siteWords(*(a->y));
+
+      for(int lb=lo; lb < hi; ++lb)
+      {
+	if (sp.geom.colour(lb) != a->colour)
+	  continue;
+
+	const std::vector<int>& sites = sp.geom.sites(lb);
+	for(int j=0; j < sites.size(); ++j)
+	{
+	  W* x = (W*)&(a->x->elem(sites[j]));
+	  const W* y = (const W*)&(a->y->elem(sites[j]));
+	  for(int i=0; i < nr; ++i)
+	    x[i] = y[i];
+	}
+      }
+    }
+
+    //! Add <psi_{b,j}, A psi_{b',k}> of the blocks b' of one colour, on the blocks b in [lo,hi)
+    /*! y holds A applied to the k-th vectors of the blocks of the colour */
+    template<typename T>
+    inline
+    void assembleBlockLoop(int lo, int hi, int myId, BlockArgs<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+      const DDDeflationSpace<T>& sp = *(a->space);
+      const int nr = siteWords(*(a->y));
+      const int nvec = sp.nvec;
+
+      for(int lb=lo; lb < hi; ++lb)
+      {
+	const std::vector<int>& sites = sp.geom.sites(lb);
+	for(int j=0; j < sites.size(); ++j)
+	{
+	  int slot = sp.geom.slot(lb, j, a->colour);
+	  if (slot < 0)
+	    continue;
+
+	  LittleComplex* m = a->little->entries(lb, slot);
+	  const W* y = (const W*)&(a->y->elem(sites[j]));
+	  for(int i=0; i < nvec; ++i)
+	    m[i*nvec + a->k] += siteDot((const W*)&(sp.vecs[i].elem(sites[j])), y, nr);
+	}
+      }
+    }
+  }
+
+
+  //! The deflated operator  P_L A = (1 - A V A_l^-1 V^dag) A
+  /*! \ingroup invert
+   *
+   * Costs two applications of A, a restriction, a prolongation and a
+   * little solve. The dagger is A^dag (1 - V A_l^-dag V^dag A^dag).
+   */
+  template<typename T>
+  class DDDeflatedLinOp : public LinearOperator<T>
+  {
+  public:
+    DDDeflatedLinOp(Handle< LinearOperator<T> > A_,
+		    Handle< InvDDDeflatedEnv::DDDeflationSpace<T> > space_) :
+      A(A_), space(space_) {}
+
+    ~DDDeflatedLinOp() {}
+
+    const Subset& subset() const {return A->subset();}
+
+    void operator() (T& chi, const T& psi, enum PlusMinus isign) const
+      {
+	START_CODE();
+
+	const Subset& s = A->subset();
+	InvDDDeflatedEnv::LittleVector c, d;
+	T tmp;
+
+	if (isign == PLUS)
+	{
+	  (*A)(chi, psi, PLUS);
+	  space->restrictVec(c, chi);
+	  space->littleSolve(d, c, PLUS);
+	  tmp[s] = zero;
+	  space->prolongVec(tmp, d);
+	  T atmp;
+	  (*A)(atmp, tmp, PLUS);
+	  chi[s] -= atmp;
+	}
+	else
+	{
+	  (*A)(tmp, psi, MINUS);
+	  space->restrictVec(c, tmp);
+	  space->littleSolve(d, c, MINUS);
+	  for(int i=0; i < d.size(); ++i)
+	    d[i] = -d[i];
+	  tmp[s] = psi;
+	  space->prolongVec(tmp, d);
+	  (*A)(chi, tmp, MINUS);
+	}
+
+	END_CODE();
+      }
+
+    unsigned long nFlops() const {return 2*A->nFlops();}
+
+  private:
+    Handle< LinearOperator<T> > A;
+    Handle< InvDDDeflatedEnv::DDDeflationSpace<T> > space;
+  };
+#endif
 
 }  // end namespace Chroma
 
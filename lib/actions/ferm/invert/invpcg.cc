@@ -0,0 +1,159 @@
+/*! \file
+ *  \brief Preconditioned Conjugate-Gradient algorithm for a hermitian Linear Operator
+ */
+
+#include "chromabase.h"
+#include "actions/ferm/invert/invpcg.h"
+
+using namespace QDP::Hints;
+
+namespace Chroma
+{
+
+  //! Preconditioned Conjugate-Gradient algorithm for a hermitian Linear Operator
+  /*! \ingroup invert
+   *
+   * See invpcg.h for the algorithm.
+   */
+  template<typename T, typename RT>
+  SystemSolverResults_t
+  InvPCG_a(const LinearOperator<T>& A,
+	   const LinearOperator<T>& P,
+	   const T& chi,
+	   T& psi,
+	   const Real& RsdCG,
+	   int MaxCG)
+  {
+    START_CODE();
+
+    const Subset& s = A.subset();
+
+    SystemSolverResults_t  res;
+    T r;                 moveToFastMemoryHint(r);
+    T z;                 moveToFastMemoryHint(z);
+    T p;                 moveToFastMemoryHint(p);
+    T ap;                moveToFastMemoryHint(ap);
+    moveToFastMemoryHint(psi,true);
+
+    QDPIO::cout << "InvPCG: starting" << std::endl;
+    FlopCounter flopcount;
+    flopcount.reset();
+    StopWatch swatch;
+    swatch.reset();
+    swatch.start();
+
+    Double chi_sq = norm2(chi, s);
+    flopcount.addSiteFlops(4*Nc*Ns, s);
+
+    Double rsd_sq = (RsdCG * RsdCG) * chi_sq;
+
+    //  r  :=  Chi - A . Psi
+    A(ap, psi, PLUS);
+    flopcount.addFlops(A.nFlops());
+
+    r[s] = chi - ap;
+    flopcount.addSiteFlops(2*Nc*Ns, s);
+
+    //  z  :=  P . r
+    P(z, r, PLUS);
+    flopcount.addFlops(P.nFlops());
+
+    //  |r|^2 and < r, z > in one reduction
+    DComplex sums = sum(cmplx(localNorm2(r), localInnerProductReal(r, z)), s);
+    flopcount.addSiteFlops(8*Nc*Ns, s);
+
+    Double cp = real(sums);
+    Double rz = imag(sums);
+
+    p[s] = z;
+
+    int k = 0;
+    while (toBool(cp > rsd_sq) && k < MaxCG)
+    {
+      ++k;
+
+      //  a  :=  < r, z > / < p, A p >
+      A(ap, p, PLUS);
+      flopcount.addFlops(A.nFlops());
+
+      Double pap = innerProductReal(p, ap, s);
+      flopcount.addSiteFlops(4*Nc*Ns, s);
+
+      if (toBool(pap <= Double(0)))
+      {
+	QDPIO::cerr << "InvPCG: operator or preconditioner not positive, < p, A p > = " << pap << std::endl;
+	break;
+      }
+
+      RT ar = rz / pap;
+
+      psi[s] += ar * p;
+      r[s] -= ar * ap;
+      flopcount.addSiteFlops(8*Nc*Ns, s);
+
+      //  z  :=  P . r
+      P(z, r, PLUS);
+      flopcount.addFlops(P.nFlops());
+
+      Double rz_old = rz;
+      sums = sum(cmplx(localNorm2(r), localInnerProductReal(r, z)), s);
+      flopcount.addSiteFlops(8*Nc*Ns, s);
+
+      cp = real(sums);
+      rz = imag(sums);
+
+      if (toBool(cp <= rsd_sq))
+	break;
+
+      //  p  :=  z + b p
+      RT br = rz / rz_old;
+      p[s] = z + br*p;
+      flopcount.addSiteFlops(4*Nc*Ns, s);
+    }
+
+    res.n_count = k;
+    res.resid   = sqrt(cp);
+    swatch.stop();
+
+    if (toBool(cp > rsd_sq))
+    {
+      QDPIO::cerr << "Nonconvergence Warning" << std::endl;
+      QDPIO::cerr << "too many PCG iterations: count =" << res.n_count << " rsd^2= " << cp << std::endl << std::flush;
+    }
+
+    flopcount.report("invpcg", swatch.getTimeInSeconds());
+    revertFromFastMemoryHint(psi,true);
+
+    END_CODE();
+    return res;
+  }
+
+
+  //
+  // Explicit versions
+  //
+  // Single precision
+  SystemSolverResults_t
+  InvPCG(const LinearOperator<LatticeFermionF>& A,
+	 const LinearOperator<LatticeFermionF>& P,
+	 const LatticeFermionF& chi,
+	 LatticeFermionF& psi,
+	 const Real& RsdCG,
+	 int MaxCG)
+  {
+    return InvPCG_a<LatticeFermionF,RealF>(A, P, chi, psi, RsdCG, MaxCG);
+  }
+
+  // Double precision
+  SystemSolverResults_t
+  InvPCG(const LinearOperator<LatticeFermionD>& A,
+	 const LinearOperator<LatticeFermionD>& P,
+	 const LatticeFermionD& chi,
+	 LatticeFermionD& psi,
+	 const Real& RsdCG,
+	 int MaxCG)
+  {
+    return InvPCG_a<LatticeFermionD,RealD>(A, P, chi, psi, RsdCG, MaxCG);
+  }
+
+}  // end namespace Chroma
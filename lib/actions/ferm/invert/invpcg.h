@@ -0,0 +1,73 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Preconditioned Conjugate-Gradient algorithm for a hermitian Linear Operator
+ */
+
+#ifndef __invpcg_h__
+#define __invpcg_h__
+
+#include "linearop.h"
+#include "syssolver.h"
+
+namespace Chroma
+{
+
+  //! Preconditioned Conjugate-Gradient algorithm for a hermitian Linear Operator
+  /*! \ingroup invert
+   * Solves
+   *
+   *   	    Chi  =  A . Psi
+   *
+   * where A is hermitian positive, with a fixed hermitian positive
+   * preconditioner P ~ A^-1.
+   *
+   * Algorithm:
+   *
+   *  r  :=  Chi - A . Psi ;   z  :=  P . r ;   p  :=  z
+   *  FOR k FROM 1 TO MaxCG DO
+   *      a  :=  < r, z > / < p, A p >
+   *      Psi += a p ;   r  -=  a A p
+   *      z  :=  P . r
+   *      IF |r| <= RsdCG |Chi| THEN RETURN;
+   *      b  :=  < r, z > / < r, z >_old
+   *      p  :=  z + b p
+   *
+   * |r|^2 and < r, z > are summed in a single reduction, so an iteration
+   * has two global reductions.
+   *
+   * Arguments:
+   *
+   *  \param A       Linear Operator    	       (Read)
+   *  \param P       Preconditioner              (Read)
+   *  \param chi     Source	               (Read)
+   *  \param psi     Solution    	    	       (Modify)
+   *  \param RsdCG   CG residual accuracy        (Read)
+   *  \param MaxCG   Maximum CG iterations       (Read)
+   *  \return res    System solver results
+   *
+   * @{
+   */
+
+  // Single precision
+  SystemSolverResults_t
+  InvPCG(const LinearOperator<LatticeFermionF>& A,
+	 const LinearOperator<LatticeFermionF>& P,
+	 const LatticeFermionF& chi,
+	 LatticeFermionF& psi,
+	 const Real& RsdCG,
+	 int MaxCG);
+
+  // Double precision
+  SystemSolverResults_t
+  InvPCG(const LinearOperator<LatticeFermionD>& A,
+	 const LinearOperator<LatticeFermionD>& P,
+	 const LatticeFermionD& chi,
+	 LatticeFermionD& psi,
+	 const Real& RsdCG,
+	 int MaxCG);
+
+  /*! @} */  // end of group invert
+
+}  // end namespace Chroma
+
+#endif
@@ -0,0 +1,414 @@
+/*! \file
+ *  \brief Pipelined Conjugate-Gradient algorithm for a generic Linear Operator
+ */
+
+#include "chromabase.h"
+#include "actions/ferm/invert/invpipecg.h"
+
+#include <vector>
+
+using namespace QDP::Hints;
+
+namespace Chroma
+{
+
+  /*! Hide the fused vector kernels in here */
+  namespace InvPipeCGEnv
+  {
+    //! Local parts of the two inner products of an iteration
+    /*!
+     * sums[0] = |r|^2,  sums[1] = Re <w,r>
+     */
+    struct Sums
+    {
+      REAL64  v[2];
+    };
+
+#ifndef QDP_IS_QDPJIT
+    template<typename T>
+    struct Args
+    {
+      T*             x;
+      T*             r;
+      T*             w;
+      T*             p;
+      T*             s;
+      T*             z;
+      const T*       q;
+      REAL64         alpha;
+      REAL64         beta;
+      const int*     site_table;
+      REAL64*        partial;     /*!< 2 doubles per thread */
+    };
+
+    //! Reals in a site of a vector
+    template<typename T>
+    inline
+    int siteWords(const T& x)
+    {
+      typedef typename WordType<T>::Type_t W;
+      return sizeof(x.elem(0)) / sizeof(W);
+    }
+
+    //! |r|^2 and Re <w,r> over the sites [lo,hi) of the site table
+    template<typename T>
+    inline
+    void sumsSiteLoop(int lo, int hi, int myId, Args<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+      const int nr = siteWords(*(a->r));
+
+      REAL64 rr = 0;
+      REAL64 wr = 0;
+
+      for(int j=lo; j < hi; ++j)
+      {
+	int site = a->site_table[j];
+	const W* r = (const W*)&(a->r->elem(site));
+	const W* w = (const W*)&(a->w->elem(site));
+
+	for(int i=0; i < nr; ++i)
+	{
+	  rr += (REAL64)r[i]*(REAL64)r[i];
+	  wr += (REAL64)w[i]*(REAL64)r[i];
+	}
+      }
+
+      a->partial[2*myId]   = rr;
+      a->partial[2*myId+1] = wr;
+    }
+
+    //! All the vector updates of an iteration over the sites [lo,hi)
+    /*!
+     * Each vector is read and written once, and the local parts of the
+     * next |r|^2 and Re <w,r> are accumulated from the new values.
+     */
+    template<typename T>
+    inline
+    void updateSiteLoop(int lo, int hi, int myId, Args<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+      const int nr = siteWords(*(a->r));
+
+      const REAL64 alpha = a->alpha;
+      const REAL64 beta  = a->beta;
+
+      REAL64 rr = 0;
+      REAL64 wr = 0;
+
+      for(int j=lo; j < hi; ++j)
+      {
+	int site = a->site_table[j];
+	W* x = (W*)&(a->x->elem(site));
+	W* r = (W*)&(a->r->elem(site));
+	W* w = (W*)&(a->w->elem(site));
+	W* p = (W*)&(a->p->elem(site));
+	W* s = (W*)&(a->s->elem(site));
+	W* z = (W*)&(a->z->elem(site));
+	const W* q = (const W*)&(a->q->elem(site));
+
+	for(int i=0; i < nr; ++i)
+	{
+	  const W zi = (W)(q[i] + beta*z[i]);
+	  const W si = (W)(w[i] + beta*s[i]);
+	  const W pi = (W)(r[i] + beta*p[i]);
+	  const W ri = (W)(r[i] - alpha*si);
+	  const W wi = (W)(w[i] - alpha*zi);
+
+	  x[i] = (W)(x[i] + alpha*pi);
+	  z[i] = zi;
+	  s[i] = si;
+	  p[i] = pi;
+	  r[i] = ri;
+	  w[i] = wi;
+
+	  rr += (REAL64)ri*(REAL64)ri;
+	  wr += (REAL64)wi*(REAL64)ri;
+	}
+      }
+
+      a->partial[2*myId]   = rr;
+      a->partial[2*myId+1] = wr;
+    }
+
+    //! Add up the thread parts
+    inline
+    void threadSum(const std::vector<REAL64>& partial, Sums& sums)
+    {
+      sums.v[0] = sums.v[1] = 0;
+      for(int t=0; t < partial.size()/2; ++t)
+      {
+	sums.v[0] += partial[2*t];
+	sums.v[1] += partial[2*t+1];
+      }
+    }
+
+    //! Local parts of |r|^2 and Re <w,r>
+    template<typename T, typename RT>
+    void localSums(const T& r, const T& w, const Subset& sub, Sums& sums)
+    {
+      std::vector<REAL64> partial(2*qdpNumThreads(), 0.0);
+
+      Args<T> a = {0, const_cast<T*>(&r), const_cast<T*>(&w), 0, 0, 0, 0,
+		   0.0, 0.0, sub.siteTable().slice(), &(partial[0])};
+      dispatch_to_threads(sub.numSiteTable(), a, sumsSiteLoop<T>);
+
+      threadSum(partial, sums);
+    }
+
+    //! Vector updates of an iteration, and the local parts of the next sums
+    template<typename T, typename RT>
+    void update(T& x, T& r, T& w, T& p, T& s, T& z, const T& q,
+		REAL64 alpha, REAL64 beta, const Subset& sub, Sums& sums)
+    {
+      std::vector<REAL64> partial(2*qdpNumThreads(), 0.0);
+
+      Args<T> a = {&x, &r, &w, &p, &s, &z, &q,
+		   alpha, beta, sub.siteTable().slice(), &(partial[0])};
+      dispatch_to_threads(sub.numSiteTable(), a, updateSiteLoop<T>);
+
+      threadSum(partial, sums);
+    }
+
+    //! Finish the reduction of the sums over the nodes
+    inline
+    void globalSums(Sums& sums)
+    {
+      QDPInternal::globalSumArray(sums.v, 2);
+    }
+
+#else
+    // Without direct site access the sums are reduced as soon as they
+    // are made, still as a single reduction of a complex number
+
+    //! |r|^2 and Re <w,r>
+    template<typename T, typename RT>
+    void localSums(const T& r, const T& w, const Subset& sub, Sums& sums)
+    {
+      DComplex c = sum(cmplx(localNorm2(r), localInnerProductReal(w, r)), sub);
+      sums.v[0] = toDouble(real(c));
+      sums.v[1] = toDouble(imag(c));
+    }
+
+    //! Vector updates of an iteration, and the next sums
+    template<typename T, typename RT>
+    void update(T& x, T& r, T& w, T& p, T& s, T& z, const T& q,
+		REAL64 alpha, REAL64 beta, const Subset& sub, Sums& sums)
+    {
+      RT ar = Double(alpha);
+      RT br = Double(beta);
+
+      z[sub] = q + br*z;
+      s[sub] = w + br*s;
+      p[sub] = r + br*p;
+      x[sub] += ar*p;
+      r[sub] -= ar*s;
+      w[sub] -= ar*z;
+
+      localSums<T,RT>(r, w, sub, sums);
+    }
+
+    //! The sums are already reduced
+    inline
+    void globalSums(Sums& sums) {}
+#endif
+  }
+
+
+  //! Pipelined Conjugate-Gradient algorithm for a generic Linear Operator
+  /*! \ingroup invert
+   *
+   * See invpipecg.h for the algorithm.
+   */
+  template<typename T, typename RT>
+  SystemSolverResults_t
+  InvPipeCG_a(const LinearOperator<T>& M,
+	      const T& chi,
+	      T& psi,
+	      const Real& RsdCG,
+	      int MaxCG)
+  {
+    START_CODE();
+
+    const Subset& sub = M.subset();
+
+    SystemSolverResults_t  res;
+    T tmp;               moveToFastMemoryHint(tmp);
+    T r;                 moveToFastMemoryHint(r);
+    T w;                 moveToFastMemoryHint(w);
+    T q;                 moveToFastMemoryHint(q);
+    T z;                 moveToFastMemoryHint(z);
+    T s;                 moveToFastMemoryHint(s);
+    T p;                 moveToFastMemoryHint(p);
+    moveToFastMemoryHint(psi,true);
+
+    QDPIO::cout << "InvPipeCG: starting" << std::endl;
+    FlopCounter flopcount;
+    flopcount.reset();
+    StopWatch swatch;
+    swatch.reset();
+    swatch.start();
+
+    Double chi_sq = norm2(chi, sub);
+    flopcount.addSiteFlops(4*Nc*Ns, sub);
+
+    Double rsd_sq = (RsdCG * RsdCG) * chi_sq;
+    const REAL64 rsd_sq_d = toDouble(rsd_sq);
+
+    //  r  :=  Chi - A . Psi
+    M(tmp, psi, PLUS);
+    M(q, tmp, MINUS);
+    flopcount.addFlops(2*M.nFlops());
+
+    r[sub] = chi - q;
+    Double cp = norm2(r, sub);
+    flopcount.addSiteFlops(6*Nc*Ns, sub);
+
+    int k = 0;
+
+    while (toBool(cp > rsd_sq) && k < MaxCG)
+    {
+      // (Re)start the recurrences from the true residual
+      M(tmp, r, PLUS);
+      M(w, tmp, MINUS);
+      flopcount.addFlops(2*M.nFlops());
+
+      z[sub] = zero;
+      s[sub] = zero;
+      p[sub] = zero;
+
+      InvPipeCGEnv::Sums sums;
+      InvPipeCGEnv::localSums<T,RT>(r, w, sub, sums);
+      flopcount.addSiteFlops(8*Nc*Ns, sub);
+
+      const int k0 = k;
+      REAL64 gamma_old = 1;
+      REAL64 alpha_old = 1;
+
+      for(; k < MaxCG; ++k)
+      {
+	//  q  :=  A . w
+	//  A non-blocking reduction of the sums would be in flight here,
+	//  and this is the only point in the iteration where they are needed
+	M(tmp, w, PLUS);
+	M(q, tmp, MINUS);
+	flopcount.addFlops(2*M.nFlops());
+
+	InvPipeCGEnv::globalSums(sums);
+
+	const REAL64 gamma = sums.v[0];
+	const REAL64 delta = sums.v[1];
+
+	if (gamma <= rsd_sq_d)
+	  break;
+
+	REAL64 alpha;
+	REAL64 beta;
+	if (k == k0)
+	{
+	  beta  = 0;
+	  alpha = gamma / delta;
+	}
+	else
+	{
+	  beta  = gamma / gamma_old;
+	  alpha = gamma / (delta - beta*gamma/alpha_old);
+	}
+
+	if (! (alpha > 0))
+	{
+	  QDPIO::cout << "InvPipeCG: breakdown at k = " << k << ", restarting" << std::endl;
+	  break;
+	}
+
+	InvPipeCGEnv::update<T,RT>(psi, r, w, p, s, z, q, alpha, beta, sub, sums);
+	flopcount.addSiteFlops(32*Nc*Ns, sub);
+
+	gamma_old = gamma;
+	alpha_old = alpha;
+      }
+
+      // The recursed residual drifts from the true one
+      M(tmp, psi, PLUS);
+      M(q, tmp, MINUS);
+      flopcount.addFlops(2*M.nFlops());
+
+      r[sub] = chi - q;
+      cp = norm2(r, sub);
+      flopcount.addSiteFlops(6*Nc*Ns, sub);
+
+      // No progress can be made from here
+      if (k == k0)
+	break;
+
+      if (toBool(cp > rsd_sq) && k < MaxCG)
+	QDPIO::cout << "InvPipeCG: true residual not converged at k = " << k
+		    << ", restarting" << std::endl;
+    }
+
+    res.n_count = k;
+    res.resid   = sqrt(cp);
+    swatch.stop();
+
+    if (toBool(cp > rsd_sq))
+    {
+      QDPIO::cerr << "Nonconvergence Warning" << std::endl;
+      QDPIO::cerr << "too many PipeCG iterations: count =" << res.n_count << " rsd^2= " << cp << std::endl << std::flush;
+    }
+
+    flopcount.report("invpipecg", swatch.getTimeInSeconds());
+    revertFromFastMemoryHint(psi,true);
+
+    END_CODE();
+    return res;
+  }
+
+
+  //
+  // Explicit versions
+  //
+  // Single precision
+  SystemSolverResults_t
+  InvPipeCG(const LinearOperator<LatticeFermionF>& M,
+	    const LatticeFermionF& chi,
+	    LatticeFermionF& psi,
+	    const Real& RsdCG,
+	    int MaxCG)
+  {
+    return InvPipeCG_a<LatticeFermionF,RealF>(M, chi, psi, RsdCG, MaxCG);
+  }
+
+  // Double precision
+  SystemSolverResults_t
+  InvPipeCG(const LinearOperator<LatticeFermionD>& M,
+	    const LatticeFermionD& chi,
+	    LatticeFermionD& psi,
+	    const Real& RsdCG,
+	    int MaxCG)
+  {
+    return InvPipeCG_a<LatticeFermionD,RealD>(M, chi, psi, RsdCG, MaxCG);
+  }
+
+  // Single precision
+  SystemSolverResults_t
+  InvPipeCG(const LinearOperator<LatticeStaggeredFermionF>& M,
+	    const LatticeStaggeredFermionF& chi,
+	    LatticeStaggeredFermionF& psi,
+	    const Real& RsdCG,
+	    int MaxCG)
+  {
+    return InvPipeCG_a<LatticeStaggeredFermionF,RealF>(M, chi, psi, RsdCG, MaxCG);
+  }
+
+  // Double precision
+  SystemSolverResults_t
+  InvPipeCG(const LinearOperator<LatticeStaggeredFermionD>& M,
+	    const LatticeStaggeredFermionD& chi,
+	    LatticeStaggeredFermionD& psi,
+	    const Real& RsdCG,
+	    int MaxCG)
+  {
+    return InvPipeCG_a<LatticeStaggeredFermionD,RealD>(M, chi, psi, RsdCG, MaxCG);
+  }
+
+}  // end namespace Chroma
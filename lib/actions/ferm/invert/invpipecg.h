@@ -0,0 +1,95 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Pipelined Conjugate-Gradient algorithm for a generic Linear Operator
+ */
+
+#ifndef __invpipecg_h__
+#define __invpipecg_h__
+
+#include "linearop.h"
+#include "syssolver.h"
+
+namespace Chroma
+{
+
+  //! Pipelined Conjugate-Gradient algorithm for a generic Linear Operator
+  /*! \ingroup invert
+   * Solves the same system as InvCG2,
+   *
+   *   	    Chi  =  A . Psi     where   A = M^dag . M
+   *
+   * with the pipelined recurrences of Ghysels and Vanroose, in which the
+   * two inner products of an iteration are taken of vectors available
+   * before the operator is applied, so both are summed in a single
+   * global reduction that can be put behind the application of A.
+   *
+   * Algorithm:
+   *
+   *  r  :=  Chi - A . Psi ;   w  :=  A . r
+   *  FOR k FROM 0 TO MaxCG DO
+   *      q  :=  A . w                       (reduction of gamma, delta in flight)
+   *      gamma := |r|**2 ;  delta := < w, r >
+   *      IF gamma <= RsdCG^2 |Chi|^2 THEN RETURN;
+   *      b  :=  gamma / gamma_old ;  a  :=  gamma / (delta - b gamma / a_old)
+   *      z  :=  q + b z ;   s  :=  w + b s ;   p  :=  r + b p
+   *      Psi += a p ;   r  -=  a s ;   w  -=  a z
+   *
+   * with b = 0 on the first iteration. The vector updates and the local
+   * parts of the next gamma and delta are done in one sweep. As the
+   * recursed residual drifts from the true one the solve is checked
+   * against the true residual at the end, and restarted from it if
+   * it is not converged.
+   *
+   * Arguments:
+   *
+   *  \param M       Linear Operator    	       (Read)
+   *  \param chi     Source	               (Read)
+   *  \param psi     Solution    	    	       (Modify)
+   *  \param RsdCG   CG residual accuracy        (Read)
+   *  \param MaxCG   Maximum CG iterations       (Read)
+   *  \return res    System solver results
+   *
+   * Operations:
+   *
+   *  N_Count ( 2 A + 32 Nc Ns ) plus 4 A per (re)start
+   *
+   * @{
+   */
+
+  // Single precision
+  SystemSolverResults_t
+  InvPipeCG(const LinearOperator<LatticeFermionF>& M,
+	    const LatticeFermionF& chi,
+	    LatticeFermionF& psi,
+	    const Real& RsdCG,
+	    int MaxCG);
+
+  // Double precision
+  SystemSolverResults_t
+  InvPipeCG(const LinearOperator<LatticeFermionD>& M,
+	    const LatticeFermionD& chi,
+	    LatticeFermionD& psi,
+	    const Real& RsdCG,
+	    int MaxCG);
+
+  // Single precision
+  SystemSolverResults_t
+  InvPipeCG(const LinearOperator<LatticeStaggeredFermionF>& M,
+	    const LatticeStaggeredFermionF& chi,
+	    LatticeStaggeredFermionF& psi,
+	    const Real& RsdCG,
+	    int MaxCG);
+
+  // Double precision
+  SystemSolverResults_t
+  InvPipeCG(const LinearOperator<LatticeStaggeredFermionD>& M,
+	    const LatticeStaggeredFermionD& chi,
+	    LatticeStaggeredFermionD& psi,
+	    const Real& RsdCG,
+	    int MaxCG);
+
+  /*! @} */  // end of group invert
+
+}  // end namespace Chroma
+
+#endif
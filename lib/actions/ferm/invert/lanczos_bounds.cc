@@ -0,0 +1,89 @@
+/*! \file
+ *  \brief Estimate the spectral bounds of a hermitian operator by Lanczos
+ */
+
+#include "actions/ferm/invert/lanczos_bounds.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace Chroma
+{
+
+  //! Anonymous namespace
+  namespace
+  {
+    //! Number of eigenvalues below x, from the signs of the Sturm sequence
+    int sturmCount(const std::vector<double>& diag,
+		   const std::vector<double>& offdiag,
+		   double x)
+    {
+      const double tiny = 1.0e-300;
+
+      int count = 0;
+      double q = 1;
+
+      for(int i=0; i < diag.size(); ++i)
+      {
+	double b2 = (i > 0) ? offdiag[i-1]*offdiag[i-1] : 0.0;
+	q = diag[i] - x - b2/q;
+	if (std::abs(q) < tiny)
+	  q = -tiny;
+	if (q < 0)
+	  ++count;
+      }
+
+      return count;
+    }
+
+    //! The k-th smallest eigenvalue (counting from 1), inside [lo,hi]
+    double bisect(const std::vector<double>& diag,
+		  const std::vector<double>& offdiag,
+		  int k, double lo, double hi)
+    {
+      for(int iter=0; iter < 200; ++iter)
+      {
+	double mid = 0.5*(lo + hi);
+	if (mid <= lo || mid >= hi)
+	  break;
+
+	if (sturmCount(diag, offdiag, mid) >= k)
+	  hi = mid;
+	else
+	  lo = mid;
+      }
+
+      return 0.5*(lo + hi);
+    }
+  }
+
+
+  // Smallest and largest eigenvalues of a real symmetric tridiagonal matrix
+  void tridiagExtremeEigs(const std::vector<double>& diag,
+			  const std::vector<double>& offdiag,
+			  double& lmin, double& lmax)
+  {
+    const int n = diag.size();
+    if (n == 0 || offdiag.size() != n-1)
+    {
+      QDPIO::cerr << __func__ << ": inconsistent tridiagonal matrix" << std::endl;
+      QDP_abort(1);
+    }
+
+    // Gershgorin interval
+    double lo = diag[0];
+    double hi = diag[0];
+    for(int i=0; i < n; ++i)
+    {
+      double r = 0;
+      if (i > 0)   r += std::abs(offdiag[i-1]);
+      if (i < n-1) r += std::abs(offdiag[i]);
+      lo = std::min(lo, diag[i] - r);
+      hi = std::max(hi, diag[i] + r);
+    }
+
+    lmin = bisect(diag, offdiag, 1, lo, hi);
+    lmax = bisect(diag, offdiag, n, lo, hi);
+  }
+
+}  // end namespace Chroma
@@ -0,0 +1,106 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Estimate the spectral bounds of a hermitian operator by Lanczos
+ */
+
+#ifndef __lanczos_bounds_h__
+#define __lanczos_bounds_h__
+
+#include "chromabase.h"
+#include "linearop.h"
+
+#include <vector>
+
+namespace Chroma
+{
+
+  //! Smallest and largest eigenvalues of a real symmetric tridiagonal matrix
+  /*! \ingroup invert
+   *
+   * Found by bisection on the Sturm sequence counts.
+   *
+   * \param diag     the n diagonal elements  ( Read )
+   * \param offdiag  the n-1 off diagonal elements  ( Read )
+   * \param lmin     smallest eigenvalue  ( Write )
+   * \param lmax     largest eigenvalue  ( Write )
+   */
+  void tridiagExtremeEigs(const std::vector<double>& diag,
+			  const std::vector<double>& offdiag,
+			  double& lmin, double& lmax);
+
+
+  //! Estimate the spectral bounds of a hermitian positive operator
+  /*! \ingroup invert
+   *
+   * Runs nsteps of Lanczos on A from the start vector and returns the
+   * extreme Ritz values. The largest converges quickly from below, the
+   * smallest slowly from above, so the interval is in general inside
+   * the spectrum. Costs nsteps applications of A and two reductions
+   * per step.
+   *
+   * \param A       hermitian operator  ( Read )
+   * \param start   start vector, must not vanish on the subset of A  ( Read )
+   * \param nsteps  number of Lanczos steps  ( Read )
+   * \param lmin    smallest Ritz value  ( Write )
+   * \param lmax    largest Ritz value  ( Write )
+   */
+  template<typename T>
+  void lanczosBounds(const LinearOperator<T>& A, const T& start, int nsteps,
+		     Real& lmin, Real& lmax)
+  {
+    START_CODE();
+
+    const Subset& s = A.subset();
+
+    std::vector<double> diag;
+    std::vector<double> offdiag;
+
+    T v;
+    T v_prev;
+    T w;
+
+    v[s] = start;
+    v_prev[s] = zero;
+
+    Double vnorm = sqrt(norm2(v, s));
+    if (toDouble(vnorm) == 0.0)
+    {
+      QDPIO::cerr << __func__ << ": start vector vanishes" << std::endl;
+      QDP_abort(1);
+    }
+    v[s] *= Real(1) / vnorm;
+
+    Double beta = zero;
+
+    for(int j=0; j < nsteps; ++j)
+    {
+      A(w, v, PLUS);
+
+      Double alpha = innerProductReal(v, w, s);
+      diag.push_back(toDouble(alpha));
+
+      w[s] -= Real(alpha)*v + Real(beta)*v_prev;
+
+      beta = sqrt(norm2(w, s));
+
+      // Invariant subspace found, the Ritz values are exact
+      if (j == nsteps-1 || toDouble(beta) <= 1.0e-12*std::abs(toDouble(alpha)))
+	break;
+
+      offdiag.push_back(toDouble(beta));
+
+      v_prev[s] = v;
+      v[s] = (Real(1)/beta) * w;
+    }
+
+    double dmin, dmax;
+    tridiagExtremeEigs(diag, offdiag, dmin, dmax);
+    lmin = Real(dmin);
+    lmax = Real(dmax);
+
+    END_CODE();
+  }
+
+}  // end namespace Chroma
+
+#endif
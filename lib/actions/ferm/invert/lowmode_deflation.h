@@ -0,0 +1,201 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Low mode deflation of M^dag M with precomputed eigenpairs
+ *
+ *  The eigenpairs are Ritz pairs of M^dag M held in the named object map,
+ *  either as full precision RitzPairs or as CompressedRitzPairs, e.g. the
+ *  space grown by the eigCG solvers. They can also be read from a file in
+ *  the format the eigCG solvers write. The correction
+ *
+ *     x += sum_i v_i <v_i, r> / lambda_i
+ *
+ *  is done as one block: all the inner products are accumulated in one
+ *  sweep over the sites with one global reduction, and all the vectors are
+ *  added back in a second sweep.
+ */
+
+#ifndef __lowmode_deflation_h__
+#define __lowmode_deflation_h__
+
+#include "chromabase.h"
+#include "named_obj.h"
+#include "meas/inline/io/named_objmap.h"
+#include "actions/ferm/invert/containers.h"
+#include "actions/ferm/invert/compressed_ritz_pairs.h"
+#include "util/ferm/block_inner_product.h"
+
+namespace Chroma
+{
+
+#ifndef QDP_IS_QDPJIT
+  //! Deflation of M^dag M with eigenpairs from the named object map
+  /*! \ingroup invert
+   *
+   * T is a lattice fermion. The vectors are taken to be orthonormal on the
+   * subset and the eigenvalues to be those of M^dag M. The pairs are looked
+   * up on every use, so the object may be spilled or grown between solves.
+   */
+  template<typename T>
+  class LowModeDeflation
+  {
+  public:
+    //! Constructor
+    /*!
+     * \param id_          named object of the eigenpairs   ( Read )
+     * \param Neig_max_    use at most this many, 0 for all   ( Read )
+     * \param s_           subset of the vectors              ( Read )
+     * \param file_name    file to read them from if id_ does not exist yet  ( Read )
+     * \param storage      FULL, SINGLE or HALF storage of the pairs read    ( Read )
+     */
+    LowModeDeflation(const std::string& id_, int Neig_max_, const Subset& s_,
+		     const std::string& file_name, const std::string& storage) :
+      id(id_), Neig_max(Neig_max_), sub(s_)
+      {
+	if (! TheNamedObjMap::Instance().check(id))
+	{
+	  if (file_name == "")
+	  {
+	    QDPIO::cerr << "LowModeDeflation: no eigenpairs with id= " << id
+			<< " and no file to read them from" << std::endl;
+	    QDP_abort(1);
+	  }
+
+	  readEvecs(file_name, storage);
+	}
+
+	if (full() == 0 && compressed() == 0)
+	{
+	  QDPIO::cerr << "LowModeDeflation: object with id= " << id
+		      << " does not hold Ritz pairs of this fermion type" << std::endl;
+	  QDP_abort(1);
+	}
+
+	QDPIO::cout << "LowModeDeflation: " << size() << " eigenpairs from id= " << id << std::endl;
+      }
+
+    //! Number of pairs used
+    int size() const
+      {
+	int n = (full() != 0) ? full()->Neig : compressed()->Neig;
+	return (Neig_max > 0 && Neig_max < n) ? Neig_max : n;
+      }
+
+    //! x += sum_i v_i <v_i, r> / lambda_i
+    void correct(T& x, const T& r) const
+      {
+	const int n = size();
+	if (n == 0)
+	  return;
+
+	if (full() != 0)
+	{
+	  const LinAlg::RitzPairs<T>& pairs = *full();
+
+	  multi1d<DComplex> c;
+	  blockInnerProduct(c, pairs.evec.vec, n, r, sub);
+	  for(int i=0; i < n; ++i)
+	    c[i] /= pairs.eval.vec[i];
+
+	  blockAxpy(x, c, pairs.evec.vec, n, sub);
+	}
+	else
+	{
+	  const LinAlg::CompressedRitzPairs<T>& pairs = *compressed();
+
+	  // The inner products are against all the stored vectors, keep n
+	  multi1d<DComplex> call;
+	  pairs.innerProducts(call, r);
+
+	  multi1d<DComplex> c(n);
+	  for(int i=0; i < n; ++i)
+	    c[i] = call[i] / pairs.eval[i];
+
+	  pairs.axpy(x, c);
+	}
+      }
+
+  private:
+    //! The full precision pairs, or null
+    const LinAlg::RitzPairs<T>* full() const
+      {
+	const NamedObject< LinAlg::RitzPairs<T> >* obj =
+	  dynamic_cast< const NamedObject< LinAlg::RitzPairs<T> >* >(&(TheNamedObjMap::Instance().get(id)));
+	return (obj != 0) ? &(obj->getData()) : 0;
+      }
+
+    //! The compressed pairs, or null
+    const LinAlg::CompressedRitzPairs<T>* compressed() const
+      {
+	const NamedObject< LinAlg::CompressedRitzPairs<T> >* obj =
+	  dynamic_cast< const NamedObject< LinAlg::CompressedRitzPairs<T> >* >(&(TheNamedObjMap::Instance().get(id)));
+	return (obj != 0) ? &(obj->getData()) : 0;
+      }
+
+    //! Read the pairs written by an eigCG solver into a new object
+    void readEvecs(const std::string& file_name, const std::string& storage)
+      {
+	StopWatch swatch;
+	swatch.reset();
+	swatch.start();
+
+	XMLReader file_xml;
+	QDPFileReader from(file_xml, file_name, QDPIO_SERIAL);
+
+	int Neig;
+	std::string file_storage;
+	multi1d<Double> eval;
+	read(file_xml, "/RitzPairs/Neig", Neig);
+	read(file_xml, "/RitzPairs/EvecStorage", file_storage);
+	read(file_xml, "/RitzPairs/eval", eval);
+
+	if (Neig_max > 0 && Neig_max < Neig)
+	  Neig = Neig_max;
+
+	if (storage == "FULL")
+	{
+	  TheNamedObjMap::Instance().create< LinAlg::RitzPairs<T> >(id);
+	  TheNamedObjMap::Instance().getData< LinAlg::RitzPairs<T> >(id).init(Neig);
+	}
+	else
+	{
+	  TheNamedObjMap::Instance().create< LinAlg::CompressedRitzPairs<T> >(id);
+	  TheNamedObjMap::Instance().getData< LinAlg::CompressedRitzPairs<T> >(id).init(Neig, sub,
+	    (storage == "HALF") ? LinAlg::RITZ_STORE_HALF : LinAlg::RITZ_STORE_SINGLE);
+	}
+
+	for(int v=0; v < Neig; ++v)
+	{
+	  XMLReader record_xml;
+	  T vec;
+
+	  if (file_storage == "FULL")
+	    read(from, record_xml, vec);
+	  else
+	  {
+	    LatticeFermionF lf;
+	    read(from, record_xml, lf);
+	    vec = lf;
+	  }
+
+	  if (storage == "FULL")
+	    TheNamedObjMap::Instance().getData< LinAlg::RitzPairs<T> >(id).AddVector(eval[v], vec, sub);
+	  else
+	    TheNamedObjMap::Instance().getData< LinAlg::CompressedRitzPairs<T> >(id).AddVector(eval[v], vec);
+	}
+
+	close(from);
+
+	swatch.stop();
+	QDPIO::cout << "LowModeDeflation: time to read " << Neig << " evecs = "
+		    << swatch.getTimeInSeconds() << " secs" << std::endl;
+      }
+
+    std::string  id;
+    int          Neig_max;
+    Subset       sub;
+  };
+#endif
+
+} // End namespace
+
+#endif
@@ -0,0 +1,76 @@
+/*! \file
+ *  \brief Params of the Chebyshev preconditioned CG inverter
+ */
+
+#include "actions/ferm/invert/syssolver_chebyprec_cg_params.h"
+
+namespace Chroma
+{
+
+  // Read parameters
+  void read(XMLReader& xml, const std::string& path, SysSolverChebyPrecCGParams& param)
+  {
+    XMLReader paramtop(xml, path);
+
+    read(paramtop, "RsdCG", param.RsdCG);
+    read(paramtop, "MaxCG", param.MaxCG);
+
+    if (paramtop.count("PolyDegree") != 0)
+      read(paramtop, "PolyDegree", param.PolyDegree);
+
+    if (paramtop.count("LanczosIter") != 0)
+      read(paramtop, "LanczosIter", param.LanczosIter);
+
+    if (paramtop.count("EigMaxSafety") != 0)
+      read(paramtop, "EigMaxSafety", param.EigMaxSafety);
+
+    param.boundsP = false;
+    if (paramtop.count("EigMin") != 0 || paramtop.count("EigMax") != 0)
+    {
+      read(paramtop, "EigMin", param.EigMin);
+      read(paramtop, "EigMax", param.EigMax);
+      param.boundsP = true;
+    }
+  }
+
+  // Writer parameters
+  void write(XMLWriter& xml, const std::string& path, const SysSolverChebyPrecCGParams& param)
+  {
+    push(xml, path);
+
+    write(xml, "invType", "CHEBYSHEV_PREC_CG_INVERTER");
+    write(xml, "RsdCG", param.RsdCG);
+    write(xml, "MaxCG", param.MaxCG);
+    write(xml, "PolyDegree", param.PolyDegree);
+    write(xml, "LanczosIter", param.LanczosIter);
+    write(xml, "EigMaxSafety", param.EigMaxSafety);
+    if (param.boundsP)
+    {
+      write(xml, "EigMin", param.EigMin);
+      write(xml, "EigMax", param.EigMax);
+    }
+
+    pop(xml);
+  }
+
+  //! Default constructor
+  SysSolverChebyPrecCGParams::SysSolverChebyPrecCGParams()
+  {
+    RsdCG = zero;
+    MaxCG = 0;
+    PolyDegree = 8;
+    LanczosIter = 20;
+    EigMaxSafety = 1.1;
+    boundsP = false;
+    EigMin = zero;
+    EigMax = zero;
+  }
+
+  //! Read parameters
+  SysSolverChebyPrecCGParams::SysSolverChebyPrecCGParams(XMLReader& xml, const std::string& path)
+  {
+    *this = SysSolverChebyPrecCGParams();
+    read(xml, path, *this);
+  }
+
+}
@@ -0,0 +1,44 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Params of the Chebyshev preconditioned CG inverter
+ */
+
+#ifndef __syssolver_chebyprec_cg_params_h__
+#define __syssolver_chebyprec_cg_params_h__
+
+#include "chromabase.h"
+
+
+namespace Chroma
+{
+
+  //! Params for the Chebyshev preconditioned CG inverter
+  /*! \ingroup invert */
+  struct SysSolverChebyPrecCGParams
+  {
+    SysSolverChebyPrecCGParams();
+    SysSolverChebyPrecCGParams(XMLReader& in, const std::string& path);
+
+    Real          RsdCG;           /*!< CG residual */
+    int           MaxCG;           /*!< Maximum CG iterations */
+
+    int           PolyDegree;      /*!< Degree of the preconditioning polynomial */
+    int           LanczosIter;     /*!< Lanczos steps to estimate the spectral bounds */
+    Real          EigMaxSafety;    /*!< Factor on the largest Ritz value, keeps the preconditioner positive */
+
+    bool          boundsP;         /*!< Bounds given, no Lanczos */
+    Real          EigMin;          /*!< Given lower bound */
+    Real          EigMax;          /*!< Given upper bound */
+  };
+
+
+  // Reader/writers
+  /*! \ingroup invert */
+  void read(XMLReader& xml, const std::string& path, SysSolverChebyPrecCGParams& param);
+
+  /*! \ingroup invert */
+  void write(XMLWriter& xml, const std::string& path, const SysSolverChebyPrecCGParams& param);
+
+} // End namespace
+
+#endif
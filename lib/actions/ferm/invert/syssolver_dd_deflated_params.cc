@@ -0,0 +1,79 @@
+/*! \file
+ *  \brief Params of the domain-decomposed inexact deflation inverter
+ */
+
+#include "actions/ferm/invert/syssolver_dd_deflated_params.h"
+
+namespace Chroma
+{
+
+  // Read parameters
+  void read(XMLReader& xml, const std::string& path, SysSolverDDDeflatedParams& param)
+  {
+    XMLReader paramtop(xml, path);
+
+    read(paramtop, "Blocking", param.Blocking);
+
+    if (paramtop.count("NumVecs") != 0)
+      read(paramtop, "NumVecs", param.NumVecs);
+
+    if (paramtop.count("SetupIter") != 0)
+      read(paramtop, "SetupIter", param.SetupIter);
+
+    if (paramtop.count("SetupMRIter") != 0)
+      read(paramtop, "SetupMRIter", param.SetupMRIter);
+
+    if (paramtop.count("OperatorRange") != 0)
+      read(paramtop, "OperatorRange", param.OperatorRange);
+
+    if (paramtop.count("CoarseRsd") != 0)
+      read(paramtop, "CoarseRsd", param.CoarseRsd);
+
+    if (paramtop.count("CoarseMaxIter") != 0)
+      read(paramtop, "CoarseMaxIter", param.CoarseMaxIter);
+
+    if (paramtop.count("CoarseGCRVecs") != 0)
+      read(paramtop, "CoarseGCRVecs", param.CoarseGCRVecs);
+
+    param.SubInvParam = readXMLGroup(paramtop, "SubInvParam", "invType");
+  }
+
+  // Writer parameters
+  void write(XMLWriter& xml, const std::string& path, const SysSolverDDDeflatedParams& param)
+  {
+    push(xml, path);
+
+    write(xml, "invType", "DD_DEFLATED_INVERTER");
+    write(xml, "Blocking", param.Blocking);
+    write(xml, "NumVecs", param.NumVecs);
+    write(xml, "SetupIter", param.SetupIter);
+    write(xml, "SetupMRIter", param.SetupMRIter);
+    write(xml, "OperatorRange", param.OperatorRange);
+    write(xml, "CoarseRsd", param.CoarseRsd);
+    write(xml, "CoarseMaxIter", param.CoarseMaxIter);
+    write(xml, "CoarseGCRVecs", param.CoarseGCRVecs);
+    xml << param.SubInvParam.xml;
+
+    pop(xml);
+  }
+
+  //! Default constructor
+  SysSolverDDDeflatedParams::SysSolverDDDeflatedParams()
+  {
+    NumVecs = 12;
+    SetupIter = 4;
+    SetupMRIter = 8;
+    OperatorRange = 2;
+    CoarseRsd = 1.0e-12;
+    CoarseMaxIter = 500;
+    CoarseGCRVecs = 16;
+  }
+
+  //! Read parameters
+  SysSolverDDDeflatedParams::SysSolverDDDeflatedParams(XMLReader& xml, const std::string& path)
+  {
+    *this = SysSolverDDDeflatedParams();
+    read(xml, path, *this);
+  }
+
+}
@@ -0,0 +1,46 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Params of the domain-decomposed inexact deflation inverter
+ */
+
+#ifndef __syssolver_dd_deflated_params_h__
+#define __syssolver_dd_deflated_params_h__
+
+#include "chromabase.h"
+#include "io/xml_group_reader.h"
+
+
+namespace Chroma
+{
+
+  //! Params for the domain-decomposed inexact deflation inverter
+  /*! \ingroup invert */
+  struct SysSolverDDDeflatedParams
+  {
+    SysSolverDDDeflatedParams();
+    SysSolverDDDeflatedParams(XMLReader& in, const std::string& path);
+
+    multi1d<int>  Blocking;        /*!< Block extents, must divide the node sub-lattice */
+    int           NumVecs;         /*!< Deflation vectors per block */
+    int           SetupIter;       /*!< Inverse iterations on the vectors */
+    int           SetupMRIter;     /*!< MR steps of each inverse iteration */
+    int           OperatorRange;   /*!< Reach of the operator in sites */
+
+    Real          CoarseRsd;       /*!< Relative residual of the little solves */
+    int           CoarseMaxIter;   /*!< Maximum iterations of the little solves */
+    int           CoarseGCRVecs;   /*!< GCR restart length of the little solves */
+
+    GroupXML_t    SubInvParam;     /*!< Solver of the deflated system */
+  };
+
+
+  // Reader/writers
+  /*! \ingroup invert */
+  void read(XMLReader& xml, const std::string& path, SysSolverDDDeflatedParams& param);
+
+  /*! \ingroup invert */
+  void write(XMLWriter& xml, const std::string& path, const SysSolverDDDeflatedParams& param);
+
+} // End namespace
+
+#endif
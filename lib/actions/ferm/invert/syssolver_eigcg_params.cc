@@ -78,6 +78,15 @@ namespace Chroma
     read(paramtop, "cleanUpEvecs", param.cleanUpEvecs);
     read(paramtop, "eigen_id", param.eigen_id);
 
+    if(paramtop.count("EvecStorage")!=0){
+      read(paramtop, "EvecStorage", param.evecStorage);
+      if (param.evecStorage != "FULL" && param.evecStorage != "SINGLE" && param.evecStorage != "HALF")
+      {
+	QDPIO::cerr << __func__ << ": EvecStorage must be FULL, SINGLE or HALF, not " << param.evecStorage << std::endl;
+	QDP_abort(1);
+      }
+    }
+
     if(paramtop.count("FileIO")!=0){
       read(paramtop, "FileIO", param.file);
     }
@@ -105,6 +114,7 @@ namespace Chroma
     write(xml, "vPrecCGvecs", param.vPrecCGvecStart);
     write(xml, "cleanUpEvecs", param.cleanUpEvecs);
     write(xml, "eigen_id", param.eigen_id);
+    write(xml, "EvecStorage", param.evecStorage);
 
     write(xml, "FileIO",param.file);
 
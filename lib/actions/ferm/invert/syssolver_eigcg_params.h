@@ -52,6 +52,7 @@ namespace Chroma
 
     bool  cleanUpEvecs ; /*!< clean up evecs upon destruction of SystemSolver */
     std::string eigen_id ; /*!< named buffer holding the eigenvectors */
+    std::string evecStorage ; /*!< FULL, SINGLE or HALF precision storage of the eigenvectors */
    
     struct File_t
     {
@@ -74,6 +75,7 @@ namespace Chroma
       
       cleanUpEvecs=false;
       eigen_id="NULL";
+      evecStorage="FULL";
 
       //IO control
       file.file_name = eigen_id ;
@@ -6,7 +6,9 @@
 #include "actions/ferm/invert/syssolver_linop_aggregate.h"
 
 #include "actions/ferm/invert/syssolver_linop_cg.h"
+#include "actions/ferm/invert/syssolver_linop_pipecg.h"
 #include "actions/ferm/invert/syssolver_linop_bicgstab.h"
+#include "actions/ferm/invert/syssolver_linop_bicgstab_half.h"
 #include "actions/ferm/invert/syssolver_linop_ibicgstab.h"
 #include "actions/ferm/invert/syssolver_linop_bicrstab.h"
 #include "actions/ferm/invert/syssolver_linop_mr.h"
@@ -18,6 +20,9 @@
 #include "actions/ferm/invert/syssolver_linop_rel_ibicgstab_clover.h"
 #include "actions/ferm/invert/syssolver_linop_rel_cg_clover.h"
 #include "actions/ferm/invert/syssolver_linop_fgmres_dr.h"
+#include "actions/ferm/invert/syssolver_linop_dd_deflated.h"
+#include "actions/ferm/invert/syssolver_linop_lowmode_deflated.h"
+#include "actions/ferm/invert/syssolver_linop_sap_clover.h"
 
 
 #include "chroma_config.h"
@@ -60,7 +65,9 @@ namespace Chroma
       {
 	// 4D system solvers
 	success &= LinOpSysSolverCGEnv::registerAll();
+	success &= LinOpSysSolverPipeCGEnv::registerAll();
 	success &= LinOpSysSolverBiCGStabEnv::registerAll();
+	success &= LinOpSysSolverBiCGStabHalfEnv::registerAll();
 	success &= LinOpSysSolverBiCRStabEnv::registerAll();
 	success &= LinOpSysSolverIBiCGStabEnv::registerAll();
 	success &= LinOpSysSolverMREnv::registerAll();
@@ -72,6 +79,9 @@ namespace Chroma
 	success &= LinOpSysSolverReliableIBiCGStabCloverEnv::registerAll();
 	success &= LinOpSysSolverReliableCGCloverEnv::registerAll();
 	success &= LinOpSysSolverFGMRESDREnv::registerAll();
+	success &= LinOpSysSolverDDDeflatedEnv::registerAll();
+	success &= LinOpSysSolverLowModeDeflatedEnv::registerAll();
+	success &= LinOpSysSolverSAPCloverEnv::registerAll();
 
 #ifdef BUILD_QUDA
 	success &= LinOpSysSolverQUDACloverEnv::registerAll();
@@ -0,0 +1,45 @@
+/*! \file
+ *  \brief Solve a M*psi=chi linear system by BICGSTAB with 16 bit vectors
+ */
+
+#include "actions/ferm/invert/syssolver_linop_factory.h"
+#include "actions/ferm/invert/syssolver_linop_aggregate.h"
+
+#include "actions/ferm/invert/syssolver_linop_bicgstab_half.h"
+
+namespace Chroma
+{
+
+  //! BICGSTAB with 16 bit vectors system solver namespace
+  namespace LinOpSysSolverBiCGStabHalfEnv
+  {
+    //! Callback function
+    LinOpSystemSolver<LatticeFermionF>* createFermF(XMLReader& xml_in,
+						    const std::string& path,
+						    Handle< FermState< LatticeFermionF, multi1d<LatticeColorMatrixF>, multi1d<LatticeColorMatrixF> > > state,
+						    Handle< LinearOperator<LatticeFermionF> > A)
+    {
+      return new LinOpSysSolverBiCGStabHalf(A, SysSolverBiCGStabParams(xml_in, path));
+    }
+
+    //! Name to be used
+    const std::string name("BICGSTAB_HALF_INVERTER");
+
+    //! Local registration flag
+    static bool registered = false;
+
+    //! Register all the factories
+    bool registerAll() 
+    {
+      bool success = true; 
+      if (! registered)
+      {
+#ifndef QDP_IS_QDPJIT
+	success &= Chroma::TheLinOpFFermSystemSolverFactory::Instance().registerObject(name, createFermF);
+#endif
+	registered = true;
+      }
+      return success;
+    }
+  }
+}
@@ -0,0 +1,114 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Solve a M*psi=chi linear system by BICGSTAB with 16 bit vectors
+ */
+
+#ifndef __syssolver_linop_bicgstab_half_h__
+#define __syssolver_linop_bicgstab_half_h__
+
+#include "chroma_config.h"
+#include "handle.h"
+#include "syssolver.h"
+#include "linearop.h"
+#include "actions/ferm/invert/syssolver_linop.h"
+#include "actions/ferm/invert/syssolver_bicgstab_params.h"
+#include "actions/ferm/invert/invbicgstab_half.h"
+
+namespace Chroma
+{
+
+  //! BICGSTAB with 16 bit vectors system solver namespace
+  namespace LinOpSysSolverBiCGStabHalfEnv
+  {
+    //! Register the syssolver
+    bool registerAll();
+  }
+
+
+  //! Solve a single precision M*psi=chi linear system by BICGSTAB with 16 bit vectors
+  /*! \ingroup invert
+   *
+   * Only registered for single precision fermions, as the inner solver
+   * of a multi precision defect correction, e.g.
+   *
+   *  <invType>RICHARDSON_MP_CLOVER_INVERTER</invType>
+   *  ...
+   *  <InnerSolverParams>
+   *    <invType>BICGSTAB_HALF_INVERTER</invType>
+   *    <RsdBiCGStab>1.0e-2</RsdBiCGStab>
+   *    <MaxBiCGStab>1000</MaxBiCGStab>
+   *  </InnerSolverParams>
+   */
+  class LinOpSysSolverBiCGStabHalf : public LinOpSystemSolver<LatticeFermionF>
+  {
+  public:
+    typedef LatticeFermionF T;
+
+    //! Constructor
+    /*!
+     * \param A_        Linear operator ( Read )
+     * \param invParam  inverter parameters ( Read )
+     */
+    LinOpSysSolverBiCGStabHalf(Handle< LinearOperator<T> > A_,
+			       const SysSolverBiCGStabParams& invParam_) : 
+      A(A_), invParam(invParam_) 
+      {}
+
+    //! Destructor is automatic
+    ~LinOpSysSolverBiCGStabHalf() {}
+
+    //! Return the subset on which the operator acts
+    const Subset& subset() const {return A->subset();}
+
+    //! Solver the linear system
+    /*!
+     * \param psi      solution ( Modify )
+     * \param chi      source ( Read )
+     * \return syssolver results
+     */
+    SystemSolverResults_t operator() (T& psi, const T& chi) const
+    {
+      START_CODE();
+      StopWatch swatch;
+      
+      SystemSolverResults_t res;
+      swatch.start();
+
+      res = InvBiCGStabHalf(*A, 
+			    chi, 
+			    psi, 
+			    invParam.RsdBiCGStab, 
+			    invParam.MaxBiCGStab, 
+			    PLUS);
+      
+      swatch.stop();
+      double time = swatch.getTimeInSeconds();
+      { 
+	T r;
+	r[A->subset()]=chi;
+	T tmp;
+	(*A)(tmp, psi, PLUS);
+	r[A->subset()] -= tmp;
+	res.resid = sqrt(norm2(r, A->subset()));
+      }
+      QDPIO::cout << "BICGSTAB_HALF_SOLVER: " << res.n_count << " iterations. Rsd = " << res.resid << " Relative Rsd = " << res.resid/sqrt(norm2(chi,A->subset())) << std::endl;
+      QDPIO::cout << "BICGSTAB_HALF_SOLVER_TIME: "<<time<< " sec" << std::endl;
+
+      END_CODE();
+      
+      return res;
+    }
+
+
+  private:
+    // Hide default constructor
+    LinOpSysSolverBiCGStabHalf() {}
+
+    Handle< LinearOperator<T> > A;
+    SysSolverBiCGStabParams invParam;
+  };
+
+} // End namespace
+
+#endif 
+
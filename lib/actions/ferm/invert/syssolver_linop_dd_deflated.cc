@@ -0,0 +1,51 @@
+/*! \file
+ *  \brief Solve a M*psi=chi linear system with domain-decomposed inexact deflation
+ */
+
+#include "actions/ferm/invert/syssolver_linop_factory.h"
+#include "actions/ferm/invert/syssolver_linop_aggregate.h"
+#include "actions/ferm/invert/syssolver_linop_dd_deflated.h"
+
+namespace Chroma
+{
+
+  //! Domain-decomposed deflation system solver namespace
+  namespace LinOpSysSolverDDDeflatedEnv
+  {
+    //! Anonymous namespace
+    namespace
+    {
+      //! Name to be used
+      const std::string name("DD_DEFLATED_INVERTER");
+
+      //! Local registration flag
+      bool registered = false;
+    }
+
+
+#ifndef QDP_IS_QDPJIT
+    //! Callback function
+    LinOpSystemSolver<LatticeFermion>* createFerm(XMLReader& xml_in,
+						  const std::string& path,
+						  Handle< FermState< LatticeFermion, multi1d<LatticeColorMatrix>, multi1d<LatticeColorMatrix> > > state,
+						  Handle< LinearOperator<LatticeFermion> > A)
+    {
+      return new LinOpSysSolverDDDeflated<LatticeFermion>(A, state, SysSolverDDDeflatedParams(xml_in, path));
+    }
+#endif
+
+    //! Register all the factories
+    bool registerAll() 
+    {
+      bool success = true; 
+      if (! registered)
+      {
+#ifndef QDP_IS_QDPJIT
+	success &= Chroma::TheLinOpFermSystemSolverFactory::Instance().registerObject(name, createFerm);
+#endif
+	registered = true;
+      }
+      return success;
+    }
+  }
+}
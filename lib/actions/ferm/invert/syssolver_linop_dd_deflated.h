@@ -0,0 +1,169 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Solve a M*psi=chi linear system with domain-decomposed inexact deflation
+ */
+
+#ifndef __syssolver_linop_dd_deflated_h__
+#define __syssolver_linop_dd_deflated_h__
+#include "chroma_config.h"
+
+#include "handle.h"
+#include "state.h"
+#include "syssolver.h"
+#include "linearop.h"
+#include "actions/ferm/invert/syssolver_linop.h"
+#include "actions/ferm/invert/syssolver_linop_factory.h"
+#include "actions/ferm/invert/syssolver_dd_deflated_params.h"
+#include "actions/ferm/invert/invdd_deflated.h"
+
+#include <string>
+
+
+namespace Chroma
+{
+
+  //! Domain-decomposed deflation system solver namespace
+  namespace LinOpSysSolverDDDeflatedEnv
+  {
+    //! Register the syssolver
+    bool registerAll();
+  }
+
+
+#ifndef QDP_IS_QDPJIT
+  //! Solve a M*psi=chi linear system with domain-decomposed inexact deflation
+  /*! \ingroup invert
+   *
+   * On the first solve NumVecs vectors are made by SetupIter approximate
+   * inverse iterations from random, cut into the blocks and the little
+   * Dirac operator on them is assembled. Every solve then runs SubInvParam
+   * on the deflated operator P_L M and puts the low modes back in with
+   * two little solves.
+   */
+  template<typename T>
+  class LinOpSysSolverDDDeflated : public LinOpSystemSolver<T>
+  {
+  public:
+    typedef LatticeColorMatrix U;
+    typedef multi1d<LatticeColorMatrix> Q;
+
+    //! Constructor
+    /*!
+     * \param A_        Linear operator ( Read )
+     * \param state_    fermion state ( Read )
+     * \param invParam  inverter parameters ( Read )
+     */
+    LinOpSysSolverDDDeflated(Handle< LinearOperator<T> > A_,
+			     Handle< FermState<T,Q,Q> > state_,
+			     const SysSolverDDDeflatedParams& invParam_) :
+      A(A_), state(state_), invParam(invParam_)
+      {}
+
+    //! Destructor is automatic
+    ~LinOpSysSolverDDDeflated() {}
+
+    //! Return the subset on which the operator acts
+    const Subset& subset() const {return A->subset();}
+
+    //! Solver the linear system
+    /*!
+     * \param psi      solution ( Modify )
+     * \param chi      source ( Read )
+     * \return syssolver results
+     */
+    SystemSolverResults_t operator() (T& psi, const T& chi) const
+      {
+	START_CODE();
+	StopWatch swatch;
+	swatch.reset(); swatch.start();
+
+	if (space.operator->() == 0)
+	  setup();
+
+	const Subset& s = A->subset();
+	InvDDDeflatedEnv::LittleVector c, c0, d;
+	T rhs, tmp;
+
+	// Low mode part  V A_l^-1 V^dag chi
+	space->restrictVec(c, chi);
+	space->littleSolve(c0, c, PLUS);
+
+	// Deflated source  P_L chi = chi - M V c0
+	tmp[s] = zero;
+	space->prolongVec(tmp, c0);
+	(*A)(rhs, tmp, PLUS);
+	rhs[s] = chi - rhs;
+
+	SystemSolverResults_t res = (*sub_solver)(psi, rhs);
+
+	// psi = V c0 + (1 - V A_l^-1 V^dag M) psi
+	(*A)(tmp, psi, PLUS);
+	space->restrictVec(c, tmp);
+	space->littleSolve(d, c, PLUS);
+	for(int i=0; i < d.size(); ++i)
+	  d[i] = c0[i] - d[i];
+	space->prolongVec(psi, d);
+
+	{ // Find true residuum
+	  T r;
+	  (*A)(r, psi, PLUS);
+	  r[s] -= chi;
+	  res.resid = sqrt(norm2(r,s));
+	}
+
+	swatch.stop();
+	QDPIO::cout << "DD_DEFLATED_SOLVER: " << res.n_count
+		    << " iterations. Rsd = " << res.resid
+		    << " Relative Rsd = " << res.resid/sqrt(norm2(chi,s)) << std::endl;
+
+	double time = swatch.getTimeInSeconds();
+	QDPIO::cout << "DD_DEFLATED_SOLVER_TIME: "<<time<< " sec" << std::endl;
+
+	END_CODE();
+
+	return res;
+      }
+
+  private:
+    // Hide default constructor
+    LinOpSysSolverDDDeflated() {}
+
+    //! Make the deflation space and the solver of the deflated system
+    void setup() const
+      {
+	StopWatch swatch;
+	swatch.reset(); swatch.start();
+
+	space = new InvDDDeflatedEnv::DDDeflationSpace<T>(A, invParam.Blocking,
+							  invParam.NumVecs, invParam.OperatorRange);
+	space->setCoarseParams(toDouble(invParam.CoarseRsd), invParam.CoarseMaxIter, invParam.CoarseGCRVecs);
+	space->generate(invParam.SetupIter, invParam.SetupMRIter);
+
+	Handle< LinearOperator<T> > PA(new DDDeflatedLinOp<T>(A, space));
+
+	std::istringstream is(invParam.SubInvParam.xml);
+	XMLReader sub_xml(is);
+	sub_solver = TheLinOpFermSystemSolverFactory::Instance().createObject(invParam.SubInvParam.id,
+									      sub_xml,
+									      invParam.SubInvParam.path,
+									      state,
+									      PA);
+
+	swatch.stop();
+	QDPIO::cout << "DD_DEFLATED_SOLVER: setup of " << space->geometry().numBlocks()
+		    << " blocks of " << invParam.NumVecs << " vectors in "
+		    << swatch.getTimeInSeconds() << " sec" << std::endl;
+      }
+
+    Handle< LinearOperator<T> > A;
+    Handle< FermState<T,Q,Q> > state;
+    SysSolverDDDeflatedParams invParam;
+
+    mutable Handle< InvDDDeflatedEnv::DDDeflationSpace<T> > space;
+    mutable Handle< LinOpSystemSolver<T> > sub_solver;
+  };
+#endif
+
+} // End namespace
+
+#endif
@@ -0,0 +1,154 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Solve a M*psi=chi linear system deflated with precomputed low modes
+ */
+
+#ifndef __syssolver_linop_lowmode_deflated_h__
+#define __syssolver_linop_lowmode_deflated_h__
+#include "chroma_config.h"
+
+#include "handle.h"
+#include "state.h"
+#include "syssolver.h"
+#include "linearop.h"
+#include "actions/ferm/invert/syssolver_linop.h"
+#include "actions/ferm/invert/syssolver_linop_factory.h"
+#include "actions/ferm/invert/syssolver_lowmode_deflated_params.h"
+#include "actions/ferm/invert/lowmode_deflation.h"
+
+#include <string>
+
+
+namespace Chroma
+{
+
+  //! Low mode deflated system solver namespace
+  namespace LinOpSysSolverLowModeDeflatedEnv
+  {
+    //! Register the syssolver
+    bool registerAll();
+  }
+
+
+#ifndef QDP_IS_QDPJIT
+  //! Solve a M*psi=chi linear system deflated with precomputed low modes
+  /*! \ingroup invert
+   *
+   * The Ritz pairs in EigenId are those of M^dag M, so the low mode part of
+   * M^-1 r = (M^dag M)^-1 M^dag r is  sum_i v_i <v_i, M^dag r> / lambda_i.
+   * It is put into the guess once, then SubInvParam is run and restarted
+   * with the low mode part of its residual as for the MdagM solver.
+   */
+  template<typename T>
+  class LinOpSysSolverLowModeDeflated : public LinOpSystemSolver<T>
+  {
+  public:
+    typedef LatticeColorMatrix U;
+    typedef multi1d<LatticeColorMatrix> Q;
+
+    //! Constructor
+    /*!
+     * \param A_        Linear operator ( Read )
+     * \param state_    fermion state ( Read )
+     * \param invParam  inverter parameters ( Read )
+     */
+    LinOpSysSolverLowModeDeflated(Handle< LinearOperator<T> > A_,
+				  Handle< FermState<T,Q,Q> > state_,
+				  const SysSolverLowModeDeflatedParams& invParam_) :
+      A(A_), invParam(invParam_),
+      deflation(invParam_.eigen_id, invParam_.Neig, A_->subset(),
+		invParam_.evec_file, invParam_.evecStorage)
+      {
+	std::istringstream is(invParam.SubInvParam.xml);
+	XMLReader sub_xml(is);
+	sub_solver = TheLinOpFermSystemSolverFactory::Instance().createObject(invParam.SubInvParam.id,
+									      sub_xml,
+									      invParam.SubInvParam.path,
+									      state_,
+									      A);
+      }
+
+    //! Destructor
+    ~LinOpSysSolverLowModeDeflated()
+      {
+	if (invParam.cleanUpEvecs)
+	  TheNamedObjMap::Instance().erase(invParam.eigen_id);
+      }
+
+    //! Return the subset on which the operator acts
+    const Subset& subset() const {return A->subset();}
+
+    //! Solver the linear system
+    /*!
+     * \param psi      solution ( Modify )
+     * \param chi      source ( Read )
+     * \return syssolver results
+     */
+    SystemSolverResults_t operator() (T& psi, const T& chi) const
+      {
+	START_CODE();
+	StopWatch swatch;
+	swatch.reset(); swatch.start();
+
+	const Subset& s = A->subset();
+	const Double chi_norm = sqrt(norm2(chi,s));
+	T r, mdag_r;
+
+	// Project the guess
+	(*A)(r, psi, PLUS);
+	r[s] = chi - r;
+	(*A)(mdag_r, r, MINUS);
+	deflation.correct(psi, mdag_r);
+
+	SystemSolverResults_t res = (*sub_solver)(psi, chi);
+
+	int restarts = 0;
+	for(; restarts < invParam.MaxRestarts; ++restarts)
+	{
+	  (*A)(r, psi, PLUS);
+	  r[s] = chi - r;
+	  if (toBool(sqrt(norm2(r,s)) <= invParam.RsdTarget*chi_norm))
+	    break;
+
+	  // Low modes of the residual before the restart
+	  (*A)(mdag_r, r, MINUS);
+	  deflation.correct(psi, mdag_r);
+
+	  int n_count = res.n_count;
+	  res = (*sub_solver)(psi, chi);
+	  res.n_count += n_count;
+	}
+
+	{ // Find true residuum
+	  (*A)(r, psi, PLUS);
+	  r[s] -= chi;
+	  res.resid = sqrt(norm2(r,s));
+	}
+
+	swatch.stop();
+	QDPIO::cout << "LOWMODE_DEFLATED_SOLVER: " << res.n_count
+		    << " iterations in " << restarts+1 << " cycles. Rsd = " << res.resid
+		    << " Relative Rsd = " << res.resid/chi_norm << std::endl;
+
+	double time = swatch.getTimeInSeconds();
+	QDPIO::cout << "LOWMODE_DEFLATED_SOLVER_TIME: "<<time<< " sec" << std::endl;
+
+	END_CODE();
+
+	return res;
+      }
+
+  private:
+    // Hide default constructor
+    LinOpSysSolverLowModeDeflated();
+
+    Handle< LinearOperator<T> > A;
+    SysSolverLowModeDeflatedParams invParam;
+    LowModeDeflation<T> deflation;
+    Handle< LinOpSystemSolver<T> > sub_solver;
+  };
+#endif
+
+} // End namespace
+
+#endif
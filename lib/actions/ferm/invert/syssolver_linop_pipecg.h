@@ -0,0 +1,102 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Solve a M*psi=chi linear system by pipelined CG
+ */
+
+#ifndef __syssolver_linop_pipecg_h__
+#define __syssolver_linop_pipecg_h__
+#include "chroma_config.h"
+#include "handle.h"
+#include "syssolver.h"
+#include "linearop.h"
+#include "actions/ferm/invert/syssolver_linop.h"
+#include "actions/ferm/invert/syssolver_cg_params.h"
+#include "actions/ferm/invert/invpipecg.h"
+
+
+namespace Chroma
+{
+
+  //! Pipelined CG system solver namespace
+  namespace LinOpSysSolverPipeCGEnv
+  {
+    //! Register the syssolver
+    bool registerAll();
+  }
+
+
+  //! Solve a M*psi=chi linear system by pipelined CG
+  /*! \ingroup invert
+   */
+  template<typename T>
+  class LinOpSysSolverPipeCG : public LinOpSystemSolver<T>
+  {
+  public:
+    //! Constructor
+    /*!
+     * \param M_        Linear operator ( Read )
+     * \param invParam  inverter parameters ( Read )
+     */
+    LinOpSysSolverPipeCG(Handle< LinearOperator<T> > A_,
+		 const SysSolverCGParams& invParam_) : 
+      A(A_), invParam(invParam_) 
+      {}
+
+    //! Destructor is automatic
+    ~LinOpSysSolverPipeCG() {}
+
+    //! Return the subset on which the operator acts
+    const Subset& subset() const {return A->subset();}
+
+    //! Solver the linear system
+    /*!
+     * \param psi      solution ( Modify )
+     * \param chi      source ( Read )
+     * \return syssolver results
+     */
+    SystemSolverResults_t operator() (T& psi, const T& chi) const
+      {
+	START_CODE();	
+	SystemSolverResults_t res;  // initialized by a constructor
+	StopWatch swatch;
+	swatch.reset();
+	swatch.start();
+
+	T chi_tmp;
+	(*A)(chi_tmp, chi, MINUS);
+	res = InvPipeCG(*A, chi_tmp, psi, invParam.RsdCG, invParam.MaxCG);
+
+	swatch.stop();
+	double time = swatch.getTimeInSeconds();
+
+	{ 
+	  T r;
+	  r[A->subset()]=chi;
+	  T tmp;
+	  (*A)(tmp, psi, PLUS);
+	  r[A->subset()] -= tmp;
+	  res.resid = sqrt(norm2(r, A->subset()));
+	}
+	QDPIO::cout << "PIPECG_SOLVER: " << res.n_count << " iterations. Rsd = " << res.resid << " Relative Rsd = " << res.resid/sqrt(norm2(chi,A->subset())) << std::endl;
+      QDPIO::cout << "PIPECG_SOLVER_TIME: "<<time<< " sec" << std::endl;
+
+	
+
+	END_CODE();
+
+	return res;
+      }
+
+
+  private:
+    // Hide default constructor
+    LinOpSysSolverPipeCG() {}
+
+    Handle< LinearOperator<T> > A;
+    SysSolverCGParams invParam;
+  };
+
+} // End namespace
+
+#endif 
+
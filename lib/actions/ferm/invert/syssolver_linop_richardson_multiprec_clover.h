@@ -37,6 +37,9 @@ namespace Chroma
   //! Solve a system using Richardson iteration.
   /*! \ingroup invert
  *** WARNING THIS SOLVER WORKS FOR CLOVER FERMIONS ONLY ***
+ *
+ * The inner solver runs in single precision. With BICGSTAB_HALF_INVERTER
+ * as the inner solver its Krylov vectors are stored in 16 bits.
    */
  
   class LinOpSysSolverRichardsonClover : public LinOpSystemSolver<LatticeFermion>
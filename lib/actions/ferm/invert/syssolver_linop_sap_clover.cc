@@ -0,0 +1,521 @@
+/*! \file
+ *  \brief Schwarz alternating procedure (SAP) preconditioner for the even-odd clover operator
+ */
+
+#include "actions/ferm/invert/syssolver_linop_factory.h"
+#include "actions/ferm/invert/syssolver_linop_aggregate.h"
+#include "actions/ferm/invert/syssolver_linop_sap_clover.h"
+#include "io/aniso_io.h"
+
+#include <map>
+
+namespace Chroma
+{
+
+  //! SAP preconditioner namespace
+  namespace LinOpSysSolverSAPCloverEnv
+  {
+    //! Anonymous namespace
+    namespace
+    {
+      //! Name to be used
+      const std::string name("SAP_CLOVER_PRECONDITIONER");
+
+      //! Local registration flag
+      bool registered = false;
+    }
+
+
+#ifndef QDP_IS_QDPJIT
+    //! Callback function
+    LinOpSystemSolver<LatticeFermion>* createFerm(XMLReader& xml_in,
+						  const std::string& path,
+						  Handle< FermState< LatticeFermion, multi1d<LatticeColorMatrix>, multi1d<LatticeColorMatrix> > > state,
+						  Handle< LinearOperator<LatticeFermion> > A)
+    {
+      return new LinOpSysSolverSAPClover(A, state, SysSolverSAPCloverParams(xml_in, path));
+    }
+#endif
+
+    //! Register all the factories
+    bool registerAll()
+    {
+      bool success = true;
+      if (! registered)
+      {
+#ifndef QDP_IS_QDPJIT
+	success &= Chroma::TheLinOpFermSystemSolverFactory::Instance().registerObject(name, createFerm);
+#endif
+	registered = true;
+      }
+      return success;
+    }
+  }
+
+
+#ifndef QDP_IS_QDPJIT
+  namespace
+  {
+    //! Checkerboard of each site on this node
+    std::vector<int> siteParity()
+    {
+      std::vector<int> parity(Layout::sitesOnNode());
+      for(int cb=0; cb < rb.numSubsets(); ++cb)
+      {
+	const int* tab = rb[cb].siteTable().slice();
+	for(int i=0; i < rb[cb].numSiteTable(); ++i)
+	  parity[tab[i]] = cb;
+      }
+      return parity;
+    }
+
+    //! Add the hop of one direction to a site
+    /*!
+     * acc += U (1 + sign gamma_mu) psi, or with U^dag. The projector has
+     * rank two, so only the two spin components t < perm[t] are multiplied
+     * by the link and the other two follow from them.
+     */
+    template<typename R>
+    inline
+    void hopDir(RComplex<R> acc[Ns][Nc], const RComplex<R>* u, bool dag, const RComplex<R>* psi,
+		const int* perm, const RComplex<R>* phase, R sign)
+    {
+      for(int t=0; t < Ns; ++t)
+      {
+	const int tp = perm[t];
+	if (tp < t)
+	  continue;
+
+	const RComplex<R> ph(sign*phase[t].real(), sign*phase[t].imag());
+	const RComplex<R> php(sign*phase[tp].real(), sign*phase[tp].imag());
+
+	RComplex<R> h[Nc];
+	for(int c=0; c < Nc; ++c)
+	  h[c] = psi[t*Nc + c] + ph*psi[tp*Nc + c];
+
+	for(int c=0; c < Nc; ++c)
+	{
+	  RComplex<R> uh(R(0), R(0));
+	  if (dag)
+	    for(int k=0; k < Nc; ++k)
+	      uh += conj(u[k*Nc + c]) * h[k];
+	  else
+	    for(int k=0; k < Nc; ++k)
+	      uh += u[c*Nc + k] * h[k];
+
+	  acc[t][c]  += uh;
+	  acc[tp][c] += php * uh;
+	}
+      }
+    }
+  }
+
+
+  // Constructor
+  LinOpSysSolverSAPClover::LinOpSysSolverSAPClover(Handle< LinearOperator<T> > A_,
+						   Handle< FermState<T,Q,Q> > state_,
+						   const SysSolverSAPCloverParams& invParam_) :
+    A(A_), invParam(invParam_)
+  {
+    START_CODE();
+
+    // The clover terms and coefficients come from the operator itself
+    const EvenOddPrecCloverLinOp* clovA = dynamic_cast<const EvenOddPrecCloverLinOp*>(A.operator->());
+    if (clovA == 0)
+    {
+      QDPIO::cerr << "SAP_CLOVER: the operator must be an EvenOddPrecCloverLinOp" << std::endl;
+      QDP_abort(1);
+    }
+
+    const CloverFermActParams& clovParams = clovA->getParam();
+
+    if (invParam.clovParamsP)
+    {
+      const CloverFermActParams& p = invParam.clovParams;
+      if (toBool(p.Mass != clovParams.Mass) ||
+	  toBool(p.clovCoeffR != clovParams.clovCoeffR) ||
+	  toBool(p.clovCoeffT != clovParams.clovCoeffT) ||
+	  p.anisoParam.anisoP != clovParams.anisoParam.anisoP ||
+	  (p.anisoParam.anisoP &&
+	   (p.anisoParam.t_dir != clovParams.anisoParam.t_dir ||
+	    toBool(p.anisoParam.xi_0 != clovParams.anisoParam.xi_0) ||
+	    toBool(p.anisoParam.nu != clovParams.anisoParam.nu))))
+      {
+	QDPIO::cerr << "SAP_CLOVER: CloverParams do not match those of the operator" << std::endl;
+	QDP_abort(1);
+      }
+    }
+
+    // The links with the boundary conditions applied, and with the
+    // coefficients of each direction folded in as the dslash does
+    u = state_->getLinks();
+    if (clovParams.anisoParam.anisoP)
+    {
+      multi1d<Real> coeffs = makeFermCoeffs(clovParams.anisoParam);
+      for(int mu=0; mu < Nd; ++mu)
+	u[mu] *= coeffs[mu];
+    }
+
+    makeBlocks();
+    makeSpinProjectors();
+    makeCloverBlocks(*clovA);
+
+    END_CODE();
+  }
+
+
+  // Cut the node sub-lattice into blocks
+  void LinOpSysSolverSAPClover::makeBlocks()
+  {
+    const multi1d<int>& block = invParam.Blocking;
+    const multi1d<int>& sub = Layout::subgridLattSize();
+
+    if (block.size() != Nd)
+    {
+      QDPIO::cerr << "SAP_CLOVER: Blocking must have Nd entries" << std::endl;
+      QDP_abort(1);
+    }
+
+    for(int mu=0; mu < Nd; ++mu)
+    {
+      if (block[mu] <= 0 || block[mu] % 2 != 0 || sub[mu] % block[mu] != 0)
+      {
+	QDPIO::cerr << "SAP_CLOVER: block size " << block[mu] << " in direction " << mu
+		    << " must be even and divide the node sub-lattice " << sub[mu] << std::endl;
+	QDP_abort(1);
+      }
+    }
+
+    std::vector<int> parity = siteParity();
+
+    // Sort the sites into blocks
+    std::map<int,int> index;
+    for(int site=0; site < Layout::sitesOnNode(); ++site)
+    {
+      multi1d<int> x = Layout::siteCoords(Layout::nodeNumber(), site);
+
+      int gb = 0;
+      int col = 0;
+      for(int mu=Nd-1; mu >= 0; --mu)
+      {
+	gb = gb*(Layout::lattSize()[mu] / block[mu]) + x[mu] / block[mu];
+	col += x[mu] / block[mu];
+      }
+
+      std::map<int,int>::const_iterator it = index.find(gb);
+      int b;
+      if (it == index.end())
+      {
+	b = blocks.size();
+	index[gb] = b;
+	blocks.push_back(Block());
+	colour_blocks[col % 2].push_back(b);
+      }
+      else
+	b = it->second;
+
+      if (parity[site] == 1)
+	blocks[b].odd.push_back(site);
+      else
+	blocks[b].even.push_back(site);
+    }
+
+    // Neighbours inside the block
+    for(int b=0; b < blocks.size(); ++b)
+    {
+      for(int p=0; p < 2; ++p)
+      {
+	const std::vector<int>& sites = (p == 0) ? blocks[b].odd : blocks[b].even;
+	std::vector<int>& nbr = (p == 0) ? blocks[b].odd_nbr : blocks[b].even_nbr;
+	nbr.resize(2*Nd*sites.size());
+
+	for(int j=0; j < sites.size(); ++j)
+	{
+	  multi1d<int> x = Layout::siteCoords(Layout::nodeNumber(), sites[j]);
+	  for(int mu=0; mu < Nd; ++mu)
+	  {
+	    for(int dir=0; dir < 2; ++dir)
+	    {
+	      multi1d<int> y = x;
+	      y[mu] += (dir == 0) ? 1 : -1;
+
+	      int n = -1;
+	      if (y[mu] >= 0 && y[mu] / block[mu] == x[mu] / block[mu])
+		n = Layout::linearSiteIndex(y);
+
+	      nbr[2*Nd*j + 2*mu + dir] = n;
+	    }
+	  }
+	}
+      }
+    }
+
+    int vol = 1;
+    for(int mu=0; mu < Nd; ++mu)
+      vol *= block[mu];
+
+    // Links, clover blocks and five spinors per site
+    const int site_bytes = sizeof(REALT) * 2 * (Nd*Nc*Nc + 2*(2*Nc)*(2*Nc) + 5*Ns*Nc);
+
+    QDPIO::cout << "SAP_CLOVER: " << blocks.size() << " blocks of " << vol
+		<< " sites per node, working set of a block about " << (vol*site_bytes)/1024 << " kB" << std::endl;
+  }
+
+
+  // Read the spin structure of the gamma matrices
+  void LinOpSysSolverSAPClover::makeSpinProjectors()
+  {
+    SpinMatrix g_one = 1.0;
+
+    for(int mu=0; mu < Nd; ++mu)
+    {
+      SpinMatrix g = Gamma(1 << mu) * g_one;
+
+      for(int s=0; s < Ns; ++s)
+      {
+	perm[mu][s] = -1;
+	for(int t=0; t < Ns; ++t)
+	{
+	  Complex z = peekSpin(g, s, t);
+	  double re = toDouble(real(z));
+	  double im = toDouble(imag(z));
+
+	  if (re*re + im*im > 0.5)
+	  {
+	    perm[mu][s] = t;
+	    phase[mu][s] = RComplex<REALT>(REALT(re), REALT(im));
+	  }
+	}
+
+	if (perm[mu][s] < 0)
+	{
+	  QDPIO::cerr << "SAP_CLOVER: gamma matrices must have one entry per row" << std::endl;
+	  QDP_abort(1);
+	}
+      }
+    }
+  }
+
+
+  // Store A_oo on the odd and A_ee^-1 on the even sites as dense chiral blocks
+  void LinOpSysSolverSAPClover::makeCloverBlocks(const EvenOddPrecCloverLinOp& clovA)
+  {
+    const int n = 2*Nc;
+    const int nsites = Layout::sitesOnNode();
+    std::vector<int> parity = siteParity();
+
+    clov_site.resize(nsites*2*n*n);
+
+    // The columns of both operators, one unit source at a time
+    T e;
+    T col;
+    for(int k=0; k < Ns*Nc; ++k)
+    {
+      e = zero;
+      for(int site=0; site < nsites; ++site)
+	((REALT*)&(e.elem(site)))[2*k] = 1;
+
+      clovA.oddOddLinOp(col, e, PLUS);
+      clovA.evenEvenInvLinOp(col, e, PLUS);
+
+      const int b = k / n;
+      const int kk = k % n;
+      for(int site=0; site < nsites; ++site)
+      {
+	const RComplex<REALT>* c = (const RComplex<REALT>*)&(col.elem(site).elem(0).elem(0));
+	RComplex<REALT>* m = &(clov_site[(site*2 + b)*n*n]);
+	for(int i=0; i < n; ++i)
+	  m[i*n + kk] = c[b*n + i];
+      }
+    }
+  }
+
+
+  // Block solves on the blocks [lo,hi) of a colour
+  void LinOpSysSolverSAPClover::blockSolveLoop(int lo, int hi, int myId, BlockArgs* a)
+  {
+    for(int i=lo; i < hi; ++i)
+      a->sap->solveBlock(a->sap->blocks[(*a->blocks)[i]], *a->psi, *a->res);
+  }
+
+
+  // out = D in  on some sites of a block, using the hops inside the block
+  void LinOpSysSolverSAPClover::hopBlock(T& out, const T& in,
+					 const std::vector<int>& sites, const std::vector<int>& nbr) const
+  {
+    for(int j=0; j < sites.size(); ++j)
+    {
+      const int x = sites[j];
+
+      RComplex<REALT> acc[Ns][Nc];
+      for(int s=0; s < Ns; ++s)
+	for(int c=0; c < Nc; ++c)
+	  acc[s][c] = RComplex<REALT>(REALT(0), REALT(0));
+
+      for(int mu=0; mu < Nd; ++mu)
+      {
+	// U_mu(x) (1 - gamma_mu) psi(x+mu)
+	const int fw = nbr[2*Nd*j + 2*mu];
+	if (fw >= 0)
+	  hopDir(acc, (const RComplex<REALT>*)&(u[mu].elem(x).elem().elem(0,0)), false,
+		 (const RComplex<REALT>*)&(in.elem(fw).elem(0).elem(0)),
+		 perm[mu], phase[mu], REALT(-1));
+
+	// U_mu^dag(x-mu) (1 + gamma_mu) psi(x-mu)
+	const int bw = nbr[2*Nd*j + 2*mu + 1];
+	if (bw >= 0)
+	  hopDir(acc, (const RComplex<REALT>*)&(u[mu].elem(bw).elem().elem(0,0)), true,
+		 (const RComplex<REALT>*)&(in.elem(bw).elem(0).elem(0)),
+		 perm[mu], phase[mu], REALT(1));
+      }
+
+      RComplex<REALT>* o = (RComplex<REALT>*)&(out.elem(x).elem(0).elem(0));
+      for(int s=0; s < Ns; ++s)
+	for(int c=0; c < Nc; ++c)
+	  o[s*Nc + c] = acc[s][c];
+    }
+  }
+
+
+  // out = M_B in  on the odd sites of a block
+  void LinOpSysSolverSAPClover::applyBlock(const Block& blk, T& out, const T& in) const
+  {
+    const int n = 2*Nc;
+
+    // te2 = A_ee^-1 D_eo in
+    hopBlock(te, in, blk.even, blk.even_nbr);
+    for(int j=0; j < blk.even.size(); ++j)
+    {
+      const int x = blk.even[j];
+      const RComplex<REALT>* p = (const RComplex<REALT>*)&(te.elem(x).elem(0).elem(0));
+      RComplex<REALT>* q = (RComplex<REALT>*)&(te2.elem(x).elem(0).elem(0));
+
+      for(int b=0; b < 2; ++b)
+      {
+	const RComplex<REALT>* m = &(clov_site[(x*2 + b)*n*n]);
+	for(int i=0; i < n; ++i)
+	{
+	  RComplex<REALT> s(REALT(0), REALT(0));
+	  for(int k=0; k < n; ++k)
+	    s += m[i*n + k] * p[b*n + k];
+	  q[b*n + i] = s;
+	}
+      }
+    }
+
+    // out = A_oo in - 1/4 D_oe te2
+    hopBlock(to, te2, blk.odd, blk.odd_nbr);
+    const REALT mquarter = -0.25;
+    for(int j=0; j < blk.odd.size(); ++j)
+    {
+      const int x = blk.odd[j];
+      const RComplex<REALT>* p = (const RComplex<REALT>*)&(in.elem(x).elem(0).elem(0));
+      const RComplex<REALT>* h = (const RComplex<REALT>*)&(to.elem(x).elem(0).elem(0));
+      RComplex<REALT>* q = (RComplex<REALT>*)&(out.elem(x).elem(0).elem(0));
+
+      for(int b=0; b < 2; ++b)
+      {
+	const RComplex<REALT>* m = &(clov_site[(x*2 + b)*n*n]);
+	for(int i=0; i < n; ++i)
+	{
+	  RComplex<REALT> s(mquarter*h[b*n + i].real(), mquarter*h[b*n + i].imag());
+	  for(int k=0; k < n; ++k)
+	    s += m[i*n + k] * p[b*n + k];
+	  q[b*n + i] = s;
+	}
+      }
+    }
+  }
+
+
+  // MR steps on  M_B dpsi = res  on a block, adding dpsi to psi
+  void LinOpSysSolverSAPClover::solveBlock(const Block& blk, T& psi, const T& res) const
+  {
+    const int n = Ns*Nc;
+    const std::vector<int>& sites = blk.odd;
+
+    for(int j=0; j < sites.size(); ++j)
+      rho.elem(sites[j]) = res.elem(sites[j]);
+
+    for(int it=0; it < invParam.BlockMRIter; ++it)
+    {
+      applyBlock(blk, mrho, rho);
+
+      // alpha = <M rho, rho> / |M rho|^2, all inside the block
+      double num_re = 0;
+      double num_im = 0;
+      double den = 0;
+      for(int j=0; j < sites.size(); ++j)
+      {
+	const REALT* m = (const REALT*)&(mrho.elem(sites[j]));
+	const REALT* r = (const REALT*)&(rho.elem(sites[j]));
+	for(int i=0; i < 2*n; i += 2)
+	{
+	  num_re += (double)m[i]*r[i]   + (double)m[i+1]*r[i+1];
+	  num_im += (double)m[i]*r[i+1] - (double)m[i+1]*r[i];
+	  den    += (double)m[i]*m[i]   + (double)m[i+1]*m[i+1];
+	}
+      }
+
+      if (den == 0.0)
+	break;
+
+      const REALT a_re = num_re / den;
+      const REALT a_im = num_im / den;
+
+      // psi += alpha rho,  rho -= alpha M rho
+      for(int j=0; j < sites.size(); ++j)
+      {
+	REALT* p = (REALT*)&(psi.elem(sites[j]));
+	REALT* r = (REALT*)&(rho.elem(sites[j]));
+	const REALT* m = (const REALT*)&(mrho.elem(sites[j]));
+	for(int i=0; i < 2*n; i += 2)
+	{
+	  p[i]   += a_re*r[i]   - a_im*r[i+1];
+	  p[i+1] += a_re*r[i+1] + a_im*r[i];
+	  r[i]   -= a_re*m[i]   - a_im*m[i+1];
+	  r[i+1] -= a_re*m[i+1] + a_im*m[i];
+	}
+      }
+    }
+  }
+
+
+  // Apply the preconditioner
+  SystemSolverResults_t LinOpSysSolverSAPClover::operator() (T& psi, const T& chi) const
+  {
+    START_CODE();
+
+    const Subset& s = A->subset();
+    SystemSolverResults_t res;
+
+    T r;
+    T tmp;
+    psi[s] = zero;
+    r[s] = chi;
+
+    for(int cycle=0; cycle < invParam.NumCycles; ++cycle)
+    {
+      for(int col=0; col < 2; ++col)
+      {
+	BlockArgs a = {this, &(colour_blocks[col]), &psi, &r};
+	dispatch_to_threads(colour_blocks[col].size(), a, blockSolveLoop);
+
+	// Residual with the couplings between the blocks
+	if (cycle < invParam.NumCycles-1 || col == 0)
+	{
+	  (*A)(tmp, psi, PLUS);
+	  r[s] = chi - tmp;
+	}
+      }
+    }
+
+    res.n_count = invParam.NumCycles;
+
+    END_CODE();
+
+    return res;
+  }
+#endif
+
+} // End namespace
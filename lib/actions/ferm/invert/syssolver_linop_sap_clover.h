@@ -0,0 +1,160 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Schwarz alternating procedure (SAP) preconditioner for the even-odd clover operator
+ */
+
+#ifndef __syssolver_linop_sap_clover_h__
+#define __syssolver_linop_sap_clover_h__
+#include "chroma_config.h"
+
+#include "handle.h"
+#include "state.h"
+#include "syssolver.h"
+#include "linearop.h"
+#include "actions/ferm/invert/syssolver_linop.h"
+#include "actions/ferm/invert/syssolver_sap_clover_params.h"
+#include "actions/ferm/linop/eoprec_clover_linop_w.h"
+
+#include <vector>
+
+
+namespace Chroma
+{
+
+  //! SAP preconditioner namespace
+  namespace LinOpSysSolverSAPCloverEnv
+  {
+    //! Register the syssolver
+    bool registerAll();
+  }
+
+
+#ifndef QDP_IS_QDPJIT
+  //! Multiplicative Schwarz preconditioner for the even-odd clover operator
+  /*! \ingroup invert
+   *
+   * Approximately solves  M psi = chi  for the Schur complement
+   *
+   *    M = A_oo - 1/4 D_oe A_ee^-1 D_eo
+   *
+   * on the odd sites. The lattice is cut into blocks coloured by the
+   * parity of the block coordinates. A cycle runs BlockMRIter minimal
+   * residual steps on every block of one colour, with the block operator
+   * M_B that drops all hops leaving the block, then updates the residual
+   * with the global operator and does the same for the other colour.
+   *
+   * The block solves need no communication and no global reductions,
+   * and the blocks of a colour run in parallel threads. The blocks
+   * should be small enough for their links, clover terms and spinors to
+   * stay in the cache, e.g. 4^4.
+   *
+   * Meant as the preconditioner of a flexible solver such as FGMRES-DR.
+   * The returned residual is not computed.
+   *
+   * A must be an EvenOddPrecCloverLinOp. The clover blocks are taken from
+   * it and the block hops use its anisotropy coefficients.
+   *
+   *** WARNING THIS SOLVER WORKS FOR CLOVER FERMIONS ONLY ***
+   */
+  class LinOpSysSolverSAPClover : public LinOpSystemSolver<LatticeFermion>
+  {
+  public:
+    typedef LatticeFermion T;
+    typedef LatticeColorMatrix U;
+    typedef multi1d<LatticeColorMatrix> Q;
+    typedef WordType<T>::Type_t REALT;
+
+    //! Constructor
+    /*!
+     * \param A_        Linear operator ( Read )
+     * \param state_    fermion state ( Read )
+     * \param invParam  inverter parameters ( Read )
+     */
+    LinOpSysSolverSAPClover(Handle< LinearOperator<T> > A_,
+			    Handle< FermState<T,Q,Q> > state_,
+			    const SysSolverSAPCloverParams& invParam_);
+
+    //! Destructor is automatic
+    ~LinOpSysSolverSAPClover() {}
+
+    //! Return the subset on which the operator acts
+    const Subset& subset() const {return A->subset();}
+
+    //! Apply the preconditioner
+    /*!
+     * \param psi      solution ( Write )
+     * \param chi      source ( Read )
+     * \return syssolver results
+     */
+    SystemSolverResults_t operator() (T& psi, const T& chi) const;
+
+    //! Sites of a block and their neighbours in the block
+    struct Block
+    {
+      std::vector<int> odd;        /*!< odd sites */
+      std::vector<int> even;       /*!< even sites */
+      std::vector<int> odd_nbr;    /*!< per odd site 2*Nd neighbour sites, forward then backward per mu, -1 outside */
+      std::vector<int> even_nbr;   /*!< the same for the even sites */
+    };
+
+    //! Args of the thread kernel
+    struct BlockArgs
+    {
+      const LinOpSysSolverSAPClover*  sap;
+      const std::vector<int>*         blocks;
+      T*                              psi;
+      const T*                        res;
+    };
+
+    //! Block solves on the blocks [lo,hi) of a colour
+    static void blockSolveLoop(int lo, int hi, int myId, BlockArgs* a);
+
+  private:
+    // Hide default constructor
+    LinOpSysSolverSAPClover() {}
+
+    //! Cut the node sub-lattice into blocks
+    void makeBlocks();
+
+    //! Read the spin structure of the gamma matrices
+    void makeSpinProjectors();
+
+    //! Store A_oo on the odd and A_ee^-1 on the even sites as dense chiral blocks
+    void makeCloverBlocks(const EvenOddPrecCloverLinOp& clovA);
+
+    //! MR steps on  M_B dpsi = res  on a block, adding dpsi to psi
+    void solveBlock(const Block& blk, T& psi, const T& res) const;
+
+    //! out = M_B in  on the odd sites of a block
+    void applyBlock(const Block& blk, T& out, const T& in) const;
+
+    //! out = D in  on some sites of a block, using the hops inside the block
+    void hopBlock(T& out, const T& in, const std::vector<int>& sites, const std::vector<int>& nbr) const;
+
+    Handle< LinearOperator<T> > A;
+    SysSolverSAPCloverParams invParam;
+
+    Q             u;            /*!< links times the anisotropy coefficients */
+
+    //! Per site the two 2Nc x 2Nc chiral blocks, row major, of A_oo or A_ee^-1
+    std::vector< RComplex<REALT> > clov_site;
+
+    std::vector<Block> blocks;
+    std::vector<int>   colour_blocks[2];
+
+    //! gamma_mu psi (s) = phase[mu][s] psi(perm[mu][s])
+    int                perm[Nd][Ns];
+    RComplex<REALT>    phase[Nd][Ns];
+
+    //! Work vectors. Each thread only touches the sites of its blocks
+    mutable T rho;
+    mutable T mrho;
+    mutable T te;
+    mutable T te2;
+    mutable T to;
+  };
+#endif
+
+} // End namespace
+
+#endif
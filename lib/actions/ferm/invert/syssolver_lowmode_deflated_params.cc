@@ -0,0 +1,79 @@
+/*! \file
+ *  \brief Params of the low mode deflated inverter
+ */
+
+#include "actions/ferm/invert/syssolver_lowmode_deflated_params.h"
+
+namespace Chroma
+{
+
+  // Read parameters
+  void read(XMLReader& xml, const std::string& path, SysSolverLowModeDeflatedParams& param)
+  {
+    XMLReader paramtop(xml, path);
+
+    read(paramtop, "EigenId", param.eigen_id);
+
+    if (paramtop.count("Neig") != 0)
+      read(paramtop, "Neig", param.Neig);
+
+    if (paramtop.count("EvecFile") != 0)
+      read(paramtop, "EvecFile", param.evec_file);
+
+    if (paramtop.count("EvecStorage") != 0)
+      read(paramtop, "EvecStorage", param.evecStorage);
+
+    if (param.evecStorage != "FULL" && param.evecStorage != "SINGLE" && param.evecStorage != "HALF")
+    {
+      QDPIO::cerr << __func__ << ": unknown EvecStorage " << param.evecStorage << std::endl;
+      QDP_abort(1);
+    }
+
+    if (paramtop.count("cleanUpEvecs") != 0)
+      read(paramtop, "cleanUpEvecs", param.cleanUpEvecs);
+
+    if (paramtop.count("RsdTarget") != 0)
+      read(paramtop, "RsdTarget", param.RsdTarget);
+
+    if (paramtop.count("MaxRestarts") != 0)
+      read(paramtop, "MaxRestarts", param.MaxRestarts);
+
+    param.SubInvParam = readXMLGroup(paramtop, "SubInvParam", "invType");
+  }
+
+  // Writer parameters
+  void write(XMLWriter& xml, const std::string& path, const SysSolverLowModeDeflatedParams& param)
+  {
+    push(xml, path);
+
+    write(xml, "invType", "LOWMODE_DEFLATED_INVERTER");
+    write(xml, "EigenId", param.eigen_id);
+    write(xml, "Neig", param.Neig);
+    write(xml, "EvecFile", param.evec_file);
+    write(xml, "EvecStorage", param.evecStorage);
+    write(xml, "cleanUpEvecs", param.cleanUpEvecs);
+    write(xml, "RsdTarget", param.RsdTarget);
+    write(xml, "MaxRestarts", param.MaxRestarts);
+    xml << param.SubInvParam.xml;
+
+    pop(xml);
+  }
+
+  //! Default constructor
+  SysSolverLowModeDeflatedParams::SysSolverLowModeDeflatedParams()
+  {
+    Neig = 0;
+    evecStorage = "FULL";
+    cleanUpEvecs = false;
+    RsdTarget = 1.0e-8;
+    MaxRestarts = 0;
+  }
+
+  //! Read parameters
+  SysSolverLowModeDeflatedParams::SysSolverLowModeDeflatedParams(XMLReader& xml, const std::string& path)
+  {
+    *this = SysSolverLowModeDeflatedParams();
+    read(xml, path, *this);
+  }
+
+}
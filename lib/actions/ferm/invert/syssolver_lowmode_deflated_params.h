@@ -0,0 +1,45 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Params of the low mode deflated inverter
+ */
+
+#ifndef __syssolver_lowmode_deflated_params_h__
+#define __syssolver_lowmode_deflated_params_h__
+
+#include "chromabase.h"
+#include "io/xml_group_reader.h"
+
+
+namespace Chroma
+{
+
+  //! Params for the low mode deflated inverter
+  /*! \ingroup invert */
+  struct SysSolverLowModeDeflatedParams
+  {
+    SysSolverLowModeDeflatedParams();
+    SysSolverLowModeDeflatedParams(XMLReader& in, const std::string& path);
+
+    std::string   eigen_id;        /*!< Named object of the Ritz pairs of M^dag M */
+    int           Neig;            /*!< Use at most this many pairs, 0 for all */
+    std::string   evec_file;       /*!< Read the pairs from here if eigen_id does not exist */
+    std::string   evecStorage;     /*!< FULL, SINGLE or HALF storage of the pairs read */
+    bool          cleanUpEvecs;    /*!< Erase the pairs when the solver goes */
+
+    Real          RsdTarget;       /*!< Relative residual that ends the restarts */
+    int           MaxRestarts;     /*!< Restarts of SubInvParam after the first solve */
+
+    GroupXML_t    SubInvParam;     /*!< Solver that is deflated */
+  };
+
+
+  // Reader/writers
+  /*! \ingroup invert */
+  void read(XMLReader& xml, const std::string& path, SysSolverLowModeDeflatedParams& param);
+
+  /*! \ingroup invert */
+  void write(XMLWriter& xml, const std::string& path, const SysSolverLowModeDeflatedParams& param);
+
+} // End namespace
+
+#endif
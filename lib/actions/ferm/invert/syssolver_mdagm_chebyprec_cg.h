@@ -0,0 +1,161 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Solve a MdagM*psi=chi linear system by Chebyshev preconditioned CG
+ */
+
+#ifndef __syssolver_mdagm_chebyprec_cg_h__
+#define __syssolver_mdagm_chebyprec_cg_h__
+#include "chroma_config.h"
+
+#include "handle.h"
+#include "syssolver.h"
+#include "linearop.h"
+#include "lmdagm.h"
+#include "actions/ferm/invert/syssolver_mdagm.h"
+#include "actions/ferm/invert/syssolver_chebyprec_cg_params.h"
+#include "actions/ferm/invert/lanczos_bounds.h"
+#include "actions/ferm/invert/invpcg.h"
+#include "actions/ferm/linop/cheby_prec_op.h"
+
+
+namespace Chroma
+{
+
+  //! Chebyshev preconditioned CG system solver namespace
+  namespace MdagMSysSolverChebyPrecCGEnv
+  {
+    //! Register the syssolver
+    bool registerAll();
+  }
+
+
+  //! Solve a MdagM system by CG preconditioned with a Chebyshev polynomial in MdagM
+  /*! \ingroup invert
+   *
+   * The preconditioner is the polynomial approximation to (M^dag M)^-1
+   * on [EigMin,EigMax] of ChebyPrecOp. Unless the interval is given it is
+   * taken from LanczosIter Lanczos steps on the first source, with the
+   * largest Ritz value scaled up by EigMaxSafety, and kept for the
+   * lifetime of the solver. Each CG iteration then costs PolyDegree+1
+   * applications of M^dag M but still only two global reductions.
+   */
+  template<typename T>
+  class MdagMSysSolverChebyPrecCG : public MdagMSystemSolver<T>
+  {
+  public:
+    //! Constructor
+    /*!
+     * \param M_        Linear operator ( Read )
+     * \param invParam  inverter parameters ( Read )
+     */
+    MdagMSysSolverChebyPrecCG(Handle< LinearOperator<T> > A_,
+			      const SysSolverChebyPrecCGParams& invParam_) :
+      A(A_), MdagM(new MdagMLinOp<T>(A_)), invParam(invParam_),
+      have_bounds(invParam_.boundsP), eig_min(invParam_.EigMin), eig_max(invParam_.EigMax)
+      {}
+
+    //! Destructor is automatic
+    ~MdagMSysSolverChebyPrecCG() {}
+
+    //! Return the subset on which the operator acts
+    const Subset& subset() const {return A->subset();}
+
+    //! Solver the linear system
+    /*!
+     * \param psi      solution ( Modify )
+     * \param chi      source ( Read )
+     * \return syssolver results
+     */
+    SystemSolverResults_t operator() (T& psi, const T& chi) const
+      {
+	START_CODE();
+	StopWatch swatch;
+	swatch.reset(); swatch.start();
+
+	if (! have_bounds)
+	  estimateBounds(chi);
+
+	ChebyPrecOp<T> prec(MdagM, eig_min, eig_max, invParam.PolyDegree);
+
+	SystemSolverResults_t res = InvPCG(*MdagM, prec, chi, psi, invParam.RsdCG, invParam.MaxCG);
+
+	{ // Find true residuum
+	  T r;
+	  (*MdagM)(r, psi, PLUS);
+	  r[A->subset()] -= chi;
+	  res.resid = sqrt(norm2(r,A->subset()));
+	}
+
+	swatch.stop();
+	QDPIO::cout << "CHEBYPREC_CG_SOLVER: " << res.n_count
+		    << " iterations. Rsd = " << res.resid
+		    << " Relative Rsd = " << res.resid/sqrt(norm2(chi,A->subset())) << std::endl;
+
+	double time = swatch.getTimeInSeconds();
+	QDPIO::cout << "CHEBYPREC_CG_SOLVER_TIME: "<<time<< " sec" << std::endl;
+
+	END_CODE();
+
+	return res;
+      }
+
+
+    //! Solve the linear system starting with a chrono guess
+    /*!
+     * \param psi solution (Write)
+     * \param chi source   (Read)
+     * \param predictor   a chronological predictor (Read)
+     * \return syssolver results
+     */
+    SystemSolverResults_t operator()(T& psi, const T& chi,
+				     AbsChronologicalPredictor4D<T>& predictor) const
+    {
+      START_CODE();
+
+      predictor(psi, (*MdagM), chi);
+
+      // Do solve
+      SystemSolverResults_t res=(*this)(psi,chi);
+
+      // Store result
+      predictor.newVector(psi);
+      END_CODE();
+      return res;
+    }
+
+  private:
+    // Hide default constructor
+    MdagMSysSolverChebyPrecCG() {}
+
+    //! Spectral bounds of MdagM from a few Lanczos steps on the source
+    void estimateBounds(const T& chi) const
+      {
+	StopWatch swatch;
+	swatch.reset(); swatch.start();
+
+	Real ritz_min, ritz_max;
+	lanczosBounds(*MdagM, chi, invParam.LanczosIter, ritz_min, ritz_max);
+
+	eig_min = ritz_min;
+	eig_max = invParam.EigMaxSafety * ritz_max;
+	have_bounds = true;
+
+	swatch.stop();
+	QDPIO::cout << "CHEBYPREC_CG_SOLVER: Lanczos bounds [" << ritz_min << ", " << ritz_max
+		    << "], using [" << eig_min << ", " << eig_max << "] in "
+		    << swatch.getTimeInSeconds() << " sec" << std::endl;
+      }
+
+    Handle< LinearOperator<T> > A;
+    Handle< LinearOperator<T> > MdagM;
+    SysSolverChebyPrecCGParams invParam;
+
+    mutable bool  have_bounds;
+    mutable Real  eig_min;
+    mutable Real  eig_max;
+  };
+
+
+} // End namespace
+
+#endif
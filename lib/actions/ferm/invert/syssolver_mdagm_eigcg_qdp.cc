@@ -229,6 +229,186 @@ namespace Chroma
       return res;
     }
 
+
+#ifndef QDP_IS_QDPJIT
+    //! Solver the linear system with the eigenvectors in reduced precision
+    /*!
+     * Same as sysSolver, but the deflation space is a CompressedRitzPairs.
+     * New vectors from EigCG are orthogonalised against the space with
+     * blocked inner products, and the Rayleigh-Ritz rotation is done a site
+     * at a time, so the space is never expanded to full precision vectors.
+     */
+    template<typename T>
+    SystemSolverResults_t sysSolverCompressed(T& psi, const T& chi, 
+					      const LinearOperator<T>& A,
+					      const LinearOperator<T>& MdagM, 
+					      const SysSolverEigCGParams& invParam)
+    {
+      START_CODE();
+
+      LinAlg::CompressedRitzPairs<T>& GoodEvecs = 
+	TheNamedObjMap::Instance().getData< LinAlg::CompressedRitzPairs<T> >(invParam.eigen_id);
+
+      const Subset& sub = MdagM.subset();
+
+      multi1d<Double> lambda ; //the eigenvalues
+      multi1d<T> evec(0); // The eigenvectors  
+      SystemSolverResults_t res;  // initialized by a constructor
+      int n_CG(0);
+      int flag(-1);//first time through
+      int restart(0);
+      Real restartTol = invParam.restartTol ;
+      StopWatch snoop;
+      while((flag==-1)||flag==3){
+	flag=0 ;
+	if(invParam.PrintLevel>0)
+	  QDPIO::cout<<"GoodEvecs.Neig= "<<GoodEvecs.Neig<<std::endl;
+	if(GoodEvecs.Neig>0){//deflate if there avectors to deflate
+	  snoop.reset();
+	  snoop.start();
+	  GoodEvecs.initGuess(MdagM, psi, chi);
+	  n_CG = 1;
+	  snoop.stop();
+	  if(invParam.PrintLevel>0)
+	    QDPIO::cout << "InitGuess:  time = "
+			<< snoop.getTimeInSeconds() 
+			<< " secs" << std::endl;
+	}
+	//if there is space for new
+	if(GoodEvecs.Neig < GoodEvecs.size())
+	  {
+	    evec.resize(0);//get in there with no evecs so that it computes new
+	    res = InvEigCG2Env::InvEigCG2(MdagM, psi, chi, lambda, evec, 
+					  invParam.Neig, invParam.Nmax, 
+					  invParam.RsdCG, invParam.MaxCG,
+					  invParam.PrintLevel);
+	    res.n_count += n_CG ;
+
+	    snoop.reset();
+	    snoop.start();
+
+	    const int Nold = GoodEvecs.Neig;
+	    const int Nnew = evec.size();
+	    const int Ntot = Nold + Nnew;
+
+	    // Orthonormalise the new vectors against the space and each other, twice
+	    for(int pass=0; pass < 2; ++pass)
+	    {
+	      for(int i=0; i < Nnew; ++i)
+	      {
+		multi1d<DComplex> c;
+		GoodEvecs.innerProducts(c, evec[i]);
+		for(int k=0; k < Nold; ++k)
+		  c[k] = -c[k];
+		GoodEvecs.axpy(evec[i], c);
+
+		for(int k=0; k < i; ++k)
+		{
+		  DComplex cc = innerProduct(evec[k], evec[i], sub);
+		  evec[i][sub] -= cc*evec[k];
+		}
+		evec[i][sub] *= Real(Double(1)/sqrt(norm2(evec[i], sub)));
+	      }
+	    }
+
+	    // Matrix elements involving the new vectors; the old ones are Ritz vectors
+	    LinAlg::Matrix<DComplex> Htmp(Ntot) ;
+	    Htmp.N = Ntot;
+	    for(int i=0; i < Ntot; ++i)
+	      for(int j=0; j < Ntot; ++j)
+		Htmp(i,j) = zero;
+	    for(int i=0; i < Nold; ++i)
+	      Htmp(i,i) = GoodEvecs.eval[i];
+
+	    T Ap;
+	    for(int i=0; i < Nnew; ++i)
+	    {
+	      MdagM(Ap, evec[i], PLUS);
+
+	      multi1d<DComplex> c;
+	      GoodEvecs.innerProducts(c, Ap);
+	      for(int j=0; j < Nold; ++j)
+	      {
+		Htmp(j,Nold+i) = c[j];
+		Htmp(Nold+i,j) = conj(c[j]);
+	      }
+	      for(int j=0; j <= i; ++j)
+	      {
+		Htmp(Nold+j,Nold+i) = innerProduct(evec[j], Ap, sub);
+		Htmp(Nold+i,Nold+j) = conj(Htmp(Nold+j,Nold+i));
+	      }
+	      Htmp(Nold+i,Nold+i) = real(Htmp(Nold+i,Nold+i));
+	    }
+
+	    char V = 'V' ; char U = 'U' ;
+	    QDPLapack::zheev(V,U,Htmp.mat,lambda);
+
+	    // Rotate and append in place
+	    GoodEvecs.rotate(Htmp, evec, Nnew);
+	    for(int k=0; k < GoodEvecs.Neig; k++)
+	      GoodEvecs.eval[k] = lambda[k];
+
+	    snoop.stop();
+	    if(invParam.PrintLevel>0)
+	      QDPIO::cout << "Evec_Refinement: time = "
+			  << snoop.getTimeInSeconds()
+			  << " secs" << std::endl;
+	  }// if there is space
+	else // call CG but ask it not to compute vectors
+	  {
+	    evec.resize(0);
+	    n_CG = res.n_count ;
+	    if(invParam.PrintLevel<2)// Call the CHROMA CG 
+	      res = InvCG2(A, chi, psi, restartTol, invParam.MaxCG);
+	    else
+	      res = InvEigCG2Env::InvEigCG2(MdagM, 
+					    psi,
+					    chi,
+					    lambda, 
+					    evec, 
+					    0, //Eigenvectors to keep
+					    invParam.Nmax,  // Max vectors to work with
+					    restartTol, // CG residual...
+					    invParam.MaxCG, // Max CG itterations
+					    invParam.PrintLevel
+					    );
+	    res.n_count += n_CG ;
+	    if(toBool(restartTol!=invParam.RsdCG)){
+	      restart++;//count the number of restarts
+	      if(invParam.PrintLevel>0)
+		QDPIO::cout<<"Restart: "<<restart<<std::endl ;
+	      flag=3 ; //restart
+	    }
+	    else{
+	      flag=0; //stop restarting
+	    }
+	    restartTol *=restartTol ;
+	    if(toBool(restartTol < invParam.RsdCG)){
+	      restartTol = invParam.RsdCG;
+	    }
+	  }
+      }//while
+
+      END_CODE();
+
+      return res;
+    }
+#endif
+
+    //! Pick the solver for the storage of the eigenvectors
+    template<typename T>
+    SystemSolverResults_t sysSolverStorage(T& psi, const T& chi, 
+					   const LinearOperator<T>& A,
+					   const LinearOperator<T>& MdagM, 
+					   const SysSolverEigCGParams& invParam)
+    {
+#ifndef QDP_IS_QDPJIT
+      if (invParam.evecStorage != "FULL")
+	return sysSolverCompressed(psi, chi, A, MdagM, invParam);
+#endif
+      return sysSolver(psi, chi, A, MdagM, invParam);
+    }
+
   } // anonymous namespace
 
 
@@ -241,7 +421,9 @@ namespace Chroma
   SystemSolverResults_t
   MdagMSysSolverQDPEigCG<LatticeFermionF>::operator()(LatticeFermionF& psi, const LatticeFermionF& chi) const
   {
-    return sysSolver(psi, chi, *A, *MdagM, invParam);
+    SystemSolverResults_t res = sysSolverStorage(psi, chi, *A, *MdagM, invParam);
+    writeCompleteEvecs();
+    return res;
   }
 
   // LatticeFermionD
@@ -249,7 +431,9 @@ namespace Chroma
   SystemSolverResults_t
   MdagMSysSolverQDPEigCG<LatticeFermionD>::operator()(LatticeFermionD& psi, const LatticeFermionD& chi) const
   {
-    return sysSolver(psi, chi, *A, *MdagM, invParam);
+    SystemSolverResults_t res = sysSolverStorage(psi, chi, *A, *MdagM, invParam);
+    writeCompleteEvecs();
+    return res;
   }
 
 #if 0
@@ -16,6 +16,8 @@
 #include "actions/ferm/invert/syssolver_mdagm.h"
 #include "actions/ferm/invert/syssolver_eigcg_params.h"
 #include "actions/ferm/invert/containers.h"
+#include "actions/ferm/invert/compressed_ritz_pairs.h"
+#include "util/info/unique_id.h"
 
 namespace Chroma
 {
@@ -42,27 +44,58 @@ namespace Chroma
      */
     MdagMSysSolverQDPEigCG(Handle< LinearOperator<T> > A_,
 			   const SysSolverEigCGParams& invParam_) : 
-      MdagM(new MdagMLinOp<T>(A_)), A(A_), invParam(invParam_) 
+      MdagM(new MdagMLinOp<T>(A_)), A(A_), invParam(invParam_), evecs_written(false)
       {
 	// NEED to grab the eignvectors from the named buffer here
 	if (! TheNamedObjMap::Instance().check(invParam.eigen_id))
 	{
-	  TheNamedObjMap::Instance().create< LinAlg::RitzPairs<T> >(invParam.eigen_id);
-	  LinAlg::RitzPairs<T>& GoodEvecs = 
-	    TheNamedObjMap::Instance().getData< LinAlg::RitzPairs<T> >(invParam.eigen_id);
+	  int N = (invParam.Neig_max > 0) ? invParam.Neig_max : invParam.Neig;
+
+	  if (invParam.evecStorage == "FULL")
+	  {
+	    TheNamedObjMap::Instance().create< LinAlg::RitzPairs<T> >(invParam.eigen_id);
+	    LinAlg::RitzPairs<T>& GoodEvecs = 
+	      TheNamedObjMap::Instance().getData< LinAlg::RitzPairs<T> >(invParam.eigen_id);
+
+	    GoodEvecs.init(N);
+	  }
+	  else
+	  {
+#ifndef QDP_IS_QDPJIT
+	    TheNamedObjMap::Instance().create< LinAlg::CompressedRitzPairs<T> >(invParam.eigen_id);
+	    LinAlg::CompressedRitzPairs<T>& GoodEvecs = 
+	      TheNamedObjMap::Instance().getData< LinAlg::CompressedRitzPairs<T> >(invParam.eigen_id);
+
+	    GoodEvecs.init(N, A->subset(), 
+			   (invParam.evecStorage == "HALF") ? LinAlg::RITZ_STORE_HALF : LinAlg::RITZ_STORE_SINGLE);
 
-	  if(invParam.Neig_max>0 ){
-	    GoodEvecs.init(invParam.Neig_max);
+	    QDPIO::cout << "MdagMSysSolverQDPEigCG: " << invParam.evecStorage << " storage of " << N 
+			<< " eigenvectors uses " << GoodEvecs.bytes() << " bytes per node" << std::endl;
+#else
+	    QDPIO::cerr << "MdagMSysSolverQDPEigCG: EvecStorage " << invParam.evecStorage << " not supported with QDP-JIT" << std::endl;
+	    QDP_abort(1);
+#endif
 	  }
-	  else{
-	    GoodEvecs.init(invParam.Neig);
+
+	  if (invParam.file.read)
+	  {
+	    QDPIO::cout << "MdagMSysSolverQDPEigCG: reading evecs from disk" << std::endl;
+	    readEvecs();
 	  }
 	}
+
+	// A space that is complete already was written by whoever completed it
+	evecs_written = spaceComplete();
       }
 
     //! Destructor is automatic
     ~MdagMSysSolverQDPEigCG()
       {
+	if (invParam.file.write && ! evecs_written)
+	{
+	  QDPIO::cout << "MdagMSysSolverQDPEigCG: writing evecs to disk" << std::endl;
+	  writeEvecs();
+	}
 	if (invParam.cleanUpEvecs)
 	{
 	  TheNamedObjMap::Instance().erase(invParam.eigen_id);
@@ -116,9 +149,172 @@ namespace Chroma
     // Hide default constructor
     MdagMSysSolverQDPEigCG() {}
 
+    //! Has the space reached its maximum size?
+    bool spaceComplete() const
+    {
+      if (invParam.evecStorage == "FULL")
+      {
+	const LinAlg::RitzPairs<T>& GoodEvecs = 
+	  TheNamedObjMap::Instance().getData< LinAlg::RitzPairs<T> >(invParam.eigen_id);
+	return GoodEvecs.Neig >= GoodEvecs.evec.vec.size();
+      }
+#ifndef QDP_IS_QDPJIT
+      const LinAlg::CompressedRitzPairs<T>& GoodEvecs = 
+	TheNamedObjMap::Instance().getData< LinAlg::CompressedRitzPairs<T> >(invParam.eigen_id);
+      return GoodEvecs.Neig >= GoodEvecs.size();
+#else
+      return false;
+#endif
+    }
+
+    //! Write the space once, as soon as it is complete
+    /*! Otherwise it is written when the solver goes */
+    void writeCompleteEvecs() const
+    {
+      if (invParam.file.write && ! evecs_written && spaceComplete())
+      {
+	QDPIO::cout << "MdagMSysSolverQDPEigCG: space complete, writing evecs to disk" << std::endl;
+	writeEvecs();
+	evecs_written = true;
+      }
+    }
+
+    //! Write the eigenpairs to  file.file_name
+    /*! Reduced precision spaces are written in single precision */
+    void writeEvecs() const
+    {
+      StopWatch swatch;
+      swatch.reset();
+      swatch.start();
+
+      const bool full = (invParam.evecStorage == "FULL");
+      multi1d<Double> eval;
+      int Neig;
+
+      if (full)
+      {
+	const LinAlg::RitzPairs<T>& GoodEvecs = 
+	  TheNamedObjMap::Instance().getData< LinAlg::RitzPairs<T> >(invParam.eigen_id);
+	Neig = GoodEvecs.Neig;
+	eval.resize(Neig);
+	for(int v=0; v < Neig; ++v)
+	  eval[v] = GoodEvecs.eval[v];
+      }
+      else
+      {
+#ifndef QDP_IS_QDPJIT
+	const LinAlg::CompressedRitzPairs<T>& GoodEvecs = 
+	  TheNamedObjMap::Instance().getData< LinAlg::CompressedRitzPairs<T> >(invParam.eigen_id);
+	Neig = GoodEvecs.Neig;
+	eval.resize(Neig);
+	for(int v=0; v < Neig; ++v)
+	  eval[v] = GoodEvecs.eval[v];
+#endif
+      }
+
+      XMLBufferWriter file_xml;
+      push(file_xml, "RitzPairs");
+      write(file_xml, "id", uniqueId());
+      write(file_xml, "Neig", Neig);
+      write(file_xml, "EvecStorage", invParam.evecStorage);
+      write(file_xml, "eval", eval);
+      pop(file_xml);
+
+      QDPFileWriter to(file_xml, invParam.file.file_name, invParam.file.file_volfmt, 
+		       QDPIO_SERIAL, QDPIO_OPEN);
+
+      for(int v=0; v < Neig; ++v)
+      {
+	XMLBufferWriter record_xml;
+	push(record_xml, "EigenVector");
+	write(record_xml, "no", v);
+	pop(record_xml);
+
+	if (full)
+	{
+	  const LinAlg::RitzPairs<T>& GoodEvecs = 
+	    TheNamedObjMap::Instance().getData< LinAlg::RitzPairs<T> >(invParam.eigen_id);
+	  write(to, record_xml, GoodEvecs.evec.vec[v]);
+	}
+	else
+	{
+#ifndef QDP_IS_QDPJIT
+	  const LinAlg::CompressedRitzPairs<T>& GoodEvecs = 
+	    TheNamedObjMap::Instance().getData< LinAlg::CompressedRitzPairs<T> >(invParam.eigen_id);
+	  T tmp;
+	  GoodEvecs.expand(tmp, v);
+	  LatticeFermionF lf = tmp;
+	  write(to, record_xml, lf);
+#endif
+	}
+      }
+
+      close(to);
+
+      swatch.stop();
+      QDPIO::cout << "MdagMSysSolverQDPEigCG: time to write " << Neig << " evecs = "
+		  << swatch.getTimeInSeconds() << " secs" << std::endl;
+    }
+
+    //! Add the eigenpairs in  file.file_name  to the space
+    /*! The file may hold any storage; vectors that do not fit are dropped */
+    void readEvecs() const
+    {
+      StopWatch swatch;
+      swatch.reset();
+      swatch.start();
+
+      XMLReader file_xml;
+      QDPFileReader from(file_xml, invParam.file.file_name, QDPIO_SERIAL);
+
+      int Neig;
+      std::string storage;
+      multi1d<Double> eval;
+      read(file_xml, "/RitzPairs/Neig", Neig);
+      read(file_xml, "/RitzPairs/EvecStorage", storage);
+      read(file_xml, "/RitzPairs/eval", eval);
+
+      for(int v=0; v < Neig; ++v)
+      {
+	XMLReader record_xml;
+	T vec;
+
+	if (storage == "FULL")
+	  read(from, record_xml, vec);
+	else
+	{
+	  LatticeFermionF lf;
+	  read(from, record_xml, lf);
+	  vec = lf;
+	}
+
+	if (invParam.evecStorage == "FULL")
+	{
+	  LinAlg::RitzPairs<T>& GoodEvecs = 
+	    TheNamedObjMap::Instance().getData< LinAlg::RitzPairs<T> >(invParam.eigen_id);
+	  GoodEvecs.AddVector(eval[v], vec, A->subset());
+	}
+	else
+	{
+#ifndef QDP_IS_QDPJIT
+	  LinAlg::CompressedRitzPairs<T>& GoodEvecs = 
+	    TheNamedObjMap::Instance().getData< LinAlg::CompressedRitzPairs<T> >(invParam.eigen_id);
+	  GoodEvecs.AddVector(eval[v], vec);
+#endif
+	}
+      }
+
+      close(from);
+
+      swatch.stop();
+      QDPIO::cout << "MdagMSysSolverQDPEigCG: time to read " << Neig << " evecs = "
+		  << swatch.getTimeInSeconds() << " secs" << std::endl;
+    }
+
     Handle< LinearOperator<T> > MdagM;
     Handle< LinearOperator<T> > A;
     SysSolverEigCGParams invParam;
+    mutable bool evecs_written;
   };
 
 } // End namespace
@@ -0,0 +1,51 @@
+/*! \file
+ *  \brief Solve a MdagM*psi=chi linear system deflated with precomputed low modes
+ */
+
+#include "actions/ferm/invert/syssolver_mdagm_factory.h"
+#include "actions/ferm/invert/syssolver_mdagm_aggregate.h"
+#include "actions/ferm/invert/syssolver_mdagm_lowmode_deflated.h"
+
+namespace Chroma
+{
+
+  //! Low mode deflated system solver namespace
+  namespace MdagMSysSolverLowModeDeflatedEnv
+  {
+    //! Anonymous namespace
+    namespace
+    {
+      //! Name to be used
+      const std::string name("LOWMODE_DEFLATED_INVERTER");
+
+      //! Local registration flag
+      bool registered = false;
+    }
+
+
+#ifndef QDP_IS_QDPJIT
+    //! Callback function
+    MdagMSystemSolver<LatticeFermion>* createFerm(XMLReader& xml_in,
+						  const std::string& path,
+						  Handle< FermState< LatticeFermion, multi1d<LatticeColorMatrix>, multi1d<LatticeColorMatrix> > > state,
+						  Handle< LinearOperator<LatticeFermion> > A)
+    {
+      return new MdagMSysSolverLowModeDeflated<LatticeFermion>(A, state, SysSolverLowModeDeflatedParams(xml_in, path));
+    }
+#endif
+
+    //! Register all the factories
+    bool registerAll() 
+    {
+      bool success = true; 
+      if (! registered)
+      {
+#ifndef QDP_IS_QDPJIT
+	success &= Chroma::TheMdagMFermSystemSolverFactory::Instance().registerObject(name, createFerm);
+#endif
+	registered = true;
+      }
+      return success;
+    }
+  }
+}
@@ -0,0 +1,176 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Solve a MdagM*psi=chi linear system deflated with precomputed low modes
+ */
+
+#ifndef __syssolver_mdagm_lowmode_deflated_h__
+#define __syssolver_mdagm_lowmode_deflated_h__
+#include "chroma_config.h"
+
+#include "handle.h"
+#include "state.h"
+#include "syssolver.h"
+#include "linearop.h"
+#include "lmdagm.h"
+#include "actions/ferm/invert/syssolver_mdagm.h"
+#include "actions/ferm/invert/syssolver_mdagm_factory.h"
+#include "actions/ferm/invert/syssolver_lowmode_deflated_params.h"
+#include "actions/ferm/invert/lowmode_deflation.h"
+
+#include <string>
+
+
+namespace Chroma
+{
+
+  //! Low mode deflated system solver namespace
+  namespace MdagMSysSolverLowModeDeflatedEnv
+  {
+    //! Register the syssolver
+    bool registerAll();
+  }
+
+
+#ifndef QDP_IS_QDPJIT
+  //! Solve a MdagM*psi=chi linear system deflated with precomputed low modes
+  /*! \ingroup invert
+   *
+   * The guess is projected once with the Ritz pairs of M^dag M in EigenId,
+   * then SubInvParam is run. While the residual is above RsdTarget the
+   * low mode part of the residual is put in as a block and SubInvParam is
+   * restarted, at most MaxRestarts times.
+   */
+  template<typename T>
+  class MdagMSysSolverLowModeDeflated : public MdagMSystemSolver<T>
+  {
+  public:
+    typedef LatticeColorMatrix U;
+    typedef multi1d<LatticeColorMatrix> Q;
+
+    //! Constructor
+    /*!
+     * \param A_        Linear operator ( Read )
+     * \param state_    fermion state ( Read )
+     * \param invParam  inverter parameters ( Read )
+     */
+    MdagMSysSolverLowModeDeflated(Handle< LinearOperator<T> > A_,
+				  Handle< FermState<T,Q,Q> > state_,
+				  const SysSolverLowModeDeflatedParams& invParam_) :
+      A(A_), MdagM(new MdagMLinOp<T>(A_)), invParam(invParam_),
+      deflation(invParam_.eigen_id, invParam_.Neig, A_->subset(),
+		invParam_.evec_file, invParam_.evecStorage)
+      {
+	std::istringstream is(invParam.SubInvParam.xml);
+	XMLReader sub_xml(is);
+	sub_solver = TheMdagMFermSystemSolverFactory::Instance().createObject(invParam.SubInvParam.id,
+									      sub_xml,
+									      invParam.SubInvParam.path,
+									      state_,
+									      A);
+      }
+
+    //! Destructor
+    ~MdagMSysSolverLowModeDeflated()
+      {
+	if (invParam.cleanUpEvecs)
+	  TheNamedObjMap::Instance().erase(invParam.eigen_id);
+      }
+
+    //! Return the subset on which the operator acts
+    const Subset& subset() const {return A->subset();}
+
+    //! Solver the linear system
+    /*!
+     * \param psi      solution ( Modify )
+     * \param chi      source ( Read )
+     * \return syssolver results
+     */
+    SystemSolverResults_t operator() (T& psi, const T& chi) const
+      {
+	START_CODE();
+	StopWatch swatch;
+	swatch.reset(); swatch.start();
+
+	const Subset& s = A->subset();
+	const Double chi_norm = sqrt(norm2(chi,s));
+	T r;
+
+	// Project the guess
+	(*MdagM)(r, psi, PLUS);
+	r[s] = chi - r;
+	deflation.correct(psi, r);
+
+	SystemSolverResults_t res = (*sub_solver)(psi, chi);
+
+	int restarts = 0;
+	for(; restarts < invParam.MaxRestarts; ++restarts)
+	{
+	  (*MdagM)(r, psi, PLUS);
+	  r[s] = chi - r;
+	  if (toBool(sqrt(norm2(r,s)) <= invParam.RsdTarget*chi_norm))
+	    break;
+
+	  // Low modes of the residual before the restart
+	  deflation.correct(psi, r);
+
+	  int n_count = res.n_count;
+	  res = (*sub_solver)(psi, chi);
+	  res.n_count += n_count;
+	}
+
+	{ // Find true residuum
+	  (*MdagM)(r, psi, PLUS);
+	  r[s] -= chi;
+	  res.resid = sqrt(norm2(r,s));
+	}
+
+	swatch.stop();
+	QDPIO::cout << "LOWMODE_DEFLATED_SOLVER: " << res.n_count
+		    << " iterations in " << restarts+1 << " cycles. Rsd = " << res.resid
+		    << " Relative Rsd = " << res.resid/chi_norm << std::endl;
+
+	double time = swatch.getTimeInSeconds();
+	QDPIO::cout << "LOWMODE_DEFLATED_SOLVER_TIME: "<<time<< " sec" << std::endl;
+
+	END_CODE();
+
+	return res;
+      }
+
+
+    //! Solve the linear system starting with a chrono guess 
+    /*! 
+     * \param psi solution (Write)
+     * \param chi source   (Read)
+     * \param predictor   a chronological predictor (Read)
+     * \return syssolver results
+     */
+    SystemSolverResults_t operator()(T& psi, const T& chi, 
+				     AbsChronologicalPredictor4D<T>& predictor) const 
+    {
+      START_CODE();
+
+      predictor(psi, (*MdagM), chi);
+
+      SystemSolverResults_t res=(*this)(psi,chi);
+
+      predictor.newVector(psi);
+      END_CODE();
+      return res;
+    }
+
+  private:
+    // Hide default constructor
+    MdagMSysSolverLowModeDeflated();
+
+    Handle< LinearOperator<T> > A;
+    Handle< LinearOperator<T> > MdagM;
+    SysSolverLowModeDeflatedParams invParam;
+    LowModeDeflation<T> deflation;
+    Handle< MdagMSystemSolver<T> > sub_solver;
+  };
+#endif
+
+} // End namespace
+
+#endif
@@ -0,0 +1,58 @@
+/*! \file
+ *  \brief Params of the Schwarz alternating procedure preconditioner for clover
+ */
+
+#include "actions/ferm/invert/syssolver_sap_clover_params.h"
+
+namespace Chroma
+{
+
+  // Read parameters
+  void read(XMLReader& xml, const std::string& path, SysSolverSAPCloverParams& param)
+  {
+    XMLReader paramtop(xml, path);
+
+    param.clovParamsP = (paramtop.count("CloverParams") != 0);
+    if (param.clovParamsP)
+      read(paramtop, "CloverParams", param.clovParams);
+
+    read(paramtop, "Blocking", param.Blocking);
+
+    if (paramtop.count("NumCycles") != 0)
+      read(paramtop, "NumCycles", param.NumCycles);
+
+    if (paramtop.count("BlockMRIter") != 0)
+      read(paramtop, "BlockMRIter", param.BlockMRIter);
+  }
+
+  // Writer parameters
+  void write(XMLWriter& xml, const std::string& path, const SysSolverSAPCloverParams& param)
+  {
+    push(xml, path);
+
+    write(xml, "invType", "SAP_CLOVER_PRECONDITIONER");
+    if (param.clovParamsP)
+      write(xml, "CloverParams", param.clovParams);
+    write(xml, "Blocking", param.Blocking);
+    write(xml, "NumCycles", param.NumCycles);
+    write(xml, "BlockMRIter", param.BlockMRIter);
+
+    pop(xml);
+  }
+
+  //! Default constructor
+  SysSolverSAPCloverParams::SysSolverSAPCloverParams()
+  {
+    clovParamsP = false;
+    NumCycles = 4;
+    BlockMRIter = 4;
+  }
+
+  //! Read parameters
+  SysSolverSAPCloverParams::SysSolverSAPCloverParams(XMLReader& xml, const std::string& path)
+  {
+    *this = SysSolverSAPCloverParams();
+    read(xml, path, *this);
+  }
+
+}
@@ -0,0 +1,40 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Params of the Schwarz alternating procedure preconditioner for clover
+ */
+
+#ifndef __syssolver_sap_clover_params_h__
+#define __syssolver_sap_clover_params_h__
+
+#include "chromabase.h"
+#include "actions/ferm/fermacts/clover_fermact_params_w.h"
+
+
+namespace Chroma
+{
+
+  //! Params for the SAP preconditioner of the even-odd clover operator
+  /*! \ingroup invert */
+  struct SysSolverSAPCloverParams
+  {
+    SysSolverSAPCloverParams();
+    SysSolverSAPCloverParams(XMLReader& in, const std::string& path);
+
+    bool                 clovParamsP;   /*!< Were clover params given? */
+    CloverFermActParams  clovParams;    /*!< Optional, checked against the operator */
+    multi1d<int>         Blocking;      /*!< Block extents, even and dividing the node sub-lattice */
+    int                  NumCycles;     /*!< SAP cycles, each over both block colours */
+    int                  BlockMRIter;   /*!< MR iterations of each block solve */
+  };
+
+
+  // Reader/writers
+  /*! \ingroup invert */
+  void read(XMLReader& xml, const std::string& path, SysSolverSAPCloverParams& param);
+
+  /*! \ingroup invert */
+  void write(XMLWriter& xml, const std::string& path, const SysSolverSAPCloverParams& param);
+
+} // End namespace
+
+#endif
@@ -0,0 +1,174 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Chebyshev polynomial approximation to the inverse of a hermitian operator
+ */
+
+#ifndef __cheby_prec_op_h__
+#define __cheby_prec_op_h__
+
+#include "chromabase.h"
+#include "handle.h"
+#include "linearop.h"
+
+#include <vector>
+
+namespace Chroma
+{
+
+#ifndef QDP_IS_QDPJIT
+  /*! Hide the site loops for the thread dispatcher in here */
+  namespace ChebyPrecOpEnv
+  {
+    template<typename T>
+    struct Args
+    {
+      T*             x;
+      T*             r;
+      T*             d;
+      const T*       ad;
+      REAL64         c1;
+      REAL64         c2;
+      const int*     site_table;
+    };
+
+    //! x += d,  r -= A d,  d = c1 d + c2 r  over the sites [lo,hi)
+    template<typename T>
+    inline
+    void stepSiteLoop(int lo, int hi, int myId, Args<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+      const int nr = sizeof(a->x->elem(0)) / sizeof(W);
+
+      const REAL64 c1 = a->c1;
+      const REAL64 c2 = a->c2;
+
+      for(int j=lo; j < hi; ++j)
+      {
+	int site = a->site_table[j];
+	W* x = (W*)&(a->x->elem(site));
+	W* r = (W*)&(a->r->elem(site));
+	W* d = (W*)&(a->d->elem(site));
+	const W* ad = (const W*)&(a->ad->elem(site));
+
+	for(int i=0; i < nr; ++i)
+	{
+	  const W ri = (W)(r[i] - ad[i]);
+	  x[i] += d[i];
+	  r[i]  = ri;
+	  d[i]  = (W)(c1*d[i] + c2*ri);
+	}
+      }
+    }
+  }
+#endif
+
+
+  //! Chebyshev polynomial approximation to the inverse of a hermitian operator
+  /*! \ingroup linop
+   *
+   * Applies p(A), the polynomial of the given degree for which
+   * 1 - x p(x) is the scaled Chebyshev polynomial that is smallest
+   * on [lmin,lmax]. This is the result of degree+1 steps of the
+   * Chebyshev semi-iteration for A x = psi from a zero guess, so it
+   * costs degree applications of A and no global reductions. Each step
+   * of the recurrence is done in one sweep over the subset.
+   *
+   * p(A) is hermitian, and positive as long as lmax is not below the
+   * largest eigenvalue of A; eigenvalues below lmin are still mapped
+   * into (0,1] by A p(A). It is fixed, so it is a valid preconditioner
+   * for CG. The sign is ignored.
+   */
+  template<typename T>
+  class ChebyPrecOp : public LinearOperator<T>
+  {
+  public:
+    //! Full constructor
+    /*!
+     * \param A_       hermitian positive operator  ( Read )
+     * \param lmin_    lower end of the interval  ( Read )
+     * \param lmax_    upper end of the interval  ( Read )
+     * \param degree_  degree of the polynomial  ( Read )
+     */
+    ChebyPrecOp(Handle< LinearOperator<T> > A_,
+		const Real& lmin_, const Real& lmax_, int degree_) :
+      A(A_), lmin(lmin_), lmax(lmax_), degree(degree_)
+      {
+	if (degree < 0 || toBool(lmin <= Real(0)) || toBool(lmax <= lmin))
+	{
+	  QDPIO::cerr << "ChebyPrecOp: need degree >= 0 and 0 < lmin < lmax, have degree = "
+		      << degree << " interval = [" << lmin << ", " << lmax << "]" << std::endl;
+	  QDP_abort(1);
+	}
+      }
+
+    //! Destructor is automatic
+    ~ChebyPrecOp() {}
+
+    //! Subset comes from underlying operator
+    const Subset& subset() const {return A->subset();}
+
+    //! chi = p(A) psi
+    void operator() (T& chi, const T& psi, enum PlusMinus isign) const
+      {
+	START_CODE();
+
+	const Subset& s = A->subset();
+
+	const REAL64 theta = 0.5*(toDouble(lmax) + toDouble(lmin));
+	const REAL64 delta = 0.5*(toDouble(lmax) - toDouble(lmin));
+	const REAL64 sigma = theta / delta;
+	REAL64 rho = 1.0 / sigma;
+
+	T r;
+	T d;
+	T ad;
+
+	chi[s] = zero;
+	r[s] = psi;
+	d[s] = Real(1.0/theta) * psi;
+
+	for(int k=0; k < degree; ++k)
+	{
+	  (*A)(ad, d, PLUS);
+
+	  const REAL64 rho_new = 1.0 / (2.0*sigma - rho);
+	  step(chi, r, d, ad, rho_new*rho, 2.0*rho_new/delta);
+	  rho = rho_new;
+	}
+
+	chi[s] += d;
+
+	END_CODE();
+      }
+
+    //! Flops of an application
+    unsigned long nFlops() const
+      {
+	return degree*(A->nFlops() + 6*Nc*Ns*(A->subset().numSiteTable())) + 2*Nc*Ns*(A->subset().numSiteTable());
+      }
+
+  private:
+    //! x += d,  r -= A d,  d = c1 d + c2 r
+    void step(T& x, T& r, T& d, const T& ad, REAL64 c1, REAL64 c2) const
+      {
+	const Subset& s = A->subset();
+
+#ifndef QDP_IS_QDPJIT
+	ChebyPrecOpEnv::Args<T> a = {&x, &r, &d, &ad, c1, c2, s.siteTable().slice()};
+	dispatch_to_threads(s.numSiteTable(), a, ChebyPrecOpEnv::stepSiteLoop<T>);
+#else
+	x[s] += d;
+	r[s] -= ad;
+	d[s] = Real(c1)*d + Real(c2)*r;
+#endif
+      }
+
+    Handle< LinearOperator<T> > A;
+    Real  lmin;
+    Real  lmax;
+    int   degree;
+  };
+
+}  // end namespace Chroma
+
+#endif
@@ -0,0 +1,326 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Cache of clover field strengths and clover blocks
+ *
+ *  Several clover operators are typically built on the same links,
+ *  e.g. the monomials of a Hasenbusch split clover HMC evaluated on
+ *  the same timescale. The field strength only depends on the links,
+ *  and the per-site clover blocks and their inverses only depend on
+ *  the links, the diagonal mass and the clover coefficients, so they
+ *  are kept here and reused instead of being rebuilt for each operator.
+ */
+
+#ifndef __clover_cache_w_h__
+#define __clover_cache_w_h__
+
+#include "chromabase.h"
+#include "singleton.h"
+#include "handle.h"
+#include "meas/glue/mesfield.h"
+
+#include <list>
+
+namespace Chroma
+{
+
+  /*! \ingroup linop */
+  namespace CloverCacheEnv
+  {
+    //! Fingerprint of a set of links
+    /*!
+     * The same on all nodes, and only equal for bitwise equal links
+     * (up to hash collisions)
+     */
+    struct LinkKey
+    {
+      double  lo;
+      double  hi;
+
+      bool operator==(const LinkKey& k) const {return (lo == k.lo) && (hi == k.hi);}
+    };
+
+    //! Everything the clover blocks depend on
+    struct BlockKey
+    {
+      LinkKey  links;
+      double   diag_mass;
+      double   coeff[6];     /*!< clover coefficient of each mu < nu plane */
+
+      bool operator==(const BlockKey& k) const
+      {
+	if (! (links == k.links) || diag_mass != k.diag_mass)
+	  return false;
+	for(int i=0; i < 6; ++i)
+	  if (coeff[i] != k.coeff[i])
+	    return false;
+	return true;
+      }
+    };
+
+    template<typename U>
+    struct FingerprintArgs
+    {
+      const multi1d<U>&  u;
+      int                 node;      /*!< this node, part of the site position */
+      unsigned long long* partial;   /*!< one per thread */
+    };
+
+    //! Hash each site separately and sum, so the result does not depend on the threading
+    /*!
+     * Each site is seeded with its node and local index, so links that
+     * are translated by a node sub-lattice give a different sum
+     */
+    template<typename U>
+    inline
+    void fingerprintSiteLoop(int lo, int hi, int myId, FingerprintArgs<U>* a)
+    {
+      const int nwords = sizeof(a->u[0].elem(0)) / sizeof(unsigned int);
+      unsigned long long acc = 0;
+
+      for(int site=lo; site < hi; ++site)
+      {
+	unsigned long long h = 14695981039346656037ULL;
+	h ^= (unsigned long long)a->node;
+	h *= 1099511628211ULL;
+	h ^= (unsigned long long)site;
+	h *= 1099511628211ULL;
+
+	for(int mu=0; mu < a->u.size(); ++mu)
+	{
+	  const unsigned int* w = (const unsigned int*)&(a->u[mu].elem(site));
+	  for(int i=0; i < nwords; ++i)
+	  {
+	    h ^= w[i];
+	    h *= 1099511628211ULL;
+	  }
+	}
+
+	// Final mix so that neighbouring sites do not cancel in the sum
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+
+	acc += h;
+      }
+
+      a->partial[myId] += acc;
+    }
+
+    //! Compute the fingerprint of a set of links
+    template<typename U>
+    LinkKey linkFingerprint(const multi1d<U>& u)
+    {
+      const int nthreads = qdpNumThreads();
+      std::vector<unsigned long long> partial(nthreads, 0);
+
+      FingerprintArgs<U> arg = {u, Layout::nodeNumber(), &(partial[0])};
+      dispatch_to_threads(Layout::sitesOnNode(), arg, fingerprintSiteLoop<U>);
+
+      unsigned long long h = 0;
+      for(int t=0; t < nthreads; ++t)
+	h += partial[t];
+
+      // Sum the two halves over the nodes - exact in double precision
+      double parts[2] = {(double)(h & 0xffffffffULL), (double)(h >> 32)};
+      QDPInternal::globalSumArray(parts, 2);
+
+      LinkKey key = {parts[0], parts[1]};
+      return key;
+    }
+  }
+
+
+  //! Cache of clover field strengths and clover blocks
+  /*!
+   * \ingroup linop
+   *
+   * Entries are grouped by link fingerprint. At most maxLinkSets() sets of
+   * links are held, and at most maxBlocks() block entries per set; in both
+   * cases the least recently used one is dropped first. Each block entry
+   * also records the checkerboards on which the blocks have been inverted
+   * in place, and which of them was inverted last since the trace log is
+   * only kept for that one.
+   *
+   * The blocks are handed out and taken in by handle, so they are shared
+   * and not copied. They must not be written through a handle the cache
+   * also holds.
+   *
+   * U is the color matrix type and B the per-site block type.
+   */
+  template<typename U, typename B>
+  class CloverTermCache
+  {
+  public:
+    typedef typename WordType<U>::Type_t REALT;
+    typedef OLattice< PScalar< PScalar< RScalar<REALT> > > > LatticeREAL;
+
+    CloverTermCache() : max_link_sets(2), max_blocks(8), access_clock(0) {}
+
+    //! Maximum number of link sets held
+    int maxLinkSets() const {return max_link_sets;}
+
+    //! Change the maximum number of link sets held
+    void setMaxLinkSets(int n)
+    {
+      max_link_sets = n;
+      trim();
+    }
+
+    //! Maximum number of block entries held per link set
+    int maxBlocks() const {return max_blocks;}
+
+    //! Change the maximum number of block entries held per link set
+    void setMaxBlocks(int n)
+    {
+      max_blocks = n;
+      for(typename std::list<LinkSet>::iterator s=sets.begin(); s != sets.end(); ++s)
+	trimBlocks(*s);
+    }
+
+    //! Drop everything
+    void clear() {sets.clear();}
+
+    //! Field strength of the links with this fingerprint
+    /*! Computed with mesField if it is not held yet */
+    const multi1d<U>& fieldStrength(const CloverCacheEnv::LinkKey& key, const multi1d<U>& u)
+    {
+      LinkSet& s = findSet(key);
+
+      if (! s.have_f)
+      {
+	mesField(s.f, u);
+	s.have_f = true;
+      }
+
+      return s.f;
+    }
+
+    //! Look for the blocks with the given inversion state
+    /*!
+     * \param tri         shared per-site blocks                (Write)
+     * \param tr_log_diag trace log of the last inverted cb     (Write)
+     * \param key         what the blocks depend on             (Read)
+     * \param inverted    mask of inverted checkerboards        (Read)
+     * \param last_cb     last inverted checkerboard, or -1     (Read)
+     *
+     * \return true if found
+     */
+    bool findBlocks(Handle< multi1d<B> >& tri, LatticeREAL& tr_log_diag,
+		    const CloverCacheEnv::BlockKey& key, int inverted, int last_cb)
+    {
+      LinkSet& s = findSet(key.links);
+
+      for(typename std::list<BlockEntry>::iterator b=s.blocks.begin(); b != s.blocks.end(); ++b)
+      {
+	if (b->key == key && b->inverted == inverted && b->last_cb == last_cb)
+	{
+	  b->last_access = access_clock;
+	  tri = b->tri;
+	  tr_log_diag = b->tr_log_diag;
+	  return true;
+	}
+      }
+
+      return false;
+    }
+
+    //! Keep the blocks in the given inversion state
+    /*! The blocks are shared, not copied, so the caller must not change them afterwards */
+    void storeBlocks(const Handle< multi1d<B> >& tri, const LatticeREAL& tr_log_diag,
+		     const CloverCacheEnv::BlockKey& key, int inverted, int last_cb)
+    {
+      LinkSet& s = findSet(key.links);
+
+      s.blocks.push_front(BlockEntry());
+      BlockEntry& b = s.blocks.front();
+      b.key         = key;
+      b.inverted    = inverted;
+      b.last_cb     = last_cb;
+      b.last_access = access_clock;
+      b.tri         = tri;
+      b.tr_log_diag = tr_log_diag;
+
+      trimBlocks(s);
+    }
+
+  private:
+    struct BlockEntry
+    {
+      CloverCacheEnv::BlockKey  key;
+      int                       inverted;
+      int                       last_cb;
+      unsigned long             last_access;
+      Handle< multi1d<B> >      tri;
+      LatticeREAL               tr_log_diag;
+    };
+
+    struct LinkSet
+    {
+      CloverCacheEnv::LinkKey   key;
+      unsigned long             last_access;
+      bool                      have_f;
+      multi1d<U>                f;
+      std::list<BlockEntry>     blocks;
+    };
+
+    //! Find or make the set for these links
+    LinkSet& findSet(const CloverCacheEnv::LinkKey& key)
+    {
+      ++access_clock;
+
+      for(typename std::list<LinkSet>::iterator s=sets.begin(); s != sets.end(); ++s)
+      {
+	if (s->key == key)
+	{
+	  s->last_access = access_clock;
+	  return *s;
+	}
+      }
+
+      sets.push_front(LinkSet());
+      LinkSet& s = sets.front();
+      s.key         = key;
+      s.last_access = access_clock;
+      s.have_f      = false;
+
+      trim();
+      return sets.front();
+    }
+
+    //! Drop the least recently used sets beyond the limit, but never the newest
+    void trim()
+    {
+      while (sets.size() > 1 && sets.size() > (size_t)max_link_sets)
+      {
+	typename std::list<LinkSet>::iterator oldest = sets.begin();
+	for(typename std::list<LinkSet>::iterator s=sets.begin(); s != sets.end(); ++s)
+	  if (s->last_access < oldest->last_access)
+	    oldest = s;
+
+	sets.erase(oldest);
+      }
+    }
+
+    //! Drop the least recently used block entries beyond the limit, but never the newest
+    void trimBlocks(LinkSet& s)
+    {
+      while (s.blocks.size() > 1 && s.blocks.size() > (size_t)max_blocks)
+      {
+	typename std::list<BlockEntry>::iterator oldest = s.blocks.begin();
+	for(typename std::list<BlockEntry>::iterator b=s.blocks.begin(); b != s.blocks.end(); ++b)
+	  if (b->last_access < oldest->last_access)
+	    oldest = b;
+
+	s.blocks.erase(oldest);
+      }
+    }
+
+    int                  max_link_sets;
+    int                  max_blocks;
+    unsigned long        access_clock;
+    std::list<LinkSet>   sets;
+  };
+
+}  // end namespace Chroma
+
+#endif
@@ -0,0 +1,295 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Batched LDL^dag inversion of the chiral blocks of the clover term
+ *
+ *  Shared by the host clover term implementations. Each block is a
+ *  hermitian 2Nc x 2Nc matrix held as its real diagonal and its strictly
+ *  lower triangle, row by row, as interleaved (re,im) pairs:
+ *
+ *      offd[ k*(k-1)/2 + l ] = A(k,l)    k > l
+ *
+ *  Blocks are factored and inverted BlockBatch at a time in double
+ *  precision, in a structure of arrays layout where every inner loop runs
+ *  over the blocks of the batch so the compiler can vectorise it. The
+ *  inverse overwrites the block and the log of the modulus of the
+ *  determinant comes out of the same pass, with one log per block.
+ */
+
+#ifndef __clover_ldl_w_h__
+#define __clover_ldl_w_h__
+
+#include "chromabase.h"
+#include <cmath>
+
+namespace Chroma
+{
+
+  /*! \ingroup linop */
+  namespace CloverLDLEnv
+  {
+    //! Number of blocks treated together
+    enum {BlockBatch = 8};
+
+    //! Invert n <= BlockBatch blocks in place
+    /*!
+     * \param n       number of blocks                              (Read)
+     * \param diag    per block, its 2Nc real diagonal entries      (Modify)
+     * \param offd    per block, its strictly lower triangle        (Modify)
+     * \param logdet  per block, log |det A|                        (Write)
+     * \param nneg    per block, number of negative pivots          (Write)
+     *
+     * Algorithm 4.1.2 LDL^dag Decomposition of Golub and van Loan,
+     * 3rd ed, page 139, followed by forward and back substitution for
+     * each column of the inverse.
+     */
+    template<typename R>
+    inline
+    void invertBlocks(int n, R* const diag[], R* const offd[],
+		      double logdet[], int nneg[])
+    {
+      const int N  = 2*Nc;
+      const int NO = N*(N-1)/2;
+      const int B  = BlockBatch;
+
+      double d[N][B];
+      double g[N][B];
+      double are[NO][B];
+      double aim[NO][B];
+      double vre[N][B];
+      double vim[N][B];
+
+      // Unused lanes hold the identity and drop out at the end
+      for(int b=0; b < B; ++b)
+      {
+	for(int i=0; i < N; ++i)
+	  d[i][b] = (b < n) ? (double)diag[b][i] : 1.0;
+
+	for(int i=0; i < NO; ++i)
+	{
+	  are[i][b] = (b < n) ? (double)offd[b][2*i]   : 0.0;
+	  aim[i][b] = (b < n) ? (double)offd[b][2*i+1] : 0.0;
+	}
+      }
+
+      //
+      // Factor  A = L D L^dag,  L with unit diagonal overwrites the lower triangle
+      //
+      for(int j=0; j < N; ++j)
+      {
+	// v(i) = D(i) conj(L(j,i))
+	for(int i=0; i < j; ++i)
+	{
+	  const int ji = j*(j-1)/2 + i;
+	  for(int b=0; b < B; ++b)
+	  {
+	    vre[i][b] =  d[i][b]*are[ji][b];
+	    vim[i][b] = -d[i][b]*aim[ji][b];
+	  }
+	}
+
+	// D(j) = A(j,j) - sum_k L(j,k) v(k),  which is real
+	for(int k=0; k < j; ++k)
+	{
+	  const int jk = j*(j-1)/2 + k;
+	  for(int b=0; b < B; ++b)
+	    d[j][b] -= are[jk][b]*vre[k][b] - aim[jk][b]*vim[k][b];
+	}
+
+	for(int b=0; b < B; ++b)
+	  g[j][b] = 1.0 / d[j][b];
+
+	// L(k,j) = ( A(k,j) - sum_l L(k,l) v(l) ) / D(j)
+	for(int k=j+1; k < N; ++k)
+	{
+	  const int kj = k*(k-1)/2 + j;
+
+	  for(int l=0; l < j; ++l)
+	  {
+	    const int kl = k*(k-1)/2 + l;
+	    for(int b=0; b < B; ++b)
+	    {
+	      are[kj][b] -= are[kl][b]*vre[l][b] - aim[kl][b]*vim[l][b];
+	      aim[kj][b] -= are[kl][b]*vim[l][b] + aim[kl][b]*vre[l][b];
+	    }
+	  }
+
+	  for(int b=0; b < B; ++b)
+	  {
+	    are[kj][b] *= g[j][b];
+	    aim[kj][b] *= g[j][b];
+	  }
+	}
+      }
+
+      // log |det A| = log prod_i |D(i)| - one log per block
+      {
+	double p[B];
+	int    neg[B];
+	for(int b=0; b < B; ++b)
+	{
+	  p[b] = 1.0;
+	  neg[b] = 0;
+	}
+
+	for(int i=0; i < N; ++i)
+	  for(int b=0; b < B; ++b)
+	  {
+	    p[b] *= std::fabs(d[i][b]);
+	    neg[b] += (d[i][b] < 0.0) ? 1 : 0;
+	  }
+
+	for(int b=0; b < n; ++b)
+	{
+	  logdet[b] = std::log(p[b]);
+	  nneg[b]   = neg[b];
+	}
+      }
+
+      //
+      // Invert column by column:  L D X = e_k  forwards, then  L^dag x = X  backwards.
+      // Column k of the inverse only overwrites entries no later column reads.
+      //
+      for(int k=0; k < N; ++k)
+      {
+	for(int b=0; b < B; ++b)
+	{
+	  vre[k][b] = g[k][b];
+	  vim[k][b] = 0.0;
+	}
+
+	// Forward substitution
+	for(int i=k+1; i < N; ++i)
+	{
+	  for(int b=0; b < B; ++b)
+	  {
+	    vre[i][b] = 0.0;
+	    vim[i][b] = 0.0;
+	  }
+
+	  for(int j=k; j < i; ++j)
+	  {
+	    const int ij = i*(i-1)/2 + j;
+	    for(int b=0; b < B; ++b)
+	    {
+	      const double tr = d[j][b]*vre[j][b];
+	      const double ti = d[j][b]*vim[j][b];
+	      vre[i][b] -= are[ij][b]*tr - aim[ij][b]*ti;
+	      vim[i][b] -= are[ij][b]*ti + aim[ij][b]*tr;
+	    }
+	  }
+
+	  for(int b=0; b < B; ++b)
+	  {
+	    vre[i][b] *= g[i][b];
+	    vim[i][b] *= g[i][b];
+	  }
+	}
+
+	// Backward substitution with L^dag
+	for(int i=N-2; i >= k; --i)
+	{
+	  for(int j=i+1; j < N; ++j)
+	  {
+	    const int ji = j*(j-1)/2 + i;
+	    for(int b=0; b < B; ++b)
+	    {
+	      vre[i][b] -= are[ji][b]*vre[j][b] + aim[ji][b]*vim[j][b];
+	      vim[i][b] -= are[ji][b]*vim[j][b] - aim[ji][b]*vre[j][b];
+	    }
+	  }
+	}
+
+	// Overwrite column k
+	for(int b=0; b < B; ++b)
+	  d[k][b] = vre[k][b];
+
+	for(int i=k+1; i < N; ++i)
+	{
+	  const int ik = i*(i-1)/2 + k;
+	  for(int b=0; b < B; ++b)
+	  {
+	    are[ik][b] = vre[i][b];
+	    aim[ik][b] = vim[i][b];
+	  }
+	}
+      }
+
+      for(int b=0; b < n; ++b)
+      {
+	for(int i=0; i < N; ++i)
+	  diag[b][i] = (R)d[i][b];
+
+	for(int i=0; i < NO; ++i)
+	{
+	  offd[b][2*i]   = (R)are[i][b];
+	  offd[b][2*i+1] = (R)aim[i][b];
+	}
+      }
+    }
+
+
+    //! Invert both blocks of the sites  site_table[lo], ..., site_table[hi-1]
+    /*!
+     * The accessor A provides
+     *
+     *   R*   diag(int site, int block)
+     *   R*   offd(int site, int block)
+     *   void setLogDet(int site, double logdet)
+     *
+     * \return the sum of log |det| over the sites
+     */
+    template<typename R, typename A>
+    inline
+    double invertSites(A& acc, const int* site_table, int lo, int hi)
+    {
+      const int sites_per_batch = BlockBatch/2;
+
+      R*     diag[BlockBatch];
+      R*     offd[BlockBatch];
+      double logdet[BlockBatch];
+      int    nneg[BlockBatch];
+
+      double sum = 0;
+
+      for(int s0=lo; s0 < hi; s0 += sites_per_batch)
+      {
+	const int ns = (hi - s0 < sites_per_batch) ? (hi - s0) : sites_per_batch;
+
+	for(int s=0; s < ns; ++s)
+	{
+	  const int site = site_table[s0 + s];
+	  for(int block=0; block < 2; ++block)
+	  {
+	    diag[2*s+block] = acc.diag(site, block);
+	    offd[2*s+block] = acc.offd(site, block);
+	  }
+	}
+
+	invertBlocks<R>(2*ns, diag, offd, logdet, nneg);
+
+	for(int s=0; s < ns; ++s)
+	{
+	  const int site = site_table[s0 + s];
+	  const double site_logdet = logdet[2*s] + logdet[2*s+1];
+
+	  acc.setLogDet(site, site_logdet);
+	  sum += site_logdet;
+
+	  // Report if site has any negative terms. (-ve def)
+	  const int site_neg_logdet = nneg[2*s] + nneg[2*s+1];
+	  if (site_neg_logdet != 0)
+	  {
+	    std::cout << "WARNING: found " << site_neg_logdet
+		      << " negative eigenvalues in Clover DET at site: " << site << std::endl;
+	  }
+	}
+      }
+
+      return sum;
+    }
+
+  }  // end namespace CloverLDLEnv
+
+}  // end namespace Chroma
+
+#endif
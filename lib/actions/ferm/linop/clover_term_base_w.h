@@ -109,6 +109,40 @@ namespace Chroma
 		     U& ds_u_nu,
 		     const U& Lambda) const;
 
+    //! Leaf products for an insertion Lambda living on both checkerboards
+    /*!
+     * Same as deriv_loops on cb=0 plus deriv_loops on cb=1 for the
+     * corresponding halves of Lambda, but the links, corners and staples
+     * are only built once.
+     */
+    void deriv_loops_all(const int mu, const int nu,
+			 U& ds_u_mu,
+			 U& ds_u_nu,
+			 const U& Lambda) const;
+
+    //! Accumulate the insertion of  chi^dag * A' * psi  on cb
+    /*!
+     * \param lambda  one color matrix per mu < nu plane           (Modify)
+     * \param chi     left std::vector                                 (Read)
+     * \param psi     right std::vector                                (Read)
+     * \param isign   D'^dag or D'  ( MINUS | PLUS ) resp.        (Read)
+     * \param cb      Checkerboard of chi std::vector                  (Read)
+     *
+     * Insertions of any terms on the same links, on either checkerboard,
+     * can be accumulated into one lambda and turned into a force with a
+     * single derivInsertion(). lambda is resized and zeroed if needed.
+     */
+    void derivAddInsertion(multi1d<U>& lambda,
+			   const T& chi, const T& psi, 
+			   enum PlusMinus isign, int cb) const;
+
+    //! Accumulate weight times the insertion of TrLn A on cb
+    void derivTrLnAddInsertion(multi1d<U>& lambda, const Real& weight,
+			       enum PlusMinus isign, int cb) const;
+
+    //! Turn accumulated insertions into a force with one sweep over the leaves
+    void derivInsertion(multi1d<U>& ds_u, const multi1d<U>& lambda) const;
+
     //! Return flops performed by the operator()
     unsigned long nFlops() const;
 
@@ -131,6 +165,19 @@ namespace Chroma
   CloverTermBase<T,U>::nFlops() const {return 552;}
 
 
+  //! Make sure there is a zeroed insertion for each mu < nu plane
+  template<typename U>
+  inline
+  void cloverInitInsertion(multi1d<U>& lambda)
+  {
+    if (lambda.size() != Nd*(Nd-1)/2)
+    {
+      lambda.resize(Nd*(Nd-1)/2);
+      lambda = zero;
+    }
+  }
+
+
   //! Take deriv of D
   /*!
    * \param chi     left std::vector                                 (Read)
@@ -146,15 +193,12 @@ namespace Chroma
   {
     START_CODE();
 
-    // base deriv resizes.
-    // Even even checkerboard
-    deriv(ds_u, chi, psi, isign,0);
-    
-    // Odd Odd checkerboard
-    multi1d<U> ds_tmp;
-    deriv(ds_tmp, chi, psi, isign,1);
-    
-    ds_u += ds_tmp;
+    // Both checkerboards share a single sweep over the leaves
+    multi1d<U> lambda;
+    derivAddInsertion(lambda, chi, psi, isign, 0);
+    derivAddInsertion(lambda, chi, psi, isign, 1);
+
+    derivInsertion(ds_u, lambda);
     
     END_CODE();
   }
@@ -166,15 +210,14 @@ namespace Chroma
   {
     START_CODE();
 
-    // base deriv resizes.
-    // Even even checkerboard
-    derivMultipole(ds_u, chi, psi, isign,0);
-    
-    // Odd Odd checkerboard
-    multi1d<U> ds_tmp;
-    derivMultipole(ds_tmp, chi, psi, isign,1);
-    
-    ds_u += ds_tmp;
+    // All poles and both checkerboards share a single sweep over the leaves
+    multi1d<U> lambda;
+    for(int i=0; i < chi.size(); i++) { 
+      derivAddInsertion(lambda, chi[i], psi[i], isign, 0);
+      derivAddInsertion(lambda, chi[i], psi[i], isign, 1);
+    }
+
+    derivInsertion(ds_u, lambda);
     
     END_CODE();
   }
@@ -669,6 +712,165 @@ namespace Chroma
   }
 
 
+  template<typename T, typename U>
+  void CloverTermBase<T,U>::deriv_loops_all(const int mu, const int nu,
+					    U& ds_u_mu,
+					    U& ds_u_nu,
+					    const U& Lambda) const
+  {
+    START_CODE();
+
+    const multi1d<U>& u = getU();
+
+    // The terms are those of deriv_loops, numbered the same way, but
+    // evaluated on all sites: each one only picks up Lambda from the
+    // checkerboard it would have been restricted to there.
+    U u_nu_for_mu = shift(u[nu],FORWARD, mu);
+    U u_mu_for_nu = shift(u[mu],FORWARD, nu);
+    U Lambda_xplus_mu = shift(Lambda, FORWARD, mu);
+    U Lambda_xplus_nu = shift(Lambda, FORWARD, nu);
+    U Lambda_xplus_muplusnu = shift(Lambda_xplus_mu, FORWARD, nu);
+
+    U up_left_corner   = adj(u_mu_for_nu)*adj(u[nu]);
+    U up_right_corner  = u_nu_for_mu*adj(u_mu_for_nu);
+    U low_right_corner = adj(u_nu_for_mu)*adj(u[mu]);
+    U low_left_corner  = adj(u[mu])*u[nu];
+
+    U staple_for   = u_nu_for_mu*up_left_corner;
+    U staple_right = up_left_corner*u[mu];
+    U staple_left  = u_mu_for_nu*low_right_corner;
+    U staple_back  = adj(u_nu_for_mu)*low_left_corner;
+
+    U u_tmp3;
+    U ds_tmp_mu;
+    U ds_tmp_nu;
+
+    // 1) and 2) non staple terms
+    u_tmp3 = u_nu_for_mu*Lambda_xplus_muplusnu;
+    ds_u_mu = u_tmp3*up_left_corner;
+
+    u_tmp3 = Lambda_xplus_nu*adj(u[nu]);
+    ds_u_mu += up_right_corner*u_tmp3;
+
+    u_tmp3 = adj(u_mu_for_nu)*Lambda_xplus_nu;
+    ds_tmp_nu = u_tmp3*adj(low_left_corner);
+
+    u_tmp3 = up_left_corner*Lambda;
+    ds_tmp_nu += u_tmp3*u[mu];
+
+    // 3) and 4) non staple terms
+    u_tmp3 = adj(u_nu_for_mu)*Lambda_xplus_mu;
+    ds_tmp_mu = u_tmp3*low_left_corner;
+
+    u_tmp3 = low_right_corner*Lambda;
+    ds_tmp_mu += u_tmp3*u[nu];
+
+    u_tmp3 = adj(up_right_corner)*Lambda_xplus_mu;
+    ds_u_nu = u_tmp3*adj(u[mu]);
+
+    u_tmp3 = u_mu_for_nu*Lambda_xplus_muplusnu;
+    ds_u_nu += u_tmp3*low_right_corner;
+
+    // 5) - 8) staple terms
+    ds_u_mu   += staple_for*Lambda;
+    ds_u_mu   += Lambda_xplus_mu*staple_for;
+    ds_tmp_nu += staple_right*Lambda_xplus_mu;
+    ds_tmp_nu += Lambda_xplus_muplusnu*staple_right;
+    ds_tmp_mu += staple_back*Lambda_xplus_nu;
+    ds_tmp_mu += Lambda_xplus_muplusnu*staple_back;
+    ds_u_nu   += staple_left*Lambda;
+    ds_u_nu   += Lambda_xplus_nu*staple_left;
+
+    // Now shift the accumulated pieces to mu and nu
+    ds_u_mu -= shift(ds_tmp_mu, BACKWARD, nu);
+    ds_u_nu -= shift(ds_tmp_nu, BACKWARD, mu); 
+
+    END_CODE();
+  }
+
+
+  template<typename T, typename U>
+  void CloverTermBase<T,U>::derivAddInsertion(multi1d<U>& lambda,
+					      const T& chi, const T& psi, 
+					      enum PlusMinus isign, int cb) const
+  {
+    START_CODE();
+
+    cloverInitInsertion(lambda);
+
+    for(int mu=0, p=0; mu < Nd; mu++) {
+      for(int nu = mu+1; nu < Nd; nu++, p++) {
+
+	// The weight for the terms, as in deriv()
+	Real factor = (Real(-1)/Real(8))*getCloverCoeff(mu,nu);
+
+	int mu_nu_index = (1 << mu) + (1 << nu); // 2^{mu} 2^{nu}
+	lambda[p][rb[cb]] += factor * traceSpin( outerProduct(Gamma(mu_nu_index)*psi, chi));
+      }
+    }
+
+    END_CODE();
+  }
+
+
+  template<typename T, typename U>
+  void CloverTermBase<T,U>::derivTrLnAddInsertion(multi1d<U>& lambda, const Real& weight,
+						  enum PlusMinus isign, int cb) const
+  {
+    START_CODE();
+
+    cloverInitInsertion(lambda);
+
+    for(int mu=0, p=0; mu < Nd; mu++) {
+      for(int nu = mu+1; nu < Nd; nu++, p++) {
+
+	// The weight for the terms, as in derivTrLn()
+	Real factor = weight*Real(-1)*getCloverCoeff(mu,nu)/Real(8);
+
+	int mu_nu_index = (1 << mu) + (1 << nu); // 2^{mu} 2^{nu}
+
+	U sigma_XY_dag=zero;
+	triacntr(sigma_XY_dag, mu_nu_index, cb);
+	lambda[p][rb[cb]] += factor * sigma_XY_dag;
+      }
+    }
+
+    END_CODE();
+  }
+
+
+  template<typename T, typename U>
+  void CloverTermBase<T,U>::derivInsertion(multi1d<U>& ds_u, const multi1d<U>& lambda) const
+  {
+    START_CODE();
+
+    if( ds_u.size() != Nd ) { 
+      ds_u.resize(Nd);
+    }
+
+    ds_u = zero;
+
+    for(int mu=0, p=0; mu < Nd; mu++) {
+      for(int nu = mu+1; nu < Nd; nu++, p++) {
+
+	U ds_tmp_mu;
+	U ds_tmp_nu;
+
+	deriv_loops_all(mu, nu, ds_tmp_mu, ds_tmp_nu, lambda[p]);
+
+	ds_u[mu] += ds_tmp_mu;
+	// -ve weight for nu from gamma_mu gamma_nu -> gamma_nu gamma_mu
+	ds_u[nu] -= ds_tmp_nu;
+      }
+    }
+
+    // Clear out the deriv on any fixed links
+    (*this).getFermBC().zero(ds_u);
+
+    END_CODE();
+  }
+
+
   //! Take deriv of D using Trace Log
   /*!
    * \param chi     left std::vector on cb                           (Read)
@@ -9,6 +9,8 @@
 #include "state.h"
 #include "actions/ferm/fermacts/clover_fermact_params_w.h"
 #include "actions/ferm/linop/clover_term_base_w.h"
+#include "actions/ferm/linop/clover_cache_w.h"
+#include "actions/ferm/linop/clover_ldl_w.h"
 #include "meas/glue/mesfield.h"
 namespace Chroma 
 { 
@@ -106,7 +108,7 @@ namespace Chroma
 #ifdef BUILD_QPHIX
     // Access the clover tri-buffer for packing
     const multi1d<PrimitiveClovTriang<REALT> >& getTriBuffer() const {
-      return tri;
+      return *tri;
     }
 #endif
 
@@ -133,12 +135,24 @@ namespace Chroma
     void chlclovms(LatticeREAL& log_diag, int cb);
     void ldagdlinv(LatticeREAL& tr_log_diag, int cb);
 
+    //! Take a private copy of the blocks before changing them in place
+    void ownBlocks();
+
     //! Get the u field
     const multi1d<U>& getU() const {return u;}
 
     //! Calculates Tr_D ( Gamma_mat L )
     Real getCloverCoeff(int mu, int nu) const;
 
+    //! The shared cache of clover terms of this precision
+    typedef SingletonHolder< CloverTermCache<U, PrimitiveClovTriang<REALT> >,
+			     QDP::CreateUsingNew,
+			     QDP::NoDestroy,
+			     QDP::SingleThreaded> TheCache;
+
+    //! Mask of the checkerboards on which the term is inverted
+    int invertedMask() const;
+
   private:
 			Handle< FermBC<T,multi1d<U>,multi1d<U> > >      fbc;
     multi1d<U>  u;
@@ -148,14 +162,21 @@ namespace Chroma
     multi1d<bool> choles_done;   // Keep note of whether the decomposition has been done
                                  // on a particular checkerboard. 
 
-    multi1d<PrimitiveClovTriang<REALT> >  tri;
+    Handle< multi1d<PrimitiveClovTriang<REALT> > >  tri;
+    bool                         tri_shared;  // tri is also held by the cache
+
+    Double                       tr_log_sum_;    // Sum of tr_log_diag_ on tr_log_sum_cb_
+    int                          tr_log_sum_cb_; // or -1 if it has to be summed again
+
+    CloverCacheEnv::BlockKey     cache_key;   // Only used if param.cache_clover
+    int                          last_cb;     // Last checkerboard inverted, or -1
     
   };
 
 
    // Empty constructor. Must use create later
   template<typename T, typename U>
-  QDPCloverTermT<T,U>::QDPCloverTermT() {}
+  QDPCloverTermT<T,U>::QDPCloverTermT() : tri_shared(false) {}
 
   // Now copy
   template<typename T, typename U>
@@ -207,7 +228,16 @@ namespace Chroma
     
     tr_log_diag_ = from.tr_log_diag_;
     
-    tri = from.tri;
+    tri = new multi1d<PrimitiveClovTriang<REALT> >(*from.tri);
+    tri_shared = false;
+
+    // The cache key is only meaningful if the source term was cached
+    param.cache_clover = param.cache_clover && from.param.cache_clover;
+    cache_key = from.cache_key;
+    last_cb   = from.last_cb;
+
+    tr_log_sum_    = from.tr_log_sum_;
+    tr_log_sum_cb_ = from.tr_log_sum_cb_;
     END_CODE();  
 #endif
   }
@@ -250,16 +280,37 @@ namespace Chroma
       diag_mass = 1 + (Nd-1)*ff + param.Mass;
     }
     
-    /* Calculate F(mu,nu) */
-    multi1d<U> f;
-    mesField(f, u);
-    makeClov(f, diag_mass);
-    
     choles_done.resize(rb.numSubsets());
     for(int i=0; i < rb.numSubsets(); i++) {
       choles_done[i] = false;
     }
-    
+    last_cb = -1;
+    tr_log_sum_cb_ = -1;
+
+    if (param.cache_clover)
+    {
+      // Reuse the blocks, or at least F(mu,nu), of an earlier term on the same links
+      cache_key.links     = CloverCacheEnv::linkFingerprint(u);
+      cache_key.diag_mass = toDouble(diag_mass);
+      for(int mu=0, p=0; mu < Nd; ++mu)
+	for(int nu=mu+1; nu < Nd; ++nu, ++p)
+	  cache_key.coeff[p] = toDouble(getCloverCoeff(mu,nu));
+
+      if (! TheCache::Instance().findBlocks(tri, tr_log_diag_, cache_key, 0, -1))
+      {
+	makeClov(TheCache::Instance().fieldStrength(cache_key.links, u), diag_mass);
+	TheCache::Instance().storeBlocks(tri, tr_log_diag_, cache_key, 0, -1);
+      }
+      tri_shared = true;
+    }
+    else
+    {
+      /* Calculate F(mu,nu) */
+      multi1d<U> f;
+      mesField(f, u);
+      makeClov(f, diag_mass);
+    }
+
 
     END_CODE();
 #endif
@@ -518,9 +569,10 @@ namespace Chroma
 
     const int nodeSites = QDP::Layout::sitesOnNode();
 
-    tri.resize(nodeSites);  // hold local lattice
+    tri = new multi1d<PrimitiveClovTriang<REALT> >(nodeSites);  // hold local lattice
+    tri_shared = false;
 
-    QDPCloverEnv::QDPCloverMakeClovArg<U> arg = {diag_mass, f0,f1,f2,f3,f4,f5,tri };
+    QDPCloverEnv::QDPCloverMakeClovArg<U> arg = {diag_mass, f0,f1,f2,f3,f4,f5,*tri };
     dispatch_to_threads(nodeSites, arg, QDPCloverEnv::makeClovSiteLoop<U>);
               
 
@@ -537,15 +589,67 @@ namespace Chroma
   {
     START_CODE();
 
+    // Inverting twice is not a state the cache knows about
+    if (choles_done[cb])
+      param.cache_clover = false;
+
+    // The state after this inversion
+    int inverted = invertedMask() | (1 << cb);
+
+    if (param.cache_clover && 
+	TheCache::Instance().findBlocks(tri, tr_log_diag_, cache_key, inverted, cb))
+    {
+      tri_shared = true;
+      choles_done[cb] = true;
+      last_cb = cb;
+      tr_log_sum_cb_ = -1;
+
+      END_CODE();
+      return;
+    }
+
     // When you are doing the cholesky - also fill out the trace_log_diag piece)
     // chlclovms(tr_log_diag_, cb);
     // Switch to LDL^\dag inversion
     ldagdlinv(tr_log_diag_,cb);
+    last_cb = cb;
+
+    if (param.cache_clover)
+    {
+      TheCache::Instance().storeBlocks(tri, tr_log_diag_, cache_key, inverted, cb);
+      tri_shared = true;
+    }
 
     END_CODE();
   }
 
 
+  //! Take a private copy of the blocks before changing them in place
+  /*! Blocks shared with the cache must stay as they were stored */
+  template<typename T, typename U>
+  void QDPCloverTermT<T,U>::ownBlocks()
+  {
+    if (tri_shared)
+    {
+      tri = new multi1d<PrimitiveClovTriang<REALT> >(*tri);
+      tri_shared = false;
+    }
+  }
+
+
+  //! Mask of the checkerboards on which the term is inverted
+  template<typename T, typename U>
+  int QDPCloverTermT<T,U>::invertedMask() const
+  {
+    int mask = 0;
+    for(int i=0; i < choles_done.size(); ++i)
+      if (choles_done[i])
+	mask |= (1 << i);
+
+    return mask;
+  }
+
+
   //! Invert
   /*!
    * Computes the inverse of the term on cb using Cholesky
@@ -565,6 +669,12 @@ namespace Chroma
       QDP_abort(1);
     }
 
+    // The trace log was already summed while inverting
+    if( ! param.sub_zero_usedP && tr_log_sum_cb_ == cb ) { 
+      END_CODE();
+      return tr_log_sum_;
+    }
+
     LatticeREAL ff=tr_log_diag_;
 
     if( param.sub_zero_usedP ) { 
@@ -590,6 +700,29 @@ namespace Chroma
       LatticeRealT& tr_log_diag;
       multi1d<PrimitiveClovTriang<REALT> >& tri;
       int cb;
+      double* partial;    // per thread sums of the trace log, if wanted
+    };
+
+    //! Block access for the shared LDL^dag kernel
+    template<typename U>
+    struct LDagDLInvAccess {
+      typedef typename LDagDLInvArgs<U>::REALT REALT;
+      LDagDLInvArgs<U>* a;
+
+      REALT* diag(int site, int block) {
+	return (REALT*)&(a->tri[site].diag[block][0]);
+      }
+
+      REALT* offd(int site, int block) {
+	return (REALT*)&(a->tri[site].offd[block][0]);
+      }
+
+      // NB we are always doing trace log | A | 
+      // (because we are always working with actually A^\dagger A
+      //  even in one flavour case where we square root)
+      void setLogDet(int site, double logdet) {
+	a->tr_log_diag.elem(site).elem().elem().elem() += (REALT)logdet;
+      }
     };
 
     template<typename U>
@@ -597,198 +730,14 @@ namespace Chroma
     void LDagDLInvSiteLoop(int lo, int hi, int myId, LDagDLInvArgs<U>* a) 
     {
       typedef typename LDagDLInvArgs<U>::REALT REALT;
-      typedef typename LDagDLInvArgs<U>::RealT RealT;
-      typedef typename LDagDLInvArgs<U>::LatticeRealT LatticeRealT;
-
-      LatticeRealT& tr_log_diag = a->tr_log_diag;
-      multi1d<PrimitiveClovTriang < REALT> >& tri = a->tri;
-      int cb = a->cb;
-      
-      
-      RScalar<REALT> zip=0;
-      int N = 2*Nc;
-      
-      // Loop through the sites.
-      for(int ssite=lo; ssite < hi; ++ssite)  {
 
-	int site = rb[cb].siteTable()[ssite];
-	
-	int site_neg_logdet=0;
-	// Loop through the blocks on the site.
-	for(int block=0; block < 2; block++) { 
-	  
-	  // Triangular storage 
-	  RScalar<REALT> inv_d[6] QDP_ALIGN16;
-	  RComplex<REALT> inv_offd[15] QDP_ALIGN16;
-	  RComplex<REALT> v[6] QDP_ALIGN16;
-	  RScalar<REALT>  diag_g[6] QDP_ALIGN16;
-	  // Algorithm 4.1.2 LDL^\dagger Decomposition
-	  // From Golub, van Loan 3rd ed, page 139
-	  for(int i=0; i < N; i++) { 
-	    inv_d[i] = tri[site].diag[block][i];
-	  }
-	  
-	  for(int i=0; i < 15; i++) { 
-	    inv_offd[i]  =tri[site].offd[block][i];
-	  }
-	  
-	  for(int j=0; j < N; ++j) { 
-	    
-	    // Compute v(0:j-1)
-	    //
-	    // for i=0:j-2
-	    //   v(i) = A(j,i) A(i,i)
-	    // end
-	    
-	    
-	    for(int i=0; i < j; i++) { 
-	      int elem_ji = j*(j-1)/2 + i;
-	      
-	      RComplex<REALT> A_ii = cmplx( inv_d[i], zip );
-	      v[i] = A_ii*adj(inv_offd[elem_ji]);
-	    }
-	    
-	    // v(j) = A(j,j) - A(j, 0:j-2) v(0:j-2)
-	    //                 ^ This is done with a loop over k ie:
-	    //
-	    // v(j) = A(j,j) - sum_k A*(j,k) v(k)     k=0...j-2
-	    //
-	    //      = A(j,j) - sum_k A*(j,k) A(j,k) A(k,k)
-	    //      = A(j,j) - sum_k | A(j,k) |^2 A(k,k)
-	    
-	    v[j] = cmplx(inv_d[j],zip);
-	    
-	    for(int k=0; k < j; k++) { 
-	      int elem_jk = j*(j-1)/2 + k;
-	      v[j] -= inv_offd[elem_jk]*v[k];
-	    }
-	    
-	    
-	    // At this point in time v[j] has to be real, since
-	    // A(j,j) is from diag ie real and all | A(j,k) |^2 is real
-	    // as is A(k,k)
-	    
-	    // A(j,j) is the diagonal element - so store it.
-	    inv_d[j] = real( v[j] );
-	    
-	    // Last line of algorithm:
-	    // A( j+1 : n, j) = ( A(j+1:n, j) - A(j+1:n, 1:j-1)v(1:k-1) ) / v(j)
-	    //
-	    // use k as first colon notation and l as second so
-	    // 
-	    // for k=j+1 < n-1
-	    //      A(k,j) = A(k,j) ;
-	    //      for l=0 < j-1
-	    //         A(k,j) -= A(k, l) v(l)
-	    //      end
-	    //      A(k,j) /= v(j);
-	    //
-	    for(int k=j+1; k < N; k++) { 
-	      int elem_kj = k*(k-1)/2 + j;
-	      for(int l=0; l < j; l++) { 
-		int elem_kl = k*(k-1)/2 + l;
-		inv_offd[elem_kj] -= inv_offd[elem_kl] * v[l];
-	      }
-	      inv_offd[elem_kj] /= v[j];
-	    }
-	  }
-	  
-	  // Now fix up the inverse
-	  RScalar<REALT> one;
-	  one.elem() = (REALT)1;
-	  
-	  for(int i=0; i < N; i++) { 
-	    diag_g[i] = one/inv_d[i];
-	    
-	    // Compute the trace log
-	    // NB we are always doing trace log | A | 
-	    // (because we are always working with actually A^\dagger A
-	    //  even in one flavour case where we square root)
-	    tr_log_diag.elem(site).elem().elem().elem() += log(fabs(inv_d[i].elem()));
-	    // However, it is worth counting just the no of negative logdets
-	    // on site
-	    if( inv_d[i].elem() < 0 ) { 
-	      site_neg_logdet++;
-	    }
-	  }
-	  // Now we need to invert the L D L^\dagger 
-	  // We can do this by solving:
-	  //
-	  //  L D L^\dagger M^{-1} = 1   
-	  //
-	  // This can be done by solving L D X = 1  (X = L^\dagger M^{-1})
-	  //
-	  // Then solving L^\dagger M^{-1} = X
-	  //
-	  // LD is lower diagonal and so X will also be lower diagonal.
-	  // LD X = 1 can be solved by forward substitution.
-	  //
-	  // Likewise L^\dagger is strictly upper triagonal and so
-	  // L^\dagger M^{-1} = X can be solved by forward substitution.
-	  RComplex<REALT> sum;
-	  for(int k = 0; k < N; ++k) {
-
-	    for(int i = 0; i < k; ++i) {
-	      zero_rep(v[i]);
-	    }
-	    
-	    /*# Forward substitution */
-	    
-	    // The first element is the inverse of the diagonal
-	    v[k] = cmplx(diag_g[k],zip);
-	    
-	    for(int i = k+1; i < N; ++i) {
-	      zero_rep(v[i]);
-	      
-	      for(int j = k; j < i; ++j) {
-		int elem_ij = i*(i-1)/2+j;	
-		
-		// subtract l_ij*d_j*x_{kj}
-		v[i] -= inv_offd[elem_ij] *inv_d[j]*v[j];
-		
-	      }
-	      
-	      // scale out by 1/d_i
-	      v[i] *= diag_g[i];
-	    }
-	    
-	    /*# Backward substitution */
-	    // V[N-1] remains unchanged
-	    // Start from V[N-2]
-	    
-	    for(int i = N-2; (int)i >= (int)k; --i) {
-	      for(int j = i+1; j < N; ++j) {
-		int elem_ji = j*(j-1)/2 + i;
-		// Subtract terms of typ (l_ji)*x_kj
-		v[i] -= adj(inv_offd[elem_ji]) * v[j];
-	      }
-	    }
-	    
-	    /*# Overwrite column k of invcl.offd */
-	    inv_d[k] = real(v[k]);
-	    for(int i = k+1; i < N; ++i) {
+      // Inverse and trace log of both blocks of the sites in one pass
+      LDagDLInvAccess<U> acc = { a };
+      double logdet = CloverLDLEnv::invertSites<REALT>(acc, rb[a->cb].siteTable().slice(), lo, hi);
 
-	      int elem_ik = i*(i-1)/2+k;
-	      inv_offd[elem_ik] = v[i];
-	    }
-	  }
-	  
-	  
-	  // Overwrite original data
-	  for(int i=0; i < N; i++) { 
-	    tri[site].diag[block][i] = inv_d[i];
-	  }
-	  for(int i=0; i < 15; i++) { 
-	    tri[site].offd[block][i] = inv_offd[i];
-	  }
-	}
-	
-	if( site_neg_logdet != 0 ) { 
-	  // Report if site has any negative terms. (-ve def)
-	  std::cout << "WARNING: found " << site_neg_logdet
-		    << " negative eigenvalues in Clover DET at site: " << site << std::endl;
-	}
-      }/* End Site Loop */
+      if (a->partial != 0) { 
+	a->partial[myId] += logdet;
+      }
     } /* End Function */
   } /* End Namespace */
 
@@ -809,9 +758,24 @@ namespace Chroma
     // Zero trace log
     tr_log_diag = zero;
 
-    QDPCloverEnv::LDagDLInvArgs<U> a = { tr_log_diag, tri, cb };
+    const int nthreads = qdpNumThreads();
+    std::vector<double> partial(nthreads, 0.0);
+
+    ownBlocks();
+
+    QDPCloverEnv::LDagDLInvArgs<U> a = { tr_log_diag, *tri, cb, &(partial[0]) };
     dispatch_to_threads(rb[cb].numSiteTable(), a, QDPCloverEnv::LDagDLInvSiteLoop<U>);
 
+    // Keep the global trace log so cholesDet need not sum it again
+    double logdet = 0;
+    for(int t=0; t < nthreads; ++t) {
+      logdet += partial[t];
+    }
+    QDPInternal::globalSum(logdet);
+
+    tr_log_sum_    = logdet;
+    tr_log_sum_cb_ = cb;
+
     
     // This comes from the days when we used to do Cholesky
     choles_done[cb] = true;
@@ -999,8 +963,10 @@ namespace Chroma
       QDP_abort(1);
     }
   
+    ownBlocks();
+
     tr_log_diag = zero;
-    QDPCloverEnv::LDagDLInvArgs<U> a = { tr_log_diag, tri, cb};
+    QDPCloverEnv::LDagDLInvArgs<U> a = { tr_log_diag, *tri, cb};
     dispatch_to_threads(rb[cb].numSiteTable(), a, QDPCloverEnv::cholesSiteLoop<U>);
     
     choles_done[cb] = true;
@@ -1042,6 +1008,7 @@ namespace Chroma
 
     int n = 2*Nc;
 
+    const multi1d<PrimitiveClovTriang<REALT> >& tri = *(this->tri);
     RComplex<REALT>* cchi = (RComplex<REALT>*)&(chi.elem(site).elem(0).elem(0));
     const RComplex<REALT>* ppsi = (const RComplex<REALT>*)&(psi.elem(site).elem(0).elem(0));
 
@@ -1487,7 +1454,7 @@ namespace Chroma
       QDP_abort(1);
     }
 
-    QDPCloverEnv::TriaCntrArgs<U> a = { B, tri, mat, cb };
+    QDPCloverEnv::TriaCntrArgs<U> a = { B, *tri, mat, cb };
     dispatch_to_threads(rb[cb].numSiteTable(), a, 
 			QDPCloverEnv::triaCntrSiteLoop<U>);
 
@@ -2099,7 +2066,7 @@ namespace Chroma
       QDP_abort(1);
     }
 
-    QDPCloverEnv::ApplyArgs<T> arg = { chi,psi,tri,cb };
+    QDPCloverEnv::ApplyArgs<T> arg = { chi,psi,*tri,cb };
     int num_sites = rb[cb].siteTable().size();
 
     // The dispatch function is at the end of the file
@@ -2174,7 +2141,7 @@ namespace Chroma
       typedef typename WordType<T>::Type_t REALT;
       int num_sites = rb[cb].siteTable().size();
 
-      QDPCloverEnv::QUDAPackArgs<REALT> args = { cb, quda_array,tri };
+      QDPCloverEnv::QUDAPackArgs<REALT> args = { cb, quda_array,*tri };
       dispatch_to_threads(num_sites, args, QDPCloverEnv::qudaPackSiteLoop<REALT>);
 
 
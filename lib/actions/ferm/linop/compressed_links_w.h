@@ -0,0 +1,359 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Gauge links stored in a compressed 12 or 8 real parameterisation
+ */
+
+#ifndef __compressed_links_w_h__
+#define __compressed_links_w_h__
+
+#include "chromabase.h"
+#include "actions/ferm/linop/lwldslash_base_w.h"
+
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <vector>
+
+
+namespace Chroma
+{
+#ifndef QDP_IS_QDPJIT
+  //! Gauge links in a compressed SU(3) parameterisation
+  /*!
+   * \ingroup linop
+   *
+   * Stores per link and direction, for a link U = s c V with V in SU(3),
+   * s = +-1 (the boundary conditions) and c the anisotropy coefficient
+   * of the direction,
+   *
+   *   12 reals:  the first two rows of V. The third row is conj(row0 x row1)
+   *   8 reals:   V_01, V_02, V_10 and the phases of V_00 and V_20. The rest
+   *              follows from the unitarity of V
+   *
+   * and multiplies half fermions by U or U^dag, rebuilding V in registers.
+   * A half fermion is read and written once and the link traffic drops
+   * from 18 to 12 or 8 reals.
+   *
+   * The parameterisations only hold for SU(3) links up to a sign, and the
+   * 8 real one loses precision when V_01, V_02 or V_20 are small, e.g.
+   * near diagonal links. A link that does not survive the round trip is
+   * stored in full instead, and create() reports how many were.
+   */
+  template<typename T, typename Q>
+  class CompressedLinksT
+  {
+  public:
+    typedef typename WordType<T>::Type_t REALT;
+    typedef std::complex<REALT> Cmplx;
+    typedef typename HalfFermionType<T>::Type_t H;
+
+    //! Empty links
+    CompressedLinksT() : npar(18), nfull(0) {}
+
+    //! Compress the links
+    /*!
+     * \param u        links ( Read )
+     * \param coeffs   anisotropy coefficients of the directions ( Read )
+     * \param npar_    12 or 8 ( Read )
+     */
+    void create(const Q& u, const multi1d<Real>& coeffs, int npar_);
+
+    //! Number of reals stored per link, 18 if not compressed
+    int numParams() const {return npar;}
+
+    //! Number of links on all nodes stored in full
+    double numFull() const {return nfull;}
+
+    //! The link U_mu at a site as a row major 3x3 matrix
+    inline void load(RComplex<REALT>* w, int mu, int site) const;
+
+    //! out = U_mu in  or  out = U_mu^dag in  on the sites of s
+    void mult(H& out, const H& in, int mu, bool adj, const Subset& s) const;
+
+    //! Args of the thread kernel
+    struct MultArgs
+    {
+      const CompressedLinksT*  links;
+      const int*               sites;
+      int                      mu;
+      bool                     adj;
+      REALT*                   out;
+      const REALT*             in;
+    };
+
+    //! Multiply on the sites [lo,hi) of the site table
+    static void multLoop(int lo, int hi, int myId, MultArgs* a);
+
+  private:
+    //! Parameters of an SU(3) matrix
+    void pack(REALT* p, const Cmplx v[9]) const;
+
+    //! Rebuild the SU(3) matrix from its parameters
+    static inline void unpack(Cmplx v[9], const REALT* p, int npar);
+
+    int npar;
+    double nfull;
+    std::vector<REALT>        data[Nd];   /*!< npar reals per site */
+    std::vector<signed char>  sign[Nd];   /*!< s per site, 0 if stored in full */
+    REALT                     scale[Nd];  /*!< c per direction */
+    std::vector<int>          full_index[Nd];  /*!< per site the offset in full, -1 if compressed */
+    std::vector<REALT>        full[Nd];   /*!< 18 reals of c U per link stored in full */
+  };
+
+
+  // Parameters of an SU(3) matrix
+  template<typename T, typename Q>
+  void CompressedLinksT<T,Q>::pack(REALT* p, const Cmplx v[9]) const
+  {
+    if (npar == 12)
+    {
+      for(int k=0; k < 6; ++k)
+      {
+	p[2*k]   = v[k].real();
+	p[2*k+1] = v[k].imag();
+      }
+    }
+    else
+    {
+      p[0] = v[1].real();  p[1] = v[1].imag();
+      p[2] = v[2].real();  p[3] = v[2].imag();
+      p[4] = v[3].real();  p[5] = v[3].imag();
+      p[6] = std::arg(v[0]);
+      p[7] = std::arg(v[6]);
+    }
+  }
+
+
+  // Rebuild the SU(3) matrix from its parameters
+  template<typename T, typename Q>
+  inline void CompressedLinksT<T,Q>::unpack(Cmplx v[9], const REALT* p, int npar)
+  {
+    if (npar == 12)
+    {
+      for(int k=0; k < 6; ++k)
+	v[k] = Cmplx(p[2*k], p[2*k+1]);
+
+      // row2 = conj(row0 x row1)
+      v[6] = std::conj(v[1]*v[5] - v[2]*v[4]);
+      v[7] = std::conj(v[2]*v[3] - v[0]*v[5]);
+      v[8] = std::conj(v[0]*v[4] - v[1]*v[3]);
+    }
+    else
+    {
+      v[1] = Cmplx(p[0], p[1]);
+      v[2] = Cmplx(p[2], p[3]);
+      v[3] = Cmplx(p[4], p[5]);
+
+      // First row and first column have unit norm
+      const REALT row_sum = std::norm(v[1]) + std::norm(v[2]);
+      const REALT a0 = std::sqrt(std::max(REALT(1) - row_sum, REALT(0)));
+      v[0] = Cmplx(a0*std::cos(p[6]), a0*std::sin(p[6]));
+
+      const REALT c0 = std::sqrt(std::max(REALT(1) - a0*a0 - std::norm(v[3]), REALT(0)));
+      v[6] = Cmplx(c0*std::cos(p[7]), c0*std::sin(p[7]));
+
+      // The rest from the orthogonality of the rows and columns
+      const REALT r_inv2 = REALT(1) / row_sum;
+      Cmplx A = std::conj(v[0]) * v[3];
+      v[4] = -(std::conj(v[6])*std::conj(v[2]) + A*v[1]) * r_inv2;
+      v[5] =  (std::conj(v[6])*std::conj(v[1]) - A*v[2]) * r_inv2;
+
+      A = std::conj(v[0]) * v[6];
+      v[7] =  (std::conj(v[3])*std::conj(v[2]) - A*v[1]) * r_inv2;
+      v[8] = -(std::conj(v[3])*std::conj(v[1]) + A*v[2]) * r_inv2;
+    }
+  }
+
+
+  // Compress the links
+  template<typename T, typename Q>
+  void CompressedLinksT<T,Q>::create(const Q& u, const multi1d<Real>& coeffs, int npar_)
+  {
+    npar = 18;
+    nfull = 0;
+    for(int mu=0; mu < Nd; ++mu)
+    {
+      data[mu].clear();
+      sign[mu].clear();
+      full_index[mu].clear();
+      full[mu].clear();
+    }
+
+    if (npar_ == 18)
+      return;
+
+    if (npar_ != 12 && npar_ != 8)
+    {
+      QDPIO::cerr << "CompressedLinks: unsupported number of link parameters " << npar_
+		  << ", use 18, 12 or 8" << std::endl;
+      QDP_abort(1);
+    }
+
+    if (Nc != 3 || Nd != 4)
+    {
+      QDPIO::cerr << "CompressedLinks: compression needs Nc=3 and Nd=4" << std::endl;
+      QDP_abort(1);
+    }
+
+    START_CODE();
+
+    npar = npar_;
+
+    // Round trip tolerance of the rebuilt links
+    const double tol = 1000 * std::numeric_limits<REALT>::epsilon();
+
+    const int nsites = Layout::sitesOnNode();
+    for(int mu=0; mu < Nd; ++mu)
+    {
+      scale[mu] = toDouble(coeffs[mu]);
+      data[mu].resize(npar*nsites);
+      sign[mu].resize(nsites);
+
+      for(int site=0; site < nsites; ++site)
+      {
+	Cmplx v[9];
+	for(int i=0; i < 3; ++i)
+	  for(int j=0; j < 3; ++j)
+	  {
+	    const RComplex<REALT>& c = u[mu].elem(site).elem().elem(i,j);
+	    v[3*i+j] = Cmplx(c.real(), c.imag());
+	  }
+
+	// det(U) = +-1 for links with boundary signs
+	const Cmplx det = v[0]*(v[4]*v[8] - v[5]*v[7])
+	  - v[1]*(v[3]*v[8] - v[5]*v[6])
+	  + v[2]*(v[3]*v[7] - v[4]*v[6]);
+	const signed char s = (det.real() < 0) ? -1 : 1;
+
+	Cmplx sv[9];
+	for(int k=0; k < 9; ++k)
+	  sv[k] = v[k] * REALT(s);
+
+	REALT* p = &(data[mu][npar*site]);
+	pack(p, sv);
+	sign[mu][site] = s;
+
+	Cmplx w[9];
+	unpack(w, p, npar);
+	double err = 0;
+	for(int k=0; k < 9; ++k)
+	  err = std::max(err, double(std::abs(w[k] - sv[k])));
+
+	if (! (err <= tol))
+	{
+	  // Keep this link in full
+	  if (full_index[mu].empty())
+	    full_index[mu].assign(nsites, -1);
+
+	  full_index[mu][site] = full[mu].size();
+	  sign[mu][site] = 0;
+	  for(int k=0; k < 9; ++k)
+	  {
+	    full[mu].push_back(scale[mu] * v[k].real());
+	    full[mu].push_back(scale[mu] * v[k].imag());
+	  }
+	  nfull += 1;
+	}
+      }
+    }
+
+    QDPInternal::globalSumArray(&nfull, 1);
+
+    QDPIO::cout << "CompressedLinks: links stored with " << npar << " reals, "
+		<< nfull << " of " << double(Nd)*Layout::vol() << " links in full" << std::endl;
+
+    END_CODE();
+  }
+
+
+  // The link U_mu at a site as a row major Nc x Nc matrix
+  template<typename T, typename Q>
+  inline void CompressedLinksT<T,Q>::load(RComplex<REALT>* w, int mu, int site) const
+  {
+    const signed char s = sign[mu][site];
+    if (s == 0)
+    {
+      const REALT* f = &(full[mu][full_index[mu][site]]);
+      for(int k=0; k < 9; ++k)
+	w[k] = RComplex<REALT>(f[2*k], f[2*k+1]);
+      return;
+    }
+
+    Cmplx v[9];
+    unpack(v, &(data[mu][npar*site]), npar);
+
+    const REALT f = scale[mu] * REALT(s);
+    for(int k=0; k < 9; ++k)
+      w[k] = RComplex<REALT>(f * v[k].real(), f * v[k].imag());
+  }
+
+
+  // Multiply on the sites [lo,hi) of the site table
+  template<typename T, typename Q>
+  void CompressedLinksT<T,Q>::multLoop(int lo, int hi, int myId, MultArgs* a)
+  {
+    const CompressedLinksT& l = *(a->links);
+
+    // A half fermion site is 2 spins of 3 colours
+    for(int i=lo; i < hi; ++i)
+    {
+      const int site = a->sites[i];
+
+      RComplex<REALT> w[9];
+      l.load(w, a->mu, site);
+
+      Cmplx v[9];
+      for(int k=0; k < 9; ++k)
+	v[k] = Cmplx(w[k].real(), w[k].imag());
+
+      const REALT* in = a->in + 12*site;
+      REALT* out = a->out + 12*site;
+
+      for(int s=0; s < 2; ++s)
+      {
+	const Cmplx x0(in[6*s+0], in[6*s+1]);
+	const Cmplx x1(in[6*s+2], in[6*s+3]);
+	const Cmplx x2(in[6*s+4], in[6*s+5]);
+
+	Cmplx y[3];
+	if (! a->adj)
+	{
+	  for(int r=0; r < 3; ++r)
+	    y[r] = v[3*r]*x0 + v[3*r+1]*x1 + v[3*r+2]*x2;
+	}
+	else
+	{
+	  for(int r=0; r < 3; ++r)
+	    y[r] = std::conj(v[r])*x0 + std::conj(v[3+r])*x1 + std::conj(v[6+r])*x2;
+	}
+
+	for(int r=0; r < 3; ++r)
+	{
+	  out[6*s+2*r]   = y[r].real();
+	  out[6*s+2*r+1] = y[r].imag();
+	}
+      }
+    }
+  }
+
+
+  // out = U_mu in  or  out = U_mu^dag in  on the sites of s
+  template<typename T, typename Q>
+  void CompressedLinksT<T,Q>::mult(H& out, const H& in, int mu, bool adj, const Subset& s) const
+  {
+    MultArgs a;
+    a.links = this;
+    a.sites = s.siteTable().slice();
+    a.mu    = mu;
+    a.adj   = adj;
+    a.out   = (REALT*)&(out.elem(0));
+    a.in    = (const REALT*)&(in.elem(0));
+
+    dispatch_to_threads(s.numSiteTable(), a, multLoop);
+  }
+#endif
+
+} // End Namespace Chroma
+
+
+#endif
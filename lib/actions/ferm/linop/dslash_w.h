@@ -100,6 +100,17 @@ namespace Chroma {
 #endif
 
 
+}  // end namespace Chroma
+
+#elif defined(BUILD_COMM_OVERLAP_WILSON_DSLASH) && ! defined(QDP_IS_QDPJIT)
+// Site kernel dslash overlapping the face exchange with the interior sites
+# include "lwldslash_comm_overlap_w.h"
+namespace Chroma {
+
+  typedef CommOverlapWilsonDslash WilsonDslash;
+  typedef CommOverlapWilsonDslashF WilsonDslashF;
+  typedef CommOverlapWilsonDslashD WilsonDslashD;
+
 }  // end namespace Chroma
 
 #else
@@ -31,6 +31,13 @@ namespace Chroma
 
     param = param_;
 
+    // Only EvenOddPrecCloverLinOp reads compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "EO3DPrecSCprecTCloverLinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     // Check we are in 4D
     if ( Nd != 4 ) { 
       QDPIO::cout << "This class (EO3DPrecSCprecTCloverLinOp) only works in 4D" << std::endl;
@@ -24,6 +24,14 @@ namespace Chroma
     // QDPIO::cout << __PRETTY_FUNCTION__ << ": enter" << std::endl;
 
     param = param_;
+
+    // Only EvenOddPrecCloverLinOp reads compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "EvenOddPrecDumbCloverFLinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     clov.create(fs, param);
     invclov.create(fs,param,clov);  // make a copy
     invclov.choles(0);  // invert the cb=0 part
@@ -109,6 +117,14 @@ namespace Chroma
     // QDPIO::cout << __PRETTY_FUNCTION__ << ": enter" << std::endl;
 
     param = param_;
+
+    // Only EvenOddPrecCloverLinOp reads compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "EvenOddPrecDumbCloverDLinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     clov.create(fs, param);
     invclov.create(fs,param,clov);  // make a copy
     invclov.choles(0);  // invert the cb=0 part
@@ -25,6 +25,13 @@ namespace Chroma
 
     param = param_;
 
+    // Only EvenOddPrecCloverLinOp reads compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "EvenOddPrecCloverExtFieldLinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     clov.create(efs->getOriginalState(), param);
  
     invclov.create(efs->getOriginalState(),param, clov);  // make a copy
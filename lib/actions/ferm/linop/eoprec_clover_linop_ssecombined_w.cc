@@ -24,6 +24,13 @@ namespace Chroma
 
     param = param_;
 
+    // The SSE combined operator has no compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "EvenOddPrecCloverLinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     clov.create(fs, param);
  
     invclov.create(fs,param,clov);  // make a copy
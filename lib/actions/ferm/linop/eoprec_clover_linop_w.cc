@@ -8,6 +8,33 @@
 
 namespace Chroma 
 { 
+  namespace
+  {
+    //! The QDP dslash can hold compressed links
+    void createDslash(QDPWilsonDslash& D,
+		      Handle< FermState<LatticeFermion, multi1d<LatticeColorMatrix>, multi1d<LatticeColorMatrix> > > fs,
+		      const AnisoParam_t& aniso, int link_params)
+    {
+      D.create(fs, aniso, link_params);
+    }
+
+    //! Any other dslash only takes the full links
+    template<typename D_t>
+    void createDslash(D_t& D,
+		      Handle< FermState<LatticeFermion, multi1d<LatticeColorMatrix>, multi1d<LatticeColorMatrix> > > fs,
+		      const AnisoParam_t& aniso, int link_params)
+    {
+      if (link_params != 18)
+      {
+	QDPIO::cerr << "EvenOddPrecCloverLinOp: LinkCompression " << link_params
+		    << " needs the QDP Wilson dslash, which is not the WilsonDslash of this build" << std::endl;
+	QDP_abort(1);
+      }
+
+      D.create(fs, aniso);
+    }
+  }
+
 
    using namespace QDP::Hints;
 
@@ -29,7 +56,7 @@ namespace Chroma
     invclov.create(fs,param,clov);  // make a copy
     invclov.choles(0);  // invert the cb=0 part
 
-    D.create(fs, param.anisoParam);
+    createDslash(D, fs, param.anisoParam, param.link_params);
 
     clov_deriv_time = 0;
     clov_apply_time = 0;
@@ -295,6 +322,115 @@ namespace Chroma
     END_CODE();
   }
 
+  //! Dslash pieces of the derivative into ds_u, clover insertions into lambda
+  /*!
+   * Same decomposition as EvenOddPrecLogDetLinearOperator::deriv, but the
+   * A'_oo and A'_ee pieces are only accumulated as insertions
+   */
+  void 
+  EvenOddPrecCloverLinOp::derivPieces(multi1d<LatticeColorMatrix>& ds_u, 
+				      multi1d<LatticeColorMatrix>& lambda,
+				      const LatticeFermion& chi, const LatticeFermion& psi, 
+				      enum PlusMinus isign) const
+  {
+    START_CODE();
+
+    enum PlusMinus msign = (isign == PLUS) ? MINUS : PLUS;
+
+    LatticeFermion tmp1, tmp2, tmp3;
+    moveToFastMemoryHint(tmp1);
+    moveToFastMemoryHint(tmp2);
+    moveToFastMemoryHint(tmp3);
+
+    multi1d<LatticeColorMatrix> ds_1;
+
+    //  chi^dag * A'_oo * psi
+    swatch.reset(); swatch.start();
+    clov.derivAddInsertion(lambda, chi, psi, isign, 1);
+    swatch.stop();
+    clov_deriv_time += swatch.getTimeInSeconds();
+
+    //  ds_u  -=  chi^dag * D'_oe * Ainv_ee * D_eo * psi_o
+    evenOddLinOp(tmp1, psi, isign);
+    evenEvenInvLinOp(tmp2, tmp1, isign);
+    derivOddEvenLinOp(ds_1, chi, tmp2, isign);
+    ds_u -= ds_1;
+
+    //  chi^dag * D_oe * Ainv_ee * A'_ee * Ainv_ee * D_eo * psi_o
+    evenOddLinOp(tmp1, chi, msign);
+    evenEvenInvLinOp(tmp3, tmp1, msign);
+
+    swatch.reset(); swatch.start();
+    clov.derivAddInsertion(lambda, tmp3, tmp2, isign, 0);
+    swatch.stop();
+    clov_deriv_time += swatch.getTimeInSeconds();
+
+    //  ds_u  -=  chi^dag * D_oe * Ainv_ee * D'_eo * psi_o
+    derivEvenOddLinOp(ds_1, tmp3, psi, isign);
+    ds_u -= ds_1;
+
+    END_CODE();
+  }
+
+
+  //! Derivative of the operator, with one leaf sweep for A_ee and A_oo
+  void 
+  EvenOddPrecCloverLinOp::deriv(multi1d<LatticeColorMatrix>& ds_u, 
+				const LatticeFermion& chi, const LatticeFermion& psi, 
+				enum PlusMinus isign) const
+  {
+    START_CODE();
+
+    ds_u.resize(Nd);
+    ds_u = zero;
+
+    multi1d<LatticeColorMatrix> lambda;
+    derivPieces(ds_u, lambda, chi, psi, isign);
+
+    multi1d<LatticeColorMatrix> ds_1;
+    swatch.reset(); swatch.start();
+    clov.derivInsertion(ds_1, lambda);
+    swatch.stop();
+    clov_deriv_time += swatch.getTimeInSeconds();
+
+    ds_u += ds_1;
+    getFermBC().zero(ds_u);
+
+    END_CODE();
+  }
+
+
+  //! Derivative of  X^dag (M^dag M)' X + weight * TrLn A_ee  with one leaf sweep
+  void 
+  EvenOddPrecCloverLinOp::derivMdagMLogDet(multi1d<LatticeColorMatrix>& ds_u, 
+					   const LatticeFermion& X, const LatticeFermion& Y, 
+					   const Real& weight) const
+  {
+    START_CODE();
+
+    ds_u.resize(Nd);
+    ds_u = zero;
+
+    // The clover insertions of both bilinears and of the log det all
+    // live on the same links
+    multi1d<LatticeColorMatrix> lambda;
+    derivPieces(ds_u, lambda, X, Y, MINUS);
+    derivPieces(ds_u, lambda, Y, X, PLUS);
+
+    multi1d<LatticeColorMatrix> ds_1;
+    swatch.reset(); swatch.start();
+    invclov.derivTrLnAddInsertion(lambda, weight, PLUS, 0);
+    clov.derivInsertion(ds_1, lambda);
+    swatch.stop();
+    clov_deriv_time += swatch.getTimeInSeconds();
+
+    ds_u += ds_1;
+    getFermBC().zero(ds_u);
+
+    END_CODE();
+  }
+
+
   //! Return flops performed by the operator()
   unsigned long EvenOddPrecCloverLinOp::nFlops() const
   {
@@ -55,6 +55,9 @@ namespace Chroma
     //! Return the fermion BC object for this linear operator
     const FermBC<T,P,Q>& getFermBC() const {return D.getFermBC();}
 
+    //! Return the fermion action params of this operator
+    const CloverFermActParams& getParam() const {return param;}
+
     //! Creation routine
     void create(Handle< FermState<T,P,Q> > fs,
 		const CloverFermActParams& param_);
@@ -115,12 +118,32 @@ namespace Chroma
 			    const multi1d<LatticeFermion>& chi, const multi1d<LatticeFermion>& psi, 
 			    enum PlusMinus isign) const;
 
+    // Keep the other deriv overloads visible
+    using EvenOddPrecLogDetLinearOperator<T,P,Q>::deriv;
+
+    //! Derivative of the operator, with one leaf sweep for A_ee and A_oo
+    void deriv(multi1d<LatticeColorMatrix>& ds_u, 
+	       const LatticeFermion& chi, const LatticeFermion& psi, 
+	       enum PlusMinus isign) const;
+
+    //! Derivative of  X^dag (M^dag M)' X + weight * TrLn A_ee  with one leaf sweep
+    void derivMdagMLogDet(multi1d<LatticeColorMatrix>& ds_u, 
+			  const LatticeFermion& X, const LatticeFermion& Y, 
+			  const Real& weight) const;
+
     //! Return flops performed by the operator()
     unsigned long nFlops() const;
 
     //! Get the log det of the even even part
     Double logDetEvenEvenLinOp(void) const; 
 
+  protected:
+    //! Dslash pieces of the derivative into ds_u, clover insertions into lambda
+    void derivPieces(multi1d<LatticeColorMatrix>& ds_u, 
+		     multi1d<LatticeColorMatrix>& lambda,
+		     const LatticeFermion& chi, const LatticeFermion& psi, 
+		     enum PlusMinus isign) const;
+
   private:
     CloverFermActParams param;
     WilsonDslash D;
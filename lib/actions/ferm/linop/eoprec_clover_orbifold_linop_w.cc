@@ -25,6 +25,13 @@ namespace Chroma
 
     param = param_;
 
+    // Only EvenOddPrecCloverLinOp reads compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "EvenOddPrecCloverOrbifoldLinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     clov.create(fs, param);
  
     invclov.create(fs,param,clov);  // make a copy
@@ -72,6 +72,13 @@ namespace Chroma
 
     param = param_;
 
+    // Only EvenOddPrecCloverLinOp reads compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "EvenOddPrecSLICLinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     multi1d<LatticeColorMatrix> u_pl(Nd);
     multi1d<LatticeColorMatrix> u_mn(Nd);
 
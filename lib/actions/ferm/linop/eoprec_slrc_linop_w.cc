@@ -26,6 +26,13 @@ namespace Chroma
 
     param = param_;
 
+    // Only EvenOddPrecCloverLinOp reads compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "EvenOddPrecSLRCLinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     // Need to make sure that fs is a stout ferm state
     // We want to have Clover with thin links
     thin_fs  = new PeriodicFermState<T,P,Q>( 
@@ -33,6 +33,13 @@ namespace Chroma
     // Copy Params
     param = param_;
 
+    // Only EvenOddPrecCloverLinOp reads compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "ILUPrecSCprecTCloverLinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     // Check we are in 4D
     if ( Nd != 4 ) { 
       QDPIO::cout << "This class (ILUPrecSCprecTCloverLinOp) only works in 4D" << std::endl;
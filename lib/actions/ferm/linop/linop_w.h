@@ -53,6 +53,7 @@
 #include "lovddag_w.h"
 #include "lovddag_double_pass_w.h"
 #include "lovlapms_w.h"
+#include "lovlapms_mp_w.h"
 #include "lovlap_double_pass_w.h"
 #include "lg5eps_w.h"
 
@@ -0,0 +1,417 @@
+/*! \file
+ *  \brief Overlap-pole operator with a mixed precision inner solve
+ */
+#include <math.h>
+#include <algorithm>
+#include "chromabase.h"
+#include "actions/ferm/linop/lovlapms_mp_w.h"
+#include "actions/ferm/fermstates/periodic_fermstate.h"
+#include "util/ferm/block_inner_product.h"
+
+
+namespace Chroma
+{
+
+  //! Constructor
+  lovlapms_mp::lovlapms_mp(const UnprecWilsonTypeFermAct<T,P,Q>& S_aux,
+			   Handle< FermState<T,P,Q> > state,
+			   const Real& _m_q, int _numroot,
+			   const Real& _constP,
+			   const multi1d<Real>& _resP,
+			   const multi1d<Real>& _rootQ,
+			   int _NEig,
+			   const multi1d<Real>& _EigValFunc,
+			   const multi1d<LatticeFermion>& _EigVec,
+			   int _MaxCG,
+			   const Real& _RsdCG,
+			   const int _ReorthFreq,
+			   const Real& _AuxMass,
+			   int _MaxCGSingle,
+			   const Real& _RsdCGSingle,
+			   int _MaxRefine,
+			   const Real& _PoleRsdRelaxMax) :
+    M(S_aux.linOp(state)), MdagM(S_aux.lMdagM(state)), fbc(state->getFermBC()),
+    m_q(_m_q), numroot(_numroot), constP(_constP),
+    resP(_resP), rootQ(_rootQ), EigVec(_EigVec), EigValFunc(_EigValFunc),
+    NEig(_NEig), MaxCG(_MaxCG), RsdCG(_RsdCG),  ReorthFreq(_ReorthFreq),
+    MaxCGSingle(_MaxCGSingle), RsdCGSingle(_RsdCGSingle), MaxRefine(_MaxRefine)
+  {
+    START_CODE();
+
+    // The links in the state already have the boundaries folded in,
+    // so the single precision kernel only needs a periodic state
+    const Q& links = state->getLinks();
+    QF links_single(Nd);
+    for(int mu=0; mu < Nd; ++mu)
+      links_single[mu] = links[mu];
+
+    Handle< FermState<TF,QF,QF> > fstate_single(new PeriodicFermState<TF,QF,QF>(links_single));
+    D_f.create(fstate_single);
+
+    fact_f = Real(Nd) + _AuxMass;
+
+    // Single precision copies of the low modes for the inner reorthogonalisation
+    EigVecF.resize(NEig);
+    for(int i=0; i < NEig; ++i)
+      EigVecF[i] = EigVec[i];
+
+    // Pole s contributes at most |resP_s|/rootQ_s times its error to the
+    // sign function. Relax the poles with the smaller weights.
+    poleRelax.resize(numroot);
+    double wmax = 0;
+    for(int s=0; s < numroot; ++s)
+    {
+      if (toDouble(rootQ[s]) > 0)
+	wmax = std::max(wmax, fabs(toDouble(resP[s])) / toDouble(rootQ[s]));
+    }
+
+    const double relax_max = std::max(1.0, toDouble(_PoleRsdRelaxMax));
+    for(int s=0; s < numroot; ++s)
+    {
+      double w = fabs(toDouble(resP[s]));
+      if (toDouble(rootQ[s]) > 0 && w > 0)
+	poleRelax[s] = std::min(wmax * toDouble(rootQ[s]) / w, relax_max);
+      else
+	poleRelax[s] = 1;
+    }
+
+    END_CODE();
+  }
+
+
+  //! Single precision  chi = (M^dag M + shift) psi
+  void lovlapms_mp::mdagmShiftF(TF& chi, const TF& psi, const RealF& shift) const
+  {
+    //
+    //  M  =  (Nd+Mass)*Psi  -  (1/2) * D' Psi
+    //
+    TF tmp1, tmp2;
+    RealF mhalf = -0.5;
+
+    D_f.apply(tmp1, psi, PLUS, 0);
+    D_f.apply(tmp1, psi, PLUS, 1);
+    tmp2 = fact_f*psi + mhalf*tmp1;
+
+    D_f.apply(tmp1, tmp2, MINUS, 0);
+    D_f.apply(tmp1, tmp2, MINUS, 1);
+    chi = fact_f*tmp2 + mhalf*tmp1;
+    chi += shift*psi;
+  }
+
+
+  //! Single precision multishift CG
+  /*!
+   * As the multishift in lovlapms, after Beat Jegerlehner's paper
+   * hep-lat/9612014, but keeping the solutions explicitly.
+   */
+  int lovlapms_mp::multiShiftF(multi1d<TF>& x, const TF& b,
+			       const multi1d<Real>& shifts,
+			       const multi1d<Double>& rsd_sq,
+			       int MaxIter) const
+  {
+    START_CODE();
+
+    const int nshift = shifts.size();
+
+    // The system with the smallest shift drives the iteration
+    const int isz = nshift - 1;
+
+    x.resize(nshift);
+    for(int s=0; s < nshift; ++s)
+      x[s] = zero;
+
+    Double c = norm2(b);
+    if (toBool(c == 0))
+    {
+      END_CODE();
+      return 0;
+    }
+
+    TF r = b;
+    TF Ap;
+    multi1d<TF> p(nshift);
+    for(int s=0; s < nshift; ++s)
+      p[s] = b;
+
+    multi1d<Real> bs(nshift);   // beta for shifted system
+    multi2d<Real> z(2,nshift);  // zeta for shifted system
+    multi1d<bool> convsP(nshift);
+    bool convP = false;
+
+    convsP = false;
+    z = 1;
+
+    Real a = 0;
+    Real bb = 1;
+    Real bp;
+    Double cp, d;
+    int iz = 1;
+
+    int k;
+    for(k = 0; k < MaxIter && ! convP; ++k)
+    {
+      // Ap = [ M^dag M + shifts(isz) ] p_isz
+      mdagmShiftF(Ap, p[isz], RealF(shifts[isz]));
+
+      if (k % ReorthFreq == 0)
+	blockProject(Ap, EigVecF, NEig, all);
+
+      d = innerProductReal(p[isz], Ap);
+
+      bp = bb;
+      bb = -Real(c/d);
+      bs[isz] = bb;
+
+      iz = 1 - iz;
+
+      for(int s = 0; s < nshift; ++s)
+      {
+	if (s != isz && ! convsP[s])
+	{
+	  Real z0 = z[1-iz][s];
+	  Real z1 = z[iz][s];
+
+	  z[iz][s]  = z0*z1*bp;
+	  z[iz][s] /= bb*a*(z1 - z0) + z1*bp*(1 - (shifts[s] - shifts[isz])*bb);
+	  bs[s] = bb * z[iz][s] / z0;
+	}
+      }
+
+      // r[k+1] += b[k] A . p[k]
+      r += RealF(bb) * Ap;
+
+      if (k % ReorthFreq == 0)
+	blockProject(r, EigVecF, NEig, all);
+
+      // x_s[k+1] -= bs[k] p_s[k]
+      for(int s = 0; s < nshift; ++s)
+      {
+	if (! convsP[s])
+	  x[s] -= RealF(bs[s]) * p[s];
+      }
+
+      cp = c;
+      c = norm2(r);
+      a = Real(c/cp);
+
+      for(int s = 0; s < nshift; ++s)
+      {
+	if (s == isz)
+	{
+	  // p[k+1] = r[k+1] + a[k+1] p[k]
+	  p[s] *= RealF(a);
+	  p[s] += r;
+	}
+	else if (! convsP[s])
+	{
+	  // ps[k+1] := zs[k+1] r[k+1] + as[k+1] ps[k]
+	  Real as = a * z[iz][s]*bs[s] / (z[1-iz][s]*bb);
+	  p[s] *= RealF(as);
+	  p[s] += RealF(z[iz][s]) * r;
+	}
+      }
+
+      // Check each pole against its own target
+      convP = true;
+      for(int s = 0; s < nshift; ++s)
+      {
+	if (! convsP[s])
+	{
+	  Double ztmp = Real(c) * z[iz][s]*z[iz][s];
+	  convsP[s] = toBool(ztmp < rsd_sq[s]);
+	  convP = convP & convsP[s];
+	}
+      }
+    }
+
+    END_CODE();
+
+    return k;
+  }
+
+
+  void lovlapms_mp::operator() (LatticeFermion& chi, const LatticeFermion& psi,
+				enum PlusMinus isign) const
+  {
+    operator()(chi, psi, isign, RsdCG);
+  }
+
+
+  //! Apply the GW operator onto a source std::vector
+  /*! \ingroup linop
+   *
+   * The operator applied is:
+   *       D       =    (1/2)[  (1+m) + (1-m)gamma_5 sgn(H_w) ] psi
+   * or    D^{dag} =    (1/2)[  (1+m) + (1-m) sgn(H_w) gamma_5 psi
+   *
+   * \param chi     result std::vector                              (Write)
+   * \param psi 	  source std::vector         	             (Read)
+   * \param isign   Hermitian Conjugation Flag
+   *                ( PLUS = no dagger| MINUS = dagger )       (Read)
+   * \param epsilon accuracy of the sign function               (Read)
+   */
+  void lovlapms_mp::operator() (LatticeFermion& chi, const LatticeFermion& psi,
+				enum PlusMinus isign, Real epsilon) const
+  {
+    START_CODE();
+
+    LatticeFermion tmp1, tmp2;
+
+    // Gamma_5
+    int G5 = Ns*Ns - 1;
+
+    // Mass for shifted system
+    Real mass = Real(1 + m_q) / Real(1 - m_q);
+
+    switch (isign)
+    {
+    case PLUS:
+      //  chi  :=  gamma_5 * (gamma_5 * mass + sgn(H)) * Psi
+      tmp1 = psi;
+      break;
+
+    case MINUS:
+      //  chi  :=  (mass + sgn(H) * gamma_5) * Psi
+      tmp1 = Gamma(G5) * psi;
+      break;
+
+    default:
+      QDP_error_exit("unknown isign value", isign);
+    }
+
+    chi = zero;
+
+    // Project out the eigenvectors as one block
+    //   c     =  EigVec^dag tmp1
+    //   tmp1 -=  EigVec c
+    //   chi  +=  EigVec func(lambda) c
+    if (NEig > 0)
+    {
+      multi1d<DComplex> cconsts;
+      blockProject(tmp1, cconsts, EigVec, NEig, all);
+
+      for(int i = 0; i < NEig; ++i)
+	cconsts[i] *= EigValFunc[i];
+
+      blockAxpy(chi, cconsts, EigVec, NEig, all);
+    }
+
+    // tmp1 <- H * Projected tmp_1
+    (*M)(tmp2, tmp1, PLUS);
+    tmp1 = Gamma(G5) * tmp2;
+
+    if (toBool(norm2(tmp1) == 0))
+    {
+      chi = zero;
+      END_CODE();
+      return;
+    }
+
+    // Same targets as lovlapms
+    Real epsilon_normalise = epsilon*(Real(1)-m_q)/Real(2);
+    Real epsilon_target = epsilon_normalise/(Real(2) + epsilon_normalise);
+    Real rsdcg_sq = epsilon_target*epsilon_target;
+    Double rsd_sq = norm2(psi)*rsdcg_sq;
+
+    multi1d<Double> target_sq(numroot);
+    for(int s = 0; s < numroot; ++s)
+      target_sq[s] = rsd_sq * poleRelax[s] * poleRelax[s];
+
+    // First pass: single precision multishift to the single precision target
+    Double b_sq = norm2(tmp1);
+    multi1d<Double> inner_sq(numroot);
+    for(int s = 0; s < numroot; ++s)
+      inner_sq[s] = std::max(toDouble(target_sq[s]), toDouble(RsdCGSingle*RsdCGSingle*b_sq));
+
+    multi1d<TF> x_f;
+    {
+      TF b_f = tmp1;
+      int n_count = multiShiftF(x_f, b_f, rootQ, inner_sq, MaxCGSingle);
+      QDPIO::cout << "Overlap Inner Solve (lovlapms_mp): single precision multishift "
+		  << n_count << " iterations" << std::endl;
+    }
+
+    multi1d<LatticeFermion> x(numroot);
+    for(int s = 0; s < numroot; ++s)
+      x[s] = x_f[s];
+
+    // Outer double precision correction, pole by pole. MaxCG bounds the
+    // single precision iterations spent on the corrections of a pole
+    int n_refine = 0;
+    int n_single = 0;
+    for(int s = 0; s < numroot; ++s)
+    {
+      multi1d<Real> shift(1);
+      shift[0] = rootQ[s];
+
+      int n_pole = 0;
+      for(int iter = 0; iter < MaxRefine; ++iter)
+      {
+	// r_s = b - (M^dag M + rootQ_s) x_s
+	LatticeFermion r;
+	(*MdagM)(r, x[s], PLUS);
+	r += rootQ[s] * x[s];
+	r = tmp1 - r;
+	blockProject(r, EigVec, NEig, all);
+
+	Double r_sq = norm2(r);
+	if (toBool(r_sq < target_sq[s]))
+	  break;
+
+	const int max_iter = std::min(MaxCGSingle, MaxCG - n_pole);
+	if (max_iter <= 0)
+	{
+	  QDPIO::cout << "Overlap Inner Solve (lovlapms_mp): pole " << s
+		      << " not converged after MaxCG= " << MaxCG << " correction iterations" << std::endl;
+	  break;
+	}
+
+	// Correction e_s solves (M^dag M + rootQ_s) e_s = r_s in single precision
+	multi1d<Double> corr_sq(1);
+	corr_sq[0] = std::max(toDouble(target_sq[s]), toDouble(RsdCGSingle*RsdCGSingle*r_sq));
+
+	multi1d<TF> e_f;
+	TF r_f = r;
+	const int n_count = multiShiftF(e_f, r_f, shift, corr_sq, max_iter);
+	n_pole += n_count;
+	n_single += n_count;
+
+	tmp2 = e_f[0];
+	x[s] += tmp2;
+	++n_refine;
+      }
+    }
+
+    QDPIO::cout << "Overlap Inner Solve (lovlapms_mp): " << n_refine
+		<< " corrections, " << n_single << " single precision iterations" << std::endl;
+
+    // Assemble the sign function
+    //   chi += mass*psi + constP*tmp1 + sum_s resP_s x_s
+    if (isign == PLUS)
+    {
+      tmp2 = Gamma(G5) * psi;
+      chi += tmp2 * mass;
+    }
+    else
+    {
+      chi += psi * mass;
+    }
+
+    chi += tmp1 * constP;
+
+    for(int s = 0; s < numroot; ++s)
+      chi += resP[s] * x[s];
+
+    if (isign == PLUS)
+    {
+      tmp1 = Gamma(G5) * chi;
+      chi = tmp1;
+    }
+
+    // Rescale to the correct normalization
+    chi *= 0.5 * (1 - m_q);
+
+    END_CODE();
+  }
+
+} // End Namespace Chroma
@@ -0,0 +1,165 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Internal Overlap-pole operator with a mixed precision inner solve
+ */
+
+#ifndef __lovlapms_mp_w_h__
+#define __lovlapms_mp_w_h__
+
+#include "linearop.h"
+#include "unprec_wilstype_fermact_w.h"
+#include "actions/ferm/linop/lwldslash_w.h"
+
+
+namespace Chroma
+{
+  //! Internal Overlap-pole operator with a mixed precision inner solve
+  /*!
+   * \ingroup linop
+   *
+   * This routine is specific to Wilson fermions!
+   *
+   * Applies the same operator as lovlapms
+   *
+   *   Chi  =   (1/2)*((1+m_q) + (1-m_q) * gamma_5 * B) . Psi
+   *  where  B  is the pole approx. to eps(H(m))
+   *
+   * but the low eigenvectors are projected out as one block (a single
+   * global reduction) and the shifted systems
+   *
+   *   (H^2 + rootQ_s) x_s = H psi
+   *
+   * are solved by a single precision multishift CG with the solutions
+   * kept explicitly. Each pole is then refined in double precision:
+   * the true residual is computed with the full precision kernel and
+   * corrected with single precision CG solves until it meets the target.
+   *
+   * Each pole may terminate early. The error of pole s enters the sign
+   * function weighted by at most |resP_s|/rootQ_s, so the residual target
+   * of pole s is relaxed by the ratio of the largest such weight to its
+   * own, clipped to PoleRsdRelaxMax. With PoleRsdRelaxMax = 1 every pole
+   * is converged to the same target as in lovlapms.
+   *
+   * The single precision kernel is the unpreconditioned isotropic Wilson
+   * operator at mass AuxMass built from the links of the state.
+   */
+
+  class lovlapms_mp : public UnprecLinearOperator<LatticeFermion,
+	    multi1d<LatticeColorMatrix>, multi1d<LatticeColorMatrix> >
+  {
+  public:
+    // Typedefs to save typing
+    typedef LatticeFermion               T;
+    typedef multi1d<LatticeColorMatrix>  P;
+    typedef multi1d<LatticeColorMatrix>  Q;
+
+    typedef LatticeFermionF              TF;
+    typedef multi1d<LatticeColorMatrixF> QF;
+
+    //! Creation routine
+    /*!
+     * \ingroup linop
+     *
+     * \param S_aux           auxiliary Wilson action            (Read)
+     * \param state           gauge field state                  (Read)
+     * \param _m_q            quark mass                         (Read)
+     * \param _numroot 	      number of poles in expansion       (Read)
+     * \param _constP         constant coeff                     (Read)
+     * \param _resP           numerator                          (Read)
+     * \param _rootQ          denom                              (Read)
+     * \param _NEig           number of eigenvalues              (Read)
+     * \param _EigValFunc     eigenvalues      	                 (Read)
+     * \param _EigVec         eigenvectors      	         (Read)
+     * \param _MaxCG          max single precision iterations of the corrections of a pole (Read)
+     * \param _RsdCG          residual for inner CG              (Read)
+     * \param _ReorthFreq     reorthogonalisation frequency      (Read)
+     * \param _AuxMass        mass of the auxiliary Wilson op    (Read)
+     * \param _MaxCGSingle    MaxCG of single precision solves   (Read)
+     * \param _RsdCGSingle    residual of single precision solves (Read)
+     * \param _MaxRefine      max double precision corrections   (Read)
+     * \param _PoleRsdRelaxMax max relaxation of a pole target   (Read)
+     */
+    lovlapms_mp(const UnprecWilsonTypeFermAct<T,P,Q>& S_aux,
+		Handle< FermState<T,P,Q> > state,
+		const Real& _m_q, int _numroot,
+		const Real& _constP,
+		const multi1d<Real>& _resP,
+		const multi1d<Real>& _rootQ,
+		int _NEig,
+		const multi1d<Real>& _EigValFunc,
+		const multi1d<LatticeFermion>& _EigVec,
+		int _MaxCG,
+		const Real& _RsdCG,
+		const int _ReorthFreq,
+		const Real& _AuxMass,
+		int _MaxCGSingle,
+		const Real& _RsdCGSingle,
+		int _MaxRefine,
+		const Real& _PoleRsdRelaxMax);
+
+    //! Destructor is automatic
+    ~lovlapms_mp() {}
+
+    //! Only defined on the entire lattice
+    const Subset& subset() const {return all;}
+
+    //! Apply the operator onto a source std::vector
+    void operator() (LatticeFermion& chi, const LatticeFermion& psi, enum PlusMinus isign) const;
+
+    //! Apply the operator onto a source std::vector
+    //! but to specified accuracy. In this case epsilon is the accuracy
+    //! (RsdCG) for the sign function
+    void operator() (LatticeFermion& chi, const LatticeFermion& psi, enum PlusMinus isign, Real epsilon) const;
+
+    //! Return the fermion BC object for this linear operator
+    const FermBC<T,P,Q>& getFermBC() const {return *fbc;}
+
+  protected:
+    //! Single precision  chi = (M^dag M + shift) psi
+    void mdagmShiftF(TF& chi, const TF& psi, const RealF& shift) const;
+
+    //! Single precision multishift CG for (M^dag M + shifts[s]) x[s] = b
+    /*!
+     * Pole s is dropped once |r_s|^2 < rsd_sq[s]. The largest index must
+     * hold the smallest shift. Returns the number of iterations.
+     */
+    int multiShiftF(multi1d<TF>& x, const TF& b,
+		    const multi1d<Real>& shifts,
+		    const multi1d<Double>& rsd_sq,
+		    int MaxIter) const;
+
+  private:
+    Handle< DiffLinearOperator<T,P,Q> > M;
+    Handle< DiffLinearOperator<T,P,Q> > MdagM;
+    Handle< FermBC<T,P,Q> >     fbc;
+
+    // Single precision kernel
+    QDPWilsonDslashF D_f;
+    RealF            fact_f;
+    multi1d<TF>      EigVecF;
+
+    // Copy all of these rather than reference them.
+    const Real m_q;
+    int numroot;
+    const Real constP;
+    const multi1d<Real> resP;
+    const multi1d<Real> rootQ;
+    const multi1d<LatticeFermion> EigVec;
+    const multi1d<Real> EigValFunc;
+    int NEig;
+    int MaxCG;
+    const Real RsdCG;
+    const int   ReorthFreq;
+    int MaxCGSingle;
+    const Real RsdCGSingle;
+    int MaxRefine;
+
+    //! Relaxation factor of the residual target of each pole
+    multi1d<Real> poleRelax;
+  };
+
+
+} // End Namespace Chroma
+
+
+#endif
@@ -0,0 +1,776 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Wilson dslash overlapping the face exchange with the interior sites
+ */
+
+#ifndef __lwldslash_comm_overlap_w_h__
+#define __lwldslash_comm_overlap_w_h__
+
+#include "state.h"
+#include "io/aniso_io.h"
+#include "actions/ferm/linop/lwldslash_base_w.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#if defined(ARCH_PARSCALAR)
+#include <qmp.h>
+#endif
+
+
+namespace Chroma
+{
+#ifndef QDP_IS_QDPJIT
+  //! Wilson dslash overlapping the face exchange with the interior sites
+  /*!
+   * \ingroup linop
+   *
+   * The same operator as QDPWilsonDslashT,
+   *
+   *   chi(x) = sum_mu U_mu(x) (1 - isign gamma_mu) psi(x+mu)
+   *                 + U_mu^dag(x-mu) (1 + isign gamma_mu) psi(x-mu)
+   *
+   * written as site kernels on half spinors. An application
+   *
+   *   1. packs the half spinors the neighbour nodes need, the backward
+   *      ones already multiplied by U^dag, and starts their exchange
+   *   2. computes the sites whose neighbours are all on the node
+   *   3. waits for the faces
+   *   4. computes the remaining sites from the received half spinors
+   *
+   * The message buffers and handles are set up once in create(). The
+   * time spent in each phase is accumulated in getTimings() and printed
+   * when the operator is destroyed. Without parscalar QDP++ all sites
+   * are interior.
+   */
+  template<typename T, typename P, typename Q>
+  class CommOverlapWilsonDslashT : public WilsonDslashBase<T, P, Q>
+  {
+  public:
+    typedef typename WordType<T>::Type_t REALT;
+
+    //! Accumulated time in seconds of the phases of apply
+    struct Timings
+    {
+      double  pack;       /*!< packing and starting the faces */
+      double  interior;   /*!< interior sites */
+      double  wait;       /*!< waiting for the faces */
+      double  boundary;   /*!< boundary sites */
+      unsigned long calls;
+    };
+
+    //! Empty constructor. Must use create later
+    CommOverlapWilsonDslashT();
+
+    //! Full constructor
+    CommOverlapWilsonDslashT(Handle< FermState<T,P,Q> > state);
+
+    //! Full constructor with anisotropy
+    CommOverlapWilsonDslashT(Handle< FermState<T,P,Q> > state,
+			     const AnisoParam_t& aniso_);
+
+    //! Full constructor with general coefficients
+    CommOverlapWilsonDslashT(Handle< FermState<T,P,Q> > state,
+			     const multi1d<Real>& coeffs_);
+
+    //! Creation routine
+    void create(Handle< FermState<T,P,Q> > state);
+
+    //! Creation routine with anisotropy
+    void create(Handle< FermState<T,P,Q> > state,
+		const AnisoParam_t& aniso_);
+
+    //! Full constructor with general coefficients
+    void create(Handle< FermState<T,P,Q> > state,
+		const multi1d<Real>& coeffs_);
+
+    //! Print the timings and free the message handles
+    ~CommOverlapWilsonDslashT();
+
+    /**
+     * Apply a dslash
+     *
+     * \param chi     result                                      (Write)
+     * \param psi     source                                      (Read)
+     * \param isign   D'^dag or D'  ( MINUS | PLUS ) resp.        (Read)
+     * \param cb      Checkerboard of OUTPUT std::vector               (Read)
+     *
+     * \return The output of applying dslash on psi
+     */
+    void apply (T& chi, const T& psi, enum PlusMinus isign, int cb) const;
+
+    //! Return the fermion BC object for this linear operator
+    const FermBC<T,P,Q>& getFermBC() const {return *fbc;}
+
+    //! Time spent in the phases of apply
+    const Timings& getTimings() const {return timings;}
+
+    //! Zero the timings
+    void resetTimings() const;
+
+    //! Args of the thread kernels
+    struct KernelArgs
+    {
+      const CommOverlapWilsonDslashT*  d;
+      const int*                       sites;
+      int                              cb;
+      int                              mu;
+      int                              dir;
+      REALT                            sign[2];   /*!< of gamma_mu in the forward and backward hops */
+      RComplex<REALT>*                 chi;
+      const RComplex<REALT>*           psi;
+      RComplex<REALT>*                 buf;
+    };
+
+    //! Pack the half spinors of a face, sites [lo,hi) of its send list
+    static void packLoop(int lo, int hi, int myId, KernelArgs* a);
+
+    //! Dslash on the sites [lo,hi) of a site list
+    static void siteLoop(int lo, int hi, int myId, KernelArgs* a);
+
+  protected:
+    //! Get the anisotropy parameters
+    const multi1d<Real>& getCoeffs() const {return coeffs;}
+
+  private:
+    // Hide copies, the message handles are owned
+    CommOverlapWilsonDslashT(const CommOverlapWilsonDslashT&) {}
+    void operator=(const CommOverlapWilsonDslashT&) {}
+
+    //! Site tables, faces and message handles
+    void setup();
+
+    //! Free the message handles
+    void freeComms();
+
+    //! Read the spin structure of the gamma matrices
+    void makeSpinProjectors();
+
+    //! Half spinor h = (1 + sign gamma_mu) psi on the pairs of spin components
+    inline void project(RComplex<REALT> h[2][Nc], const RComplex<REALT>* psi, int mu, REALT sign) const;
+
+    //! uh = U h  or  uh = U^dag h
+    static inline void mult(RComplex<REALT> uh[2][Nc], const RComplex<REALT>* u, bool dag,
+			    const RComplex<REALT> h[2][Nc]);
+
+    //! Add the reconstructed spinor of uh to acc
+    inline void accumulate(RComplex<REALT> acc[Ns][Nc], const RComplex<REALT>* uh, int mu, REALT sign) const;
+
+    //! The hops leaving the node of one output checkerboard, direction and hop
+    struct Face
+    {
+      std::vector<int>              send_sites;   /*!< sites whose half spinors are sent */
+      int                           nrecv;        /*!< half spinors received */
+      std::vector< RComplex<REALT> > send_buf;
+      std::vector< RComplex<REALT> > recv_buf;
+#if defined(ARCH_PARSCALAR)
+      QMP_msgmem_t                  msg[2];
+      QMP_msghandle_t               mh;
+#endif
+    };
+
+    multi1d<Real> coeffs;  /*!< Nd array of coefficients of terms in the action */
+    Handle< FermBC<T,P,Q> >  fbc;
+    Q  u;
+
+    //! The spin components paired by (1 +- gamma_mu), and gamma_mu psi (s) = phase[mu][s] psi(perm[mu][s])
+    int                pair[Nd][2];
+    int                perm[Nd][Ns];
+    RComplex<REALT>    phase[Nd][Ns];
+
+    std::vector<int>   interior[2];   /*!< output sites with all neighbours on the node */
+    std::vector<int>   boundary[2];   /*!< the other output sites */
+    std::vector<int>   nbr;           /*!< per site and 2*Nd hops the neighbour site, or -1 - index in the face */
+
+    mutable Face       face[2][Nd][2];
+    bool               comms_declared;
+
+    mutable Timings    timings;
+  };
+
+
+  //! Empty constructor
+  template<typename T, typename P, typename Q>
+  CommOverlapWilsonDslashT<T,P,Q>::CommOverlapWilsonDslashT() : comms_declared(false)
+  {
+    resetTimings();
+  }
+
+  //! Full constructor
+  template<typename T, typename P, typename Q>
+  CommOverlapWilsonDslashT<T,P,Q>::CommOverlapWilsonDslashT(Handle< FermState<T,P,Q> > state) :
+    comms_declared(false)
+  {
+    create(state);
+  }
+
+  //! Full constructor with anisotropy
+  template<typename T, typename P, typename Q>
+  CommOverlapWilsonDslashT<T,P,Q>::CommOverlapWilsonDslashT(Handle< FermState<T,P,Q> > state,
+							    const AnisoParam_t& aniso_) :
+    comms_declared(false)
+  {
+    create(state, aniso_);
+  }
+
+  //! Full constructor with general coefficients
+  template<typename T, typename P, typename Q>
+  CommOverlapWilsonDslashT<T,P,Q>::CommOverlapWilsonDslashT(Handle< FermState<T,P,Q> > state,
+							    const multi1d<Real>& coeffs_) :
+    comms_declared(false)
+  {
+    create(state, coeffs_);
+  }
+
+  //! Print the timings and free the message handles
+  template<typename T, typename P, typename Q>
+  CommOverlapWilsonDslashT<T,P,Q>::~CommOverlapWilsonDslashT()
+  {
+    if (timings.calls > 0)
+    {
+      QDPIO::cout << "CommOverlapWilsonDslash: " << timings.calls << " applications, time (secs):"
+		  << " pack= " << timings.pack
+		  << " interior= " << timings.interior
+		  << " wait= " << timings.wait
+		  << " boundary= " << timings.boundary << std::endl;
+    }
+    freeComms();
+  }
+
+  //! Creation routine
+  template<typename T, typename P, typename Q>
+  void CommOverlapWilsonDslashT<T,P,Q>::create(Handle< FermState<T,P,Q> > state)
+  {
+    multi1d<Real> cf(Nd);
+    cf = 1.0;
+    create(state, cf);
+  }
+
+  //! Creation routine with anisotropy
+  template<typename T, typename P, typename Q>
+  void CommOverlapWilsonDslashT<T,P,Q>::create(Handle< FermState<T,P,Q> > state,
+					       const AnisoParam_t& anisoParam)
+  {
+    START_CODE();
+
+    create(state, makeFermCoeffs(anisoParam));
+
+    END_CODE();
+  }
+
+  //! Full constructor with general coefficients
+  template<typename T, typename P, typename Q>
+  void CommOverlapWilsonDslashT<T,P,Q>::create(Handle< FermState<T,P,Q> > state,
+					       const multi1d<Real>& coeffs_)
+  {
+    START_CODE();
+
+    if (Ns != 4)
+    {
+      QDPIO::cerr << "CommOverlapWilsonDslash: only implemented for Ns=4" << std::endl;
+      QDP_abort(1);
+    }
+
+    // Save a copy of the aniso params original fields and with aniso folded in
+    coeffs = coeffs_;
+
+    // Save a copy of the fermbc
+    fbc = state->getFermBC();
+
+    // Sanity check
+    if (fbc.operator->() == 0)
+    {
+      QDPIO::cerr << "CommOverlapWilsonDslash: error: fbc is null" << std::endl;
+      QDP_abort(1);
+    }
+
+    u.resize(Nd);
+
+    // Fold in anisotropy
+    for(int mu=0; mu < u.size(); ++mu) {
+      u[mu] = (state->getLinks())[mu];
+    }
+
+    // Rescale the u fields by the anisotropy
+    for(int mu=0; mu < u.size(); ++mu)
+    {
+      u[mu] *= coeffs[mu];
+    }
+
+    makeSpinProjectors();
+    setup();
+    resetTimings();
+
+    END_CODE();
+  }
+
+
+  //! Zero the timings
+  template<typename T, typename P, typename Q>
+  void CommOverlapWilsonDslashT<T,P,Q>::resetTimings() const
+  {
+    timings.pack = timings.interior = timings.wait = timings.boundary = 0;
+    timings.calls = 0;
+  }
+
+
+  //! Read the spin structure of the gamma matrices
+  template<typename T, typename P, typename Q>
+  void CommOverlapWilsonDslashT<T,P,Q>::makeSpinProjectors()
+  {
+    SpinMatrix g_one = 1.0;
+
+    for(int mu=0; mu < Nd; ++mu)
+    {
+      SpinMatrix g = Gamma(1 << mu) * g_one;
+
+      for(int s=0; s < Ns; ++s)
+      {
+	perm[mu][s] = -1;
+	for(int t=0; t < Ns; ++t)
+	{
+	  Complex z = peekSpin(g, s, t);
+	  double re = toDouble(real(z));
+	  double im = toDouble(imag(z));
+
+	  if (re*re + im*im > 0.5)
+	  {
+	    perm[mu][s] = t;
+	    phase[mu][s] = RComplex<REALT>(REALT(re), REALT(im));
+	  }
+	}
+
+	if (perm[mu][s] < 0 || perm[mu][s] == s)
+	{
+	  QDPIO::cerr << "CommOverlapWilsonDslash: gamma_" << mu << " is not an off-diagonal permutation" << std::endl;
+	  QDP_abort(1);
+	}
+      }
+
+      int np = 0;
+      for(int s=0; s < Ns; ++s)
+	if (perm[mu][s] > s)
+	  pair[mu][np++] = s;
+    }
+  }
+
+
+  //! Site tables, faces and message handles
+  template<typename T, typename P, typename Q>
+  void CommOverlapWilsonDslashT<T,P,Q>::setup()
+  {
+    freeComms();
+
+    const int me = Layout::nodeNumber();
+    const multi1d<int>& latt = Layout::lattSize();
+    const int nsites = Layout::sitesOnNode();
+
+    nbr.assign(2*Nd*nsites, 0);
+
+    for(int cb=0; cb < 2; ++cb)
+    {
+      interior[cb].clear();
+      boundary[cb].clear();
+
+      // Output sites, and the hops leaving the node. The received half
+      // spinors are ordered by the output site.
+      std::vector<int> recv_sites[Nd][2];
+
+      const int* tab = rb[cb].siteTable().slice();
+      for(int j=0; j < rb[cb].numSiteTable(); ++j)
+      {
+	const int x = tab[j];
+	const multi1d<int> xc = Layout::siteCoords(me, x);
+	bool inner = true;
+
+	for(int mu=0; mu < Nd; ++mu)
+	  for(int dir=0; dir < 2; ++dir)
+	  {
+	    multi1d<int> yc = xc;
+	    yc[mu] = (yc[mu] + ((dir == 0) ? 1 : -1) + latt[mu]) % latt[mu];
+
+	    if (Layout::nodeNumber(yc) == me)
+	      nbr[2*Nd*x + 2*mu + dir] = Layout::linearSiteIndex(yc);
+	    else
+	    {
+	      recv_sites[mu][dir].push_back(x);
+	      inner = false;
+	    }
+	  }
+
+	if (inner)
+	  interior[cb].push_back(x);
+	else
+	  boundary[cb].push_back(x);
+      }
+
+      for(int mu=0; mu < Nd; ++mu)
+	for(int dir=0; dir < 2; ++dir)
+	{
+	  std::vector<int>& rs = recv_sites[mu][dir];
+	  std::sort(rs.begin(), rs.end());
+	  for(int i=0; i < rs.size(); ++i)
+	    nbr[2*Nd*rs[i] + 2*mu + dir] = -1 - i;
+
+	  Face& f = face[cb][mu][dir];
+	  f.nrecv = rs.size();
+	  f.recv_buf.resize(2*Nc*f.nrecv);
+	}
+
+      // The sites whose half spinors the neighbour nodes need, in the
+      // order of the output sites there
+      const int* otab = rb[1-cb].siteTable().slice();
+      for(int mu=0; mu < Nd; ++mu)
+	for(int dir=0; dir < 2; ++dir)
+	{
+	  std::vector< std::pair<int,int> > send;
+	  for(int j=0; j < rb[1-cb].numSiteTable(); ++j)
+	  {
+	    const int y = otab[j];
+	    multi1d<int> xc = Layout::siteCoords(me, y);
+	    xc[mu] = (xc[mu] + ((dir == 0) ? -1 : 1) + latt[mu]) % latt[mu];
+
+	    if (Layout::nodeNumber(xc) != me)
+	      send.push_back(std::make_pair(Layout::linearSiteIndex(xc), y));
+	  }
+	  std::sort(send.begin(), send.end());
+
+	  Face& f = face[cb][mu][dir];
+	  f.send_sites.resize(send.size());
+	  for(int i=0; i < send.size(); ++i)
+	    f.send_sites[i] = send[i].second;
+	  f.send_buf.resize(2*Nc*send.size());
+
+	  if (f.send_sites.size() != f.nrecv)
+	  {
+	    QDPIO::cerr << "CommOverlapWilsonDslash: faces do not match in direction " << mu << std::endl;
+	    QDP_abort(1);
+	  }
+	}
+    }
+
+#if defined(ARCH_PARSCALAR)
+    // Forward hops receive from the node in +mu and send to the one in -mu,
+    // backward hops the other way round
+    for(int cb=0; cb < 2; ++cb)
+      for(int mu=0; mu < Nd; ++mu)
+	for(int dir=0; dir < 2; ++dir)
+	{
+	  Face& f = face[cb][mu][dir];
+	  if (f.nrecv == 0)
+	    continue;
+
+	  const int from = (dir == 0) ? +1 : -1;
+	  const size_t nbytes = f.nrecv*2*Nc*sizeof(RComplex<REALT>);
+
+	  f.msg[0] = QMP_declare_msgmem(&(f.recv_buf[0]), nbytes);
+	  f.msg[1] = QMP_declare_msgmem(&(f.send_buf[0]), nbytes);
+
+	  QMP_msghandle_t mh[2];
+	  mh[0] = QMP_declare_receive_relative(f.msg[0], mu, from, 0);
+	  mh[1] = QMP_declare_send_relative(f.msg[1], mu, -from, 0);
+	  f.mh = QMP_declare_multiple(mh, 2);
+
+	  if (f.msg[0] == 0 || f.msg[1] == 0 || mh[0] == 0 || mh[1] == 0 || f.mh == 0)
+	  {
+	    QDPIO::cerr << "CommOverlapWilsonDslash: failed to declare the messages" << std::endl;
+	    QDP_abort(1);
+	  }
+	}
+#endif
+    comms_declared = true;
+  }
+
+
+  //! Free the message handles
+  template<typename T, typename P, typename Q>
+  void CommOverlapWilsonDslashT<T,P,Q>::freeComms()
+  {
+    if (! comms_declared)
+      return;
+
+#if defined(ARCH_PARSCALAR)
+    for(int cb=0; cb < 2; ++cb)
+      for(int mu=0; mu < Nd; ++mu)
+	for(int dir=0; dir < 2; ++dir)
+	{
+	  Face& f = face[cb][mu][dir];
+	  if (f.nrecv == 0)
+	    continue;
+
+	  QMP_free_msghandle(f.mh);
+	  QMP_free_msgmem(f.msg[1]);
+	  QMP_free_msgmem(f.msg[0]);
+	}
+#endif
+    comms_declared = false;
+  }
+
+
+  //! Half spinor h = (1 + sign gamma_mu) psi on the pairs of spin components
+  template<typename T, typename P, typename Q>
+  inline void CommOverlapWilsonDslashT<T,P,Q>::project(RComplex<REALT> h[2][Nc], const RComplex<REALT>* psi,
+						       int mu, REALT sign) const
+  {
+    for(int p=0; p < 2; ++p)
+    {
+      const int t  = pair[mu][p];
+      const int tp = perm[mu][t];
+      const RComplex<REALT> ph(sign*phase[mu][t].real(), sign*phase[mu][t].imag());
+
+      for(int c=0; c < Nc; ++c)
+	h[p][c] = psi[t*Nc + c] + ph*psi[tp*Nc + c];
+    }
+  }
+
+
+  //! uh = U h  or  uh = U^dag h
+  template<typename T, typename P, typename Q>
+  inline void CommOverlapWilsonDslashT<T,P,Q>::mult(RComplex<REALT> uh[2][Nc], const RComplex<REALT>* u, bool dag,
+						    const RComplex<REALT> h[2][Nc])
+  {
+    for(int p=0; p < 2; ++p)
+      for(int c=0; c < Nc; ++c)
+      {
+	RComplex<REALT> s(REALT(0), REALT(0));
+	if (dag)
+	  for(int k=0; k < Nc; ++k)
+	    s += conj(u[k*Nc + c]) * h[p][k];
+	else
+	  for(int k=0; k < Nc; ++k)
+	    s += u[c*Nc + k] * h[p][k];
+	uh[p][c] = s;
+      }
+  }
+
+
+  //! Add the reconstructed spinor of uh to acc
+  template<typename T, typename P, typename Q>
+  inline void CommOverlapWilsonDslashT<T,P,Q>::accumulate(RComplex<REALT> acc[Ns][Nc], const RComplex<REALT>* uh,
+							  int mu, REALT sign) const
+  {
+    for(int p=0; p < 2; ++p)
+    {
+      const int t  = pair[mu][p];
+      const int tp = perm[mu][t];
+      const RComplex<REALT> php(sign*phase[mu][tp].real(), sign*phase[mu][tp].imag());
+
+      for(int c=0; c < Nc; ++c)
+      {
+	acc[t][c]  += uh[p*Nc + c];
+	acc[tp][c] += php * uh[p*Nc + c];
+      }
+    }
+  }
+
+
+  //! Pack the half spinors of a face
+  template<typename T, typename P, typename Q>
+  void CommOverlapWilsonDslashT<T,P,Q>::packLoop(int lo, int hi, int myId, KernelArgs* a)
+  {
+    const CommOverlapWilsonDslashT& d = *(a->d);
+    const int mu = a->mu;
+    const int ns = Ns*Nc;
+
+    for(int i=lo; i < hi; ++i)
+    {
+      const int y = a->sites[i];
+
+      RComplex<REALT> h[2][Nc];
+      d.project(h, a->psi + ns*y, mu, a->sign[a->dir]);
+
+      RComplex<REALT>* out = a->buf + 2*Nc*i;
+      if (a->dir == 0)
+      {
+	// Forward hop, the link is applied at the output site
+	for(int p=0; p < 2; ++p)
+	  for(int c=0; c < Nc; ++c)
+	    out[p*Nc + c] = h[p][c];
+      }
+      else
+      {
+	// Backward hop, U^dag(y) is on this node
+	RComplex<REALT> uh[2][Nc];
+	mult(uh, (const RComplex<REALT>*)&(d.u[mu].elem(y).elem().elem(0,0)), true, h);
+	for(int p=0; p < 2; ++p)
+	  for(int c=0; c < Nc; ++c)
+	    out[p*Nc + c] = uh[p][c];
+      }
+    }
+  }
+
+
+  //! Dslash on the sites [lo,hi) of a site list
+  template<typename T, typename P, typename Q>
+  void CommOverlapWilsonDslashT<T,P,Q>::siteLoop(int lo, int hi, int myId, KernelArgs* a)
+  {
+    const CommOverlapWilsonDslashT& d = *(a->d);
+    const int ns = Ns*Nc;
+
+    for(int i=lo; i < hi; ++i)
+    {
+      const int x = a->sites[i];
+
+      RComplex<REALT> acc[Ns][Nc];
+      for(int s=0; s < Ns; ++s)
+	for(int c=0; c < Nc; ++c)
+	  acc[s][c] = RComplex<REALT>(REALT(0), REALT(0));
+
+      for(int mu=0; mu < Nd; ++mu)
+      {
+	RComplex<REALT> h[2][Nc];
+	RComplex<REALT> uh[2][Nc];
+
+	// U_mu(x) (1 + sign gamma_mu) psi(x+mu)
+	const int fw = d.nbr[2*Nd*x + 2*mu];
+	if (fw >= 0)
+	  d.project(h, a->psi + ns*fw, mu, a->sign[0]);
+	else
+	{
+	  const RComplex<REALT>* r = &(d.face[a->cb][mu][0].recv_buf[2*Nc*(-1 - fw)]);
+	  for(int p=0; p < 2; ++p)
+	    for(int c=0; c < Nc; ++c)
+	      h[p][c] = r[p*Nc + c];
+	}
+	mult(uh, (const RComplex<REALT>*)&(d.u[mu].elem(x).elem().elem(0,0)), false, h);
+	d.accumulate(acc, &(uh[0][0]), mu, a->sign[0]);
+
+	// U_mu^dag(x-mu) (1 + sign gamma_mu) psi(x-mu)
+	const int bw = d.nbr[2*Nd*x + 2*mu + 1];
+	if (bw >= 0)
+	{
+	  d.project(h, a->psi + ns*bw, mu, a->sign[1]);
+	  mult(uh, (const RComplex<REALT>*)&(d.u[mu].elem(bw).elem().elem(0,0)), true, h);
+	  d.accumulate(acc, &(uh[0][0]), mu, a->sign[1]);
+	}
+	else
+	{
+	  d.accumulate(acc, &(d.face[a->cb][mu][1].recv_buf[2*Nc*(-1 - bw)]), mu, a->sign[1]);
+	}
+      }
+
+      RComplex<REALT>* o = a->chi + ns*x;
+      for(int s=0; s < Ns; ++s)
+	for(int c=0; c < Nc; ++c)
+	  o[s*Nc + c] = acc[s][c];
+    }
+  }
+
+
+  //! General Wilson-Dirac dslash
+  /*! \ingroup linop
+   * Wilson dslash
+   *
+   * Arguments:
+   *
+   *  \param chi	      Result				                (Write)
+   *  \param psi	      Pseudofermion field				(Read)
+   *  \param isign      D'^dag or D' ( MINUS | PLUS ) resp.		(Read)
+   *  \param cb	      Checkerboard of OUTPUT std::vector			(Read)
+   */
+  template<typename T, typename P, typename Q>
+  void
+  CommOverlapWilsonDslashT<T,P,Q>::apply (T& chi, const T& psi,
+					  enum PlusMinus isign, int cb) const
+  {
+    START_CODE();
+
+    StopWatch swatch;
+
+    KernelArgs a;
+    a.d   = this;
+    a.cb  = cb;
+    a.sign[0] = (isign == PLUS) ? REALT(-1) : REALT(1);
+    a.sign[1] = -a.sign[0];
+    a.chi = (RComplex<REALT>*)&(chi.elem(0).elem(0).elem(0));
+    a.psi = (const RComplex<REALT>*)&(psi.elem(0).elem(0).elem(0));
+
+    // Pack and start the faces
+    swatch.reset(); swatch.start();
+    for(int mu=0; mu < Nd; ++mu)
+      for(int dir=0; dir < 2; ++dir)
+      {
+	Face& f = face[cb][mu][dir];
+	if (f.nrecv == 0)
+	  continue;
+
+	a.mu    = mu;
+	a.dir   = dir;
+	a.sites = &(f.send_sites[0]);
+	a.buf   = &(f.send_buf[0]);
+	dispatch_to_threads(f.send_sites.size(), a, packLoop);
+
+#if defined(ARCH_PARSCALAR)
+	if (QMP_start(f.mh) != QMP_SUCCESS)
+	{
+	  QDPIO::cerr << "CommOverlapWilsonDslash: QMP_start failed" << std::endl;
+	  QDP_abort(1);
+	}
+#endif
+      }
+    swatch.stop();
+    timings.pack += swatch.getTimeInSeconds();
+
+    // Interior sites while the faces are in flight
+    swatch.reset(); swatch.start();
+    if (! interior[cb].empty())
+    {
+      a.sites = &(interior[cb][0]);
+      dispatch_to_threads(interior[cb].size(), a, siteLoop);
+    }
+    swatch.stop();
+    timings.interior += swatch.getTimeInSeconds();
+
+    // Wait for the faces
+    swatch.reset(); swatch.start();
+#if defined(ARCH_PARSCALAR)
+    for(int mu=0; mu < Nd; ++mu)
+      for(int dir=0; dir < 2; ++dir)
+      {
+	Face& f = face[cb][mu][dir];
+	if (f.nrecv > 0 && QMP_wait(f.mh) != QMP_SUCCESS)
+	{
+	  QDPIO::cerr << "CommOverlapWilsonDslash: QMP_wait failed" << std::endl;
+	  QDP_abort(1);
+	}
+      }
+#endif
+    swatch.stop();
+    timings.wait += swatch.getTimeInSeconds();
+
+    // Boundary sites from the received half spinors
+    swatch.reset(); swatch.start();
+    if (! boundary[cb].empty())
+    {
+      a.sites = &(boundary[cb][0]);
+      dispatch_to_threads(boundary[cb].size(), a, siteLoop);
+    }
+    swatch.stop();
+    timings.boundary += swatch.getTimeInSeconds();
+
+    ++timings.calls;
+
+    getFermBC().modifyF(chi, QDP::rb[cb]);
+
+    END_CODE();
+  }
+
+
+  typedef CommOverlapWilsonDslashT<LatticeFermion,
+				   multi1d<LatticeColorMatrix>,
+				   multi1d<LatticeColorMatrix> > CommOverlapWilsonDslash;
+
+  typedef CommOverlapWilsonDslashT<LatticeFermionF,
+				   multi1d<LatticeColorMatrixF>,
+				   multi1d<LatticeColorMatrixF> > CommOverlapWilsonDslashF;
+
+  typedef CommOverlapWilsonDslashT<LatticeFermionD,
+				   multi1d<LatticeColorMatrixD>,
+				   multi1d<LatticeColorMatrixD> > CommOverlapWilsonDslashD;
+#endif
+
+} // End Namespace Chroma
+
+
+#endif
@@ -9,6 +9,7 @@
 #include "state.h"
 #include "io/aniso_io.h"
 #include "actions/ferm/linop/lwldslash_base_w.h"
+#include "actions/ferm/linop/compressed_links_w.h"
 
 
 namespace Chroma 
@@ -73,6 +74,17 @@ namespace Chroma
     void create(Handle< FermState<T,P,Q> > state, 
 		const multi1d<Real>& coeffs_);
 
+    //! Creation routine with anisotropy and compressed links
+    /*! link_params is 18 (full links), 12 or 8, see CompressedLinksT */
+    void create(Handle< FermState<T,P,Q> > state,
+		const AnisoParam_t& aniso_,
+		int link_params);
+
+    //! Creation routine with general coefficients and compressed links
+    void create(Handle< FermState<T,P,Q> > state, 
+		const multi1d<Real>& coeffs_,
+		int link_params);
+
     //! No real need for cleanup here
     ~QDPWilsonDslashT() {}
 
@@ -96,9 +108,15 @@ namespace Chroma
     const multi1d<Real>& getCoeffs() const {return coeffs;}
 
   private:
+    //! Dslash with the compressed links
+    void applyCompressed(T& chi, const T& psi, enum PlusMinus isign, int cb) const;
+
     multi1d<Real> coeffs;  /*!< Nd array of coefficients of terms in the action */
     Handle< FermBC<T,P,Q> >  fbc;
     Q  u;
+#ifndef QDP_IS_QDPJIT
+    CompressedLinksT<T,Q>  links;  /*!< replace u if compressed */
+#endif
   };
 
   //! General Wilson-Dirac dslash
@@ -181,6 +199,24 @@ namespace Chroma
   template<typename T, typename P, typename Q>
   void QDPWilsonDslashT<T,P,Q>::create(Handle< FermState<T,P,Q> > state,
 			       const multi1d<Real>& coeffs_)
+  {
+    create(state, coeffs_, 18);
+  }
+
+  //! Creation routine with anisotropy and compressed links
+  template<typename T, typename P, typename Q>
+  void QDPWilsonDslashT<T,P,Q>::create(Handle< FermState<T,P,Q> > state,
+			       const AnisoParam_t& anisoParam,
+			       int link_params) 
+  {
+    create(state, makeFermCoeffs(anisoParam), link_params);
+  }
+
+  //! Creation routine with general coefficients and compressed links
+  template<typename T, typename P, typename Q>
+  void QDPWilsonDslashT<T,P,Q>::create(Handle< FermState<T,P,Q> > state,
+			       const multi1d<Real>& coeffs_,
+			       int link_params)
   {
     //QDPIO::cout << "Setting up QDP Wilson Dslash\n";
 
@@ -204,6 +240,22 @@ namespace Chroma
       u[mu] = (state->getLinks())[mu];
     }
   
+#ifndef QDP_IS_QDPJIT
+    // The compressed links carry the anisotropy themselves
+    links.create(u, coeffs, link_params);
+    if (links.numParams() != 18)
+    {
+      u.resize(0);
+      return;
+    }
+#else
+    if (link_params != 18)
+    {
+      QDPIO::cerr << "QDPWilsonDslash: no compressed links with QDP-JIT" << std::endl;
+      QDP_abort(1);
+    }
+#endif
+
     // Rescale the u fields by the anisotropy
     for(int mu=0; mu < u.size(); ++mu)
     {
@@ -228,6 +280,14 @@ namespace Chroma
   QDPWilsonDslashT<T,P,Q>::apply (T& chi, const T& psi, 
 			  enum PlusMinus isign, int cb) const
   {
+#ifndef QDP_IS_QDPJIT
+    if (links.numParams() != 18)
+    {
+      applyCompressed(chi, psi, isign, cb);
+      return;
+    }
+#endif
+
     START_CODE();
 #if (QDP_NC == 2) || (QDP_NC == 3)
     /*     F 
@@ -302,6 +362,125 @@ namespace Chroma
     END_CODE();
   }
 
+  //! Dslash with the compressed links
+  /*!
+   * The same as apply, hop by hop on half fermions so that the link
+   * multiplies run over the compressed links. Only for Nd=4.
+   */
+  template<typename T, typename P, typename Q>
+  void 
+  QDPWilsonDslashT<T,P,Q>::applyCompressed (T& chi, const T& psi, 
+				    enum PlusMinus isign, int cb) const
+  {
+#if ! defined(QDP_IS_QDPJIT) && (QDP_NC == 3) && (QDP_ND == 4)
+    START_CODE();
+
+    int otherCB = (cb == 0 ? 1 : 0);
+
+    typename HalfFermionType<T>::Type_t tmp;
+    typename HalfFermionType<T>::Type_t tmp2;
+    typename HalfFermionType<T>::Type_t tmp3;
+
+    switch (isign)
+    {
+    case PLUS:
+      {
+	tmp[rb[otherCB]] = spinProjectDir0Minus(psi);
+	tmp2[rb[cb]] = shift(tmp, FORWARD, 0);
+	links.mult(tmp3, tmp2, 0, false, rb[cb]);
+	chi[rb[cb]] = spinReconstructDir0Minus(tmp3);
+
+	tmp[rb[otherCB]] = spinProjectDir1Minus(psi);
+	tmp2[rb[cb]] = shift(tmp, FORWARD, 1);
+	links.mult(tmp3, tmp2, 1, false, rb[cb]);
+	chi[rb[cb]] += spinReconstructDir1Minus(tmp3);
+
+	tmp[rb[otherCB]] = spinProjectDir2Minus(psi);
+	tmp2[rb[cb]] = shift(tmp, FORWARD, 2);
+	links.mult(tmp3, tmp2, 2, false, rb[cb]);
+	chi[rb[cb]] += spinReconstructDir2Minus(tmp3);
+
+	tmp[rb[otherCB]] = spinProjectDir3Minus(psi);
+	tmp2[rb[cb]] = shift(tmp, FORWARD, 3);
+	links.mult(tmp3, tmp2, 3, false, rb[cb]);
+	chi[rb[cb]] += spinReconstructDir3Minus(tmp3);
+
+	tmp[rb[otherCB]] = spinProjectDir0Plus(psi);
+	links.mult(tmp3, tmp, 0, true, rb[otherCB]);
+	tmp2[rb[cb]] = shift(tmp3, BACKWARD, 0);
+	chi[rb[cb]] += spinReconstructDir0Plus(tmp2);
+
+	tmp[rb[otherCB]] = spinProjectDir1Plus(psi);
+	links.mult(tmp3, tmp, 1, true, rb[otherCB]);
+	tmp2[rb[cb]] = shift(tmp3, BACKWARD, 1);
+	chi[rb[cb]] += spinReconstructDir1Plus(tmp2);
+
+	tmp[rb[otherCB]] = spinProjectDir2Plus(psi);
+	links.mult(tmp3, tmp, 2, true, rb[otherCB]);
+	tmp2[rb[cb]] = shift(tmp3, BACKWARD, 2);
+	chi[rb[cb]] += spinReconstructDir2Plus(tmp2);
+
+	tmp[rb[otherCB]] = spinProjectDir3Plus(psi);
+	links.mult(tmp3, tmp, 3, true, rb[otherCB]);
+	tmp2[rb[cb]] = shift(tmp3, BACKWARD, 3);
+	chi[rb[cb]] += spinReconstructDir3Plus(tmp2);
+      }
+      break;
+
+    case MINUS:
+      {
+	tmp[rb[otherCB]] = spinProjectDir0Plus(psi);
+	tmp2[rb[cb]] = shift(tmp, FORWARD, 0);
+	links.mult(tmp3, tmp2, 0, false, rb[cb]);
+	chi[rb[cb]] = spinReconstructDir0Plus(tmp3);
+
+	tmp[rb[otherCB]] = spinProjectDir1Plus(psi);
+	tmp2[rb[cb]] = shift(tmp, FORWARD, 1);
+	links.mult(tmp3, tmp2, 1, false, rb[cb]);
+	chi[rb[cb]] += spinReconstructDir1Plus(tmp3);
+
+	tmp[rb[otherCB]] = spinProjectDir2Plus(psi);
+	tmp2[rb[cb]] = shift(tmp, FORWARD, 2);
+	links.mult(tmp3, tmp2, 2, false, rb[cb]);
+	chi[rb[cb]] += spinReconstructDir2Plus(tmp3);
+
+	tmp[rb[otherCB]] = spinProjectDir3Plus(psi);
+	tmp2[rb[cb]] = shift(tmp, FORWARD, 3);
+	links.mult(tmp3, tmp2, 3, false, rb[cb]);
+	chi[rb[cb]] += spinReconstructDir3Plus(tmp3);
+
+	tmp[rb[otherCB]] = spinProjectDir0Minus(psi);
+	links.mult(tmp3, tmp, 0, true, rb[otherCB]);
+	tmp2[rb[cb]] = shift(tmp3, BACKWARD, 0);
+	chi[rb[cb]] += spinReconstructDir0Minus(tmp2);
+
+	tmp[rb[otherCB]] = spinProjectDir1Minus(psi);
+	links.mult(tmp3, tmp, 1, true, rb[otherCB]);
+	tmp2[rb[cb]] = shift(tmp3, BACKWARD, 1);
+	chi[rb[cb]] += spinReconstructDir1Minus(tmp2);
+
+	tmp[rb[otherCB]] = spinProjectDir2Minus(psi);
+	links.mult(tmp3, tmp, 2, true, rb[otherCB]);
+	tmp2[rb[cb]] = shift(tmp3, BACKWARD, 2);
+	chi[rb[cb]] += spinReconstructDir2Minus(tmp2);
+
+	tmp[rb[otherCB]] = spinProjectDir3Minus(psi);
+	links.mult(tmp3, tmp, 3, true, rb[otherCB]);
+	tmp2[rb[cb]] = shift(tmp3, BACKWARD, 3);
+	chi[rb[cb]] += spinReconstructDir3Minus(tmp2);
+      }
+      break;
+    }
+
+    QDPWilsonDslashT<T,P,Q>::getFermBC().modifyF(chi, QDP::rb[cb]);
+
+    END_CODE();
+#else
+    QDPIO::cerr << "lwldslash_w: compressed links need Nc=3 and Nd=4" << std::endl;
+    QDP_abort(1);
+#endif
+  }
+
   typedef QDPWilsonDslashT<LatticeFermion,
 			   multi1d<LatticeColorMatrix>,
 			   multi1d<LatticeColorMatrix> > QDPWilsonDslash;
@@ -24,6 +24,13 @@ namespace Chroma
     u = fs->getLinks();
     param = param_;
 
+    // Only EvenOddPrecCloverLinOp reads compressed links
+    if (param.link_params != 18)
+    {
+      QDPIO::cerr << "UnprecW12LinOp: LinkCompression is not supported by this operator" << std::endl;
+      QDP_abort(1);
+    }
+
     A.create(fs, param); // Unaltered fields for clover
 
     if (Nd != 4)
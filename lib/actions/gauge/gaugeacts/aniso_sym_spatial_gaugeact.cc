@@ -10,6 +10,7 @@
 #include "actions/gauge/gaugeacts/gaugeact_factory.h"
 #include "actions/gauge/gaugestates/gauge_createstate_aggregate.h"
 #include "actions/gauge/gaugeacts/aniso_sym_shared_functions.h"
+#include "actions/gauge/gaugeacts/plaq_rect_force.h"
 
 #include <cstdio>
 
@@ -94,45 +95,19 @@ namespace Chroma
   {
     START_CODE();
 
-    const multi1d<LatticeColorMatrix>& u_bc = state->getLinks();
-    multi1d<LatticeColorMatrix> ds_tmp(Nd);
-    result.resize(Nd);
-    for(int mu =0; mu < Nd; mu++) { 
-      result[mu] = zero;
-      ds_tmp[mu] = zero;
-    }
-    
-
-
-
+    // Space-space plaquettes, and rectangles with both directions spatial
+    PlaqRectForce force;
     for(int mu = 0; mu < Nd; mu++) { 
       for(int nu = 0 ; nu < Nd; nu++) { 
-
-	// mu and nu both have to be spatial and not equal to each other
-	// It is OK to accumulate into ds_tmp
 	if( ( mu != nu ) && (mu != param.aniso.t_dir) 
 	    && (nu != param.aniso.t_dir ) ) {
-
-
-	  AnisoSym::deriv_part(mu, 
-			       nu, 
-			       param.aniso.t_dir,
-			       plaq_c_s, 
-			       rect_c_s, 
-			       true,
-			       ds_tmp,
-			       u_bc);
-
-
-	  
+	  force.setPlaq(mu, nu, plaq_c_s);
+	  force.setRect(mu, nu, rect_c_s);
 	}
       }
     }
 
-    // Close loops
-    for(int mu=0 ; mu < Nd; mu++) { 
-      result[mu] = u_bc[mu]*ds_tmp[mu];
-    }
+    force.deriv(result, state->getLinks());
 
     // Apply boundaries
     getGaugeBC().zero(result);
@@ -8,6 +8,7 @@
 #include "actions/gauge/gaugestates/gauge_createstate_aggregate.h"
 
 #include  "actions/gauge/gaugeacts/aniso_sym_shared_functions.h"
+#include "actions/gauge/gaugeacts/plaq_rect_force.h"
 namespace Chroma
 {
  
@@ -108,60 +109,20 @@ namespace Chroma
   void AnisoSymTemporalGaugeAct::deriv(multi1d<LatticeColorMatrix>& result,
 				       const Handle< GaugeState<P,Q> >& state) const
   {
-    result.resize(Nd);
-    int mu;
-    int nu;
-
-    multi1d<LatticeColorMatrix> ds_tmp(Nd);
-
-
-    const multi1d<LatticeColorMatrix>& u_bc = state->getLinks();
-    
-    for(mu=0; mu < Nd; mu++) { 
-      result[mu] =zero;
-      ds_tmp[mu]= zero;
-    }
-
-    // length 1 in the t_dir (nu = t_dir) 
-    // Accumulate into ds_tmp
-    nu = param.aniso.t_dir;
-    for(mu=0; mu < Nd; mu++) { 
-      if( mu != nu ) { 
-	AnisoSym::deriv_part(mu, 
-			     nu, 
-			     param.aniso.t_dir,
-			     plaq_c_t, 
-			     rect_c_t_2, 
-			     true,
-			     ds_tmp,
-			     u_bc);
+    START_CODE();
 
+    // Space-time plaquettes, and rectangles of length 1 in the t_dir.
+    // Rectangles of length 2 in the t_dir are omitted
+    const int t_dir = param.aniso.t_dir;
+    PlaqRectForce force;
+    for(int mu=0; mu < Nd; mu++) { 
+      if( mu != t_dir ) { 
+	force.setPlaq(mu, t_dir, plaq_c_t);
+	force.setRect(mu, t_dir, rect_c_t_2);
       }
     }
 
-
-    // length 2 in the t_dir (mu = t_dir)
-    // Accumulate into ds_tmp
-
-    mu = param.aniso.t_dir;
-    for(int nu=0; nu < Nd; nu++) { 
-      if( mu != nu ) { 
-	AnisoSym::deriv_part(mu, 
-			     nu, 
-			     param.aniso.t_dir,
-			     plaq_c_t, 
-			     rect_c_t_2, 
-			     true,
-			     ds_tmp,
-			     u_bc);
-
-      }
-    }     
-
-    // Close up the loops
-    for(int mu=0; mu < Nd; mu++) { 
-      result[mu] = u_bc[mu]*ds_tmp[mu];
-    }
+    force.deriv(result, state->getLinks());
 
     // Apply BCs
     getGaugeBC().zero(result);
@@ -10,6 +10,7 @@
 #include "gaugebc.h"
 #include "actions/gauge/gaugeacts/plaq_gaugeact.h"
 #include "actions/gauge/gaugeacts/rect_gaugeact.h"
+#include "actions/gauge/gaugeacts/plaq_rect_force.h"
 #include "actions/gauge/gaugeacts/pg_gaugeact.h"
 
 namespace Chroma
@@ -95,12 +96,10 @@ namespace Chroma
     void deriv(P& result,
 	       const Handle< GaugeState<P,Q> >& state) const
     {
-      plaq->deriv(result,state);
+      PlaqRectForce(*plaq, *rect).deriv(result, state->getLinks());
+      getGaugeBC().zero(result);
 
       multi1d<LatticeColorMatrix> tmp;
-      rect->deriv(tmp,state);
-      result += tmp;
-
       pg->deriv(tmp,state);
       result += tmp;
     }
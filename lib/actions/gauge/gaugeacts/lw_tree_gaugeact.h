@@ -10,6 +10,7 @@
 #include "gaugebc.h"
 #include "actions/gauge/gaugeacts/plaq_gaugeact.h"
 #include "actions/gauge/gaugeacts/rect_gaugeact.h"
+#include "actions/gauge/gaugeacts/plaq_rect_force.h"
 
 namespace Chroma
 {
@@ -87,11 +88,8 @@ namespace Chroma
     void deriv(multi1d<LatticeColorMatrix>& result,
 	      const Handle< GaugeState<P,Q> >& state) const
     {
-      plaq->deriv(result,state);
-
-      multi1d<LatticeColorMatrix> tmp;
-      rect->deriv(tmp,state);
-      result += tmp;
+      PlaqRectForce(*plaq, *rect).deriv(result, state->getLinks());
+      getGaugeBC().zero(result);
     }
 
     //! Compute the actions
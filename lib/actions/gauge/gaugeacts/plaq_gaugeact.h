@@ -114,6 +114,9 @@ namespace Chroma
     //! Compute the temporal part of the action given a time direction
     Double temporalS(const Handle< GaugeState<P,Q> >& state, int t_dir) const;
 
+    //! Plaquette coefficient of each plane
+    const multi2d<Real>& getCoeffs() const {return param.coeffs;}
+
     //! Destructor is automatic
     ~PlaqGaugeAct() {}
 
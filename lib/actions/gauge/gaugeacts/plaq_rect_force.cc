@@ -0,0 +1,218 @@
+/*! \file
+ *  \brief Fused plaquette plus rectangle gauge force
+ */
+
+#include "chromabase.h"
+#include "actions/gauge/gaugeacts/plaq_rect_force.h"
+
+namespace Chroma
+{
+
+  // No loops
+  PlaqRectForce::PlaqRectForce() : c_plaq(Nd,Nd), c_rect(Nd,Nd), do_plaq(Nd,Nd), do_rect(Nd,Nd)
+  {
+    c_plaq = Real(0);
+    c_rect = Real(0);
+    do_plaq = false;
+    do_rect = false;
+  }
+
+
+  // The loops of a plaquette and a rectangle action
+  PlaqRectForce::PlaqRectForce(const PlaqGaugeAct& plaq, const RectGaugeAct& rect,
+			       Planes planes) :
+    c_plaq(Nd,Nd), c_rect(Nd,Nd), do_plaq(Nd,Nd), do_rect(Nd,Nd)
+  {
+    init(&plaq, rect, planes);
+  }
+
+
+  // The loops of a rectangle action alone
+  PlaqRectForce::PlaqRectForce(const RectGaugeAct& rect, Planes planes) :
+    c_plaq(Nd,Nd), c_rect(Nd,Nd), do_plaq(Nd,Nd), do_rect(Nd,Nd)
+  {
+    init(0, rect, planes);
+  }
+
+
+  // Set the loops of the actions
+  void PlaqRectForce::init(const PlaqGaugeAct* plaq, const RectGaugeAct& rect, Planes planes)
+  {
+    c_plaq = Real(0);
+    c_rect = Real(0);
+    do_plaq = false;
+    do_rect = false;
+
+    const int t_dir = rect.tDir();
+
+    for(int mu=0; mu < Nd; ++mu)
+    {
+      for(int nu=0; nu < Nd; ++nu)
+      {
+	if (mu == nu)
+	  continue;
+
+	const bool temporal = (mu == t_dir) || (nu == t_dir);
+	if ((planes == SPATIAL_PLANES && temporal) || (planes == TEMPORAL_PLANES && ! temporal))
+	  continue;
+
+	if (plaq != 0)
+	  setPlaq(mu, nu, plaq->getCoeffs()[mu][nu]);
+
+	if (mu == t_dir)
+	{
+	  if (! rect.noTemporal21LoopsP())
+	    setRect(mu, nu, rect.getCoeffT1());
+	}
+	else if (nu == t_dir)
+	  setRect(mu, nu, rect.getCoeffT2());
+	else
+	  setRect(mu, nu, rect.getCoeffS());
+      }
+    }
+  }
+
+
+  // Include the plaquettes of the mu,nu plane
+  void PlaqRectForce::setPlaq(int mu, int nu, const Real& c)
+  {
+    c_plaq[mu][nu] = c_plaq[nu][mu] = c;
+    do_plaq[mu][nu] = do_plaq[nu][mu] = true;
+  }
+
+
+  // Include the rectangles 2 links long in mu and 1 in nu
+  void PlaqRectForce::setRect(int mu, int nu, const Real& c)
+  {
+    c_rect[mu][nu] = c;
+    do_rect[mu][nu] = true;
+  }
+
+
+  // Add the staples of the links in mu from the mu,nu plane
+  /*
+   * All the staples are written so that the ones hanging below the link
+   * are built one site up in nu, summed, and shifted back once.
+   */
+  void PlaqRectForce::linkStaples(int mu, int nu,
+				  LatticeColorMatrix& g_mu,
+				  const LatticeColorMatrix& u_mu_xplusnu,
+				  const LatticeColorMatrix& u_nu_xplusmu,
+				  const multi1d<LatticeColorMatrix>& two_link,
+				  const multi1d<LatticeColorMatrix>& u) const
+  {
+    START_CODE();
+
+    //  --<--
+    // |     |          U(x+mu,nu) U^+(x+nu,mu) U^+(x,nu)
+    // V     ^
+    // x
+    LatticeColorMatrix up_staple = u_nu_xplusmu*adj(u_mu_xplusnu)*adj(u[nu]);
+
+    // ^     |
+    // |     V          U^+(x+mu,nu) U^+(x,mu) U(x,nu), one site up in nu
+    //  --<--
+    // x
+    LatticeColorMatrix down_staple = adj(u_nu_xplusmu)*adj(u[mu])*u[nu];
+
+    // Staples below the link, summed before shifting back in nu
+    LatticeColorMatrix below = zero;
+
+    if (do_plaq[mu][nu])
+    {
+      const Real& c = c_plaq[mu][nu];
+      g_mu  += c*up_staple;
+      below += c*down_staple;
+    }
+
+    // Rectangles 2 links long in nu
+    if (do_rect[nu][mu])
+    {
+      const Real& c = c_rect[nu][mu];
+
+      // Above:  U(x+mu,nu) U(x+mu+nu,nu) U^+(x+2nu,mu) U^+(x+nu,nu) U^+(x,nu)
+      g_mu += c*(u_nu_xplusmu*shift(up_staple, FORWARD, nu)*adj(u[nu]));
+
+      // Below:  U^+(x+mu-nu,nu) U^+(x+mu-2nu,nu) U^+(x-2nu,mu) U(x-2nu,nu) U(x-nu,nu)
+      LatticeColorMatrix tmp = shift(down_staple, BACKWARD, nu);
+      below += c*(adj(u_nu_xplusmu)*tmp*u[nu]);
+    }
+
+    // Rectangles 2 links long in mu, with the link first or second along them
+    if (do_rect[mu][nu])
+    {
+      const Real& c = c_rect[mu][nu];
+
+      // U^+(x+mu+nu,mu) U^+(x+nu,mu)
+      LatticeColorMatrix two_link_adj_xplusnu = adj(shift(two_link[mu], FORWARD, nu));
+
+      // Above, link first:   U(x+mu,mu) U(x+2mu,nu) U^+(x+mu+nu,mu) U^+(x+nu,mu) U^+(x,nu)
+      LatticeColorMatrix tmp = shift(u[mu]*u_nu_xplusmu, FORWARD, mu);
+      g_mu += c*(tmp*two_link_adj_xplusnu*adj(u[nu]));
+
+      // Above, link second:  U(x+mu,nu) U^+(x+nu,mu) U^+(x-mu+nu,mu) U^+(x-mu,nu) U(x-mu,mu)
+      tmp = shift(two_link_adj_xplusnu*adj(u[nu])*u[mu], BACKWARD, mu);
+      g_mu += c*(u_nu_xplusmu*tmp);
+
+      // Below, link first:   U(x+mu,mu) U^+(x+2mu-nu,nu) U^+(x+mu-nu,mu) U^+(x-nu,mu) U(x-nu,nu)
+      tmp = shift(u_mu_xplusnu*adj(u_nu_xplusmu), FORWARD, mu);
+      below += c*(tmp*adj(two_link[mu])*u[nu]);
+
+      // Below, link second:  U^+(x+mu-nu,nu) U^+(x-nu,mu) U^+(x-mu-nu,mu) U(x-mu-nu,nu) U(x-mu,mu)
+      tmp = shift(adj(two_link[mu])*u[nu]*u_mu_xplusnu, BACKWARD, mu);
+      below += c*(adj(u_nu_xplusmu)*tmp);
+    }
+
+    g_mu += shift(below, BACKWARD, nu);
+
+    END_CODE();
+  }
+
+
+  // Compute dS/dU
+  void PlaqRectForce::deriv(multi1d<LatticeColorMatrix>& ds_u,
+			    const multi1d<LatticeColorMatrix>& u) const
+  {
+    START_CODE();
+
+    ds_u.resize(Nd);
+
+    // U(x,mu) U(x+mu,mu) for the directions rectangles are long in
+    multi1d<LatticeColorMatrix> two_link(Nd);
+    for(int mu=0; mu < Nd; ++mu)
+    {
+      bool need = false;
+      for(int nu=0; nu < Nd; ++nu)
+	need |= (mu != nu) && do_rect[mu][nu];
+
+      if (need)
+	two_link[mu] = u[mu]*shift(u[mu], FORWARD, mu);
+    }
+
+    // Sum of the staples of each link
+    multi1d<LatticeColorMatrix> g(Nd);
+    g = zero;
+
+    for(int mu=0; mu < Nd; ++mu)
+    {
+      for(int nu=mu+1; nu < Nd; ++nu)
+      {
+	if (! (do_plaq[mu][nu] || do_rect[mu][nu] || do_rect[nu][mu]))
+	  continue;
+
+	LatticeColorMatrix u_mu_xplusnu = shift(u[mu], FORWARD, nu);
+	LatticeColorMatrix u_nu_xplusmu = shift(u[nu], FORWARD, mu);
+
+	linkStaples(mu, nu, g[mu], u_mu_xplusnu, u_nu_xplusmu, two_link, u);
+	linkStaples(nu, mu, g[nu], u_nu_xplusmu, u_mu_xplusnu, two_link, u);
+      }
+    }
+
+    // Close the loops. The 1/(2Nc) is as in PlaqGaugeAct::deriv
+    for(int mu=0; mu < Nd; ++mu)
+      ds_u[mu] = (Real(-1)/Real(2*Nc))*(u[mu]*g[mu]);
+
+    END_CODE();
+  }
+
+}
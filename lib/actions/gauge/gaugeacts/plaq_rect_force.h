@@ -0,0 +1,83 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Fused plaquette plus rectangle gauge force
+ */
+
+#ifndef __plaq_rect_force_h__
+#define __plaq_rect_force_h__
+
+#include "chromabase.h"
+#include "actions/gauge/gaugeacts/plaq_gaugeact.h"
+#include "actions/gauge/gaugeacts/rect_gaugeact.h"
+
+namespace Chroma
+{
+
+  //! Force of the plaquettes and 1x2 rectangles of an improved gauge action
+  /*! \ingroup gaugeacts
+   *
+   * Computes dS/dU of
+   *
+   *   S = -1/Nc Sum_{mu<nu} cp[mu][nu] Sum Re Tr Plaq_{mu,nu}
+   *       -1/Nc Sum_{mu!=nu} cr[mu][nu] Sum Re Tr Rect_{mu,nu}
+   *
+   * where Rect_{mu,nu} is 2 links long in mu and 1 in nu, with the same
+   * normalisation as PlaqGaugeAct::deriv and RectGaugeAct::deriv, so the
+   * result equals the sum of those two. All staples of a link are summed
+   * first, sharing the products and shifts of the plaquette and both
+   * rectangle orientations of each plane, and the loops are closed with
+   * one multiplication per link at the end. The caller applies the gauge
+   * boundary conditions.
+   */
+  class PlaqRectForce
+  {
+  public:
+    //! Which planes of the actions to include
+    enum Planes {ALL_PLANES, SPATIAL_PLANES, TEMPORAL_PLANES};
+
+    //! No loops
+    PlaqRectForce();
+
+    //! The loops of a plaquette and a rectangle action
+    /*!
+     * Spatial planes are those not containing the time direction of the
+     * rectangle action, and the rectangle coefficients and omission of
+     * the rectangles 2 links long in time follow RectGaugeAct::deriv.
+     */
+    PlaqRectForce(const PlaqGaugeAct& plaq, const RectGaugeAct& rect,
+		  Planes planes = ALL_PLANES);
+
+    //! The loops of a rectangle action alone
+    PlaqRectForce(const RectGaugeAct& rect, Planes planes = ALL_PLANES);
+
+    //! Include the plaquettes of the mu,nu plane
+    void setPlaq(int mu, int nu, const Real& c);
+
+    //! Include the rectangles 2 links long in mu and 1 in nu
+    void setRect(int mu, int nu, const Real& c);
+
+    //! Compute dS/dU
+    void deriv(multi1d<LatticeColorMatrix>& ds_u,
+	       const multi1d<LatticeColorMatrix>& u) const;
+
+  private:
+    //! Set the loops of the actions. The plaquette action may be null
+    void init(const PlaqGaugeAct* plaq, const RectGaugeAct& rect, Planes planes);
+
+    //! Add the staples of the links in mu from the mu,nu plane
+    void linkStaples(int mu, int nu,
+		     LatticeColorMatrix& g_mu,
+		     const LatticeColorMatrix& u_mu_xplusnu,
+		     const LatticeColorMatrix& u_nu_xplusmu,
+		     const multi1d<LatticeColorMatrix>& two_link,
+		     const multi1d<LatticeColorMatrix>& u) const;
+
+    multi2d<Real>  c_plaq;     /*!< plaquette coefficients, symmetric */
+    multi2d<Real>  c_rect;     /*!< rectangle coefficients, [long][short] */
+    multi2d<bool>  do_plaq;
+    multi2d<bool>  do_rect;
+  };
+
+}
+
+#endif
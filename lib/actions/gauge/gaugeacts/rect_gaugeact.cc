@@ -4,6 +4,7 @@
 
 #include "chromabase.h"
 #include "actions/gauge/gaugeacts/rect_gaugeact.h"
+#include "actions/gauge/gaugeacts/plaq_rect_force.h"
 #include "actions/gauge/gaugeacts/gaugeact_factory.h"
 #include "actions/gauge/gaugestates/gauge_createstate_aggregate.h"
 
@@ -129,213 +130,22 @@ namespace Chroma
     END_CODE();
   }
 
-  inline
-  void RectGaugeAct::deriv_part(int mu, int nu, Real c_munu,
-				multi1d<LatticeColorMatrix>& ds_u, 
-				const multi1d<LatticeColorMatrix>& u) const
-  {
-    START_CODE();
-
-    //       ---> --->  = U(x,mu)*U(x+mu, mu)
-    LatticeColorMatrix from_left_2link = u[mu]*shift(u[mu], FORWARD, mu);
-
-
-    // upper_l =    ----> --->
-    //             ^
-    //             |
-    //
-    // U(x, nu)*U(x+nu,mu)*U(x+mu+nu, mu)
-    LatticeColorMatrix upper_l = u[nu]*shift(from_left_2link, FORWARD, nu);
-
-
-    //       <--- <----
-    //      |
-    //      |
-    //      V ---> ---> (x+2mu)
-    //
-    // so here we have the staple for x + 2mu
-    // we need to shift it forward by 2 mu
-
-    // Here we shift it by mu after assembly
-
-    // shift, backward mu of:
-    // U^dag(x+mu+nu, mu)*U^dag(x+nu, mu)*U^dag(x, nu)*U(x,mu)*U(x+mu,mu)
-    //=U^dag(x+nu, mu)*U^dag(x-mu+nu, mu)*U^dag(x-mu, nu)*U(x-mu,mu)*U(x,mu)
-    LatticeColorMatrix tmp = shift( adj(upper_l)*from_left_2link, BACKWARD, mu);
-    
-
-    // and we shift it again
-    //       <--- <----
-    //      |
-    //      |
-    //      V ---> ---> (x)
-    //=U^dag(x+-mu+nu, mu)*U^dag(x-2mu+nu, mu)*U^dag(x-2mu, nu)*U(x-2mu,mu)*U(x-mu,mu)
-    ds_u[nu] = shift(tmp, BACKWARD, mu);
-
-    
-    // Tmp = u(x+mu, nu)
-    tmp = shift(u[nu], FORWARD, mu);
-    
-    // tmp2 = u(x + 2mu, nu)
-    LatticeColorMatrix tmp2 = shift(tmp, FORWARD, mu);
-
-    // Upper_le = from_left_2link(x+nu) * u^dag(x + 2mu, nu)
-    //          = u(x+nu, mu)*u(x+mu+nu, mu)*u^dag(x+2mu, nu)
-
-    //           = ----> ----> |
-    //                         | 
-    //                         V
-
-    upper_l = tmp2*adj(shift(from_left_2link, FORWARD, nu));
-
-    // ds_u =  ----> ----> |
-    //                     | 
-    //        <----  <---  V
-
-    // = u(x+nu, mu)*u(x+mu+nu, mu)*u^dag(x+2mu, nu)*u^dag(x+mu, mu)*u^dag(x,mu)
-
-    ds_u[nu] += adj(upper_l)*adj(from_left_2link);
-
-    
-
-    //              | <---- <--- ^ 
-    //              |            |
-    //              |            |
-    //          x   V            | x + 2mu
-
-    // u(x+2mu,nu)*u^dag(x+mu+nu,mu)*u^dag(x+nu, mu)*u^dag(x, nu)
-    LatticeColorMatrix up_staple = upper_l*adj(u[nu]);
-
-    //              ^            |
-    //              |            |
-    //              |            |
-    //          x   <----- <---- V x + 2mu
-
-    //  u^dag(x+2mu,nu) U^dag(x+mu,mu) U^dag(x,mu) U(x,nu)
-    tmp = adj(tmp2)*adj(from_left_2link);
-      
-    LatticeColorMatrix down_staple = tmp*u[nu];
-
-    // The following terms generate force staple for U(x+mu)
-    // the backward shift moves the contribution to the correct place
-    //
-    //              | <---- <--- ^ 
-    //              |            |
-    //              |            |
-    //          x   V----->      | x + 2mu
-
-    
-    // u(x+mu,nu)*u^dag(x+nu,mu)*u^dag(x-mu+nu, mu)*u^dag(x-mu, nu) u(x-mu,mu)
-    ds_u[mu] = shift( up_staple*u[mu], BACKWARD, mu);
-
-    //           x   ^---         | x+2mu
-    //               |            |
-    //               |            |
-    //               <----- <---- V 
-    
-    // shift backward nu shift backward mu of 
-    //  u^dag(x+mu-nu,nu) U^dag(x-nu,mu) U^dag(x-mu-nu,mu) U(x-mu-nu,nu) U(x-mu,mu)
-
-    tmp2 = shift(down_staple, BACKWARD, nu);
-    ds_u[mu] += shift(tmp2*u[mu], BACKWARD, mu);
-    
-    //              | <---- <--- ^ 
-    //              |            |
-    //              |            |
-    //          x   V      ----->| x + 2mu
-    tmp = shift(u[mu], FORWARD, mu);
-    ds_u[mu] += tmp*up_staple;
-
-
-    //         x    ^      ----->| x + 2mu + nu
-    //              |            |
-    //              |            |
-    //              <----- <---- V
-
-
-    ds_u[mu] += tmp*tmp2;
-
-    ds_u[mu] *= c_munu/Real(-2*Nc);
-    ds_u[nu] *= c_munu/Real(-2*Nc);
-
-    END_CODE();
-  }
-
-
   void
   RectGaugeAct::deriv(multi1d<LatticeColorMatrix>& ds_u,
 		      const Handle< GaugeState<P,Q> >& state) const
   {
     START_CODE();
 
-
-#if 1
-    // More efficient version
     QDP::StopWatch swatch;
     swatch.reset();
     swatch.start();
 
-    ds_u.resize(Nd);
-    Real c;
-
-    multi1d<LatticeColorMatrix> ds_tmp(Nd);
-
-    const multi1d<LatticeColorMatrix>& u = state->getLinks();
-    
-    ds_u = zero;
-    ds_tmp = zero; 
-
-    for(int mu=0; mu < Nd; mu++) { 
-      for(int nu=0; nu < Nd; nu++) { 
-
-	if (mu == nu) continue;
-
-	if ( mu == params.aniso.t_dir ) { 
-	  c = params.coeff_t1;
-	}
-	else if( nu == params.aniso.t_dir ) { 
-	  c = params.coeff_t2;
-	}
-	else { 
-	  c = params.coeff_s;
-	}
-
-	bool skip = (mu == params.aniso.t_dir && params.no_temporal_2link );
-	if (!skip) {
-	  deriv_part(mu, nu, c, ds_u, u);
-
-	  ds_tmp[mu] += ds_u[mu];
-	  ds_tmp[nu] += ds_u[nu];
-	}
-      }
-    }
-
-    for(int mu = 0; mu < Nd; mu++) { 
-      ds_u[mu] = u[mu]*ds_tmp[mu];
-    }
-
+    PlaqRectForce(*this).deriv(ds_u, state->getLinks());
     getGaugeBC().zero(ds_u);
+
     swatch.stop();
     RectGaugeActEnv::time_spent += swatch.getTimeInSeconds();
-#else
-
-    // This version uses new deriv_spatial/deriv_temporal structure.
-    // Above version saves a couple of closings of the staples
-    // so is faster and should be preferred.
-    // This is for testing only
-    ds_u.resize(Nd);
-    multi1d<LatticeColorMatrix> ds_tmp(Nd);
-    
-    ds_u = zero;
-    ds_tmp = zero;
 
-    derivSpatial(ds_u, state);
-    derivTemporal(ds_tmp, state);
-    
-    for(int mu=0; mu < Nd; ++mu) { 
-      ds_u[mu] += ds_tmp[mu];
-    }
-#endif
     END_CODE();
   }
 
@@ -346,43 +156,8 @@ namespace Chroma
   {
     START_CODE();
 
-    ds_u.resize(Nd);
-    Real c;
-
-    multi1d<LatticeColorMatrix> ds_tmp(Nd);
-
-    const multi1d<LatticeColorMatrix>& u = state->getLinks();
-    
-    ds_u = zero;
-    ds_tmp = zero; 
-    const int t_dir = params.aniso.t_dir;
-
-    // Use spatial coefficient
-    c = params.coeff_s;
-
-    for(int mu=0; mu < Nd; mu++) { 
-      for(int nu=0; nu < Nd; nu++) { 
-	
-	// Ensure mu!=nu (so we have a rectangle instead of a line
-	//        also that mu and nu are both spatial (neither is t_dir)
-	if ( (mu != nu ) && (mu != t_dir) && (nu != t_dir) ) {
-
-	  deriv_part(mu, nu, c, ds_u, u);
-
-	  ds_tmp[mu] += ds_u[mu];
-	  ds_tmp[nu] += ds_u[nu];
-
-	}	  
-      }
-    }
-
-    for(int mu = 0; mu < Nd; mu++) { 
-      if( mu != t_dir ) {
-	ds_u[mu] = u[mu]*ds_tmp[mu];
-      }
-    }
+    PlaqRectForce(*this, PlaqRectForce::SPATIAL_PLANES).deriv(ds_u, state->getLinks());
     getGaugeBC().zero(ds_u); 
-    
 
     END_CODE();
   }
@@ -395,50 +170,7 @@ namespace Chroma
   {
     START_CODE();
 
-    QDP::StopWatch swatch;
-    swatch.reset();
-    swatch.start();
-
-    ds_u.resize(Nd);
-    Real c;
-    int mu, nu;
-
-    multi1d<LatticeColorMatrix> ds_tmp(Nd);
-
-    const multi1d<LatticeColorMatrix>& u = state->getLinks();
-    
-    ds_u = zero;
-    ds_tmp = zero; 
-
-    // length 1 in the t_dir (nu = t_dir) 
-    const int t_dir = params.aniso.t_dir;
-    nu = t_dir;
-    c = params.coeff_t2;
-    for(mu=0; mu < Nd; mu++) { 
-      if( mu != nu ) { 
-	deriv_part(mu,nu,c,ds_u, u);
-	ds_tmp[mu] += ds_u[mu];
-	ds_tmp[nu] += ds_u[nu];
-      }
-    }
-
-
-    // length 2 in the t_dir (mu = t_dir)
-    mu = t_dir;
-    c = params.coeff_t1;
-    for(int nu=0; nu < Nd; nu++) { 
-      if( (!params.no_temporal_2link) && (nu != mu ) ) {  
-	  deriv_part(mu, nu, c, ds_u, u);
-
-	  ds_tmp[mu] += ds_u[mu];
-	  ds_tmp[nu] += ds_u[nu];
-      } 
-    }     
-
-
-    for(int mu = 0; mu < Nd; mu++) { 
-      ds_u[mu] = u[mu]*ds_tmp[mu];
-    }
+    PlaqRectForce(*this, PlaqRectForce::TEMPORAL_PLANES).deriv(ds_u, state->getLinks());
     getGaugeBC().zero(ds_u);
       
     END_CODE();
@@ -139,12 +139,6 @@ namespace Chroma
     Handle< CreateGaugeState<P,Q> >  cgs;  // Create gauge state
     RectGaugeActParams params; // THe parameter struct
 
-    // A function for computing the  contribution from one rectangle 
-    // in the mu/nu plane specified.
-    void deriv_part(int mu, int nu, Real c_munu,
-		    multi1d<LatticeColorMatrix>& ds_u, 
-		    const multi1d<LatticeColorMatrix>& u) const;
-
     // A function for computing the contribution to the action from 
     // one rectangle int he mu,nu plane specified
     void S_part(int mu, int nu, Real c, LatticeReal& lgimp, 
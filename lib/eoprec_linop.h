@@ -8,6 +8,7 @@
 
 #include "chromabase.h"
 #include "linearop.h"
+#include "workspace.h"
 
 using namespace QDP::Hints;
 
@@ -125,7 +126,9 @@ namespace Chroma
     virtual void operator() (T& chi, const T& psi, 
 			     enum PlusMinus isign) const
     {
-      T   tmp1, tmp2; moveToFastMemoryHint(tmp1); moveToFastMemoryHint(tmp2);
+      Workspace<T>  ws1, ws2;
+      T&  tmp1 = *ws1;
+      T&  tmp2 = *ws2;
 
       /*  Tmp1   =  D     A^(-1)     D    Psi  */
       /*      O      O,E        E,E   E,O    O */
@@ -348,8 +351,9 @@ namespace Chroma
     virtual void operator() (multi1d<T>& chi, const multi1d<T>& psi, 
 			     enum PlusMinus isign) const
     {
-      multi1d<T>  tmp1(size());  moveToFastMemoryHint(tmp1);
-      multi1d<T>  tmp2(size());  moveToFastMemoryHint(tmp2);
+      WorkspaceArray<T>  ws1(size()), ws2(size());
+      multi1d<T>&  tmp1 = *ws1;
+      multi1d<T>&  tmp2 = *ws2;
 
       /*  Tmp1   =  D     A^(-1)     D    Psi  */
       /*      O      O,E        E,E   E,O    O */
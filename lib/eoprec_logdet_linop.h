@@ -206,6 +206,27 @@ namespace Chroma
       getFermBC().zero(ds_u);
     }
 
+    //! Derivative of  X^dag (M^dag M)' X  plus  weight * TrLn A_ee
+    /*!
+     * With  Y = M X  this is  X^dag M'^dag Y + Y^dag M' X + weight * (TrLn A_ee)',
+     * the force of a two flavor monomial including its even-even log det.
+     * Operators whose pieces share work may override this.
+     */
+    virtual void derivMdagMLogDet(P& ds_u, const T& X, const T& Y, 
+				  const Real& weight) const
+    {
+      P   ds_1;  // deriv routines should resize
+
+      this->deriv(ds_u, X, Y, MINUS);
+
+      this->deriv(ds_1, Y, X, PLUS);
+      ds_u += ds_1;
+
+      this->derivLogDetEvenEvenLinOp(ds_1, PLUS);
+      for(int mu=0; mu < ds_u.size(); ++mu)
+	ds_u[mu] += weight*ds_1[mu];
+    }
+
     //! Apply the even-even block onto a source std::vector
     virtual void derivEvenEvenLinOp(P& ds_u, const T& chi, const T& psi, 
 				    enum PlusMinus isign) const
@@ -8,6 +8,7 @@
 
 #include "handle.h"
 #include "linearop.h"
+#include "workspace.h"
 
 namespace Chroma 
 { 
@@ -38,7 +39,8 @@ namespace Chroma
     /*! For this operator, the sign is ignored */
     inline void operator() (T& chi, const T& psi, enum PlusMinus isign) const
       {
-	T  tmp;  QDP::Hints::moveToFastMemoryHint(tmp);
+	Workspace<T>  ws;
+	T&  tmp = *ws;
 
 	(*A)(tmp, psi, PLUS);
 	(*A)(chi, tmp, MINUS);
@@ -86,7 +88,8 @@ namespace Chroma
     /*! For this operator, the sign is ignored */
     inline void operator() (multi1d<T>& chi, const multi1d<T>& psi, enum PlusMinus isign) const
       {
-	multi1d<T>  tmp(size()); QDP::Hints::moveToFastMemoryHint(tmp);
+	WorkspaceArray<T>  ws(size());
+	multi1d<T>&  tmp = *ws;
 	(*A)(tmp, psi, PLUS);
 	(*A)(chi, tmp, MINUS);
       }
@@ -141,6 +141,83 @@ namespace Chroma
   }  // namespace  Baryon2PtContractions
 
 
+  //! Anonymous namespace
+  namespace
+  {
+    //! Forward and possibly time-reversed baryon correlators
+    /*! Returns whether the time-reversed ones were computed */
+    bool barhqlqDisp(const LatticePropagator& propagator_1, 
+		     const LatticePropagator& propagator_2, 
+		     const SftMom& phases,
+		     int bc_spec, bool time_rev,
+		     multi3d<DComplex>& bardisp1,
+		     multi3d<DComplex>& bardisp2)
+    {
+      // Forward
+      barhqlq(propagator_1, propagator_2, phases, bardisp1);
+
+      // Possibly add in a time-reversed contribution
+      bool time_revP = (bc_spec*bc_spec == 1) ? time_rev : false;
+
+      if (time_revP)
+      {
+	/* Time-charge reverse the quark propagators */
+	/* S_{CT} = gamma_5 gamma_4 = gamma_1 gamma_2 gamma_3 = Gamma(7) */
+	LatticePropagator q1_tmp = - (Gamma(7) * propagator_1 * Gamma(7));
+	LatticePropagator q2_tmp = - (Gamma(7) * propagator_2 * Gamma(7));
+
+	barhqlq(q1_tmp, q2_tmp, phases, bardisp2);
+      }
+
+      return time_revP;
+    }
+
+
+    //! Shift a baryon correlator to the source and fold in the time-reversed one
+    void barhqlqProp(multi1d<Complex>& barprop,
+		     const multi3d<DComplex>& bardisp1,
+		     const multi3d<DComplex>& bardisp2,
+		     bool time_revP,
+		     int baryons, int sink_mom_num,
+		     int t0, int bc_spec)
+    {
+      int length  = bardisp1.size1();
+      barprop.resize(length);
+
+      /* forward */
+      for(int t = 0; t < length; ++t)
+      {
+	int t_eff = (t - t0 + length) % length;
+	    
+	if ( bc_spec < 0 && (t_eff+t0) >= length)
+	  barprop[t_eff] = -bardisp1[baryons][sink_mom_num][t];
+	else
+	  barprop[t_eff] =  bardisp1[baryons][sink_mom_num][t];
+      }
+
+      if (time_revP)
+      {
+	/* backward */
+	for(int t = 0; t < length; ++t)
+	{
+	  int t_eff = (length - t + t0) % length;
+	
+	  if ( bc_spec < 0 && (t_eff-t0) > 0)
+	  {
+	    barprop[t_eff] -= bardisp2[baryons][sink_mom_num][t];
+	    barprop[t_eff] *= 0.5;
+	  }
+	  else
+	  {
+	    barprop[t_eff] += bardisp2[baryons][sink_mom_num][t];
+	    barprop[t_eff] *= 0.5;
+	  }
+	}
+      }
+    }
+  }
+
+
   //! Heavy-light baryon 2-pt functions
   /*!
    * \ingroup hadron
@@ -182,26 +259,11 @@ namespace Chroma
     multi3d<DComplex> bardisp1;
     multi3d<DComplex> bardisp2;
 
-    // Forward
-    barhqlq(propagator_1, propagator_2, phases, bardisp1);
-
-    // Possibly add in a time-reversed contribution
-    bool time_revP = (bc_spec*bc_spec == 1) ? time_rev : false;
-
-    if (time_revP)
-    {
-      /* Time-charge reverse the quark propagators */
-      /* S_{CT} = gamma_5 gamma_4 = gamma_1 gamma_2 gamma_3 = Gamma(7) */
-      LatticePropagator q1_tmp = - (Gamma(7) * propagator_1 * Gamma(7));
-      LatticePropagator q2_tmp = - (Gamma(7) * propagator_2 * Gamma(7));
-
-      barhqlq(q1_tmp, q2_tmp, phases, bardisp2);
-    }
-
+    bool time_revP = barhqlqDisp(propagator_1, propagator_2, phases, bc_spec, time_rev,
+				 bardisp1, bardisp2);
 
     int num_baryons = bardisp1.size3();
     int num_mom = bardisp1.size2();
-    int length  = bardisp1.size1();
 
     // Loop over baryons
     XMLArrayWriter xml_bar(xml,num_baryons);
@@ -222,38 +284,8 @@ namespace Chroma
 	write(xml_sink_mom, "sink_mom_num", sink_mom_num) ;
 	write(xml_sink_mom, "sink_mom", phases.numToMom(sink_mom_num)) ;
 
-	multi1d<Complex> barprop(length);
-
-	/* forward */
-	for(int t = 0; t < length; ++t)
-	{
-	  int t_eff = (t - t0 + length) % length;
-	    
-	  if ( bc_spec < 0 && (t_eff+t0) >= length)
-	    barprop[t_eff] = -bardisp1[baryons][sink_mom_num][t];
-	  else
-	    barprop[t_eff] =  bardisp1[baryons][sink_mom_num][t];
-	}
-
-	if (time_revP)
-	{
-	  /* backward */
-	  for(int t = 0; t < length; ++t)
-	  {
-	    int t_eff = (length - t + t0) % length;
-	
-	    if ( bc_spec < 0 && (t_eff-t0) > 0)
-	    {
-	      barprop[t_eff] -= bardisp2[baryons][sink_mom_num][t];
-	      barprop[t_eff] *= 0.5;
-	    }
-	    else
-	    {
-	      barprop[t_eff] += bardisp2[baryons][sink_mom_num][t];
-	      barprop[t_eff] *= 0.5;
-	    }
-	  }
-	}
+	multi1d<Complex> barprop;
+	barhqlqProp(barprop, bardisp1, bardisp2, time_revP, baryons, sink_mom_num, t0, bc_spec);
 
 	write(xml_sink_mom, "barprop", barprop);
 	pop(xml_sink_mom);
@@ -269,6 +301,54 @@ namespace Chroma
   }
 
 
+  // Heavy-light baryon 2-pt functions written to a binary correlator file
+  void barhqlq(const LatticePropagator& propagator_1, 
+	       const LatticePropagator& propagator_2, 
+	       const SftMom& phases,
+	       int t0, int bc_spec, bool time_rev,
+	       CorrBinaryWriter& bin,
+	       const CorrBinaryKey& key)
+  {
+    START_CODE();
+
+    if ( Ns != 4 || Nc != 3 )		/* Code is specific to Ns=4 and Nc=3. */
+      return;
+
+    multi3d<DComplex> bardisp1;
+    multi3d<DComplex> bardisp2;
+
+    bool time_revP = barhqlqDisp(propagator_1, propagator_2, phases, bc_spec, time_rev,
+				 bardisp1, bardisp2);
+
+    int num_baryons = bardisp1.size3();
+    int num_mom = bardisp1.size2();
+    int length  = bardisp1.size1();
+
+    CorrBinaryKey corr_key(key);
+    multi1d<Complex> barprop;
+    multi1d<DComplex> dbarprop(length);
+
+    for(int baryons = 0; baryons < num_baryons; ++baryons)
+    {
+      corr_key.gamma = baryons;
+
+      for(int sink_mom_num = 0; sink_mom_num < num_mom; ++sink_mom_num)
+      {
+	corr_key.mom = phases.numToMom(sink_mom_num);
+
+	// Same precision as the xml output
+	barhqlqProp(barprop, bardisp1, bardisp2, time_revP, baryons, sink_mom_num, t0, bc_spec);
+	for(int t = 0; t < length; ++t)
+	  dbarprop[t] = barprop[t];
+
+	bin.write(corr_key, dbarprop);
+      }
+    }
+
+    END_CODE();
+  }
+
+
 
   //! Heavy-light baryon 2-pt functions
   /*!
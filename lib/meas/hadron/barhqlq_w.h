@@ -8,6 +8,7 @@
 
 #include "chromabase.h"
 #include "util/ft/sftmom.h"
+#include "meas/hadron/corr_binary_writer.h"
 
 namespace Chroma 
 {
@@ -91,6 +92,29 @@ namespace Chroma
 	       const std::string& xml_group);
 
 
+  //! Heavy-light baryon 2-pt functions written to a binary correlator file
+  /*!
+   * \ingroup hadron
+   *
+   * The same correlators as above, one per baryon number and sink momentum.
+   *
+   * \param propagator_1   "s" quark propagator ( Read )
+   * \param propagator_2   "u" quark propagator ( Read )
+   * \param t0             cartesian coordinates of the source ( Read )
+   * \param bc_spec        boundary condition for spectroscopy ( Read )
+   * \param time_rev       add in time reversed contribution if true ( Read )
+   * \param phases         object holds list of momenta and Fourier phases ( Read )
+   * \param bin            binary correlator file ( Write )
+   * \param key            hadron, quarks, source and sink of the keys ( Read )
+   */
+  void barhqlq(const LatticePropagator& propagator_1, 
+	       const LatticePropagator& propagator_2, 
+	       const SftMom& phases,
+	       int t0, int bc_spec, bool time_rev,
+	       CorrBinaryWriter& bin,
+	       const CorrBinaryKey& key);
+
+
 
   //! Heavy-light baryon 2-pt functions
   /*!
@@ -0,0 +1,241 @@
+/*! \file
+ * \brief Write hadron correlators to a binary columnar file
+ */
+
+#include "meas/hadron/corr_binary_writer.h"
+
+namespace Chroma
+{
+  //! Anonymous namespace
+  namespace
+  {
+    //! Raw write, counting failures
+    void put(FILE* f, const void* p, size_t n, int& err)
+    {
+      if (n > 0 && fwrite(p, 1, n, f) != n)
+	++err;
+    }
+
+    void putInt(FILE* f, int v, int& err)
+    {
+      int v32 = v;
+      put(f, &v32, sizeof(int), err);
+    }
+
+    void putLong(FILE* f, long long v, int& err)
+    {
+      put(f, &v, sizeof(long long), err);
+    }
+
+    //! A string column: the dictionary in code order, then the codes
+    void putColumn(FILE* f, const std::map<std::string,int>& dict, const std::vector<int>& codes, int& err)
+    {
+      std::vector<std::string> entries(dict.size());
+      for(std::map<std::string,int>::const_iterator it = dict.begin(); it != dict.end(); ++it)
+	entries[it->second] = it->first;
+
+      putInt(f, entries.size(), err);
+      for(int i=0; i < entries.size(); ++i)
+      {
+	putInt(f, entries[i].size(), err);
+	put(f, entries[i].data(), entries[i].size(), err);
+      }
+      if (! codes.empty())
+	put(f, &(codes[0]), codes.size()*sizeof(int), err);
+    }
+  }
+
+
+  // Constructor
+  CorrBinaryWriter::CorrBinaryWriter(size_t buffer_size_) :
+    BackgroundWriter< std::vector<double> >(2),
+    buffer_size(buffer_size_), is_open(false), file(0), data_bytes(0)
+  {
+  }
+
+
+  // Create the file and start the writer
+  void CorrBinaryWriter::open(const std::string& file_)
+  {
+    close();
+
+    int err = 0;
+    if (Layout::primaryNode())
+    {
+      file_name = file_;
+      file = fopen(file_name.c_str(), "wb");
+      if (file == 0)
+	err = 1;
+      else
+      {
+	const char magic[8] = {'C','H','C','O','R','R','0','1'};
+	put(file, magic, 8, err);
+	putInt(file, Nd-1, err);
+	putInt(file, 0, err);
+      }
+    }
+    QDPInternal::broadcast(err);
+
+    if (err != 0)
+    {
+      QDPIO::cerr << __func__ << ": error creating correlator file= " << file_ << std::endl;
+      QDP_abort(1);
+    }
+
+    data_bytes = 8 + 2*sizeof(int);
+    is_open = true;
+
+    if (Layout::primaryNode())
+      start();
+  }
+
+
+  // Dictionary code of a string of a column
+  int CorrBinaryWriter::code(std::map<std::string,int>& dict, const std::string& s)
+  {
+    std::map<std::string,int>::const_iterator it = dict.find(s);
+    if (it != dict.end())
+      return it->second;
+
+    const int c = dict.size();
+    dict[s] = c;
+    return c;
+  }
+
+
+  // Append a correlator
+  void CorrBinaryWriter::write(const CorrBinaryKey& key, const multi1d<DComplex>& corr)
+  {
+    if (! is_open)
+    {
+      QDPIO::cerr << __func__ << ": correlator file is not open" << std::endl;
+      QDP_abort(1);
+    }
+
+    if (key.mom.size() != Nd-1)
+    {
+      QDPIO::cerr << __func__ << ": expected a momentum of " << Nd-1 << " components" << std::endl;
+      QDP_abort(1);
+    }
+
+    if (! Layout::primaryNode())
+      return;
+
+    hadron_col.push_back(code(hadron_dict, key.hadron));
+    quarks_col.push_back(code(quarks_dict, key.quarks));
+    gamma_col.push_back(key.gamma);
+    for(int i=0; i < key.mom.size(); ++i)
+      mom_col.push_back(key.mom[i]);
+    source_col.push_back(code(source_dict, key.source));
+    sink_col.push_back(code(sink_dict, key.sink));
+    length_col.push_back(corr.size());
+    offset_col.push_back(data_bytes);
+
+    for(int t=0; t < corr.size(); ++t)
+    {
+      current.push_back(toDouble(real(corr[t])));
+      current.push_back(toDouble(imag(corr[t])));
+    }
+    data_bytes += 2*corr.size()*sizeof(double);
+
+    if (current.size()*sizeof(double) >= buffer_size)
+      submit();
+  }
+
+
+  // Hand the current buffer to the writer
+  void CorrBinaryWriter::submit()
+  {
+    if (current.empty())
+      return;
+
+    // At most two buffers wait, so the memory stays bounded
+    push(current);
+
+    current.reserve(buffer_size/sizeof(double) + 1);
+  }
+
+
+  // Wait for the buffered correlators to be written
+  void CorrBinaryWriter::flush()
+  {
+    int err = 0;
+    if (Layout::primaryNode() && is_open)
+    {
+      submit();
+      err = drain();
+    }
+    QDPInternal::broadcast(err);
+
+    if (err != 0)
+    {
+      QDPIO::cerr << __func__ << ": " << err << " writes to the correlator file failed" << std::endl;
+      QDP_abort(1);
+    }
+  }
+
+
+  // Write the buffered correlators and the index, and close the file
+  void CorrBinaryWriter::close()
+  {
+    if (! is_open)
+      return;
+
+    flush();
+
+    int err = 0;
+    if (Layout::primaryNode())
+    {
+      stop();
+
+      // The index follows the data
+      const long long nrec = offset_col.size();
+      putLong(file, nrec, err);
+      putColumn(file, hadron_dict, hadron_col, err);
+      putColumn(file, quarks_dict, quarks_col, err);
+      if (nrec > 0)
+      {
+	put(file, &(gamma_col[0]), gamma_col.size()*sizeof(int), err);
+	put(file, &(mom_col[0]), mom_col.size()*sizeof(int), err);
+      }
+      putColumn(file, source_dict, source_col, err);
+      putColumn(file, sink_dict, sink_col, err);
+      if (nrec > 0)
+      {
+	put(file, &(length_col[0]), length_col.size()*sizeof(int), err);
+	put(file, &(offset_col[0]), offset_col.size()*sizeof(long long), err);
+      }
+
+      const char magic[8] = {'C','H','C','O','R','I','D','X'};
+      putLong(file, data_bytes, err);
+      put(file, magic, 8, err);
+
+      if (fclose(file) != 0)
+	++err;
+      file = 0;
+
+      hadron_dict.clear(); quarks_dict.clear(); source_dict.clear(); sink_dict.clear();
+      hadron_col.clear(); quarks_col.clear(); gamma_col.clear(); mom_col.clear();
+      source_col.clear(); sink_col.clear(); length_col.clear(); offset_col.clear();
+      current.clear();
+    }
+    QDPInternal::broadcast(err);
+    is_open = false;
+
+    if (err != 0)
+    {
+      QDPIO::cerr << __func__ << ": error writing the index of the correlator file" << std::endl;
+      QDP_abort(1);
+    }
+  }
+
+
+  // Write a buffer, on the background thread
+  int CorrBinaryWriter::writeItem(std::vector<double>& buf)
+  {
+    int err = 0;
+    put(file, &(buf[0]), buf.size()*sizeof(double), err);
+    return err;
+  }
+
+} // namespace Chroma
@@ -0,0 +1,112 @@
+// -*- C++ -*-
+/*! \file
+ * \brief Write hadron correlators to a binary columnar file
+ */
+
+#ifndef __corr_binary_writer_h__
+#define __corr_binary_writer_h__
+
+#include "chromabase.h"
+#include "util/ferm/background_writer.h"
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+namespace Chroma
+{
+  //! Key of a correlator in a binary correlator file
+  /*! \ingroup hadron */
+  struct CorrBinaryKey
+  {
+    std::string   hadron;     /*!< correlator group, e.g. Wilson_Mesons */
+    std::string   quarks;     /*!< ids of the quark propagators */
+    int           gamma;      /*!< gamma value, or baryon number */
+    multi1d<int>  mom;        /*!< sink momentum */
+    std::string   source;     /*!< source type, e.g. Point */
+    std::string   sink;       /*!< sink type, e.g. Shell */
+  };
+
+
+  //! Writes hadron correlators to a binary columnar file
+  /*! \ingroup hadron
+   *
+   * All numbers are in the byte order of the host. The file is
+   *
+   *   header:   char[8] "CHCORR01", int32 number of momentum components, int32 0
+   *   data:     the correlators, each a time ordered array of complex doubles
+   *   index:    int64 number of correlators, then the key columns
+   *             hadron, quarks, gamma, mom, source, sink, and the
+   *             columns length (int32) and offset (int64, bytes from the
+   *             start of the file) of the data
+   *   trailer:  int64 offset of the index, char[8] "CHCORIDX"
+   *
+   * A string column is a dictionary, int32 number of entries followed by
+   * int32 length and the characters of each entry, and an int32 code per
+   * correlator. The gamma column holds an int32 and the mom column the
+   * int32 components per correlator.
+   *
+   * The correlators are the same on all nodes, so only the primary node
+   * keeps them. write() appends to a buffer; a full buffer is handed to a
+   * background thread that does the disk writes. All calls are collective.
+   */
+  class CorrBinaryWriter : private BackgroundWriter< std::vector<double> >
+  {
+  public:
+    //! Constructor
+    /*!
+     * \param buffer_size  bytes of data collected before a write  ( Read )
+     */
+    CorrBinaryWriter(size_t buffer_size = 4 << 20);
+
+    //! Destructor closes the file
+    ~CorrBinaryWriter() {close();}
+
+    //! Create the file and start the writer
+    void open(const std::string& file);
+
+    //! Append a correlator
+    void write(const CorrBinaryKey& key, const multi1d<DComplex>& corr);
+
+    //! Wait for the buffered correlators to be written
+    void flush();
+
+    //! Write the buffered correlators and the index, and close the file
+    void close();
+
+    //! Is the file open?
+    bool isOpen() const {return is_open;}
+
+  private:
+    //! Write a buffer, on the background thread
+    int writeItem(std::vector<double>& buf);
+
+    //! Hand the current buffer to the writer
+    void submit();
+
+    //! Dictionary code of a string of a column
+    static int code(std::map<std::string,int>& dict, const std::string& s);
+
+    // Hide copies
+    CorrBinaryWriter(const CorrBinaryWriter&);
+    void operator=(const CorrBinaryWriter&);
+
+    size_t  buffer_size;
+    bool    is_open;
+
+    // Primary node only
+    FILE*                file;
+    std::string          file_name;
+    std::vector<double>  current;
+    long long            data_bytes;
+
+    // Index columns, primary node only
+    std::map<std::string,int>  hadron_dict, quarks_dict, source_dict, sink_dict;
+    std::vector<int>           hadron_col, quarks_col, gamma_col, mom_col, source_col, sink_col;
+    std::vector<int>           length_col;
+    std::vector<long long>     offset_col;
+  };
+
+} // namespace Chroma
+
+#endif
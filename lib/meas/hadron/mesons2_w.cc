@@ -79,6 +79,7 @@
 #include "chromabase.h"
 #include "util/ft/sftmom.h"
 #include "meas/hadron/mesons_w.h"
+#include "meas/hadron/mesons2_w.h"
 
 namespace Chroma {
 
@@ -175,4 +176,54 @@ void mesons2(const LatticePropagator& quark_prop_1,
   END_CODE();
 }
 
+
+// Meson 2-pt functions written to a binary correlator file
+void mesons2(const LatticePropagator& quark_prop_1,
+	     const LatticePropagator& quark_prop_2,
+	     const SftMom& phases,
+	     int t0,
+	     CorrBinaryWriter& bin,
+	     const CorrBinaryKey& key)
+{
+  START_CODE();
+
+  // Length of lattice in decay direction
+  int length = phases.numSubsets();
+
+  // Construct the anti-quark propagator from quark_prop_2
+  int G5 = Ns*Ns-1;
+  LatticePropagator anti_quark_prop =  Gamma(G5) * quark_prop_2 * Gamma(G5);
+
+  CorrBinaryKey corr_key(key);
+
+  for (int gamma_value=0; gamma_value < (Ns*Ns); ++gamma_value)
+  {
+    // Construct the meson correlation function
+    LatticeComplex corr_fn;
+    corr_fn = trace(adj(anti_quark_prop) * (Gamma(gamma_value) *
+                    quark_prop_1 * Gamma(gamma_value)));
+
+    multi2d<DComplex> hsum;
+    hsum = phases.sft(corr_fn);
+
+    corr_key.gamma = gamma_value;
+
+    for (int sink_mom_num=0; sink_mom_num < phases.numMom(); ++sink_mom_num) 
+    {
+      corr_key.mom = phases.numToMom(sink_mom_num);
+
+      multi1d<DComplex> mesprop(length);
+      for (int t=0; t < length; ++t) 
+      {
+        int t_eff = (t - t0 + length) % length;
+	mesprop[t_eff] = hsum[sink_mom_num][t];
+      }
+
+      bin.write(corr_key, mesprop);
+    } // end for(sink_mom_num)
+  } // end for(gamma_value)
+
+  END_CODE();
+}
+
 }  // end namespace Chroma
@@ -6,6 +6,8 @@
 #ifndef __mesons2_h__
 #define __mesons2_h__
 
+#include "meas/hadron/corr_binary_writer.h"
+
 namespace Chroma {
 
 //! Meson 2-pt functions
@@ -36,6 +38,24 @@ void mesons2(const LatticePropagator& quark_prop_1,
 	     int t0,
 	     XMLWriter& xml,
 	     const std::string& xml_group) ;
+
+//! Meson 2-pt functions written to a binary correlator file
+/* The same correlators as above, one per gamma value and sink momentum.
+ *
+ * \param quark_prop_1  first quark propagator ( Read )
+ * \param quark_prop_2  second (anti-) quark propagator ( Read )
+ * \param t0            timeslice coordinate of the source ( Read )
+ * \param phases        object holds list of momenta and Fourier phases ( Read )
+ * \param bin           binary correlator file ( Write )
+ * \param key           hadron, quarks, source and sink of the keys ( Read )
+ */
+
+void mesons2(const LatticePropagator& quark_prop_1,
+	     const LatticePropagator& quark_prop_2,
+	     const SftMom& phases,
+	     int t0,
+	     CorrBinaryWriter& bin,
+	     const CorrBinaryKey& key) ;
   
 }  // end namespace Chroma
 
@@ -30,6 +30,7 @@
 #include "meas/inline/hadron/inline_propagator_ferm_w.h"
 #include "meas/inline/hadron/inline_multi_propagator_w.h"
 #include "meas/inline/hadron/inline_seqsource_w.h"
+#include "meas/inline/hadron/inline_multi_seqsource_w.h"
 #include "meas/inline/hadron/inline_seqprop_test_w.h"
 #include "meas/inline/hadron/inline_hadspec_w.h"
 #include "meas/inline/hadron/inline_mesonspec_w.h"
@@ -114,6 +115,7 @@ namespace Chroma
 
 	success &= InlineMultiPropagatorEnv::registerAll();  // save space
 	success &= InlineSeqSourceEnv::registerAll();
+	success &= InlineMultiSeqSourceEnv::registerAll();
 #ifdef BUILD_LAPACK
 	success &= InlineLaplaceEigsEnv::registerAll();
 #endif
@@ -170,6 +170,12 @@ namespace Chroma
       {
 	read(paramtop, "xml_file", xml_file);
       }
+
+      // Possible binary correlator file pattern
+      if (paramtop.count("binary_file") != 0) 
+      {
+	read(paramtop, "binary_file", binary_file);
+      }
     }
     catch(const std::string& e) 
     {
@@ -187,6 +193,8 @@ namespace Chroma
     Chroma::write(xml_out, "Param", param);
     Chroma::write(xml_out, "NamedObject", named_obj);
     QDP::write(xml_out, "xml_file", xml_file);
+    if (binary_file != "")
+      QDP::write(xml_out, "binary_file", binary_file);
 
     pop(xml_out);
   }
@@ -404,6 +412,15 @@ namespace Chroma
     // First calculate some gauge invariant observables just for info.
     MesPlq(xml_out, "Observables", u);
 
+    // Meson and baryon correlators go to a binary file if one is given
+    CorrBinaryWriter bin;
+    if (params.binary_file != "")
+    {
+      std::string binary_file = makeXMLFileName(params.binary_file, update_no);
+      write(xml_out, "binary_file", binary_file);
+      bin.open(binary_file);
+    }
+
     // Keep an array of all the xml output buffers
     push(xml_out, "Wilson_hadron_measurements");
 
@@ -564,11 +581,25 @@ namespace Chroma
       QDPIO::cout << "Source type = " << src_type << std::endl;
       QDPIO::cout << "Sink type = "   << snk_type << std::endl;
 
+      // Keys of the binary correlators
+      CorrBinaryKey bin_key;
+      bin_key.quarks = named_obj.first_id + "," + named_obj.second_id;
+      bin_key.source = src_type;
+      bin_key.sink   = snk_type;
+
       // Do the mesons first
       if (params.param.MesonP) 
       {
-	mesons2(sink_prop_1, sink_prop_2, phases, t0,
-		xml_out, source_sink_type + "_Wilson_Mesons");
+	if (bin.isOpen())
+	{
+	  bin_key.hadron = "Wilson_Mesons";
+	  mesons2(sink_prop_1, sink_prop_2, phases, t0, bin, bin_key);
+	}
+	else
+	{
+	  mesons2(sink_prop_1, sink_prop_2, phases, t0,
+		  xml_out, source_sink_type + "_Wilson_Mesons");
+	}
       } // end if (MesonP)
 
 
@@ -588,9 +619,19 @@ namespace Chroma
       // Do the baryons
       if (params.param.BaryonP) 
       {
-	barhqlq(sink_prop_2, sink_prop_1, phases, 
-		t0, bc_spec, params.param.time_rev, 
-		xml_out, source_sink_type + "_Wilson_Baryons");
+	if (bin.isOpen())
+	{
+	  bin_key.hadron = "Wilson_Baryons";
+	  barhqlq(sink_prop_2, sink_prop_1, phases, 
+		  t0, bc_spec, params.param.time_rev, 
+		  bin, bin_key);
+	}
+	else
+	{
+	  barhqlq(sink_prop_2, sink_prop_1, phases, 
+		  t0, bc_spec, params.param.time_rev, 
+		  xml_out, source_sink_type + "_Wilson_Baryons");
+	}
       } // end if (BaryonP)
 
       pop(xml_out);  // array element
@@ -598,6 +639,9 @@ namespace Chroma
     pop(xml_out);  // Wilson_spectroscopy
     pop(xml_out);  // hadspec
 
+    // Write the rest of the correlators and the index
+    bin.close();
+
     snoop.stop();
     QDPIO::cout << InlineHadSpecEnv::name << ": total time = "
 		<< snoop.getTimeInSeconds() 
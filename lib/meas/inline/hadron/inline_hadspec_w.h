@@ -55,7 +55,8 @@ namespace Chroma
       multi1d<Props_t> sink_pairs;
     } named_obj;
 
-    std::string xml_file;  // Alternate XML file pattern
+    std::string xml_file;     // Alternate XML file pattern
+    std::string binary_file;  // Optional binary correlator file pattern
   };
 
 
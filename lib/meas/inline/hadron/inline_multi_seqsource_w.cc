@@ -0,0 +1,643 @@
+/*! \file
+ * \brief Inline construction of many sequential sources in one pass
+ *
+ * Sequential sources for several sink operators, sink momenta and
+ * sink times from one read and one smearing of the forward propagators
+ */
+
+#include "handle.h"
+#include "meas/inline/hadron/inline_multi_seqsource_w.h"
+#include "meas/inline/abs_inline_measurement_factory.h"
+#include "meas/glue/mesplq.h"
+#include "meas/hadron/seqsource_factory_w.h"
+#include "meas/hadron/seqsource_aggregate_w.h"
+#include "meas/sinks/sink_smearing_factory.h"
+#include "meas/sinks/sink_smearing_aggregate.h"
+#include "meas/sinks/pt_sink_smearing.h"
+#include "meas/sinks/sh_sink_smearing.h"
+#include "meas/sinks/norm_sh_sink_smearing.h"
+#include "meas/sinks/wall_sink_smearing.h"
+#include "meas/smear/no_quark_displacement.h"
+#include "meas/smear/simple_quark_displacement.h"
+#include "meas/smear/no_quark_smearing.h"
+#include "meas/smear/gaus_quark_smearing.h"
+#include "meas/smear/jacobi_quark_smearing.h"
+#include "meas/hadron/simple_meson_seqsrc_w.h"
+#include "meas/hadron/deriv_meson_seqsrc_w.h"
+#include "util/ft/sftmom.h"
+#include "util/info/proginfo.h"
+#include "util/info/unique_id.h"
+#include "meas/inline/io/named_objmap.h"
+
+namespace Chroma
+{
+  namespace InlineMultiSeqSourceEnv
+  {
+    //! Parameter input
+    void read(XMLReader& xml, const std::string& path, Params::Param_t& param)
+    {
+      XMLReader paramtop(xml, path);
+
+      param.seqsrcs = readXMLArrayGroup(paramtop, "SeqSources", "SeqSourceType");
+      read(paramtop, "t_sinks", param.t_sinks);
+      read(paramtop, "sink_moms", param.sink_moms);
+    }
+
+    //! Parameter output
+    void write(XMLWriter& xml, const std::string& path, const Params::Param_t& param)
+    {
+      push(xml, path);
+
+      push(xml, "SeqSources");
+      for(int i=0; i < param.seqsrcs.size(); ++i)
+      {
+	xml << param.seqsrcs[i].xml;
+      }
+      pop(xml);
+
+      write(xml, "t_sinks", param.t_sinks);
+      write(xml, "sink_moms", param.sink_moms);
+
+      pop(xml);
+    }
+
+    //! Propagator input
+    void read(XMLReader& xml, const std::string& path, Params::NamedObject_t& input)
+    {
+      XMLReader inputtop(xml, path);
+
+      read(inputtop, "gauge_id", input.gauge_id);
+      read(inputtop, "prop_ids", input.prop_ids);
+      read(inputtop, "seqsource_id", input.seqsource_id);
+
+      if (inputtop.count("seqsource_list_id") == 1)
+	read(inputtop, "seqsource_list_id", input.seqsource_list_id);
+    }
+
+    //! Propagator output
+    void write(XMLWriter& xml, const std::string& path, const Params::NamedObject_t& input)
+    {
+      push(xml, path);
+
+      write(xml, "gauge_id", input.gauge_id);
+      write(xml, "prop_ids", input.prop_ids);
+      write(xml, "seqsource_id", input.seqsource_id);
+      write(xml, "seqsource_list_id", input.seqsource_list_id);
+
+      pop(xml);
+    }
+
+
+    namespace
+    {
+      AbsInlineMeasurement* createMeasurement(XMLReader& xml_in,
+					      const std::string& path)
+      {
+	return new InlineMeas(Params(xml_in, path));
+      }
+
+      //! Local registration flag
+      bool registered = false;
+
+      //! Rewrite one kind of sequential source params for a new sink
+      /*!
+       * The params are read into their struct, retargeted and written
+       * back, so the group holds exactly what the struct reader accepts
+       */
+      template<typename P>
+      GroupXML_t retargetSeqSource(const GroupXML_t& seqsrc, int t_sink,
+				   const multi1d<int>& sink_mom, int& j_decay)
+      {
+	std::istringstream  xml_s(seqsrc.xml);
+	XMLReader  seqsrctop(xml_s);
+
+	P params(seqsrctop, seqsrc.path);
+	params.t_sink   = t_sink;
+	params.sink_mom = sink_mom;
+	j_decay         = params.j_decay;
+
+	XMLBufferWriter xml_tmp;
+	params.writeXML(xml_tmp, "SeqSource");
+
+	// The struct writers do not know their factory key. Put it
+	// back as the first element, as the SeqSource_t reader needs it.
+	const std::string open = "<SeqSource>";
+	std::string body = xml_tmp.printCurrentContext();
+	body.insert(body.find(open) + open.size(),
+		    "<SeqSourceType>" + seqsrc.id + "</SeqSourceType>");
+
+	GroupXML_t out;
+	out.xml  = body;
+	out.id   = seqsrc.id;
+	out.path = "/SeqSource";
+	return out;
+      }
+
+      //! Rewrite a sequential source group for a new sink time and momentum
+      GroupXML_t retargetSeqSource(const GroupXML_t& seqsrc, int t_sink,
+				   const multi1d<int>& sink_mom, int& j_decay)
+      {
+	std::istringstream  xml_s(seqsrc.xml);
+	XMLReader  seqsrctop(xml_s);
+	XMLReader  paramtop(seqsrctop, seqsrc.path);
+
+	// Sources integrated over a range of sink times have no single t_sink
+	if (paramtop.count("t_sink_start") != 0 || paramtop.count("pol_dir") != 0)
+	{
+	  QDPIO::cerr << name << ": sequential source " << seqsrc.id
+		      << " is not built on a single sink time slice" << std::endl;
+	  QDP_abort(1);
+	}
+
+	if (paramtop.count("deriv_dir") != 0)
+	  return retargetSeqSource<DerivMesonSeqSourceEnv::ParamsDir>(seqsrc, t_sink, sink_mom, j_decay);
+	else if (paramtop.count("deriv_length") != 0)
+	  return retargetSeqSource<DerivMesonSeqSourceEnv::Params>(seqsrc, t_sink, sink_mom, j_decay);
+	else
+	  return retargetSeqSource<SimpleMesonSeqSourceEnv::Params>(seqsrc, t_sink, sink_mom, j_decay);
+      }
+
+      //! Does a quark displacement stay within a time slice?
+      bool displacementInSlice(const GroupXML_t& disp, int j_decay)
+      {
+	if (disp.id == NoQuarkDisplacementEnv::getName())
+	  return true;
+
+	if (disp.id == SimpleQuarkDisplacementEnv::getName())
+	{
+	  std::istringstream  xml_s(disp.xml);
+	  XMLReader  disptop(xml_s);
+	  SimpleQuarkDisplacementEnv::Params p(disptop, disp.path);
+	  return p.disp_length == 0 || p.disp_dir != j_decay;
+	}
+
+	return false;
+      }
+
+      //! Does a quark smearing stay within a time slice?
+      bool smearingInSlice(const GroupXML_t& smr, int j_decay)
+      {
+	std::istringstream  xml_s(smr.xml);
+	XMLReader  smrtop(xml_s);
+
+	if (smr.id == NoQuarkSmearingEnv::getName())
+	  return true;
+
+	if (smr.id == GausQuarkSmearingEnv::getName())
+	  return GausQuarkSmearingEnv::Params(smrtop, smr.path).no_smear_dir == j_decay;
+
+	if (smr.id == JacobiQuarkSmearingEnv::getName())
+	  return JacobiQuarkSmearingEnv::Params(smrtop, smr.path).no_smear_dir == j_decay;
+
+	return false;
+      }
+
+      //! Does the sink smearing act within each time slice?
+      /*!
+       * Only then can sources on distinct sink times share one
+       * application of it. Unknown smearings are assumed not to.
+       */
+      bool sinkInSlice(const GroupXML_t& sink, int j_decay)
+      {
+	std::istringstream  xml_s(sink.xml);
+	XMLReader  sinktop(xml_s);
+
+	if (sink.id == WallQuarkSinkSmearingEnv::getName())
+	{
+	  return WallQuarkSinkSmearingEnv::Params(sinktop, sink.path).j_decay == j_decay;
+	}
+	else if (sink.id == PointQuarkSinkSmearingEnv::getName())
+	{
+	  PointQuarkSinkSmearingEnv::Params p(sinktop, sink.path);
+	  return displacementInSlice(p.quark_displacement, j_decay);
+	}
+	else if (sink.id == ShellQuarkSinkSmearingEnv::getName())
+	{
+	  ShellQuarkSinkSmearingEnv::Params p(sinktop, sink.path);
+	  return displacementInSlice(p.quark_displacement, j_decay) &&
+	    smearingInSlice(p.quark_smearing, j_decay);
+	}
+	else if (sink.id == NormShellQuarkSinkSmearingEnv::getName())
+	{
+	  NormShellQuarkSinkSmearingEnv::Params p(sinktop, sink.path);
+	  return displacementInSlice(p.quark_displacement, j_decay) &&
+	    smearingInSlice(p.quark_smearing, j_decay);
+	}
+
+	return false;
+      }
+
+      //! Format a momentum the way the XML writer does
+      std::string momString(const multi1d<int>& mom, const std::string& sep)
+      {
+	std::ostringstream os;
+	for(int i=0; i < mom.size(); ++i)
+	{
+	  if (i > 0)
+	    os << sep;
+	  os << mom[i];
+	}
+	return os.str();
+      }
+    }
+
+    const std::string name = "MULTI_SEQSOURCE";
+
+    //! Register all the factories
+    bool registerAll()
+    {
+      bool success = true;
+      if (! registered)
+      {
+	success &= QuarkSinkSmearingEnv::registerAll();
+	success &= HadronSeqSourceEnv::registerAll();
+	success &= TheInlineMeasurementFactory::Instance().registerObject(name, createMeasurement);
+	registered = true;
+      }
+      return success;
+    }
+
+
+    // Param stuff
+    Params::Params() { frequency = 0; }
+
+    Params::Params(XMLReader& xml_in, const std::string& path)
+    {
+      try
+      {
+	XMLReader paramtop(xml_in, path);
+
+	if (paramtop.count("Frequency") == 1)
+	  read(paramtop, "Frequency", frequency);
+	else
+	  frequency = 1;
+
+	// The sink operators, times and momenta
+	read(paramtop, "Param", param);
+
+	// The parameters for smearing the sink
+	read(paramtop, "PropSink", sink_header);
+
+	// Read in the forward_prop/seqsource info
+	read(paramtop, "NamedObject", named_obj);
+      }
+      catch(const std::string& e)
+      {
+	QDPIO::cerr << __func__ << ": Caught Exception reading XML: " << e << std::endl;
+	QDP_abort(1);
+      }
+    }
+
+
+    void
+    Params::writeXML(XMLWriter& xml_out, const std::string& path)
+    {
+      push(xml_out, path);
+
+      write(xml_out, "Param", param);
+      write(xml_out, "PropSink", sink_header);
+      write(xml_out, "NamedObject", named_obj);
+
+      pop(xml_out);
+    }
+
+
+    // Function call
+    void
+    InlineMeas::operator()(unsigned long update_no,
+			   XMLWriter& xml_out)
+    {
+      START_CODE();
+
+      StopWatch snoop;
+      snoop.reset();
+      snoop.start();
+
+      // Test and grab a reference to the gauge field
+      XMLBufferWriter gauge_xml;
+      try
+      {
+	TheNamedObjMap::Instance().getData< multi1d<LatticeColorMatrix> >(params.named_obj.gauge_id);
+	TheNamedObjMap::Instance().get(params.named_obj.gauge_id).getRecordXML(gauge_xml);
+      }
+      catch( std::bad_cast )
+      {
+	QDPIO::cerr << name << ": caught dynamic cast error"
+		    << std::endl;
+	QDP_abort(1);
+      }
+      catch (const std::string& e)
+      {
+	QDPIO::cerr << name << ": std::map call failed: " << e
+		    << std::endl;
+	QDP_abort(1);
+      }
+      const multi1d<LatticeColorMatrix>& u =
+	TheNamedObjMap::Instance().getData< multi1d<LatticeColorMatrix> >(params.named_obj.gauge_id);
+
+      push(xml_out, "multi_seqsource");
+      write(xml_out, "update_no", update_no);
+
+      QDPIO::cout << name << ": multiple propagator sequential source constructor" << std::endl;
+      StopWatch swatch;
+
+      proginfo(xml_out);    // Print out basic program info
+
+      // Write out the input
+      params.writeXML(xml_out, "Input");
+
+      // Write out the config header
+      write(xml_out, "Config_info", gauge_xml);
+
+      push(xml_out, "Output_version");
+      write(xml_out, "out_version", 1);
+      pop(xml_out);
+
+      // Calculate some gauge invariant observables just for info.
+      MesPlq(xml_out, "Observables", u);
+
+      // Sanity checks
+      const int num_t = params.param.t_sinks.size();
+
+      if (params.named_obj.prop_ids.size() == 0 || params.param.seqsrcs.size() == 0 ||
+	  num_t == 0 || params.param.sink_moms.size() == 0)
+      {
+	QDPIO::cerr << name << ": sanity error: nothing to do" << std::endl;
+	QDP_abort(1);
+      }
+
+      for(int t=0; t < num_t; ++t)
+	for(int tt=0; tt < t; ++tt)
+	  if (params.param.t_sinks[t] == params.param.t_sinks[tt])
+	  {
+	    QDPIO::cerr << name << ": t_sink = " << params.param.t_sinks[t]
+			<< " appears more than once" << std::endl;
+	    QDP_abort(1);
+	  }
+
+      //
+      // Read the quark propagators and extract headers
+      //
+      multi1d<LatticePropagator> forward_props(params.named_obj.prop_ids.size());
+      multi1d<ForwardProp_t> forward_headers(params.named_obj.prop_ids.size());
+      push(xml_out, "Forward_prop_infos");
+      for(int loop=0; loop < params.named_obj.prop_ids.size(); ++loop)
+      {
+	push(xml_out, "elem");
+	try
+	{
+	  // Snarf the data into a copy
+	  forward_props[loop] =
+	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.prop_ids[loop]);
+
+	  // Snarf the source info. This is will throw if the source_id is not there
+	  XMLReader prop_file_xml, prop_record_xml;
+	  TheNamedObjMap::Instance().get(params.named_obj.prop_ids[loop]).getFileXML(prop_file_xml);
+	  TheNamedObjMap::Instance().get(params.named_obj.prop_ids[loop]).getRecordXML(prop_record_xml);
+
+	  // Try to invert this record XML into a ChromaProp struct
+	  {
+	    Propagator_t  header;
+	    read(prop_record_xml, "/Propagator", header);
+
+	    forward_headers[loop].prop_header   = header.prop_header;
+	    forward_headers[loop].source_header = header.source_header;
+	    forward_headers[loop].gauge_header  = header.gauge_header;
+	  }
+
+	  // Save prop input
+	  write(xml_out, "Propagator_info", prop_record_xml);
+	}
+	catch( std::bad_cast )
+	{
+	  QDPIO::cerr << name << ": caught dynamic cast error"
+		      << std::endl;
+	  QDP_abort(1);
+	}
+	catch (const std::string& e)
+	{
+	  QDPIO::cerr << name << ": std::map call failed: " << e
+		      << std::endl;
+	  QDP_abort(1);
+	}
+	pop(xml_out);
+      }
+      pop(xml_out);
+
+      QDPIO::cout << "Forward propagators successfully read and parsed" << std::endl;
+
+      // Derived from input prop
+      int j_decay  = forward_headers[0].source_header.j_decay;
+
+      // Initialize the slow Fourier transform phases
+      SftMom phases(0, true, j_decay);
+
+      for(int t=0; t < num_t; ++t)
+      {
+	if (params.param.t_sinks[t] < 0 || params.param.t_sinks[t] >= QDP::Layout::lattSize()[j_decay])
+	{
+	  QDPIO::cerr << "Sink time coordinate incorrect." << std::endl;
+	  QDPIO::cerr << "t_sink = " << params.param.t_sinks[t] << std::endl;
+	  QDP_abort(1);
+	}
+      }
+
+
+      //------------------ Start main body of calculations -----------------------------
+
+      multi1d<std::string> seqsource_ids(params.param.seqsrcs.size() *
+					 params.param.sink_moms.size() * num_t);
+      int num_ids = 0;
+
+      try
+      {
+	std::istringstream  xml_s(params.sink_header.sink.xml);
+	XMLReader  sinktop(xml_s);
+	QDPIO::cout << "Sink = " << params.sink_header.sink.id << std::endl;
+
+	Handle< QuarkSourceSink<LatticePropagator> >
+	  sinkSmearing(ThePropSinkSmearingFactory::Instance().createObject(params.sink_header.sink.id,
+									   sinktop,
+									   params.sink_header.sink.path,
+									   u));
+
+	// Do the sink smearing BEFORE the interpolating operator,
+	// once for all the sequential sources
+	for(int loop=0; loop < params.named_obj.prop_ids.size(); ++loop)
+	{
+	  forward_headers[loop].sink_header = params.sink_header;
+	  (*sinkSmearing)(forward_props[loop]);
+	}
+
+	// Sources on distinct sink times can only share one sink
+	// smearing if the smearing does not mix time slices
+	const bool sink_in_slice = sinkInSlice(params.sink_header.sink, j_decay);
+	if (! sink_in_slice)
+	  QDPIO::cout << name << ": sink smearing " << params.sink_header.sink.id
+		      << " may mix time slices - smearing each sink time separately" << std::endl;
+
+	XMLBufferWriter file_xml;
+	push(file_xml, "seqsource");
+	write(file_xml, "id", uniqueId());  // NOTE: new ID form
+	pop(file_xml);
+
+	push(xml_out, "SeqSources");
+
+	for(int op=0; op < params.param.seqsrcs.size(); ++op)
+	{
+	  const GroupXML_t& seqsrc = params.param.seqsrcs[op];
+	  QDPIO::cout << "SeqSource = " << seqsrc.id << std::endl;
+
+	  for(int mom=0; mom < params.param.sink_moms.size(); ++mom)
+	  {
+	    const multi1d<int>& sink_mom = params.param.sink_moms[mom];
+
+	    multi1d<LatticePropagator> seq_srcs(num_t);
+	    multi1d<SeqSource_t> seq_headers(num_t);
+
+	    // All the sources of this operator and momentum. Check
+	    // whether each one lives only on its own sink time slice.
+	    bool confined = true;
+
+	    swatch.reset();
+	    swatch.start();
+
+	    for(int t=0; t < num_t; ++t)
+	    {
+	      SeqSource_t& hdr = seq_headers[t];
+	      hdr.seqsrc      = retargetSeqSource(seqsrc, params.param.t_sinks[t], sink_mom, hdr.j_decay);
+	      hdr.t_sink      = params.param.t_sinks[t];
+	      hdr.sink_mom    = sink_mom;
+
+	      std::istringstream  xml_seq(hdr.seqsrc.xml);
+	      XMLReader  seqsrctop(xml_seq);
+
+	      Handle< HadronSeqSource<LatticePropagator> >
+		hadSeqSource(TheWilsonHadronSeqSourceFactory::Instance().createObject(hdr.seqsrc.id,
+										      seqsrctop,
+										      hdr.seqsrc.path));
+
+	      seq_srcs[t] = (*hadSeqSource)(u, forward_headers, forward_props);
+
+	      Double leak = norm2(where(Layout::latticeCoordinate(hdr.j_decay) == hdr.t_sink,
+					LatticePropagator(zero),
+					seq_srcs[t]));
+	      if (hdr.j_decay != j_decay || toBool(leak != 0))
+		confined = false;
+	    }
+
+	    // Do the sink smearing AFTER the interpolating operator.
+	    // If the smearing acts within a time slice, sources on
+	    // distinct time slices can share one application.
+	    if (sink_in_slice && confined && num_t > 1)
+	    {
+	      LatticePropagator sum = seq_srcs[0];
+	      for(int t=1; t < num_t; ++t)
+		sum += seq_srcs[t];
+
+	      (*sinkSmearing)(sum);
+
+	      for(int t=0; t < num_t; ++t)
+		seq_srcs[t] = where(Layout::latticeCoordinate(j_decay) == params.param.t_sinks[t],
+				    sum,
+				    LatticePropagator(zero));
+	    }
+	    else
+	    {
+	      for(int t=0; t < num_t; ++t)
+		(*sinkSmearing)(seq_srcs[t]);
+	    }
+
+	    swatch.stop();
+	    QDPIO::cout << "Hadron sequential sources for " << seqsrc.id
+			<< " sink_mom = " << momString(sink_mom, " ")
+			<< " computed: time= "
+			<< swatch.getTimeInSeconds()
+			<< " secs" << std::endl;
+
+	    //
+	    // Write the sequential sources out to named buffers
+	    //
+	    for(int t=0; t < num_t; ++t)
+	    {
+	      std::ostringstream id;
+	      id << params.named_obj.seqsource_id << "_" << seqsrc.id
+		 << "_p" << momString(sink_mom, "_")
+		 << "_t" << params.param.t_sinks[t];
+
+	      // Sanity check - write out the norm2 of the propagator source in the j_decay direction
+	      multi1d<Double> seqsource_corr = sumMulti(localNorm2(seq_srcs[t]),
+							phases.getSet());
+	      push(xml_out, "elem");
+	      write(xml_out, "seqsource_id", id.str());
+	      write(xml_out, "SeqSourceType", seqsrc.id);
+	      write(xml_out, "t_sink", params.param.t_sinks[t]);
+	      write(xml_out, "sink_mom", sink_mom);
+	      write(xml_out, "seqsource_corr", seqsource_corr);
+	      pop(xml_out);
+
+	      // Header composed of all forward prop headers
+	      SequentialSource_t new_header;
+	      new_header.sink_header      = params.sink_header;
+	      new_header.seqsource_header = seq_headers[t];
+	      new_header.forward_props    = forward_headers;
+	      new_header.gauge_header     = gauge_xml.printCurrentContext();
+
+	      XMLBufferWriter record_xml;
+	      write(record_xml, "SequentialSource", new_header);
+
+	      TheNamedObjMap::Instance().create<LatticePropagator>(id.str());
+	      TheNamedObjMap::Instance().getData<LatticePropagator>(id.str()) = seq_srcs[t];
+	      TheNamedObjMap::Instance().get(id.str()).setFileXML(file_xml);
+	      TheNamedObjMap::Instance().get(id.str()).setRecordXML(record_xml);
+
+	      seqsource_ids[num_ids++] = id.str();
+	    }
+	  }
+	}
+
+	pop(xml_out);  // SeqSources
+
+	// The list of sources, in the order they were built
+	if (params.named_obj.seqsource_list_id != "")
+	{
+	  XMLBufferWriter list_record_xml;
+	  push(list_record_xml, "SeqSourceList");
+	  write(list_record_xml, "seqsource_ids", seqsource_ids);
+	  pop(list_record_xml);
+
+	  TheNamedObjMap::Instance().create< multi1d<std::string> >(params.named_obj.seqsource_list_id);
+	  TheNamedObjMap::Instance().getData< multi1d<std::string> >(params.named_obj.seqsource_list_id) = seqsource_ids;
+	  TheNamedObjMap::Instance().get(params.named_obj.seqsource_list_id).setFileXML(file_xml);
+	  TheNamedObjMap::Instance().get(params.named_obj.seqsource_list_id).setRecordXML(list_record_xml);
+	}
+
+	QDPIO::cout << "Stored " << num_ids << " sequential sources" << std::endl;
+      }
+      catch (std::bad_cast)
+      {
+	QDPIO::cerr << name << ": dynamic cast error"
+		    << std::endl;
+	QDP_abort(1);
+      }
+      catch(const std::string& e)
+      {
+	QDPIO::cerr << name << ": Caught Exception: " << e << std::endl;
+	QDP_abort(1);
+      }
+
+      pop(xml_out);    // multi_seqsource
+
+      snoop.stop();
+      QDPIO::cout << name << ": total time = "
+		  << snoop.getTimeInSeconds()
+		  << " secs" << std::endl;
+
+      QDPIO::cout << name << ": ran successfully" << std::endl;
+
+      END_CODE();
+    }
+
+  }
+
+}
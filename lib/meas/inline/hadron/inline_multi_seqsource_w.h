@@ -0,0 +1,89 @@
+// -*- C++ -*-
+/*! \file
+ * \brief Inline construction of many sequential sources in one pass
+ *
+ * Sequential sources for several sink operators, sink momenta and
+ * sink times from one read and one smearing of the forward propagators
+ */
+
+#ifndef __inline_multi_seqsource_w_h__
+#define __inline_multi_seqsource_w_h__
+
+#include "chromabase.h"
+#include "meas/inline/abs_inline_measurement.h"
+#include "io/qprop_io.h"
+#include "io/xml_group_reader.h"
+
+namespace Chroma
+{
+  /*! \ingroup inlinehadron */
+  namespace InlineMultiSeqSourceEnv
+  {
+    extern const std::string name;
+    bool registerAll();
+
+
+    //! Parameter structure
+    /*! \ingroup inlinehadron */
+    struct Params
+    {
+      Params();
+      Params(XMLReader& xml_in, const std::string& path);
+      void writeXML(XMLWriter& xml_out, const std::string& path);
+
+      unsigned long      frequency;
+
+      struct Param_t
+      {
+	multi1d<GroupXML_t>  seqsrcs;      /*!< sink operators; their t_sink and sink_mom are replaced */
+	multi1d<int>         t_sinks;      /*!< sink times */
+	multi1d< multi1d<int> > sink_moms; /*!< sink momenta */
+      } param;
+
+      PropSinkSmear_t    sink_header;
+
+      struct NamedObject_t
+      {
+	std::string            gauge_id;
+	multi1d<std::string>   prop_ids;
+	std::string            seqsource_id;       /*!< prefix of the output ids */
+	std::string            seqsource_list_id;  /*!< optional list of all output ids */
+      } named_obj;
+    };
+
+    //! Compute sequential sources for all operator, momentum and sink time combinations
+    /*! \ingroup inlinehadron
+     *
+     * The forward propagators are read and sink smeared once. For each
+     * operator and momentum the sources of all sink times are summed,
+     * smeared once and split again by time slice, provided each of them
+     * is confined to its own sink time. Otherwise they are smeared one
+     * at a time.
+     *
+     * Each source is stored as  <seqsource_id>_<op>_p<px>_<py>_<pz>_t<t_sink>
+     * with the usual SequentialSource header, and the ids in the order
+     * they were built are stored under seqsource_list_id as a
+     * multi1d<std::string> for a later solver to pick up.
+     */
+    class InlineMeas : public AbsInlineMeasurement
+    {
+    public:
+      ~InlineMeas() {}
+      InlineMeas(const Params& p) : params(p) {}
+      InlineMeas(const InlineMeas& p) : params(p.params) {}
+
+      unsigned long getFrequency(void) const {return params.frequency;}
+
+      //! Do the measurement
+      void operator()(const unsigned long update_no,
+		      XMLWriter& xml_out);
+
+    private:
+      Params params;
+    };
+
+  }
+
+}
+
+#endif
@@ -19,6 +19,7 @@
 #include "util/ferm/key_prop_colorvec.h"
 #include "util/ferm/key_prop_matelem.h"
 #include "util/ferm/key_val_db.h"
+#include "util/ferm/async_db_writer.h"
 #include "util/ferm/transf.h"
 #include "util/ferm/spin_rep.h"
 #include "util/ferm/diractodr.h"
@@ -33,6 +34,9 @@
 
 #include "meas/inline/io/named_objmap.h"
 
+#include <complex>
+#include <map>
+
 #ifndef QDP_IS_QDPJIT
 
 namespace Chroma 
@@ -106,6 +110,10 @@ namespace Chroma
       read(inputtop, "Nt_backward", input.Nt_backward);
       read(inputtop, "mass_label", input.mass_label);
       read(inputtop, "num_tries", input.num_tries);
+
+      input.num_batch = 8;
+      if (inputtop.count("num_batch") != 0)
+	read(inputtop, "num_batch", input.num_batch);
     }
 
     //! Propagator output
@@ -120,6 +128,7 @@ namespace Chroma
       write(xml, "Nt_backward", input.Nt_backward);
       write(xml, "mass_label", input.mass_label);
       write(xml, "num_tries", input.num_tries);
+      write(xml, "num_batch", input.num_batch);
 
       pop(xml);
     }
@@ -299,6 +308,151 @@ namespace Chroma
 
 	return keys;
       }
+
+
+      //----------------------------------------------------------------------------
+      //! Args for the sink projection
+      struct ProjectArgs
+      {
+	const std::complex<float>*   sink;   /*!< num_vecs x K sink vectors */
+	const std::complex<double>*  soln;   /*!< K x ncol solution components */
+	int                          K;
+	int                          ncol;
+	std::complex<double>*        out;    /*!< num_vecs x ncol */
+      };
+
+      //! out = sink^dag soln for the sink vectors [lo,hi)
+      void projectLoop(int lo, int hi, int myId, ProjectArgs* a)
+      {
+	const int K = a->K;
+	const int ncol = a->ncol;
+
+	for(int i=lo; i < hi; ++i)
+	{
+	  std::complex<double>* o = a->out + i*ncol;
+	  const std::complex<float>* v = a->sink + i*K;
+
+	  for(int k=0; k < K; ++k)
+	  {
+	    const std::complex<double> vc(v[k].real(), -v[k].imag());
+	    const std::complex<double>* s = a->soln + k*ncol;
+	    for(int n=0; n < ncol; ++n)
+	      o[n] += vc * s[n];
+	  }
+	}
+      }
+
+
+      //----------------------------------------------------------------------------
+      //! Projects batches of solutions onto the sink vectors of time-slices
+      /*!
+       * The sink vectors of a time-slice are packed once into a dense
+       * num_vecs x (Nc * sites) matrix. The spin components of a batch of
+       * solutions on the time-slice are packed into a (Nc * sites) x (Ns * batch)
+       * matrix, and the perambulator entries are the product of the two.
+       * All time-slices share one global sum.
+       */
+      class SinkProjector
+      {
+      public:
+	//! Constructor
+	SinkProjector(const SubEigenMap& eigen_map_, int num_vecs_) : eigen_map(eigen_map_), num_vecs(num_vecs_) {}
+
+	//! Project the solutions onto the sink vectors of the time-slices
+	/*!
+	 * The entry of sink vector i, solution j and sink spin s on the
+	 * ti-th time-slice is  out[((ti*num_vecs + i)*nsoln + j)*Ns + s]
+	 */
+	void project(std::vector< std::complex<double> >& out, 
+		     const std::vector<int>& t_slices,
+		     const std::vector<const LatticeFermion*>& solns);
+
+      private:
+	//! Packed sink vectors of a time-slice
+	const std::vector< std::complex<float> >& sinkVecs(int t);
+
+	const SubEigenMap& eigen_map;
+	int num_vecs;
+	std::map< int, std::vector< std::complex<float> > > sink;
+      };
+
+
+      //! Packed sink vectors of a time-slice
+      const std::vector< std::complex<float> >& SinkProjector::sinkVecs(int t)
+      {
+	std::map< int, std::vector< std::complex<float> > >::const_iterator it = sink.find(t);
+	if (it != sink.end())
+	  return it->second;
+
+	const Subset& sub = eigen_map.getSet()[t];
+	const int* tab = sub.siteTable().slice();
+	const int nsites = sub.numSiteTable();
+	const int K = Nc*nsites;
+
+	std::vector< std::complex<float> >& v = sink[t];
+	v.resize(num_vecs*K);
+
+	LatticeColorVectorF tmp = zero;
+	for(int i=0; i < num_vecs; ++i)
+	{
+	  tmp = eigen_map.getVec(t, i);
+	  for(int q=0; q < nsites; ++q)
+	  {
+	    const REAL32* w = (const REAL32*)&(tmp.elem(tab[q]));
+	    for(int c=0; c < Nc; ++c)
+	      v[i*K + q*Nc + c] = std::complex<float>(w[2*c], w[2*c+1]);
+	  }
+	}
+
+	return v;
+      }
+
+
+      //! Project the solutions onto the sink vectors of the time-slices
+      void SinkProjector::project(std::vector< std::complex<double> >& out, 
+				  const std::vector<int>& t_slices,
+				  const std::vector<const LatticeFermion*>& solns)
+      {
+	typedef WordType<LatticeFermion>::Type_t W;
+
+	const int nsoln = solns.size();
+	const int ncol = Ns*nsoln;
+	const int chunk = num_vecs*ncol;
+
+	out.assign(t_slices.size()*chunk, std::complex<double>(0,0));
+
+	std::vector< std::complex<double> > S;
+	for(int ti=0; ti < t_slices.size(); ++ti)
+	{
+	  const std::vector< std::complex<float> >& V = sinkVecs(t_slices[ti]);
+
+	  const Subset& sub = eigen_map.getSet()[t_slices[ti]];
+	  const int* tab = sub.siteTable().slice();
+	  const int nsites = sub.numSiteTable();
+	  const int K = Nc*nsites;
+
+	  if (K == 0)
+	    continue;
+
+	  // Spin components of the solutions, sites and colors down the rows
+	  S.resize(K*ncol);
+	  for(int q=0; q < nsites; ++q)
+	  {
+	    for(int j=0; j < nsoln; ++j)
+	    {
+	      const W* w = (const W*)&(solns[j]->elem(tab[q]));
+	      for(int s=0; s < Ns; ++s)
+		for(int c=0; c < Nc; ++c)
+		  S[(q*Nc + c)*ncol + j*Ns + s] = std::complex<double>(w[2*(s*Nc+c)], w[2*(s*Nc+c)+1]);
+	    }
+	  }
+
+	  ProjectArgs a = {&(V[0]), &(S[0]), K, ncol, &(out[ti*chunk])};
+	  dispatch_to_threads(num_vecs, a, projectLoop);
+	}
+
+	QDPInternal::globalSumArray((double*)&(out[0]), 2*out.size());
+      }
 	
     } // end anonymous
   } // end namespace
@@ -526,12 +680,11 @@ namespace Chroma
 
 
       //
-      // DB storage
+      // DB storage. The perambulators are written from a background thread.
       //
-      BinaryStoreDB< SerialDBKey<KeyPropElementalOperator_t>, SerialDBData<ValPropElementalOperator_t> > qdp_db;
+      AsyncDBWriter<KeyPropElementalOperator_t, ValPropElementalOperator_t> qdp_db;
 
-      // Open the file, and write the meta-data and the binary for this operator
-      if (! qdp_db.fileExists(params.named_obj.prop_op_file))
+      // Open the file, and write the meta-data if it is new
       {
 	XMLBufferWriter file_xml;
 
@@ -545,16 +698,7 @@ namespace Chroma
 	write(file_xml, "Weights", readEigVals(eigen_meta_data));
 	pop(file_xml);
 
-	std::string file_str(file_xml.str());
-	qdp_db.setMaxUserInfoLen(file_str.size());
-
-	qdp_db.open(params.named_obj.prop_op_file, O_RDWR | O_CREAT, 0664);
-
-	qdp_db.insertUserdata(file_str);
-      }
-      else
-      {
-	qdp_db.open(params.named_obj.prop_op_file, O_RDWR, 0664);
+	qdp_db.open(params.named_obj.prop_op_file, file_xml.str());
       }
 
       QDPIO::cout << "Finished opening peram file" << std::endl;
@@ -605,6 +749,10 @@ namespace Chroma
 	//
 	const int num_vecs            = params.param.contract.num_vecs;
 	const multi1d<int>& t_sources = params.param.contract.t_sources;
+	const int num_batch           = (params.param.contract.num_batch > 0) ? params.param.contract.num_batch : 1;
+
+	// Projection onto the sink vectors
+	SinkProjector sink_projector(sub_eigen_map, num_vecs);
 
 	// Loop over each time source
 	for(int tt=0; tt < t_sources.size(); ++tt)
@@ -612,6 +760,20 @@ namespace Chroma
 	  int t_source = t_sources[tt];  // This is the actual time-slice.
 	  QDPIO::cout << "t_source = " << t_source << std::endl; 
 
+	  // The active time-slices, and their index in the projections
+	  std::vector<bool> active_t_slices = getActiveTSlices(t_source,
+							       params.param.contract.Nt_forward,
+							       params.param.contract.Nt_backward);
+	  std::vector<int> t_slices;
+	  std::vector<int> t_index(Lt, -1);
+	  for(int t=0; t < Lt; ++t)
+	  {
+	    if (! active_t_slices[t]) {continue;}
+
+	    t_index[t] = t_slices.size();
+	    t_slices.push_back(t);
+	  }
+
 	  // Loop over each spin source
 	  for(int spin_source=0; spin_source < Ns; ++spin_source)
 	  {
@@ -642,10 +804,12 @@ namespace Chroma
 
 
 	    //
-	    // The space distillation loop
+	    // The space distillation loop, in batches of sources
 	    //
-	    for(int colorvec_src=0; colorvec_src < num_vecs; ++colorvec_src)
+	    for(int batch_start=0; batch_start < num_vecs; batch_start += num_batch)
 	    {
+	      const int nb = (num_vecs - batch_start < num_batch) ? num_vecs - batch_start : num_batch;
+
 	      StopWatch sniss1;
 	      sniss1.reset();
 	      sniss1.start();
@@ -653,122 +817,141 @@ namespace Chroma
 	      StopWatch snarss1;
 	      snarss1.reset();
 	      snarss1.start();
-	      QDPIO::cout << "Do spin_source= " << spin_source << "  colorvec_src= " << colorvec_src << std::endl; 
-
-	      // Get the source std::vector
-	      LatticeColorVector vec_srce = zero;
-	      vec_srce = sub_eigen_map.getVec(t_source, colorvec_src);
+	      QDPIO::cout << "Do spin_source= " << spin_source << "  colorvec_src= " << batch_start
+			  << " to " << batch_start + nb - 1 << std::endl; 
 
 	      //
-	      // Loop over each spin source and invert. 
-	      // Use the same colorstd::vector source. No spin dilution will be used.
+	      // Insert each ColorVector into spin index spin_source.
+	      // No spin dilution will be used.
 	      //
-	      multi1d<LatticeColorVector> ferm_out(Ns);
+	      multi1d<LatticeFermion> chi(nb);
+	      multi1d<LatticeFermion> quark_soln(nb);
+	      for(int j=0; j < nb; ++j)
+	      {
+		LatticeColorVector vec_srce = zero;
+		vec_srce = sub_eigen_map.getVec(t_source, batch_start + j);
 
-	      // Insert a ColorVector into spin index spin_source
-	      // This only overwrites sections, so need to initialize first
-	      LatticeFermion chi = zero;
-	      CvToFerm(vec_srce, chi, spin_source);
+		// This only overwrites sections, so need to initialize first
+		chi[j] = zero;
+		CvToFerm(vec_srce, chi[j], spin_source);
+	      }
 
-	      LatticeFermion quark_soln = zero;
+	      // Do the propagator inversions. Solutions that are not finite
+	      // are solved again.
+	      std::vector<int> todo;
+	      for(int j=0; j < nb; ++j)
+		todo.push_back(j);
 
-	      // Do the propagator inversion
-	      // Check if bad things are happening
-	      bool badP = true;
-	      for(int nn = 1; nn <= params.param.contract.num_tries; ++nn)
+	      for(int nn = 1; nn <= params.param.contract.num_tries && ! todo.empty(); ++nn)
 	      {	
-		// Reset
-		quark_soln = zero;
-		badP = false;
-	      
-		// Solve for the solution std::vector
-		SystemSolverResults_t res = (*PP)(quark_soln, chi);
-		ncg_had += res.n_count;
-
-		// Check for finite values - neither NaN nor Inf
-
-		if (isfinite(quark_soln))
+		std::vector<LatticeFermion*> psi_p;
+		std::vector<const LatticeFermion*> chi_p;
+		for(int r=0; r < todo.size(); ++r)
 		{
-		  // Okay
-		  break;
+		  quark_soln[todo[r]] = zero;
+		  psi_p.push_back(&(quark_soln[todo[r]]));
+		  chi_p.push_back(&(chi[todo[r]]));
 		}
-		else
+
+		// Solve for the solution vectors
+		std::vector<SystemSolverResults_t> res = PP->solveBatch(psi_p, chi_p);
+
+		// Check for finite values - neither NaN nor Inf
+		std::vector<int> bad;
+		for(int r=0; r < todo.size(); ++r)
 		{
-		  QDPIO::cerr << name << ": WARNING - found something not finite, may retry\n";
-		  badP = true;
+		  ncg_had += res[r].n_count;
+
+		  if (! isfinite(quark_soln[todo[r]]))
+		  {
+		    QDPIO::cerr << name << ": WARNING - found something not finite for colorvec_src= " 
+				<< batch_start + todo[r] << ", may retry\n";
+		    bad.push_back(todo[r]);
+		  }
 		}
+		todo.swap(bad);
 	      }
 
 	      // Sanity check
-	      if (badP)
+	      if (! todo.empty())
 	      {
 		QDPIO::cerr << name << ": this is bad - did not get a finite solution std::vector after num_tries= " 
 			    << params.param.contract.num_tries << std::endl;
 		QDP_abort(1);
 	      }
 
-	      // Extract into the temporary output array
-	      for(int spin_sink=0; spin_sink < Ns; ++spin_sink)
-	      {
-		ferm_out(spin_sink) = peekSpin(quark_soln, spin_sink);
-	      }
-
 	      snarss1.stop();
-	      QDPIO::cout << "Time to compute prop for spin_source= " << spin_source << "  colorvec_src= " << colorvec_src << "  time = " 
+	      QDPIO::cout << "Time to compute props for spin_source= " << spin_source << "  colorvec_src= " << batch_start 
+			  << " to " << batch_start + nb - 1 << "  time = " 
 			  << snarss1.getTimeInSeconds() 
 			  << " secs" << std::endl;
 
 	      // The perambulator part
-	      // Loop over time
-	      for(int t_slice = 0; t_slice < Lt; ++t_slice)
+	      // Project all the solutions onto all the sink vectors of the active time-slices
+	      std::vector<const LatticeFermion*> soln_p;
+	      for(int j=0; j < nb; ++j)
+		soln_p.push_back(&(quark_soln[j]));
+
+	      std::vector< std::complex<double> > proj;
+	      sink_projector.project(proj, t_slices, soln_p);
+
+	      for(std::list<KeyPropElementalOperator_t>::const_iterator key= snk_keys.begin();
+		  key != snk_keys.end();
+		  ++key)
 	      {
-		// Loop over all the keys
-		for(std::list<KeyPropElementalOperator_t>::const_iterator key= snk_keys.begin();
-		    key != snk_keys.end();
-		    ++key)
+		const int ti = t_index[key->t_slice];
+		multi2d<ComplexD>& mat = peram[*key].mat;
+
+		for(int colorvec_sink=0; colorvec_sink < num_vecs; ++colorvec_sink)
 		{
-		  if (key->t_slice != t_slice) {continue;}
-		  
-		  // Loop over the sink colorvec, form the innerproduct and the resulting perambulator
-		  for(int colorvec_sink=0; colorvec_sink < num_vecs; ++colorvec_sink)
+		  for(int j=0; j < nb; ++j)
 		  {
-		    peram[*key].mat(colorvec_sink,colorvec_src) = innerProduct(sub_eigen_map.getVec(t_slice, colorvec_sink), 
-									       ferm_out(key->spin_snk));
-
-		  } // for colorvec_sink
-		} // for key
-	      } // for t_slice
+		    const std::complex<double>& z = proj[((ti*num_vecs + colorvec_sink)*nb + j)*Ns + key->spin_snk];
+		    mat(colorvec_sink, batch_start + j) = cmplx(RealD(z.real()), RealD(z.imag()));
+		  }
+		} // for colorvec_sink
+	      } // for key
 
 	      sniss1.stop();
-	      QDPIO::cout << "Time to compute and assemble peram for spin_source= " << spin_source << "  colorvec_src= " << colorvec_src << "  time = " 
+	      QDPIO::cout << "Time to compute and assemble peram for spin_source= " << spin_source << "  colorvec_src= " << batch_start 
+			  << " to " << batch_start + nb - 1 << "  time = " 
 			  << sniss1.getTimeInSeconds() 
 			  << " secs" << std::endl;
 
-	    } // for colorvec_src
+	    } // for batch_start
 
-	    // Write out each time-slice chunk of a lattice colorvec soln to disk
-	    QDPIO::cout << "Write perambulator for spin_source= " << spin_source << "  to disk" << std::endl;
+	    // The perambulator is complete. Hand it to the writer and carry on.
 	    StopWatch sniss2;
 	    sniss2.reset();
 	    sniss2.start();
 
-	    // The perambulator is complete. Write it.
 	    for(std::list<KeyPropElementalOperator_t>::const_iterator key= snk_keys.begin();
 		key != snk_keys.end();
 		++key)
 	    {
-	      // Insert/write to disk
 	      qdp_db.insert(*key, peram[*key]);
 	    } // for key
 
 	    sniss2.stop();
-	    QDPIO::cout << "Time to write perambulators for spin_src= " << spin_source << "  time = " 
+	    QDPIO::cout << "Time to queue perambulators for spin_src= " << spin_source << "  time = " 
 			<< sniss2.getTimeInSeconds() 
 			<< " secs" << std::endl;
 	    
 	  } // for spin_src
 	} // for tt
 
+	// Wait for the last writes
+	StopWatch sniss3;
+	sniss3.reset();
+	sniss3.start();
+
+	qdp_db.close();
+
+	sniss3.stop();
+	QDPIO::cout << "Time to finish writing perambulators  time = " 
+		    << sniss3.getTimeInSeconds() 
+		    << " secs" << std::endl;
+
 	swatch.stop();
 	QDPIO::cout << "Propagators computed: time= " 
 		    << swatch.getTimeInSeconds() 
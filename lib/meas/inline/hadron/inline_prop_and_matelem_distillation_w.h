@@ -43,6 +43,7 @@ namespace Chroma
 	  std::string   mass_label;     /*!< Some kind of mass label */
 
 	  int           num_tries;      /*!< In case of bad things happening in the solution vectors, do retries */
+	  int           num_batch;      /*!< Color vector sources solved and projected together */
 	};
 
 	ChromaProp_t    prop;
@@ -87,6 +87,7 @@ namespace Chroma
     try
     {
       TheNamedObjMap::Instance().dump();
+      TheNamedObjMap::Instance().dump(xml_out, "NamedObjects");
     }
     catch( std::bad_cast ) 
     {
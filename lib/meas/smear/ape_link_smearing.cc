@@ -5,6 +5,7 @@
 #include "chromabase.h"
 
 #include "meas/smear/link_smearing_factory.h"
+#include "meas/smear/link_smearing_cache.h"
 #include "meas/smear/ape_link_smearing.h"
 #include "meas/smear/ape_smear.h"
 
@@ -34,7 +35,12 @@ namespace Chroma
       LinkSmearing* createSource(XMLReader& xml_in,
 				 const std::string& path)
       {
-	return new LinkSmear(Params(xml_in, path));
+	Params params(xml_in, path);
+
+	// Identical smearings of the same links are shared through the cache
+	XMLBufferWriter key;
+	write(key, "LinkSmearing", params);
+	return LinkSmearingCacheEnv::cached(new LinkSmear(params), key.str());
       }
 
       //! Local registration flag
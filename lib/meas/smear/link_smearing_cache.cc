@@ -0,0 +1,171 @@
+/*! \file
+ *  \brief Process wide cache of smeared gauge fields
+ */
+
+#include "meas/smear/link_smearing_cache.h"
+#include "actions/ferm/linop/clover_cache_w.h"
+#include "singleton.h"
+#include "handle.h"
+
+#include <list>
+
+namespace Chroma
+{
+
+  namespace LinkSmearingCacheEnv
+  {
+    namespace
+    {
+      //! The smeared fields, least recently used dropped first
+      class LinkSmearingCache
+      {
+      public:
+	LinkSmearingCache() :
+	  max_bytes(0), budget_set(false), access_clock(0),
+	  hits(0), misses(0), evictions(0) {}
+
+	//! Smear u with s, or copy the cached result
+	void smear(multi1d<LatticeColorMatrix>& u, const LinkSmearing& s, const std::string& key)
+	{
+	  const CloverCacheEnv::LinkKey links = CloverCacheEnv::linkFingerprint(u);
+	  ++access_clock;
+
+	  for(std::list<Entry>::iterator e=entries.begin(); e != entries.end(); ++e)
+	  {
+	    if (e->links == links && e->key == key)
+	    {
+	      ++hits;
+	      e->last_access = access_clock;
+	      u = e->u;
+	      QDPIO::cout << "LinkSmearingCache: hit" << std::endl;
+	      return;
+	    }
+	  }
+
+	  ++misses;
+	  s(u);
+
+	  entries.push_front(Entry());
+	  Entry& e = entries.front();
+	  e.links       = links;
+	  e.key         = key;
+	  e.last_access = access_clock;
+	  e.u           = u;
+
+	  trim();
+	}
+
+	void setBudget(size_t bytes)
+	{
+	  max_bytes  = bytes;
+	  budget_set = true;
+	  trim();
+	}
+
+	void clear() {entries.clear();}
+
+	void write(XMLWriter& xml, const std::string& path) const
+	{
+	  push(xml, path);
+	  QDP::write(xml, "hits", hits);
+	  QDP::write(xml, "misses", misses);
+	  QDP::write(xml, "evictions", evictions);
+	  QDP::write(xml, "entries", int(entries.size()));
+	  pop(xml);
+	}
+
+      private:
+	struct Entry
+	{
+	  CloverCacheEnv::LinkKey       links;
+	  std::string                   key;
+	  unsigned long                 last_access;
+	  multi1d<LatticeColorMatrix>   u;
+	};
+
+	//! Bytes of a smeared gauge field on this node
+	static size_t fieldBytes()
+	{
+	  return size_t(Nd) * Layout::sitesOnNode() * sizeof(LatticeColorMatrix().elem(0));
+	}
+
+	//! Drop the least recently used entries beyond the budget, but never the newest
+	void trim()
+	{
+	  const size_t budget = budget_set ? max_bytes : 2*fieldBytes();
+	  if (budget == 0)
+	    return;
+
+	  while (entries.size() > 1 && entries.size()*fieldBytes() > budget)
+	  {
+	    std::list<Entry>::iterator oldest = entries.begin();
+	    for(std::list<Entry>::iterator e=entries.begin(); e != entries.end(); ++e)
+	      if (e->last_access < oldest->last_access)
+		oldest = e;
+
+	    entries.erase(oldest);
+	    ++evictions;
+	  }
+	}
+
+	size_t             max_bytes;
+	bool               budget_set;
+	unsigned long      access_clock;
+	int                hits;
+	int                misses;
+	int                evictions;
+	std::list<Entry>   entries;
+      };
+
+      typedef SingletonHolder< LinkSmearingCache,
+			       QDP::CreateUsingNew,
+			       QDP::NoDestroy,
+			       QDP::SingleThreaded> TheLinkSmearingCache;
+
+
+      //! A smearing that goes through the cache
+      class CachedLinkSmearing : public LinkSmearing
+      {
+      public:
+	CachedLinkSmearing(LinkSmearing* smear_, const std::string& key_) :
+	  smear(smear_), key(key_) {}
+
+	//! Smear the links, or copy the cached result
+	void operator()(multi1d<LatticeColorMatrix>& u) const
+	{
+	  TheLinkSmearingCache::Instance().smear(u, *smear, key);
+	}
+
+      private:
+	Handle<LinkSmearing>  smear;
+	std::string           key;
+      };
+    }
+
+
+    // Wrap a smearing so that it goes through the cache
+    LinkSmearing* cached(LinkSmearing* smear, const std::string& key)
+    {
+      return new CachedLinkSmearing(smear, key);
+    }
+
+    // Set the memory budget in bytes, 0 means unlimited
+    void setBudget(size_t bytes)
+    {
+      TheLinkSmearingCache::Instance().setBudget(bytes);
+    }
+
+    // Drop all entries
+    void clear()
+    {
+      TheLinkSmearingCache::Instance().clear();
+    }
+
+    // Write the hits, misses and evictions so far
+    void write(XMLWriter& xml, const std::string& path)
+    {
+      TheLinkSmearingCache::Instance().write(xml, path);
+    }
+  }
+
+}  // end namespace Chroma
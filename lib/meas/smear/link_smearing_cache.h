@@ -0,0 +1,55 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Process wide cache of smeared gauge fields
+ *
+ *  Measurements in one job often smear the same configuration with the
+ *  same parameters, e.g. a source, a sink and the colour vectors all using
+ *  the same stout links. The link smearings created through the factory
+ *  go through this cache, so each distinct smearing of a configuration is
+ *  done once, on the first request, and copied out afterwards.
+ */
+
+#ifndef __link_smearing_cache_h__
+#define __link_smearing_cache_h__
+
+#include "chromabase.h"
+#include "meas/smear/link_smearing.h"
+
+namespace Chroma
+{
+
+  //! Shared cache of smeared gauge fields
+  /*! \ingroup smear
+   *
+   * An entry is keyed by a fingerprint of the unsmeared links and by the
+   * smearing type and parameters, as written by the parameter writer of the
+   * smearing. The fingerprint stands for the gauge id and the update number:
+   * it is the same for the same configuration under any name and changes
+   * whenever the links change.
+   *
+   * The entries are held within a memory budget; the least recently used
+   * ones are dropped first, but the newest is always kept. The default
+   * budget is two smeared gauge fields.
+   */
+  namespace LinkSmearingCacheEnv
+  {
+    //! Wrap a smearing so that it goes through the cache
+    /*!
+     * \param smear   the smearing, owned by the result    ( Read )
+     * \param key     smearing type and parameters         ( Read )
+     */
+    LinkSmearing* cached(LinkSmearing* smear, const std::string& key);
+
+    //! Set the memory budget in bytes, 0 means unlimited
+    void setBudget(size_t bytes);
+
+    //! Drop all entries
+    void clear();
+
+    //! Write the hits, misses and evictions so far
+    void write(XMLWriter& xml, const std::string& path);
+  }
+
+}  // end namespace Chroma
+
+#endif
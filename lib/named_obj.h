@@ -15,11 +15,144 @@
 
 #include "chromabase.h"
 #include "handle.h"
+#include "qdp_map_obj_memory.h"
 #include <map>
+#include <set>
 #include <string>
+#include <fstream>
+#include <cstdio>
+#include <cctype>
 
 namespace Chroma
 {
+  //--------------------------------------------------------------------------------------
+  //! Size and spill support for a named object type
+  /*! @ingroup support
+   *
+   * By default the size of an object is unknown (zero) and it is never
+   * spilled to disk. Lattice objects, arrays of them and in memory map
+   * objects are specialised below; other containers specialise this
+   * next to their definition. Objects of unknown size are not counted
+   * against the memory budget of the map.
+   */
+  template<typename T>
+  struct NamedObjectTraits
+  {
+    //! Is the size of the object known?
+    static bool sized() {return false;}
+
+    //! Bytes held on this node
+    static unsigned long size(const T& d) {return 0;}
+
+    //! Can the object be written to scratch and freed?
+    static bool spillable() {return false;}
+
+    //! Write the node local data
+    static void spill(std::ostream& os, const T& d) {}
+
+    //! Read the node local data into a freshly allocated object
+    static void restore(std::istream& is, T& d) {}
+  };
+
+
+  //! Lattice objects are spilled as their raw node local sites
+  /*! @ingroup support */
+  template<typename T>
+  struct NamedObjectTraits< OLattice<T> >
+  {
+    static bool sized() {return true;}
+
+    static unsigned long size(const OLattice<T>& d) 
+    {
+      return sizeof(T)*Layout::sitesOnNode();
+    }
+
+#ifndef QDP_IS_QDPJIT
+    static bool spillable() {return true;}
+
+    static void spill(std::ostream& os, const OLattice<T>& d) 
+    {
+      os.write((const char*)&(d.elem(0)), size(d));
+    }
+
+    static void restore(std::istream& is, OLattice<T>& d) 
+    {
+      is.read((char*)&(d.elem(0)), size(d));
+    }
+#else
+    static bool spillable() {return false;}
+    static void spill(std::ostream& os, const OLattice<T>& d) {}
+    static void restore(std::istream& is, OLattice<T>& d) {}
+#endif
+  };
+
+
+  //! Arrays of lattice objects, e.g. gauge fields
+  /*! @ingroup support */
+  template<typename T>
+  struct NamedObjectTraits< multi1d< OLattice<T> > >
+  {
+    static bool sized() {return true;}
+
+    static unsigned long size(const multi1d< OLattice<T> >& d) 
+    {
+      return d.size()*sizeof(T)*Layout::sitesOnNode();
+    }
+
+    static bool spillable() {return NamedObjectTraits< OLattice<T> >::spillable();}
+
+    static void spill(std::ostream& os, const multi1d< OLattice<T> >& d) 
+    {
+      int n = d.size();
+      os.write((const char*)&n, sizeof(int));
+      for(int i=0; i < n; ++i)
+	NamedObjectTraits< OLattice<T> >::spill(os, d[i]);
+    }
+
+    static void restore(std::istream& is, multi1d< OLattice<T> >& d) 
+    {
+      int n = 0;
+      is.read((char*)&n, sizeof(int));
+      d.resize(n);
+      for(int i=0; i < n; ++i)
+	NamedObjectTraits< OLattice<T> >::restore(is, d[i]);
+    }
+  };
+
+
+  //! Map objects, e.g. colorvec maps and eigenvector stores
+  /*! @ingroup support
+   *
+   * Only a map held in memory holds data on the node, a disk backed map
+   * counts as zero. All entries are taken to be the size of the first.
+   * They are not spilled.
+   */
+  template<typename K, typename V>
+  struct NamedObjectTraits< Handle< QDP::MapObject<K,V> > >
+  {
+    static bool sized() {return true;}
+
+    static unsigned long size(const Handle< QDP::MapObject<K,V> >& d) 
+    {
+      const QDP::MapObjectMemory<K,V>* m = 
+	dynamic_cast<const QDP::MapObjectMemory<K,V>*>(d.operator->());
+      if (m == 0 || m->size() == 0)
+	return 0;
+
+      std::vector<K> keys;
+      m->keys(keys);
+      V val;
+      m->get(keys[0], val);
+
+      return m->size()*NamedObjectTraits<V>::size(val);
+    }
+
+    static bool spillable() {return false;}
+    static void spill(std::ostream& os, const Handle< QDP::MapObject<K,V> >& d) {}
+    static void restore(std::istream& is, Handle< QDP::MapObject<K,V> >& d) {}
+  };
+
+
   //--------------------------------------------------------------------------------------
   //! Typeinfo Hiding Base Clase
   /*! @ingroup support
@@ -27,7 +160,7 @@ namespace Chroma
   class NamedObjectBase 
   {
   public:
-    NamedObjectBase() {}
+    NamedObjectBase() : last_access(0) {}
 
     //! Setter
     virtual void setFileXML(XMLReader& xml) = 0;
@@ -53,6 +186,27 @@ namespace Chroma
     //! Getter
     virtual void getRecordXML(XMLBufferWriter& xml) const = 0;
 
+    //! Is the size of the data known?
+    virtual bool sized() const {return false;}
+
+    //! Bytes held in memory on this node, zero if unknown or spilled
+    virtual unsigned long size() const {return 0;}
+
+    //! Can this object be spilled to disk?
+    virtual bool spillable() const {return false;}
+
+    //! Is the data currently on disk?
+    virtual bool spilled() const {return false;}
+
+    //! Write the data to a node local file and free it
+    virtual void spill(const std::string& file) {}
+
+    //! Read the data back from disk and remove the file
+    virtual void restore() {}
+
+    //! Last access stamp, used for the least-recently-used policy
+    unsigned long last_access;
+
     // This is key for cleanup
     virtual ~NamedObjectBase() {}
   };
@@ -67,13 +221,17 @@ namespace Chroma
   {
   public:
     //! Constructor
-    NamedObject() : data(new T) {}
+    NamedObject() : data(new T), is_spilled(false) {}
   
     template<typename P1>
-    NamedObject(const P1& p1) : data(new T(p1)) {}
+    NamedObject(const P1& p1) : data(new T(p1)), is_spilled(false) {}
  
     //! Destructor
-    ~NamedObject() {}
+    ~NamedObject() 
+    {
+      if (is_spilled)
+	std::remove(spill_file.c_str());
+    }
 
     //! Setter
     void setFileXML(XMLReader& xml) 
@@ -139,10 +297,83 @@ namespace Chroma
       return *data;
     }
 
+    //! Is the size of the data known?
+    bool sized() const {return NamedObjectTraits<T>::sized();}
+
+    //! Bytes held in memory on this node
+    unsigned long size() const 
+    {
+      return (is_spilled) ? 0 : NamedObjectTraits<T>::size(*data);
+    }
+
+    //! Can this object be spilled to disk?
+    bool spillable() const {return NamedObjectTraits<T>::spillable();}
+
+    //! Is the data currently on disk?
+    bool spilled() const {return is_spilled;}
+
+    //! Write the data to a node local file and free it
+    /*!
+     * The file holds a magic number and the payload length, followed by
+     * the raw node local data
+     */
+    void spill(const std::string& file) 
+    {
+      if (is_spilled || ! spillable())
+	return;
+
+      std::ofstream os(file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+      unsigned long header[2] = {spill_magic, NamedObjectTraits<T>::size(*data)};
+      os.write((const char*)header, sizeof(header));
+      NamedObjectTraits<T>::spill(os, *data);
+      os.close();
+
+      if (os.fail())
+      {
+	std::ostringstream error_stream;
+	error_stream << "NamedObject::spill : error writing " << file << std::endl;
+	throw error_stream.str();
+      }
+
+      spill_file = file;
+      is_spilled = true;
+      data = Handle<T>();
+    }
+
+    //! Read the data back from disk and remove the file
+    void restore() 
+    {
+      if (! is_spilled)
+	return;
+
+      std::ifstream is(spill_file.c_str(), std::ios::in | std::ios::binary);
+      unsigned long header[2] = {0, 0};
+      is.read((char*)header, sizeof(header));
+
+      Handle<T> d(new T);
+      NamedObjectTraits<T>::restore(is, *d);
+
+      if (is.fail() || header[0] != spill_magic || header[1] != NamedObjectTraits<T>::size(*d))
+      {
+	std::ostringstream error_stream;
+	error_stream << "NamedObject::restore : error reading " << spill_file << std::endl;
+	throw error_stream.str();
+      }
+      is.close();
+
+      std::remove(spill_file.c_str());
+      data = d;
+      is_spilled = false;
+    }
+
   private:
+    static const unsigned long spill_magic = 0x4e4f424aUL;
+
     Handle<T>   data;
     std::string file_xml;
     std::string record_xml;
+    bool        is_spilled;
+    std::string spill_file;
   };
 
 
@@ -154,7 +385,7 @@ namespace Chroma
   {
   public:
     // Creation: clear the std::map
-    NamedObjectMap() {
+    NamedObjectMap() : max_bytes(0), scratch_dir("."), access_clock(0), spill_count(0) {
       the_map.clear();
     };
 
@@ -268,11 +499,116 @@ namespace Chroma
     {
       QDPIO::cout << "Available Keys are : " << std::endl;
       for(MapType_t::const_iterator j = the_map.begin(); j != the_map.end(); j++) 
-	QDPIO::cout << j->first << std::endl;
+      {
+	QDPIO::cout << j->first << "  bytes= " << j->second->size();
+	if (j->second->spilled())
+	  QDPIO::cout << "  (spilled)";
+	QDPIO::cout << std::endl;
+      }
+      QDPIO::cout << "Total bytes in memory per node= " << memoryInUse() << std::endl;
+    }
+
+
+    //! Write the objects and their sizes
+    void dump(XMLWriter& xml, const std::string& path) const
+    {
+      push(xml, path);
+      write(xml, "bytes_in_memory", memoryInUse());
+      write(xml, "max_bytes", max_bytes);
+      write(xml, "spill_count", spill_count);
+      push(xml, "Objects");
+      for(MapType_t::const_iterator j = the_map.begin(); j != the_map.end(); j++) 
+      {
+	push(xml, "elem");
+	write(xml, "id", j->first);
+	write(xml, "bytes", j->second->size());
+	write(xml, "spilled", j->second->spilled());
+	pop(xml);
+      }
+      pop(xml);
+      pop(xml);
+    }
+
+
+    //! Set the memory budget per node in bytes and where to spill
+    /*!
+     * A budget of zero means no limit. Only objects of known size are
+     * counted, see NamedObjectTraits.
+     */
+    void setBudget(unsigned long max_bytes_, const std::string& scratch_dir_)
+    {
+      max_bytes   = max_bytes_;
+      scratch_dir = scratch_dir_;
+    }
+
+
+    //! Bytes held in memory on this node by the objects of known size
+    unsigned long memoryInUse() const
+    {
+      unsigned long bytes = 0;
+      for(MapType_t::const_iterator j = the_map.begin(); j != the_map.end(); j++) 
+	bytes += j->second->size();
+
+      return bytes;
+    }
+
+
+    //! Spill least-recently-used objects until the budget is met
+    /*!
+     * References returned by get() and getData() are invalidated for the
+     * objects that get spilled, so this must only be called when no such
+     * references are held, e.g. between inline measurements.
+     *
+     * All nodes hold the same objects and see the same lookups, so they
+     * make the same choices.
+     */
+    void enforceBudget()
+    {
+      if (max_bytes == 0)
+	return;
+
+      // Say once which objects the budget does not see
+      for(MapType_t::const_iterator j = the_map.begin(); j != the_map.end(); j++) 
+      {
+	if (! j->second->sized() && unsized_ids.insert(j->first).second)
+	  QDPIO::cout << "NamedObjectMap: size of id= " << j->first 
+		      << " is unknown, it is not counted against the memory budget" << std::endl;
+      }
+
+      unsigned long bytes = memoryInUse();
+      while (bytes > max_bytes)
+      {
+	// Find the least recently used resident object that can be spilled
+	MapType_t::iterator victim = the_map.end();
+	for(MapType_t::iterator j = the_map.begin(); j != the_map.end(); j++) 
+	{
+	  NamedObjectBase& obj = *(j->second);
+	  if (obj.spilled() || ! obj.spillable() || obj.size() == 0)
+	    continue;
+
+	  if (victim == the_map.end() || obj.last_access < victim->second->last_access)
+	    victim = j;
+	}
+
+	if (victim == the_map.end())
+	{
+	  QDPIO::cout << "NamedObjectMap: over the memory budget but nothing left to spill" << std::endl;
+	  break;
+	}
+
+	unsigned long victim_bytes = victim->second->size();
+	QDPIO::cout << "NamedObjectMap: spilling id= " << victim->first 
+		    << "  bytes= " << victim_bytes << std::endl;
+
+	victim->second->spill(spillFile(victim->first));
+	++spill_count;
+	bytes -= victim_bytes;
+      }
     }
   
   
     //! Look something up and return a NamedObjectBase reference
+    /*! Objects that were spilled to disk are read back in */
     NamedObjectBase& get(const std::string& id) const
     {
       // Find it
@@ -287,7 +623,15 @@ namespace Chroma
       else 
       {
 	// Found, return the reference
-	return *(iter->second);
+	NamedObjectBase& obj = *(iter->second);
+	if (obj.spilled())
+	{
+	  QDPIO::cout << "NamedObjectMap: restoring id= " << id << std::endl;
+	  obj.restore();
+	}
+
+	obj.last_access = ++access_clock;
+	return obj;
       }
     }
 
@@ -320,8 +664,25 @@ namespace Chroma
     }
 
   private:
+    //! Node local scratch file for an object
+    std::string spillFile(const std::string& id) const
+    {
+      std::ostringstream os;
+      os << scratch_dir << "/chroma_named_obj_";
+      for(std::string::const_iterator c = id.begin(); c != id.end(); ++c)
+	os << (isalnum(*c) ? *c : '_');
+      os << "_" << spill_count << "_node" << Layout::nodeNumber() << ".bin";
+      return os.str();
+    }
+
     typedef std::map<std::string, NamedObjectBase*> MapType_t;
     MapType_t the_map;
+
+    unsigned long max_bytes;        /*!< memory budget per node, 0 is unlimited */
+    std::string   scratch_dir;      /*!< where spilled objects go */
+    mutable unsigned long access_clock;
+    unsigned long spill_count;
+    std::set<std::string> unsized_ids;  /*!< objects of unknown size already reported */
   };
 
 }
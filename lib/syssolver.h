@@ -8,6 +8,8 @@
 
 #include "chromabase.h"
 
+#include <vector>
+
 namespace Chroma
 {
   //-----------------------------------------------------------------------------------
@@ -45,6 +47,21 @@ namespace Chroma
      */
     virtual SystemSolverResults_t operator() (T& psi, const T& chi) const = 0;
 
+    //! Solve for a batch of source vectors
+    /*!
+     * Solves   A*psi[i] = chi[i]  for all i. The default solves one source
+     * after the other. Solvers that can share work between right hand
+     * sides, e.g. with a multi-rhs operator, override this.
+     */
+    virtual std::vector<SystemSolverResults_t> solveBatch(const std::vector<T*>& psi,
+							  const std::vector<const T*>& chi) const
+    {
+      std::vector<SystemSolverResults_t> res(chi.size());
+      for(int i=0; i < chi.size(); ++i)
+	res[i] = (*this)(*(psi[i]), *(chi[i]));
+      return res;
+    }
+
     //! Return the subset on which the operator acts
     virtual const Subset& subset() const = 0;
   };
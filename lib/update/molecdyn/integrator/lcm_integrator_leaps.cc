@@ -79,6 +79,45 @@ namespace Chroma
       END_CODE();
     }
 
+    //! Force gradient LeapP for just a selected list of monomials
+    void leapPFG(const multi1d< IntegratorShared::MonomialPair >& monomials,
+		 const Real& dt,
+		 const Real& dt_fg,
+		 AbsFieldState<multi1d<LatticeColorMatrix>,
+		               multi1d<LatticeColorMatrix> >& s)
+    {
+      START_CODE();
+
+      XMLWriter& xml_out = TheXMLLogWriter::Instance();
+      push(xml_out, "leapPFG");
+      write(xml_out, "dt", dt);
+      write(xml_out, "dt_fg", dt_fg);
+
+      // Keep the links and momenta to put back
+      multi1d<LatticeColorMatrix> u_save(s.getQ());
+      multi1d<LatticeColorMatrix> p_save(s.getP());
+
+      // Displace the links along the force:  a leapP from zero momenta
+      // followed by a unit leapQ, so the anisotropy factors go the same way
+      for(int mu=0; mu < Nd; mu++) 
+	(s.getP())[mu] = zero;
+
+      push(xml_out, "Displacement");
+      leapP(monomials, dt_fg, s);
+      leapQ(Real(1), s);
+      pop(xml_out);
+
+      // Force on the displaced links
+      s.getP() = p_save;
+      leapP(monomials, dt, s);
+
+      s.getQ() = u_save;
+
+      pop(xml_out); // leapPFG
+
+      END_CODE();
+    }
+
     void leapQ(const Real& dt, 
 	       AbsFieldState<multi1d<LatticeColorMatrix>,
 	       multi1d<LatticeColorMatrix> >& s) 
@@ -69,6 +69,23 @@ namespace Chroma
 			     multi1d<LatticeColorMatrix> >& s);
 
 
+    //! Force gradient LeapP for a list of Monomials
+    /*! @ingroup integrator
+     *
+     * P is updated with the force of the monomials evaluated on the
+     * links displaced along that same force by dt_fg,
+     *
+     *   U' = exp( dt_fg F(U) ) U,     P <- P + dt F(U')
+     *
+     * which to the required order is the force gradient (Hessian)
+     * term of the integrator without computing the Hessian.
+     * The links are restored afterwards.
+     */
+    void leapPFG(const multi1d< IntegratorShared::MonomialPair >& monomials,
+		 const Real& dt,
+		 const Real& dt_fg,
+		 AbsFieldState<multi1d<LatticeColorMatrix>,
+		               multi1d<LatticeColorMatrix> >& s);
 
 
   } // End Namespace MDIntegratorSteps
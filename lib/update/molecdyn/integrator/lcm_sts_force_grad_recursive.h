@@ -0,0 +1,138 @@
+// -*- C++ -*-
+
+/*! @file
+ * @brief Force gradient recursive integrator
+ *
+ * Omelyan's 4th order force gradient integrator, with the force
+ * gradient term approximated by a force evaluation on displaced links
+ */
+
+#ifndef LCM_STS_FORCE_GRAD_RECURSIVE_H
+#define LCM_STS_FORCE_GRAD_RECURSIVE_H
+
+
+#include "chromabase.h"
+#include "update/molecdyn/hamiltonian/abs_hamiltonian.h"
+#include "update/molecdyn/integrator/abs_integrator.h"
+#include "update/molecdyn/integrator/integrator_shared.h"
+
+namespace Chroma 
+{
+
+  /*! @ingroup integrator */
+  namespace LatColMatSTSForceGradRecursiveIntegratorEnv 
+  {
+    extern const std::string name;
+    bool registerAll();
+  }
+
+
+  /*! @ingroup integrator */
+  struct  LatColMatSTSForceGradRecursiveIntegratorParams
+  {
+    LatColMatSTSForceGradRecursiveIntegratorParams();
+    LatColMatSTSForceGradRecursiveIntegratorParams(XMLReader& xml, const std::string& path);
+    int  n_steps;
+    multi1d<std::string> monomial_ids;
+    std::string subintegrator_xml;
+  };
+
+  /*! @ingroup integrator */
+  void read(XMLReader& xml_in, 
+	    const std::string& path,
+	    LatColMatSTSForceGradRecursiveIntegratorParams& p);
+
+  /*! @ingroup integrator */
+  void write(XMLWriter& xml_out,
+	     const std::string& path, 
+	     const LatColMatSTSForceGradRecursiveIntegratorParams& p);
+
+  //! Force gradient integrator
+  /*! @ingroup integrator
+   *  Specialised to multi1d<LatticeColorMatrix>
+   *
+   *  Each step is
+   *
+   *    exp(dt/6 S) exp(dt/2 T) exp(2dt/3 S + dt^3/72 C) exp(dt/2 T) exp(dt/6 S)
+   *
+   *  with T the sub integrator and C = [S,[S,T]] the force gradient term.
+   *  The middle exponential is done with one extra force evaluation on
+   *  links displaced by dt^2/24 along the force (LCMMDIntegratorSteps::leapPFG),
+   *  so a step costs 4 force evaluations of this level, 3 after rolling the
+   *  outer dt/6 updates of neighbouring steps together, against 2 for the
+   *  2nd order minimum norm integrator. In exchange the error is 4th order
+   *  so much larger steps are possible. Since all monomials at this level
+   *  commute with those below it, the sub integrator may be any component.
+   */
+  class LatColMatSTSForceGradRecursiveIntegrator 
+    : public AbsRecursiveIntegrator<multi1d<LatticeColorMatrix>,
+				    multi1d<LatticeColorMatrix> > 
+  {
+  public:
+
+    // Simplest Constructor
+    LatColMatSTSForceGradRecursiveIntegrator(int  n_steps_, 
+					 const multi1d<std::string>& monomial_ids_,
+					 Handle< AbsComponentIntegrator< multi1d<LatticeColorMatrix>, multi1d<LatticeColorMatrix> > >& SubIntegrator_) : n_steps(n_steps_), SubIntegrator(SubIntegrator_) {
+
+      IntegratorShared::bindMonomials(monomial_ids_, monomials);
+    };
+
+    // Construct from params struct and Hamiltonian
+    LatColMatSTSForceGradRecursiveIntegrator(
+					 const LatColMatSTSForceGradRecursiveIntegratorParams& p) : n_steps(p.n_steps), SubIntegrator(IntegratorShared::createSubIntegrator(p.subintegrator_xml)) {
+
+      IntegratorShared::bindMonomials(p.monomial_ids, monomials);
+      
+    }
+
+
+    // Copy constructor
+    LatColMatSTSForceGradRecursiveIntegrator(const LatColMatSTSForceGradRecursiveIntegrator& l) :
+      n_steps(l.n_steps), monomials(l.monomials), SubIntegrator(l.SubIntegrator) {}
+
+    // ! Destruction is automagic
+    ~LatColMatSTSForceGradRecursiveIntegrator(void) {};
+
+
+    void operator()( AbsFieldState<multi1d<LatticeColorMatrix>,
+		                   multi1d<LatticeColorMatrix> >& s, 
+		     const Real& traj_length) const;
+   			    
+    AbsComponentIntegrator<multi1d<LatticeColorMatrix>,
+			   multi1d<LatticeColorMatrix> >& getSubIntegrator() const {
+      return (*SubIntegrator);
+    }
+    
+  protected:
+    //! Refresh fields in just this level
+    void refreshFieldsThisLevel(AbsFieldState<multi1d<LatticeColorMatrix>,
+				multi1d<LatticeColorMatrix> >& s) const {
+      for(int i=0; i < monomials.size(); i++) { 
+	monomials[i].mon->refreshInternalFields(s);
+      }
+    }
+
+    //! Reset Predictors in just this level
+    void resetPredictorsThisLevel(void) const {
+      for(int i=0; i < monomials.size(); ++i) {
+	monomials[i].mon->resetPredictors();
+      }
+    }
+
+  private:
+    
+    int  n_steps;
+
+    multi1d< IntegratorShared::MonomialPair > monomials;
+
+    Handle< AbsComponentIntegrator<multi1d<LatticeColorMatrix>,
+				   multi1d<LatticeColorMatrix> > > SubIntegrator;
+	              
+
+  };
+
+}
+
+
+#endif
@@ -9,6 +9,10 @@
 
 #include "update/molecdyn/monomial/remez.h"
 
+#include <fstream>
+#include <cmath>
+#include <cstdio>
+
 namespace Chroma 
 { 
 
@@ -69,6 +73,9 @@ namespace Chroma
 	read(paramtop, "digitPrecision", digitPrecision);
       else
 	digitPrecision = 50;
+
+      if (paramtop.count("cacheFile") != 0)
+	read(paramtop, "cacheFile", cacheFile);
     }
 
 
@@ -84,11 +91,142 @@ namespace Chroma
       write(xml, "upperMax", upperMax);
       write(xml, "degree", degree);
       write(xml, "digitPrecision", digitPrecision);
+      if (cacheFile != "")
+	write(xml, "cacheFile", cacheFile);
       
       pop(xml);
     }
 
 
+
+    //! Cache of approximations on disk
+    namespace
+    {
+      //! One computed approximation
+      struct CacheEntry_t
+      {
+	Params        key;
+	Real          error;      /*!< maximum relative error of the approximation */
+	RemezCoeff_t  pfe;
+	RemezCoeff_t  ipfe;
+      };
+
+      void readCoeff(XMLReader& xml, const std::string& path, RemezCoeff_t& c)
+      {
+	XMLReader top(xml, path);
+	read(top, "norm", c.norm);
+	read(top, "res", c.res);
+	read(top, "pole", c.pole);
+      }
+
+      void writeCoeff(XMLWriter& xml, const std::string& path, const RemezCoeff_t& c)
+      {
+	push(xml, path);
+	write(xml, "norm", c.norm);
+	write(xml, "res", c.res);
+	write(xml, "pole", c.pole);
+	pop(xml);
+      }
+
+      void read(XMLReader& xml, const std::string& path, CacheEntry_t& e)
+      {
+	XMLReader top(xml, path);
+	read(top, "numPower", e.key.numPower);
+	read(top, "denPower", e.key.denPower);
+	read(top, "lowerMin", e.key.lowerMin);
+	read(top, "upperMax", e.key.upperMax);
+	read(top, "degree", e.key.degree);
+	read(top, "digitPrecision", e.key.digitPrecision);
+	read(top, "error", e.error);
+	readCoeff(top, "PFECoeffs", e.pfe);
+	readCoeff(top, "IPFECoeffs", e.ipfe);
+      }
+
+      void write(XMLWriter& xml, const std::string& path, const CacheEntry_t& e)
+      {
+	push(xml, path);
+	write(xml, "numPower", e.key.numPower);
+	write(xml, "denPower", e.key.denPower);
+	write(xml, "lowerMin", e.key.lowerMin);
+	write(xml, "upperMax", e.key.upperMax);
+	write(xml, "degree", e.key.degree);
+	write(xml, "digitPrecision", e.key.digitPrecision);
+	write(xml, "error", e.error);
+	writeCoeff(xml, "PFECoeffs", e.pfe);
+	writeCoeff(xml, "IPFECoeffs", e.ipfe);
+	pop(xml);
+      }
+
+      //! Equal up to the rounding of the decimal representation in the file
+      bool sameBound(const Real& a, const Real& b)
+      {
+	double x = toDouble(a);
+	double y = toDouble(b);
+	return std::fabs(x - y) <= 1.0e-10 * std::max(std::fabs(x), std::fabs(y));
+      }
+
+      bool sameKey(const Params& a, const Params& b)
+      {
+	return (a.numPower == b.numPower) && (a.denPower == b.denPower) 
+	  && (a.degree == b.degree) && (a.digitPrecision == b.digitPrecision)
+	  && sameBound(a.lowerMin, b.lowerMin) && sameBound(a.upperMax, b.upperMax);
+      }
+
+      //! An entry is only used if it is complete and its error is sensible
+      bool validEntry(const CacheEntry_t& e)
+      {
+	double err = toDouble(e.error);
+	return (err == err) && (err > 0) && (err < 1)
+	  && (e.pfe.res.size() == e.key.degree) && (e.pfe.pole.size() == e.key.degree)
+	  && (e.ipfe.res.size() == e.key.degree) && (e.ipfe.pole.size() == e.key.degree);
+      }
+
+      //! Read all the entries of the cache file, if it exists
+      void readCache(const std::string& file, multi1d<CacheEntry_t>& entries)
+      {
+	entries.resize(0);
+
+	int exists = 0;
+	if (Layout::primaryNode())
+	{
+	  std::ifstream f(file.c_str());
+	  exists = f.good() ? 1 : 0;
+	}
+	QDPInternal::broadcast(exists);
+
+	if (! exists)
+	  return;
+
+	try 
+	{
+	  XMLReader xml(file);
+	  read(xml, "/RemezCache/Entries", entries);
+	}
+	catch(const std::string& e) 
+	{
+	  QDPIO::cout << name << ": ignoring unreadable cache file " << file << ": " << e << std::endl;
+	  entries.resize(0);
+	}
+      }
+
+      //! Write the entries to the cache file
+      /*! Written to a temporary and renamed, so a reader never sees a partial file */
+      void writeCache(const std::string& file, const multi1d<CacheEntry_t>& entries)
+      {
+	const std::string tmp = file + ".tmp";
+	{
+	  XMLFileWriter xml(tmp);
+	  push(xml, "RemezCache");
+	  write(xml, "Entries", entries);
+	  pop(xml);
+	  xml.close();
+	}
+
+	if (Layout::primaryNode())
+	  std::rename(tmp.c_str(), file.c_str());
+      }
+    }
+
     // Produce the partial-fraction-expansion (PFE) and its inverse (IPFE)
     void RatApprox::operator()(RemezCoeff_t& pfe, RemezCoeff_t& ipfe) const
     {
@@ -107,11 +245,33 @@ namespace Chroma
 	QDP_abort(1);
       }
 
+      // Look for it in the cache
+      multi1d<CacheEntry_t> entries;
+      if (params.cacheFile != "")
+      {
+	readCache(params.cacheFile, entries);
+
+	for(int i=0; i < entries.size(); ++i)
+	{
+	  if (sameKey(entries[i].key, params) && validEntry(entries[i]))
+	  {
+	    QDPIO::cout << "Read partial fraction expansion from " << params.cacheFile 
+			<< "  error=" << entries[i].error << std::endl;
+
+	    pfe  = entries[i].pfe;
+	    ipfe = entries[i].ipfe;
+
+	    END_CODE();
+	    return;
+	  }
+	}
+      }
+
       // Find approx to  x^abs(params.numPower/params.denPower)
       QDPIO::cout << "Compute partial fraction expansion" << std::endl;
       QDPIO::cout << "Numerator Power=" << power_num << " Denominator Power=" << power_den << std::endl;
       Remez  remez(params.lowerMin, params.upperMax, prec);
-      remez.generateApprox(params.degree, power_num, power_den);
+      Real error = remez.generateApprox(params.degree, power_num, power_den);
 
       if (params.numPower > 0)
       {
@@ -130,6 +290,30 @@ namespace Chroma
 	ipfe = remez.getPFE();
       }
 
+      // Keep it for next time
+      if (params.cacheFile != "")
+      {
+	CacheEntry_t e;
+	e.key   = params;
+	e.error = error;
+	e.pfe   = pfe;
+	e.ipfe  = ipfe;
+
+	if (validEntry(e))
+	{
+	  // Another job may have added entries meanwhile
+	  readCache(params.cacheFile, entries);
+
+	  multi1d<CacheEntry_t> all(entries.size() + 1);
+	  for(int i=0; i < entries.size(); ++i)
+	    all[i] = entries[i];
+	  all[entries.size()] = e;
+
+	  writeCache(params.cacheFile, all);
+	  QDPIO::cout << "Added partial fraction expansion to " << params.cacheFile << std::endl;
+	}
+      }
+
       END_CODE();
     }
 
@@ -31,11 +31,17 @@ namespace Chroma
       Real upperMax;        /*!< upper bound of approximation region */
       int  degree;          /*!< degree of approximation */
       int  digitPrecision;  /*!< number of digits used for bigfloat calcs */
+      std::string cacheFile; /*!< optional file of previously computed approximations */
     };
 
 
     //! Remez type of rational approximations
-    /*! @ingroup monomial */
+    /*! @ingroup monomial
+     *
+     * If cacheFile is given, approximations are looked up there by their
+     * parameters before running the Remez algorithm, and new ones are
+     * added to it together with their error.
+     */
     class RatApprox : public RationalApprox
     {
     public:
@@ -482,8 +482,6 @@ namespace Chroma
       //Create LinOp
       Handle< EvenOddPrecLogDetLinearOperator<Phi,P,Q> > M(FA.linOp(state));
 
-      P F_tmp;
-
       // Do the force computation. deriv() in these linops refers only
       // to the bit coming from the odd-odd bilinear -- this works in 
       // the normal way.
@@ -503,22 +501,14 @@ namespace Chroma
       Phi Y;
       (*M)(Y, X, PLUS);
 
-      M->deriv(F, X, Y, MINUS);
-      
       // fold M^dag into X^dag ->  Y  !!
-
-      M->deriv(F_tmp, Y, X, PLUS);
-      F += F_tmp;
+      // The bilinear and the 2 TrLn A_ee pieces together, so the
+      // operator can share work between them
+      M->derivMdagMLogDet(F, X, Y, Real(2));
  
       for(int mu=0; mu < F.size(); ++mu) {
 	F[mu] *= Real(-1);
       }
-   
-      
-      M->derivLogDetEvenEvenLinOp(F_tmp, PLUS);
-      for(int mu =0; mu < Nd; mu++) { 
-	F[mu] += Real(-2)*F_tmp[mu]; 
-      }
       
       state->deriv(F);
       write(xml_out, "n_count", res.n_count);
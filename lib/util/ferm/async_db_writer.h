@@ -0,0 +1,140 @@
+// -*- C++ -*-
+/*! \file
+ * \brief Write key/value pairs to a DB from a background thread
+ */
+
+#ifndef __async_db_writer_h__
+#define __async_db_writer_h__
+
+#include "chromabase.h"
+#include "util/ferm/key_val_db.h"
+#include "util/ferm/background_writer.h"
+
+#include <utility>
+
+namespace Chroma
+{
+  //---------------------------------------------------------------------
+  //! Writes key/value pairs to a DB from a background thread
+  /*! \ingroup ferm
+   *
+   * The DB is only opened on the primary node, and the thread there does
+   * the serialisation and the disk writes, so it never communicates. All
+   * calls are collective. insert() copies the pair into a queue and
+   * returns, blocking only if more than max_pending pairs are waiting.
+   * flush() waits for the queue to drain and checks the writes.
+   */
+  template<typename K, typename V>
+  class AsyncDBWriter : private BackgroundWriter< std::pair< SerialDBKey<K>, SerialDBData<V> > >
+  {
+    typedef std::pair< SerialDBKey<K>, SerialDBData<V> > Item;
+
+  public:
+    //! Constructor
+    /*!
+     * \param max_pending_  pairs that may wait to be written  ( Read )
+     */
+    AsyncDBWriter(int max_pending_ = 256) : BackgroundWriter<Item>(max_pending_), is_open(false) {}
+
+    //! Destructor waits for the pending writes
+    ~AsyncDBWriter() {close();}
+
+    //! Open or create the DB and start the writer
+    /*!
+     * The user data is only written if the DB is created.
+     *
+     * \param file       DB file name  ( Read )
+     * \param user_data  meta-data of a new DB  ( Read )
+     */
+    void open(const std::string& file, const std::string& user_data)
+    {
+      int ret = 0;
+      if (Layout::primaryNode())
+      {
+	if (! db.fileExists(file))
+	{
+	  db.setMaxUserInfoLen(user_data.size());
+	  ret = db.open(file, O_RDWR | O_CREAT, 0664);
+	  if (ret == 0)
+	    ret = db.insertUserdata(user_data);
+	}
+	else
+	{
+	  ret = db.open(file, O_RDWR, 0664);
+	}
+      }
+      QDPInternal::broadcast(ret);
+
+      if (ret != 0)
+      {
+	QDPIO::cerr << __func__ << ": error opening DB= " << file << std::endl;
+	QDP_abort(1);
+      }
+
+      is_open = true;
+
+      if (Layout::primaryNode())
+	this->start();
+    }
+
+    //! Queue a pair for writing
+    void insert(const K& key, const V& val)
+    {
+      if (! Layout::primaryNode())
+	return;
+
+      Item item(SerialDBKey<K>(key), SerialDBData<V>(val));
+      this->push(item);
+    }
+
+    //! Wait for the pending writes, and abort if any failed
+    void flush()
+    {
+      int err = 0;
+      if (Layout::primaryNode() && is_open)
+	err = this->drain();
+      QDPInternal::broadcast(err);
+
+      if (err != 0)
+      {
+	QDPIO::cerr << __func__ << ": " << err << " DB writes failed" << std::endl;
+	QDP_abort(1);
+      }
+    }
+
+    //! Write the pending pairs, stop the writer and close the DB
+    void close()
+    {
+      if (! is_open)
+	return;
+
+      flush();
+
+      if (Layout::primaryNode())
+      {
+	this->stop();
+	db.close();
+      }
+      is_open = false;
+    }
+
+  private:
+    //! Write a pair, on the background thread
+    int writeItem(Item& item)
+    {
+      return (db.insert(item.first, item.second) != 0) ? 1 : 0;
+    }
+
+    // Hide copies
+    AsyncDBWriter(const AsyncDBWriter&);
+    void operator=(const AsyncDBWriter&);
+
+    bool  is_open;
+
+    //! The DB, only used on the primary node
+    ConfDataStoreDB< SerialDBKey<K>, SerialDBData<V> >  db;
+  };
+
+} // namespace Chroma
+
+#endif
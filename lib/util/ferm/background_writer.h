@@ -0,0 +1,158 @@
+// -*- C++ -*-
+/*! \file
+ * \brief Queue of items written out by a background thread
+ */
+
+#ifndef __background_writer_h__
+#define __background_writer_h__
+
+#include "chromabase.h"
+
+#include <list>
+#include <utility>
+#include <pthread.h>
+
+namespace Chroma
+{
+  //---------------------------------------------------------------------
+  //! Queue of items written out by a background thread
+  /*! \ingroup ferm
+   *
+   * A writer derives from this and implements writeItem(), which runs on
+   * the background thread and must not communicate. The calls here are
+   * local to a node; writers that only do I/O on the primary node start
+   * the thread there only. push() hands an item to the thread, blocking
+   * while max_pending items are waiting. drain() waits for the queue to
+   * empty and returns the failed writes so far. The derived destructor
+   * must call stop() before its members go.
+   */
+  template<typename Item>
+  class BackgroundWriter
+  {
+  public:
+    //! Constructor
+    /*!
+     * \param max_pending_  items that may wait to be written  ( Read )
+     */
+    BackgroundWriter(int max_pending_) : max_pending(max_pending_), running(false) {}
+
+    //! Destructor
+    virtual ~BackgroundWriter() {}
+
+    //! Start the thread
+    void start()
+    {
+      stop_flag = false;
+      busy = false;
+      errors = 0;
+
+      pthread_mutex_init(&mutex, 0);
+      pthread_cond_init(&cond, 0);
+      pthread_create(&thread, 0, &BackgroundWriter::run, this);
+      running = true;
+    }
+
+    //! Queue an item, taking over its contents by swap
+    void push(Item& item)
+    {
+      pthread_mutex_lock(&mutex);
+      while (queue.size() >= (size_t)max_pending)
+	pthread_cond_wait(&cond, &mutex);
+
+      queue.push_back(Item());
+      std::swap(queue.back(), item);
+      pthread_cond_broadcast(&cond);
+      pthread_mutex_unlock(&mutex);
+    }
+
+    //! Wait for the queued items, and return the failed writes so far
+    int drain()
+    {
+      if (! running)
+	return 0;
+
+      pthread_mutex_lock(&mutex);
+      while (! queue.empty() || busy)
+	pthread_cond_wait(&cond, &mutex);
+      int err = errors;
+      pthread_mutex_unlock(&mutex);
+
+      return err;
+    }
+
+    //! Write the queued items and stop the thread
+    void stop()
+    {
+      if (! running)
+	return;
+
+      pthread_mutex_lock(&mutex);
+      stop_flag = true;
+      pthread_cond_broadcast(&cond);
+      pthread_mutex_unlock(&mutex);
+
+      pthread_join(thread, 0);
+      pthread_cond_destroy(&cond);
+      pthread_mutex_destroy(&mutex);
+      running = false;
+    }
+
+  protected:
+    //! Write one item on the background thread, return the number of failures
+    virtual int writeItem(Item& item) = 0;
+
+  private:
+    //! Writer loop
+    static void* run(void* arg)
+    {
+      BackgroundWriter* w = static_cast<BackgroundWriter*>(arg);
+
+      pthread_mutex_lock(&w->mutex);
+      for(;;)
+      {
+	while (w->queue.empty() && ! w->stop_flag)
+	  pthread_cond_wait(&w->cond, &w->mutex);
+
+	if (w->queue.empty())
+	  break;
+
+	// Take the item out and write it without holding the lock
+	std::list<Item> item;
+	item.splice(item.begin(), w->queue, w->queue.begin());
+	w->busy = true;
+	pthread_cond_broadcast(&w->cond);
+	pthread_mutex_unlock(&w->mutex);
+
+	int err = w->writeItem(item.front());
+
+	pthread_mutex_lock(&w->mutex);
+	w->errors += err;
+	w->busy = false;
+	pthread_cond_broadcast(&w->cond);
+      }
+      pthread_mutex_unlock(&w->mutex);
+
+      return 0;
+    }
+
+    // Hide copies
+    BackgroundWriter(const BackgroundWriter&);
+    void operator=(const BackgroundWriter&);
+
+    int   max_pending;
+    bool  running;
+
+    // Shared with the thread, guarded by mutex
+    std::list<Item> queue;
+    bool  stop_flag;
+    bool  busy;
+    int   errors;
+
+    pthread_t        thread;
+    pthread_mutex_t  mutex;
+    pthread_cond_t   cond;
+  };
+
+} // namespace Chroma
+
+#endif
@@ -0,0 +1,303 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Blocked inner products and projections against a set of vectors
+ *
+ *  The routines here compute all the inner products of a source against
+ *  a block of vectors with a single global reduction, and apply the
+ *  corresponding linear combination in a single sweep over the lattice.
+ *  They are the building blocks for low-mode projection in the overlap
+ *  sign function and in deflated solvers.
+ */
+
+#ifndef __block_inner_product_h__
+#define __block_inner_product_h__
+
+#include "chromabase.h"
+
+namespace Chroma
+{
+
+  //! Complex scalar type of the same precision as a lattice fermion
+  /*! \ingroup ferm */
+  template<typename T>
+  struct BlockInnerProductTraits {};
+
+  template<>
+  struct BlockInnerProductTraits<LatticeFermionF>
+  {
+    typedef ComplexF  Complex_t;
+  };
+
+  template<>
+  struct BlockInnerProductTraits<LatticeFermionD>
+  {
+    typedef ComplexD  Complex_t;
+  };
+
+
+  /*! Hide the site loops for the thread dispatcher in here */
+  namespace BlockInnerProductEnv
+  {
+    template<typename T>
+    struct InnerProductArgs
+    {
+      const multi1d<T>& v;
+      int               nvec;
+      const T&          x;
+      const int*        site_table;
+      REAL64*           partial;     /*!< 2*nvec doubles per thread */
+    };
+
+    template<typename T>
+    struct AxpyArgs
+    {
+      T&                y;
+      const multi1d<T>& v;
+      int               nvec;
+      const REAL64*     coeffs;      /*!< re,im pairs */
+      REAL64            sign;
+      const int*        site_table;
+    };
+
+#ifndef QDP_IS_QDPJIT
+    //! c_i += <v_i, x> over the sites [lo,hi) of the site table
+    template<typename T>
+    inline
+    void innerProductSiteLoop(int lo, int hi, int myId, InnerProductArgs<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+
+      const int nvec = a->nvec;
+      REAL64* c = &(a->partial[2*nvec*myId]);
+
+      for(int i=0; i < 2*nvec; ++i)
+	c[i] = 0;
+
+      for(int j=lo; j < hi; ++j)
+      {
+	int site = a->site_table[j];
+	const PSpinVector<PColorVector<RComplex<W>, Nc>, Ns>& xs = a->x.elem(site);
+
+	// Each site of x is read once and reused against all vectors
+	for(int i=0; i < nvec; ++i)
+	{
+	  const PSpinVector<PColorVector<RComplex<W>, Nc>, Ns>& vs = a->v[i].elem(site);
+	  REAL64 re = 0;
+	  REAL64 im = 0;
+
+	  for(int s=0; s < Ns; ++s)
+	  {
+	    for(int col=0; col < Nc; ++col)
+	    {
+	      const RComplex<W>& vv = vs.elem(s).elem(col);
+	      const RComplex<W>& xx = xs.elem(s).elem(col);
+
+	      re += (REAL64)vv.real()*(REAL64)xx.real() + (REAL64)vv.imag()*(REAL64)xx.imag();
+	      im += (REAL64)vv.real()*(REAL64)xx.imag() - (REAL64)vv.imag()*(REAL64)xx.real();
+	    }
+	  }
+
+	  c[2*i]   += re;
+	  c[2*i+1] += im;
+	}
+      }
+    }
+
+    //! y += sign * sum_i c_i v_i over the sites [lo,hi) of the site table
+    template<typename T>
+    inline
+    void axpySiteLoop(int lo, int hi, int myId, AxpyArgs<T>* a)
+    {
+      typedef typename WordType<T>::Type_t W;
+
+      const int nvec = a->nvec;
+
+      for(int j=lo; j < hi; ++j)
+      {
+	int site = a->site_table[j];
+	PSpinVector<PColorVector<RComplex<W>, Nc>, Ns>& ys = a->y.elem(site);
+
+	for(int i=0; i < nvec; ++i)
+	{
+	  const PSpinVector<PColorVector<RComplex<W>, Nc>, Ns>& vs = a->v[i].elem(site);
+	  const W cr = (W)(a->sign * a->coeffs[2*i]);
+	  const W ci = (W)(a->sign * a->coeffs[2*i+1]);
+
+	  for(int s=0; s < Ns; ++s)
+	  {
+	    for(int col=0; col < Nc; ++col)
+	    {
+	      const RComplex<W>& vv = vs.elem(s).elem(col);
+	      RComplex<W>& yy = ys.elem(s).elem(col);
+
+	      yy.real() += cr*vv.real() - ci*vv.imag();
+	      yy.imag() += cr*vv.imag() + ci*vv.real();
+	    }
+	  }
+	}
+      }
+    }
+#endif
+
+    //! Unpack coefficients into an array of re,im pairs
+    inline
+    void packCoeffs(std::vector<REAL64>& buf, const multi1d<DComplex>& c, int nvec)
+    {
+      buf.resize(2*nvec);
+      for(int i=0; i < nvec; ++i)
+      {
+	buf[2*i]   = toDouble(real(c[i]));
+	buf[2*i+1] = toDouble(imag(c[i]));
+      }
+    }
+  }
+
+
+  //! Compute all inner products c_i = <v_i, x> with one global reduction
+  /*!
+   * \ingroup ferm
+   *
+   * \param c      inner products, resized to nvec     (Write)
+   * \param v      block of vectors                    (Read)
+   * \param nvec   number of vectors of v to use       (Read)
+   * \param x      source                              (Read)
+   * \param s      subset                              (Read)
+   */
+  template<typename T>
+  void blockInnerProduct(multi1d<DComplex>& c,
+			 const multi1d<T>& v, int nvec,
+			 const T& x, const Subset& s)
+  {
+    START_CODE();
+
+    c.resize(nvec);
+    if (nvec <= 0)
+    {
+      END_CODE();
+      return;
+    }
+
+#ifndef QDP_IS_QDPJIT
+    const int nthreads = qdpNumThreads();
+    std::vector<REAL64> partial(2*nvec*nthreads, 0.0);
+
+    BlockInnerProductEnv::InnerProductArgs<T> arg = {v, nvec, x, s.siteTable().slice(), &(partial[0])};
+    dispatch_to_threads(s.numSiteTable(), arg, BlockInnerProductEnv::innerProductSiteLoop<T>);
+
+    // Sum over the threads and then a single reduction over the nodes
+    std::vector<REAL64> sums(2*nvec, 0.0);
+    for(int t=0; t < nthreads; ++t)
+      for(int i=0; i < 2*nvec; ++i)
+	sums[i] += partial[2*nvec*t + i];
+
+    QDPInternal::globalSumArray(&(sums[0]), 2*nvec);
+
+    for(int i=0; i < nvec; ++i)
+      c[i] = cmplx(Double(sums[2*i]), Double(sums[2*i+1]));
+#else
+    for(int i=0; i < nvec; ++i)
+      c[i] = innerProduct(v[i], x, s);
+#endif
+
+    END_CODE();
+  }
+
+
+  //! Accumulate y += sum_i c_i v_i in a single sweep over y
+  /*!
+   * \ingroup ferm
+   *
+   * \param y      target                              (Modify)
+   * \param c      coefficients                        (Read)
+   * \param v      block of vectors                    (Read)
+   * \param nvec   number of vectors of v to use       (Read)
+   * \param s      subset                              (Read)
+   */
+  template<typename T>
+  void blockAxpy(T& y, const multi1d<DComplex>& c,
+		 const multi1d<T>& v, int nvec,
+		 const Subset& s)
+  {
+    START_CODE();
+
+    if (nvec <= 0)
+    {
+      END_CODE();
+      return;
+    }
+
+#ifndef QDP_IS_QDPJIT
+    std::vector<REAL64> coeffs;
+    BlockInnerProductEnv::packCoeffs(coeffs, c, nvec);
+
+    BlockInnerProductEnv::AxpyArgs<T> arg = {y, v, nvec, &(coeffs[0]), 1.0, s.siteTable().slice()};
+    dispatch_to_threads(s.numSiteTable(), arg, BlockInnerProductEnv::axpySiteLoop<T>);
+#else
+    typedef typename BlockInnerProductTraits<T>::Complex_t  C;
+    for(int i=0; i < nvec; ++i)
+    {
+      C ci = c[i];
+      y[s] += ci * v[i];
+    }
+#endif
+
+    END_CODE();
+  }
+
+
+  //! Project a block of vectors out of x:  c = V^dag x,  x -= V c
+  /*!
+   * \ingroup ferm
+   *
+   * The vectors must be orthonormal. This is a classical Gram-Schmidt
+   * step, so it costs one global reduction instead of nvec.
+   *
+   * \param x      vector to project                   (Modify)
+   * \param c      projection coefficients             (Write)
+   * \param v      block of orthonormal vectors        (Read)
+   * \param nvec   number of vectors of v to use       (Read)
+   * \param s      subset                              (Read)
+   */
+  template<typename T>
+  void blockProject(T& x, multi1d<DComplex>& c,
+		    const multi1d<T>& v, int nvec,
+		    const Subset& s)
+  {
+    START_CODE();
+
+    blockInnerProduct(c, v, nvec, x, s);
+
+#ifndef QDP_IS_QDPJIT
+    if (nvec > 0)
+    {
+      std::vector<REAL64> coeffs;
+      BlockInnerProductEnv::packCoeffs(coeffs, c, nvec);
+
+      BlockInnerProductEnv::AxpyArgs<T> arg = {x, v, nvec, &(coeffs[0]), -1.0, s.siteTable().slice()};
+      dispatch_to_threads(s.numSiteTable(), arg, BlockInnerProductEnv::axpySiteLoop<T>);
+    }
+#else
+    typedef typename BlockInnerProductTraits<T>::Complex_t  C;
+    for(int i=0; i < nvec; ++i)
+    {
+      C ci = c[i];
+      x[s] -= ci * v[i];
+    }
+#endif
+
+    END_CODE();
+  }
+
+
+  //! Project a block of vectors out of x, discarding the coefficients
+  /*! \ingroup ferm */
+  template<typename T>
+  void blockProject(T& x, const multi1d<T>& v, int nvec, const Subset& s)
+  {
+    multi1d<DComplex> c;
+    blockProject(x, c, v, nvec, s);
+  }
+
+}  // end namespace Chroma
+
+#endif
@@ -8,6 +8,7 @@
 
 
 #include "chromabase.h"
+#include "named_obj.h"
 
 namespace Chroma 
 {
@@ -40,6 +41,22 @@ namespace Chroma
     write(bin_out, evpair.eigenValue.weights);
   }
 
+  //! Size of a pair held in the named object map
+  template<typename T>
+  struct NamedObjectTraits< EVPair<T> >
+  {
+    static bool sized() {return NamedObjectTraits<T>::sized();}
+
+    static unsigned long size(const EVPair<T>& d) 
+    {
+      return NamedObjectTraits<T>::size(d.eigenVector) + d.eigenValue.weights.size()*sizeof(Real);
+    }
+
+    static bool spillable() {return false;}
+    static void spill(std::ostream& os, const EVPair<T>& d) {}
+    static void restore(std::istream& is, EVPair<T>& d) {}
+  };
+
 };
 
 
@@ -5,6 +5,7 @@
 
 #include "chromabase.h"
 #include "util/gauge/eesu3.h"
+#include "util/gauge/su3_batch_kernels.h"
 
 namespace Chroma 
 {
@@ -21,6 +22,15 @@ namespace Chroma
   {
     START_CODE( );
 
+#if defined(BUILD_BATCHED_SU3_KERNELS) && ! defined(QDP_IS_QDPJIT)
+    if (Nc == 3)
+    {
+      SU3BatchKernels::exp(iQ, all);
+      END_CODE( );
+      return;
+    }
+#endif
+
     LatticeColorMatrix Q = timesMinusI(iQ);
 
     LatticeComplex f0, f1, f2;
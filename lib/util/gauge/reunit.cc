@@ -20,6 +20,9 @@
 
 #include "chromabase.h"
 #include "util/gauge/reunit.h"
+#include "util/gauge/su3_batch_kernels.h"
+
+#include <vector>
 
 
 namespace Chroma {
@@ -30,6 +33,51 @@ namespace Chroma {
     double getTime() { return time_spent; }
   };
 
+#if defined(BUILD_BATCHED_SU3_KERNELS) && ! defined(QDP_IS_QDPJIT)
+  //! The SU(3) case of reunit_t with the batched kernel
+  template<typename Q>
+  inline
+  void reunit_batch_t(Q& xa, 
+		      LatticeBoolean& bad, 
+		      int& numbad, 
+		      enum Reunitarize ruflag,
+		      const Subset& mstag)
+  {
+    typedef typename WordType<Q>::Type_t W;
+
+    numbad = 0;
+
+    if ( ruflag != REUNITARIZE_ERROR &&
+	 ruflag != REUNITARIZE_LABEL )
+    {
+      SU3BatchKernels::reunit(xa, (W*)0, mstag);
+      return;
+    }
+
+    // The deviation from SU(3) of each site of the subset
+    std::vector<W> sigma(mstag.numSiteTable());
+    SU3BatchKernels::reunit(xa, &(sigma[0]), mstag);
+
+    const W fuzz = 1.0e-5;
+    const int* sites = mstag.siteTable().slice();
+    double nbad = 0;
+    for(int j=0; j < mstag.numSiteTable(); ++j)
+    {
+      const bool b = sigma[j] > fuzz;
+      if (b)
+	nbad += 1;
+      if (ruflag == REUNITARIZE_LABEL)
+	bad.elem(sites[j]).elem().elem().elem() = b;
+    }
+    QDPInternal::globalSumArray(&nbad, 1);
+    numbad = int(nbad);
+
+    if ( ruflag == REUNITARIZE_ERROR && numbad > 0 )
+      QDP_error_exit("Unitarity violated", numbad);
+  }
+#endif
+
+
   template<typename Q, typename C, typename R, typename S>
   inline
   void reunit_t(Q& xa, 
@@ -44,6 +92,18 @@ namespace Chroma {
     swatch.reset();
     swatch.start();
 
+#if defined(BUILD_BATCHED_SU3_KERNELS) && ! defined(QDP_IS_QDPJIT)
+    if (Nc == 3)
+    {
+      reunit_batch_t(xa, bad, numbad, ruflag, mstag);
+
+      swatch.stop();
+      ReunitEnv::time_spent += swatch.getTimeInSeconds();
+      END_CODE();
+      return;
+    }
+#endif
+
     multi2d<C> a(Nc, Nc);
     multi2d<C> b(Nc, Nc);
     R t1;
@@ -0,0 +1,551 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief SU(3) matrix kernels on batches of sites
+ */
+
+#ifndef __su3_batch_kernels_h__
+#define __su3_batch_kernels_h__
+
+#include "chromabase.h"
+#include "chroma_config.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Chroma
+{
+#if defined(BUILD_BATCHED_SU3_KERNELS) && ! defined(QDP_IS_QDPJIT)
+  //! SU(3) matrix kernels on batches of sites
+  /*!
+   * \ingroup gauge
+   *
+   * A batch holds the matrices of nlanes sites in structure of arrays
+   * layout, re[k][lane] and im[k][lane] for the element k = 3*i+j. The
+   * kernels loop over the lanes innermost, so the compiler can put the
+   * lanes of a batch in the lanes of the vector registers.
+   *
+   * The lattice drivers gather the sites of a subset into batches, run a
+   * kernel and scatter the results back, threaded over the batches. The
+   * kernels follow the algorithms of taproj, reunit, eesu3 and su3proj
+   * step by step, but the order of the floating point operations differs,
+   * so the results agree to rounding, not bitwise. Only for Nc=3, and only
+   * built with --enable-batched-su3-kernels; otherwise, for other Nc and
+   * for QDP-JIT the callers use their QDP expression code.
+   */
+  namespace SU3BatchKernels
+  {
+    //! Sites per batch
+    const int nlanes = 8;
+
+    //! The matrices of a batch of sites
+    template<typename R>
+    struct Batch
+    {
+      R re[9][nlanes];
+      R im[9][nlanes];
+    };
+
+
+    //---------------------------------------------------------------------
+    //! a = (1/2)[a - a_dag] - Tr[(1/2)*(a - a_dag)]/3
+    template<typename R>
+    inline void taproj(Batch<R>& a)
+    {
+      for(int l=0; l < nlanes; ++l)
+      {
+	const R tr3 = (a.im[0][l] + a.im[4][l] + a.im[8][l]) / R(3);
+
+	for(int i=0; i < 3; ++i)
+	{
+	  a.re[4*i][l] = 0;
+	  a.im[4*i][l] -= tr3;
+	}
+      }
+
+      // Off diagonal pairs (i,j), i < j
+      const int ij[3] = {1, 2, 5};
+      const int ji[3] = {3, 6, 7};
+      for(int k=0; k < 3; ++k)
+	for(int l=0; l < nlanes; ++l)
+	{
+	  const R re = R(0.5)*(a.re[ij[k]][l] - a.re[ji[k]][l]);
+	  const R im = R(0.5)*(a.im[ij[k]][l] + a.im[ji[k]][l]);
+	  a.re[ij[k]][l] = re;
+	  a.im[ij[k]][l] = im;
+	  a.re[ji[k]][l] = -re;
+	  a.im[ji[k]][l] = im;
+	}
+    }
+
+
+    //---------------------------------------------------------------------
+    //! Reunitarise as reunit: Gram-Schmidt on the columns 0 and 1, column 2
+    //! from their cross product
+    /*!
+     * With sigma != 0 the deviation of each site from SU(3) is written
+     * to sigma[lane], as the sigmasq of reunit.
+     */
+    template<typename R>
+    inline void reunit(Batch<R>& a, R* sigma)
+    {
+      for(int l=0; l < nlanes; ++l)
+      {
+	// Keep the third column
+	R r2re[3], r2im[3];
+	for(int c=0; c < 3; ++c)
+	{
+	  r2re[c] = a.re[3*c+2][l];
+	  r2im[c] = a.im[3*c+2][l];
+	}
+
+	// Normalise the first column
+	R t1 = 0;
+	for(int c=0; c < 3; ++c)
+	  t1 += a.re[3*c][l]*a.re[3*c][l] + a.im[3*c][l]*a.im[3*c][l];
+	t1 = std::sqrt(t1);
+	R t4 = R(1) / t1;
+	for(int c=0; c < 3; ++c)
+	{
+	  a.re[3*c][l] *= t4;
+	  a.im[3*c][l] *= t4;
+	}
+
+	// t2 = u^dag v, v <- v - t2 u
+	R t2re = 0, t2im = 0;
+	for(int c=0; c < 3; ++c)
+	{
+	  t2re += a.re[3*c][l]*a.re[3*c+1][l] + a.im[3*c][l]*a.im[3*c+1][l];
+	  t2im += a.re[3*c][l]*a.im[3*c+1][l] - a.im[3*c][l]*a.re[3*c+1][l];
+	}
+	for(int c=0; c < 3; ++c)
+	{
+	  a.re[3*c+1][l] -= t2re*a.re[3*c][l] - t2im*a.im[3*c][l];
+	  a.im[3*c+1][l] -= t2re*a.im[3*c][l] + t2im*a.re[3*c][l];
+	}
+
+	// Normalise the second column
+	R t3 = 0;
+	for(int c=0; c < 3; ++c)
+	  t3 += a.re[3*c+1][l]*a.re[3*c+1][l] + a.im[3*c+1][l]*a.im[3*c+1][l];
+	t3 = std::sqrt(t3);
+	t4 = R(1) / t3;
+	for(int c=0; c < 3; ++c)
+	{
+	  a.re[3*c+1][l] *= t4;
+	  a.im[3*c+1][l] *= t4;
+	}
+
+	// w(c) = conj(u(c+1) v(c+2) - u(c+2) v(c+1))
+	for(int c=0; c < 3; ++c)
+	{
+	  const int c1 = (c+1) % 3;
+	  const int c2 = (c+2) % 3;
+	  const R ure1 = a.re[3*c1][l],   uim1 = a.im[3*c1][l];
+	  const R ure2 = a.re[3*c2][l],   uim2 = a.im[3*c2][l];
+	  const R vre1 = a.re[3*c1+1][l], vim1 = a.im[3*c1+1][l];
+	  const R vre2 = a.re[3*c2+1][l], vim2 = a.im[3*c2+1][l];
+
+	  a.re[3*c+2][l] =   (ure1*vre2 - uim1*vim2) - (ure2*vre1 - uim2*vim1);
+	  a.im[3*c+2][l] = -((ure1*vim2 + uim1*vre2) - (ure2*vim1 + uim2*vre1));
+	}
+
+	if (sigma != 0)
+	{
+	  R sq = (1-t1)*(1-t1) + t2re*t2re + t2im*t2im + (1-t3)*(1-t3);
+	  for(int c=0; c < 3; ++c)
+	  {
+	    const R dre = r2re[c] - a.re[3*c+2][l];
+	    const R dim = r2im[c] - a.im[3*c+2][l];
+	    sq += dre*dre + dim*dim;
+	  }
+	  sigma[l] = std::sqrt(sq);
+	}
+      }
+    }
+
+
+    //---------------------------------------------------------------------
+    //! iQ = exp(iQ) for traceless antihermitian iQ, by Cayley-Hamilton as eesu3
+    /*!
+     * exp(iQ) = f0 + f1*Q + f2*Q*Q, section III of hep-lat/0311018
+     */
+    template<typename R>
+    inline void exp(Batch<R>& a)
+    {
+      for(int l=0; l < nlanes; ++l)
+      {
+	// Q = -i iQ
+	R qre[9], qim[9];
+	for(int k=0; k < 9; ++k)
+	{
+	  qre[k] =  a.im[k][l];
+	  qim[k] = -a.re[k][l];
+	}
+
+	// QQ = Q*Q
+	R qqre[9], qqim[9];
+	for(int i=0; i < 3; ++i)
+	  for(int j=0; j < 3; ++j)
+	  {
+	    R sre = 0, sim = 0;
+	    for(int k=0; k < 3; ++k)
+	    {
+	      sre += qre[3*i+k]*qre[3*k+j] - qim[3*i+k]*qim[3*k+j];
+	      sim += qre[3*i+k]*qim[3*k+j] + qim[3*i+k]*qre[3*k+j];
+	    }
+	    qqre[3*i+j] = sre;
+	    qqim[3*i+j] = sim;
+	  }
+
+	// c0 = Re tr(Q QQ)/3,  c1 = Re tr(QQ)/2
+	R c0 = 0;
+	for(int i=0; i < 3; ++i)
+	  for(int k=0; k < 3; ++k)
+	    c0 += qre[3*i+k]*qqre[3*k+i] - qim[3*i+k]*qqim[3*k+i];
+	c0 /= R(3);
+	const R c1 = R(0.5)*(qqre[0] + qqre[4] + qqre[8]);
+
+	const R c0abs = std::fabs(c0);
+	const R c0max = 2 * std::pow(c1 / R(3), R(1.5));
+	const R theta = std::acos(c0abs / c0max);
+	const R u     = std::sqrt(c1 / R(3)) * std::cos(theta / R(3));
+	const R w     = std::sqrt(c1) * std::sin(theta / R(3));
+	const R uu    = u*u;
+	const R ww    = w*w;
+	const R cosu  = std::cos(u);
+	const R cosw  = std::cos(w);
+	const R sinu  = std::sin(u);
+	const R sinw  = std::sin(w);
+
+	// exp(2iu) and exp(-iu)
+	const R e2re = 2*cosu*cosu - 1, e2im = 2*cosu*sinu;
+	const R emre = cosu,            emim = -sinu;
+
+	const bool b_c0 = (c0 < 0);
+	const bool b_c1 = (c1 > R(1.0e-4));
+	const bool b_w  = (std::fabs(w) > R(0.05));
+
+	const R denom = b_c1 ? 9*uu - ww : R(1);
+	const R xi0 = b_w ? sinw/w : 1 - (R(1)/6)*ww*(1 - (R(1)/20)*ww*(1 - (R(1)/42)*ww));
+
+	R f0re, f0im, f1re, f1im, f2re, f2im;
+	if (b_c1)
+	{
+	  // f0 = ((uu - ww) exp2iu + expmiu (8 uu cosw, 2u(3uu+ww) xi0)) / denom
+	  R xre = 8*uu*cosw, xim = 2*u*(3*uu + ww)*xi0;
+	  f0re = ((uu - ww)*e2re + emre*xre - emim*xim) / denom;
+	  f0im = ((uu - ww)*e2im + emre*xim + emim*xre) / denom;
+
+	  // f1 = (2u exp2iu - expmiu (2u cosw, (ww-3uu) xi0)) / denom
+	  xre = 2*u*cosw;  xim = (ww - 3*uu)*xi0;
+	  f1re = (2*u*e2re - (emre*xre - emim*xim)) / denom;
+	  f1im = (2*u*e2im - (emre*xim + emim*xre)) / denom;
+
+	  // f2 = (exp2iu - expmiu (cosw, 3u xi0)) / denom
+	  xre = cosw;  xim = 3*u*xi0;
+	  f2re = (e2re - (emre*xre - emim*xim)) / denom;
+	  f2im = (e2im - (emre*xim + emim*xre)) / denom;
+
+	  // f_j(-c0, c1) = (-1)^j f*_j(c0, c1)
+	  if (b_c0)
+	  {
+	    f0im = -f0im;
+	    f1re = -f1re;
+	    f2im = -f2im;
+	  }
+	}
+	else
+	{
+	  // Expansion in small c1
+	  f0re = 1 - c0*c0/720;
+	  f0im = -c0/6*(1 - c1/20*(1 - c1/42));
+	  f1re = c0/24*(1 - c1/15*(1 - 3*c1/112));
+	  f1im = 1 - c1/6*(1 - c1/20*(1 - c1/42)) - c0*c0/5040;
+	  f2re = R(0.5)*(-1 + c1/12*(1 - c1/30*(1 - c1/56)) + c0*c0/20160);
+	  f2im = R(0.5)*(c0/60*(1 - c1/21*(1 - c1/48)));
+	}
+
+	// f0 + f1 Q + f2 QQ
+	for(int k=0; k < 9; ++k)
+	{
+	  a.re[k][l] = f1re*qre[k] - f1im*qim[k] + f2re*qqre[k] - f2im*qqim[k];
+	  a.im[k][l] = f1re*qim[k] + f1im*qre[k] + f2re*qqim[k] + f2im*qqre[k];
+	}
+	for(int i=0; i < 3; ++i)
+	{
+	  a.re[4*i][l] += f0re;
+	  a.im[4*i][l] += f0im;
+	}
+      }
+    }
+
+
+    //---------------------------------------------------------------------
+    //! SU(3) indices of the SU(2) subgroup su2_index, as su2Extract
+    inline void su2Indices(int su2_index, int& i1, int& i2)
+    {
+      switch (su2_index)
+      {
+      case 0: i1 = 0; i2 = 1; break;
+      case 1: i1 = 1; i2 = 2; break;
+      case 2: i1 = 0; i2 = 2; break;
+      default:
+	QDPIO::cerr << __func__ << ": trouble with SU2 subgroup index" << std::endl;
+	QDP_abort(1);
+      }
+    }
+
+    //! u = V u with V in the SU(2) subgroup su2_index maximising Re Tr(V u w), as su3proj
+    template<typename R>
+    inline void su3proj(Batch<R>& u, const Batch<R>& w, int su2_index, R fuzz)
+    {
+      int i1, i2;
+      su2Indices(su2_index, i1, i2);
+      const int rows[2] = {i1, i2};
+
+      for(int l=0; l < nlanes; ++l)
+      {
+	// The elements (i1,i1), (i1,i2), (i2,i1), (i2,i2) of u*w
+	R vre[2][2], vim[2][2];
+	for(int x=0; x < 2; ++x)
+	  for(int y=0; y < 2; ++y)
+	  {
+	    R sre = 0, sim = 0;
+	    for(int k=0; k < 3; ++k)
+	    {
+	      const int uk = 3*rows[x] + k;
+	      const int wk = 3*k + rows[y];
+	      sre += u.re[uk][l]*w.re[wk][l] - u.im[uk][l]*w.im[wk][l];
+	      sim += u.re[uk][l]*w.im[wk][l] + u.im[uk][l]*w.re[wk][l];
+	    }
+	    vre[x][y] = sre;
+	    vim[x][y] = sim;
+	  }
+
+	// r_k of the SU(2) part, then normalise
+	const R r0 = vre[0][0] + vre[1][1];
+	const R r1 = vim[0][1] + vim[1][0];
+	const R r2 = vre[0][1] - vre[1][0];
+	const R r3 = vim[0][0] - vim[1][1];
+	const R r_l = std::sqrt(r0*r0 + r1*r1 + r2*r2 + r3*r3);
+
+	const bool ok = (r_l > fuzz);
+	const R lftmp = R(1) / (ok ? r_l : R(1));
+	const R a0 = ok ?  r0*lftmp : R(1);
+	const R a1 = ok ? -(r1*lftmp) : R(0);
+	const R a2 = ok ? -(r2*lftmp) : R(0);
+	const R a3 = ok ? -(r3*lftmp) : R(0);
+
+	// Rows i1 and i2 of V u, with the SU(2) block
+	//  (a0 + i a3,  a2 + i a1)
+	//  (-a2 + i a1, a0 - i a3)
+	for(int k=0; k < 3; ++k)
+	{
+	  const R xre = u.re[3*i1+k][l], xim = u.im[3*i1+k][l];
+	  const R yre = u.re[3*i2+k][l], yim = u.im[3*i2+k][l];
+
+	  u.re[3*i1+k][l] = a0*xre - a3*xim + a2*yre - a1*yim;
+	  u.im[3*i1+k][l] = a0*xim + a3*xre + a2*yim + a1*yre;
+	  u.re[3*i2+k][l] = -a2*xre - a1*xim + a0*yre + a3*yim;
+	  u.im[3*i2+k][l] = -a2*xim + a1*xre + a0*yim - a3*yre;
+	}
+      }
+    }
+
+
+    //---------------------------------------------------------------------
+    //! The kernels as functors of a batch, a second batch and sigma
+    template<typename R>
+    struct TaprojOp
+    {
+      void operator()(Batch<R>& x, const Batch<R>& y, R* sigma) const {taproj(x);}
+    };
+
+    template<typename R>
+    struct ReunitOp
+    {
+      bool check;
+      void operator()(Batch<R>& x, const Batch<R>& y, R* sigma) const {reunit(x, check ? sigma : 0);}
+    };
+
+    template<typename R>
+    struct ExpOp
+    {
+      void operator()(Batch<R>& x, const Batch<R>& y, R* sigma) const {exp(x);}
+    };
+
+    template<typename R>
+    struct SU3ProjOp
+    {
+      int  su2_index;
+      R    fuzz;
+      void operator()(Batch<R>& x, const Batch<R>& y, R* sigma) const {su3proj(x, y, su2_index, fuzz);}
+    };
+
+    //! The SU(2) hits of all subgroups, then reunitarise, as an iteration of sun_proj
+    template<typename R>
+    struct MaxTraceOp
+    {
+      R    fuzz;
+      void operator()(Batch<R>& x, const Batch<R>& y, R* sigma) const
+      {
+	for(int su2_index=0; su2_index < 3; ++su2_index)
+	  su3proj(x, y, su2_index, fuzz);
+	reunit(x, (R*)0);
+      }
+    };
+
+
+    //---------------------------------------------------------------------
+    //! Args of the thread loop
+    template<typename T, typename Op>
+    struct LoopArgs
+    {
+      typedef typename WordType<T>::Type_t R;
+
+      T*          x;
+      const T*    y;        /*!< may be 0 */
+      R*          sigma;    /*!< one per site of the subset, may be 0 */
+      const int*  sites;
+      int         nsites;
+      Op          op;
+    };
+
+    //! Site of a lane, the last site repeats in a partial batch
+    inline int laneSite(const int* sites, int nsites, int first, int l)
+    {
+      return sites[std::min(first + l, nsites - 1)];
+    }
+
+    template<typename T, typename R>
+    inline void load(Batch<R>& b, const T& x, const int* sites, int nsites, int first)
+    {
+      for(int l=0; l < nlanes; ++l)
+      {
+	const int site = laneSite(sites, nsites, first, l);
+	for(int i=0; i < 3; ++i)
+	  for(int j=0; j < 3; ++j)
+	  {
+	    const RComplex<R>& c = x.elem(site).elem().elem(i,j);
+	    b.re[3*i+j][l] = c.real();
+	    b.im[3*i+j][l] = c.imag();
+	  }
+      }
+    }
+
+    template<typename T, typename R>
+    inline void store(T& x, const Batch<R>& b, const int* sites, int nsites, int first)
+    {
+      for(int l=0; l < nlanes && first + l < nsites; ++l)
+      {
+	const int site = sites[first + l];
+	for(int i=0; i < 3; ++i)
+	  for(int j=0; j < 3; ++j)
+	  {
+	    RComplex<R>& c = x.elem(site).elem().elem(i,j);
+	    c.real() = b.re[3*i+j][l];
+	    c.imag() = b.im[3*i+j][l];
+	  }
+      }
+    }
+
+    //! Run the kernel on the batches [lo,hi)
+    template<typename T, typename Op>
+    void batchLoop(int lo, int hi, int myId, LoopArgs<T,Op>* a)
+    {
+      typedef typename WordType<T>::Type_t R;
+
+      Batch<R> bx, by;
+      R sigma[nlanes];
+
+      for(int n=lo; n < hi; ++n)
+      {
+	const int first = n*nlanes;
+	load(bx, *(a->x), a->sites, a->nsites, first);
+	if (a->y != 0)
+	  load(by, *(a->y), a->sites, a->nsites, first);
+
+	a->op(bx, by, sigma);
+
+	store(*(a->x), bx, a->sites, a->nsites, first);
+	if (a->sigma != 0)
+	  for(int l=0; l < nlanes && first + l < a->nsites; ++l)
+	    a->sigma[first + l] = sigma[l];
+      }
+    }
+
+    //! Run the kernel on the sites of s
+    template<typename T, typename Op>
+    void run(T& x, const T* y, typename WordType<T>::Type_t* sigma, const Op& op, const Subset& s)
+    {
+      LoopArgs<T,Op> a;
+      a.x      = &x;
+      a.y      = y;
+      a.sigma  = sigma;
+      a.sites  = s.siteTable().slice();
+      a.nsites = s.numSiteTable();
+      a.op     = op;
+
+      const int nbatch = (a.nsites + nlanes - 1) / nlanes;
+      dispatch_to_threads(nbatch, a, batchLoop<T,Op>);
+    }
+
+
+    //---------------------------------------------------------------------
+    //! Traceless antihermitian projection on the sites of s
+    template<typename T>
+    void taproj(T& a, const Subset& s)
+    {
+      typedef typename WordType<T>::Type_t R;
+      run(a, (const T*)0, (R*)0, TaprojOp<R>(), s);
+    }
+
+    //! Reunitarise on the sites of s
+    /*!
+     * If sigma is not 0, it gets the deviation from SU(3) of each site of
+     * the site table of s
+     */
+    template<typename T>
+    void reunit(T& a, typename WordType<T>::Type_t* sigma, const Subset& s)
+    {
+      typedef typename WordType<T>::Type_t R;
+      ReunitOp<R> op;
+      op.check = (sigma != 0);
+      run(a, (const T*)0, sigma, op, s);
+    }
+
+    //! Exponentiate traceless antihermitian matrices on the sites of s
+    template<typename T>
+    void exp(T& a, const Subset& s)
+    {
+      typedef typename WordType<T>::Type_t R;
+      run(a, (const T*)0, (R*)0, ExpOp<R>(), s);
+    }
+
+    //! One SU(2) subgroup step of the maximisation of Re Tr(u w) on the sites of s
+    template<typename T>
+    void su3proj(T& u, const T& w, int su2_index, const Subset& s)
+    {
+      typedef typename WordType<T>::Type_t R;
+      SU3ProjOp<R> op;
+      op.su2_index = su2_index;
+      op.fuzz = toDouble(fuzz);
+      run(u, &w, (R*)0, op, s);
+    }
+
+    //! All SU(2) subgroup steps then reunitarisation on the sites of s
+    template<typename T>
+    void maxTraceStep(T& u, const T& w, const Subset& s)
+    {
+      typedef typename WordType<T>::Type_t R;
+      MaxTraceOp<R> op;
+      op.fuzz = toDouble(fuzz);
+      run(u, &w, (R*)0, op, s);
+    }
+
+  }  // end namespace SU3BatchKernels
+#endif
+
+}  // end namespace Chroma
+
+#endif
@@ -16,6 +16,7 @@
 #include "util/gauge/su2extract.h"
 #include "util/gauge/sunfill.h"
 #include "util/gauge/su3proj.h"
+#include "util/gauge/su3_batch_kernels.h"
 
 namespace Chroma 
 {
@@ -28,6 +29,15 @@ namespace Chroma
   {
     START_CODE();
 
+#if defined(BUILD_BATCHED_SU3_KERNELS) && ! defined(QDP_IS_QDPJIT)
+    if (Nc == 3)
+    {
+      SU3BatchKernels::su3proj(u, w, su2_index, mstag);
+      END_CODE();
+      return;
+    }
+#endif
+
     // V = U*W
     LatticeColorMatrix v;
     v[mstag] = u * w;
@@ -17,6 +17,7 @@
 #include "util/gauge/sun_proj.h"
 #include "util/gauge/su3proj.h"
 #include "util/gauge/reunit.h" 
+#include "util/gauge/su3_batch_kernels.h"
 
 
 namespace Chroma 
@@ -61,12 +62,22 @@ namespace Chroma
     {
       ++iter;
 
-      // Loop over SU(2) subgroup index
-      for(int su2_index = 0; su2_index < Nc*(Nc-1)/2; ++su2_index)
-	su3proj(v, w, su2_index, mstag);
+#if defined(BUILD_BATCHED_SU3_KERNELS) && ! defined(QDP_IS_QDPJIT)
+      if (Nc == 3)
+      {
+	// All SU(2) subgroups and the reunitarization in one pass
+	SU3BatchKernels::maxTraceStep(v, w, mstag);
+      }
+      else
+#endif
+      {
+	// Loop over SU(2) subgroup index
+	for(int su2_index = 0; su2_index < Nc*(Nc-1)/2; ++su2_index)
+	  su3proj(v, w, su2_index, mstag);
 
-      // Reunitarize: this is the slow bit of the code...
-      reunit(v,mstag);
+	// Reunitarize: this is the slow bit of the code...
+	reunit(v,mstag);
+      }
 
       // Calculate the trace
       new_tr = sum(real(trace(v * w)), mstag) * norm;
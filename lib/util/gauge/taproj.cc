@@ -6,6 +6,7 @@
 
 #include "chromabase.h"
 #include "util/gauge/taproj.h"
+#include "util/gauge/su3_batch_kernels.h"
 
 namespace Chroma 
 {
@@ -35,24 +36,33 @@ namespace Chroma
     swatch.reset();
     swatch.start();
 
-    // a = a - a_dagger  --- a -> antihermitian matrix
-    LatticeColorMatrix aux_1 = a;
-    a -= adj(aux_1);
+#if defined(BUILD_BATCHED_SU3_KERNELS) && ! defined(QDP_IS_QDPJIT)
+    if (Nc == 3)
+    {
+      SU3BatchKernels::taproj(a, all);
+    }
+    else
+#endif
+    {
+      // a = a - a_dagger  --- a -> antihermitian matrix
+      LatticeColorMatrix aux_1 = a;
+      a -= adj(aux_1);
  
-    if (Nc > 1) {
-      // tmp = Im Tr[ a ]
-      LatticeReal tmp = imag(trace(a));
+      if (Nc > 1) {
+	// tmp = Im Tr[ a ]
+	LatticeReal tmp = imag(trace(a));
     
-      // a = a - (1/Nc) * Im Tr[ a] = a - (1/Nc)*tmp
-      tmp *= (Real(1)/Real(Nc));
+	// a = a - (1/Nc) * Im Tr[ a] = a - (1/Nc)*tmp
+	tmp *= (Real(1)/Real(Nc));
 
-      // Is this a fill or a UnitMatrix*I?
-      LatticeColorMatrix aux = cmplx(0, tmp);
-      a -= aux;
-    }
+	// Is this a fill or a UnitMatrix*I?
+	LatticeColorMatrix aux = cmplx(0, tmp);
+	a -= aux;
+      }
 
-    // Normalisation to make taproj idempotent
-    a *= (Real(1)/Real(2));
+      // Normalisation to make taproj idempotent
+      a *= (Real(1)/Real(2));
+    }
 
     swatch.stop();
     TaprojEnv::time_spent+=swatch.getTimeInSeconds();
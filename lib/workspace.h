@@ -0,0 +1,225 @@
+// -*- C++ -*-
+/*! @file
+ * @brief Pool of reusable temporaries for linear operators and solvers
+ *
+ * Linear operators are applied thousands of times in a solve. Rather
+ * than constructing fresh lattice temporaries on each application,
+ * they borrow them from a pool held per type, which only allocates
+ * when more temporaries are in use at once than ever before.
+ */
+
+#ifndef __workspace_h__
+#define __workspace_h__
+
+#include "chromabase.h"
+#include "singleton.h"
+
+#include <vector>
+
+namespace Chroma
+{
+
+  //! How pooled objects are made
+  template<typename T>
+  struct WorkspaceCreate
+  {
+    static T* create(int n) {return new T;}
+  };
+
+  //! Array temporaries are made with their length
+  template<typename T>
+  struct WorkspaceCreate< multi1d<T> >
+  {
+    static multi1d<T>* create(int n) {return new multi1d<T>(n);}
+  };
+
+
+  //! Pool of temporaries of type T
+  /*! @ingroup linop
+   *
+   * Objects handed out are not initialized, in the same way a freshly
+   * constructed lattice object is not, and are full lattice objects so
+   * they may be used on any subset. Array temporaries are pooled by
+   * their length.
+   *
+   * Not thread safe. Like the rest of the operators it is only meant
+   * to be used from the master thread; the site loops are threaded
+   * inside the expressions.
+   */
+  template<typename T>
+  class WorkspacePool
+  {
+  public:
+    //! Usage counters
+    struct Stats
+    {
+      unsigned long  allocs;     /*!< objects constructed */
+      unsigned long  borrows;    /*!< objects handed out */
+      int            in_use;     /*!< objects currently handed out */
+      int            held;       /*!< objects owned by the pool */
+    };
+
+    WorkspacePool() {resetStats();}
+
+    ~WorkspacePool()
+    {
+      for(int i=0; i < entries.size(); ++i)
+	delete entries[i].obj;
+    }
+
+    //! Borrow an object. For arrays n is the length, otherwise it is ignored
+    T* acquire(int n)
+    {
+      ++stats.borrows;
+      ++stats.in_use;
+
+      for(int i=0; i < entries.size(); ++i)
+      {
+	if (! entries[i].in_use && entries[i].n == n)
+	{
+	  entries[i].in_use = true;
+	  return entries[i].obj;
+	}
+      }
+
+      Entry e;
+      e.obj    = create(n);
+      e.n      = n;
+      e.in_use = true;
+      entries.push_back(e);
+
+      ++stats.allocs;
+      stats.held = entries.size();
+
+      return e.obj;
+    }
+
+    //! Give an object back
+    void release(T* obj)
+    {
+      for(int i=0; i < entries.size(); ++i)
+      {
+	if (entries[i].obj == obj)
+	{
+	  entries[i].in_use = false;
+	  --stats.in_use;
+	  return;
+	}
+      }
+
+      QDPIO::cerr << "WorkspacePool: released an object not from this pool" << std::endl;
+      QDP_abort(1);
+    }
+
+    //! Free the objects not currently in use
+    void clear()
+    {
+      std::vector<Entry> keep;
+      for(int i=0; i < entries.size(); ++i)
+      {
+	if (entries[i].in_use)
+	  keep.push_back(entries[i]);
+	else
+	  delete entries[i].obj;
+      }
+      entries.swap(keep);
+      stats.held = entries.size();
+    }
+
+    //! Current counters
+    const Stats& getStats() const {return stats;}
+
+    //! Zero the allocation and borrow counters
+    void resetStats()
+    {
+      stats.allocs  = 0;
+      stats.borrows = 0;
+      stats.in_use  = 0;
+      stats.held    = entries.size();
+      for(int i=0; i < entries.size(); ++i)
+	if (entries[i].in_use)
+	  ++stats.in_use;
+    }
+
+  private:
+    struct Entry
+    {
+      T*    obj;
+      int   n;
+      bool  in_use;
+    };
+
+    static T* create(int n)
+    {
+      T* obj = WorkspaceCreate<T>::create(n);
+      QDP::Hints::moveToFastMemoryHint(*obj);
+      return obj;
+    }
+
+    std::vector<Entry>  entries;
+    Stats               stats;
+  };
+
+
+  //! Per type pools
+  /*! @ingroup linop */
+  template<typename T>
+  struct TheWorkspacePool
+  {
+    typedef SingletonHolder< WorkspacePool<T>, QDP::CreateUsingNew, QDP::NoDestroy, QDP::SingleThreaded > Type_t;
+
+    static WorkspacePool<T>& Instance() {return Type_t::Instance();}
+  };
+
+
+  //! A temporary borrowed from the pool for the lifetime of this object
+  /*! @ingroup linop
+   *
+   *  Use in place of a local temporary, e.g.
+   *
+   *    Workspace<T> ws1;  T& tmp1 = *ws1;
+   *    evenOddLinOp(tmp1, psi, isign);
+   */
+  template<typename T>
+  class Workspace
+  {
+  public:
+    Workspace() : obj(TheWorkspacePool<T>::Instance().acquire(0)) {}
+
+    ~Workspace() {TheWorkspacePool<T>::Instance().release(obj);}
+
+    T& operator*() {return *obj;}
+    const T& operator*() const {return *obj;}
+
+  private:
+    Workspace(const Workspace&);
+    void operator=(const Workspace&);
+
+    T*  obj;
+  };
+
+
+  //! An array temporary borrowed from the pool for the lifetime of this object
+  /*! @ingroup linop */
+  template<typename T>
+  class WorkspaceArray
+  {
+  public:
+    explicit WorkspaceArray(int n) : obj(TheWorkspacePool< multi1d<T> >::Instance().acquire(n)) {}
+
+    ~WorkspaceArray() {TheWorkspacePool< multi1d<T> >::Instance().release(obj);}
+
+    multi1d<T>& operator*() {return *obj;}
+    const multi1d<T>& operator*() const {return *obj;}
+
+  private:
+    WorkspaceArray(const WorkspaceArray&);
+    void operator=(const WorkspaceArray&);
+
+    multi1d<T>*  obj;
+  };
+
+}
+
+
+#endif
@@ -3,6 +3,7 @@
  */
 
 #include "chroma.h"
+#include "meas/smear/link_smearing_cache.h"
 
 using namespace Chroma;
 extern "C" { 
@@ -16,6 +17,13 @@ struct Params_t
 {
   multi1d<int>    nrow;
   std::string     inline_measurement_xml;
+
+  // Memory budget for the named objects
+  unsigned long   named_obj_max_mb;   // 0 means unlimited
+  std::string     named_obj_scratch_dir;
+
+  // Memory budget for the cached smeared gauge fields
+  int             smear_cache_max_mb;  // -1 means the default, 0 unlimited
 };
 
 struct Inline_input_t
@@ -31,6 +39,23 @@ void read(XMLReader& xml, const std::string& path, Params_t& p)
   XMLReader paramtop(xml, path);
   read(paramtop, "nrow", p.nrow);
 
+  p.named_obj_max_mb = 0;
+  p.named_obj_scratch_dir = ".";
+  if (paramtop.count("NamedObjBudget") == 1)
+  {
+    XMLReader budgettop(paramtop, "NamedObjBudget");
+    read(budgettop, "MaxMemoryMB", p.named_obj_max_mb);
+    if (budgettop.count("ScratchDir") == 1)
+      read(budgettop, "ScratchDir", p.named_obj_scratch_dir);
+  }
+
+  p.smear_cache_max_mb = -1;
+  if (paramtop.count("SmearedGaugeCache") == 1)
+  {
+    XMLReader cachetop(paramtop, "SmearedGaugeCache");
+    read(cachetop, "MaxMemoryMB", p.smear_cache_max_mb);
+  }
+
   XMLReader measurements_xml(paramtop, "InlineMeasurements");
   std::ostringstream inline_os;
   measurements_xml.print(inline_os);
@@ -211,6 +236,15 @@ int main(int argc, char *argv[])
     InlineDefaultGaugeField::reset();
     InlineDefaultGaugeField::set(u, config_xml);
 
+    // Memory budget of the named objects. Objects are only spilled between
+    // measurements, when no references to them are held.
+    TheNamedObjMap::Instance().setBudget(input.param.named_obj_max_mb*1024*1024,
+					 input.param.named_obj_scratch_dir);
+
+    // Memory budget of the smeared gauge fields shared by the measurements
+    if (input.param.smear_cache_max_mb >= 0)
+      LinkSmearingCacheEnv::setBudget(size_t(input.param.smear_cache_max_mb)*1024*1024);
+
     // Measure inline observables 
     push(xml_out, "InlineObservables");
     xml_out.flush();
@@ -230,6 +264,8 @@ int main(int argc, char *argv[])
 	pop(xml_out); 
 
 	xml_out.flush();
+
+	TheNamedObjMap::Instance().enforceBudget();
       }
     }
     swatch.stop();
@@ -241,6 +277,10 @@ int main(int argc, char *argv[])
 
     pop(xml_out); // pop("InlineObservables");
 
+    // Reuse of the smeared gauge fields
+    LinkSmearingCacheEnv::write(xml_out, "SmearedGaugeCache");
+    LinkSmearingCacheEnv::clear();
+
     // Reset the default gauge field
     InlineDefaultGaugeField::reset();
   }
@@ -0,0 +1,684 @@
+/*! \file
+ *  \brief Kernel benchmarks with machine readable output
+ *
+ *  Times a configurable list of kernels on a random gauge field and
+ *  writes, for each, the latency per call and the achieved GFLOP/s and
+ *  GB/s as JSON, so that results can be compared between builds.
+ *
+ *  Flop and byte counts are per-site models of the useful work, summed
+ *  over the lattice, in the spirit of the nFlops() of the operators:
+ *
+ *    wilson_dslash        1320 flops; 8 links, 8 spinors in, 1 out
+ *    clover_apply         552 flops;  clover block, 1 spinor in, 1 out
+ *    clover_invert        no flop model; clover block in and out
+ *    wilson_mdagm         2 x nFlops() of the operator; 4 dslash
+ *    clover_mdagm         2 x nFlops() of the operator; 4 dslash, 4 clover
+ *    cg_iteration         per iteration, MdagM plus 5 vector ops
+ *    stout_smear          no flop or byte model
+ *    gauge_force          Wilson staples and U * staple per link
+ *    meson_contractions   Ns*Ns traces of products of two propagators
+ *    sft                  one complex multiply-add per site and momentum
+ *
+ *  Kernels with no model report null for the corresponding rate.
+ *  Checkerboarded kernels act on one checkerboard, i.e. half the sites.
+ *  Times are averaged over the nodes.
+ */
+
+#include "chroma.h"
+#include "chroma_config.h"
+#include "actions/ferm/linop/clover_term_w.h"
+#include "actions/ferm/invert/invcg2.h"
+#include "actions/gauge/gaugeacts/wilson_gaugeact.h"
+#include "actions/gauge/gaugestates/periodic_gaugestate.h"
+#include "util/gauge/stout_utils.h"
+#include "util/gauge/reunit.h"
+
+#include <fstream>
+
+using namespace Chroma;
+
+typedef LatticeFermion               T;
+typedef multi1d<LatticeColorMatrix>  P;
+typedef multi1d<LatticeColorMatrix>  Q;
+
+
+/*
+ * Input
+ */
+struct Bench_params_t
+{
+  multi1d<int>          nrow;
+  multi1d<std::string>  kernels;
+  int                   num_calls;     // timed calls per kernel
+  int                   num_warmup;    // untimed calls first
+  int                   cg_iters;      // iterations of each CG solve
+  Real                  mass;
+  Real                  clov_coeff;
+  Real                  stout_rho;
+  int                   mom2_max;
+};
+
+struct Bench_input_t
+{
+  Bench_params_t  param;
+  QDP::Seed       rng_seed;
+  std::string     json_file;     // empty means standard output
+};
+
+
+void read(XMLReader& xml, const std::string& path, Bench_params_t& p)
+{
+  XMLReader paramtop(xml, path);
+  read(paramtop, "nrow", p.nrow);
+
+  if (paramtop.count("Kernels") != 0)
+    read(paramtop, "Kernels", p.kernels);
+  else
+  {
+    const char* all[] = {"wilson_dslash", "clover_apply", "clover_invert",
+			 "wilson_mdagm", "clover_mdagm", "cg_iteration",
+			 "stout_smear", "gauge_force", "meson_contractions", "sft"};
+    const int n = sizeof(all) / sizeof(all[0]);
+    p.kernels.resize(n);
+    for(int i=0; i < n; ++i)
+      p.kernels[i] = all[i];
+  }
+
+  p.num_calls = 20;
+  if (paramtop.count("NumCalls") != 0)
+    read(paramtop, "NumCalls", p.num_calls);
+
+  p.num_warmup = 2;
+  if (paramtop.count("NumWarmup") != 0)
+    read(paramtop, "NumWarmup", p.num_warmup);
+
+  p.cg_iters = 50;
+  if (paramtop.count("CGIters") != 0)
+    read(paramtop, "CGIters", p.cg_iters);
+
+  p.mass = 0.1;
+  if (paramtop.count("Mass") != 0)
+    read(paramtop, "Mass", p.mass);
+
+  p.clov_coeff = 1.0;
+  if (paramtop.count("clovCoeff") != 0)
+    read(paramtop, "clovCoeff", p.clov_coeff);
+
+  p.stout_rho = 0.1;
+  if (paramtop.count("StoutRho") != 0)
+    read(paramtop, "StoutRho", p.stout_rho);
+
+  p.mom2_max = 3;
+  if (paramtop.count("mom2_max") != 0)
+    read(paramtop, "mom2_max", p.mom2_max);
+
+  if (p.num_calls <= 0 || p.num_warmup < 0 || p.cg_iters <= 0)
+  {
+    QDPIO::cerr << "chroma_bench: NumCalls and CGIters must be positive, NumWarmup not negative" << std::endl;
+    QDP_abort(1);
+  }
+}
+
+
+void read(XMLReader& xml, const std::string& path, Bench_input_t& p)
+{
+  try
+  {
+    XMLReader paramtop(xml, path);
+
+    read(paramtop, "Param", p.param);
+
+    if (paramtop.count("RNG") > 0)
+      read(paramtop, "RNG", p.rng_seed);
+    else
+      p.rng_seed = 11;     // default seed
+
+    if (paramtop.count("JSONFile") > 0)
+      read(paramtop, "JSONFile", p.json_file);
+  }
+  catch( const std::string& e )
+  {
+    QDPIO::cerr << "Error reading XML : " << e << std::endl;
+    QDP_abort(1);
+  }
+}
+
+
+/*
+ * Kernels
+ */
+
+//! A timed kernel
+class BenchKernel
+{
+public:
+  virtual ~BenchKernel() {}
+
+  //! Run once. Returns the number of units of work done, usually 1
+  virtual int call() = 0;
+
+  //! Flops per unit of work summed over the lattice, negative if not modelled
+  virtual double flops() const {return -1;}
+
+  //! Bytes moved per unit of work summed over the lattice, negative if not modelled
+  virtual double bytes() const {return -1;}
+};
+
+
+//! Size of a floating point word
+static double wordSize() {return sizeof(WordType<Real>::Type_t);}
+
+//! Sites of a checkerboard
+static double cbSites() {return 0.5 * Layout::vol();}
+
+
+//! Bytes of one dslash on a checkerboard: 8 links, 8 spinors in and 1 out
+static double dslashBytes()
+{
+  return cbSites() * wordSize() * (2*Nd*2*Nc*Nc + 2*Nd*2*Nc*Ns + 2*Nc*Ns);
+}
+
+//! Real words of the clover blocks of a site: 2 real diagonals and 2 complex triangles
+static int cloverWords() {return 2*(2*Nc) + 2*(2*Nc*(2*Nc - 1));}
+
+//! Bytes of one clover apply on a checkerboard: the blocks, a spinor in and out
+static double cloverBytes()
+{
+  return cbSites() * wordSize() * (cloverWords() + 2*2*Nc*Ns);
+}
+
+
+class WilsonDslashKernel : public BenchKernel
+{
+public:
+  WilsonDslashKernel(Handle< FermState<T,P,Q> > fs) : D(fs), cb(0)
+  {
+    gaussian(psi);
+  }
+
+  int call()
+  {
+    D.apply(chi, psi, PLUS, cb);
+    cb = 1 - cb;
+    return 1;
+  }
+
+  double flops() const {return cbSites() * 1320;}
+  double bytes() const {return dslashBytes();}
+
+private:
+  WilsonDslash  D;
+  T             psi, chi;
+  int           cb;
+};
+
+
+class CloverApplyKernel : public BenchKernel
+{
+public:
+  CloverApplyKernel(Handle< FermState<T,P,Q> > fs, const CloverFermActParams& p)
+  {
+    clov.create(fs, p);
+    gaussian(psi);
+  }
+
+  int call()
+  {
+    clov.apply(chi, psi, PLUS, 0);
+    return 1;
+  }
+
+  double flops() const {return cbSites() * clov.nFlops();}
+  double bytes() const {return cloverBytes();}
+
+private:
+  CloverTerm  clov;
+  T           psi, chi;
+};
+
+
+//! Repeated inversion of the same blocks in place, which stay well conditioned
+class CloverInvertKernel : public BenchKernel
+{
+public:
+  CloverInvertKernel(Handle< FermState<T,P,Q> > fs, const CloverFermActParams& p)
+  {
+    clov.create(fs, p);
+  }
+
+  int call()
+  {
+    clov.choles(0);
+    return 1;
+  }
+
+  double bytes() const
+  {
+    return cbSites() * wordSize() * 2 * cloverWords();
+  }
+
+private:
+  CloverTerm  clov;
+};
+
+
+class MdagMKernel : public BenchKernel
+{
+public:
+  //! Takes ownership of the operator. Clover operators also apply the blocks
+  MdagMKernel(LinearOperator<T>* M_, bool clover_) : M(M_), MdagM(M), clover(clover_)
+  {
+    gaussian(psi);
+  }
+
+  int call()
+  {
+    MdagM(chi, psi, PLUS);
+    return 1;
+  }
+
+  double flops() const {return 2.0 * M->nFlops() * Layout::numNodes();}
+  double bytes() const {return 4*dslashBytes() + (clover ? 4*cloverBytes() : 0.0);}
+
+private:
+  Handle< LinearOperator<T> >  M;
+  MdagMLinOp<T>                MdagM;
+  bool                         clover;
+  T                            psi, chi;
+};
+
+
+//! CG on the normal equations, stopped after a fixed number of iterations
+class CGKernel : public BenchKernel
+{
+public:
+  //! Takes ownership of the operator
+  CGKernel(LinearOperator<T>* M_, int iters_) : M(M_), iters(iters_)
+  {
+    gaussian(chi);
+  }
+
+  int call()
+  {
+    psi = zero;
+    SystemSolverResults_t res = InvCG2(*M, chi, psi, Real(1.0e-30), iters);
+    return res.n_count;
+  }
+
+  //! MdagM, 3 axpys and 2 norms of 2*Nc*Ns reals on a checkerboard
+  double flops() const
+  {
+    return 2.0 * M->nFlops() * Layout::numNodes() + cbSites() * 5 * 2*(2*Nc*Ns);
+  }
+
+  double bytes() const
+  {
+    return 4*dslashBytes() + cbSites() * wordSize() * (3*3 + 2) * 2*Nc*Ns;
+  }
+
+private:
+  Handle< LinearOperator<T> >  M;
+  int                          iters;
+  T                            chi, psi;
+};
+
+
+class StoutSmearKernel : public BenchKernel
+{
+public:
+  StoutSmearKernel(const multi1d<LatticeColorMatrix>& u_, const Real& rho_) :
+    u(u_), next(Nd), smear_dirs(Nd), rho(Nd,Nd)
+  {
+    smear_dirs = true;
+    rho = rho_;
+  }
+
+  int call()
+  {
+    Stouting::smear_links(u, next, smear_dirs, rho);
+    return 1;
+  }
+
+private:
+  const multi1d<LatticeColorMatrix>&  u;
+  multi1d<LatticeColorMatrix>         next;
+  multi1d<bool>                       smear_dirs;
+  multi2d<Real>                       rho;
+};
+
+
+//! Force of the Wilson gauge action
+class GaugeForceKernel : public BenchKernel
+{
+public:
+  GaugeForceKernel(const multi1d<LatticeColorMatrix>& u) :
+    S(Handle< CreateGaugeState<P,Q> >(new CreatePeriodicGaugeState<P,Q>()), Real(6.0)),
+    state(S.createState(u)), ds_u(Nd)
+  {
+  }
+
+  int call()
+  {
+    S.deriv(ds_u, state);
+    return 1;
+  }
+
+  //! Per link: 2(Nd-1) staples of 2 products and a sum, then one more product
+  double flops() const
+  {
+    const double matmul = 8*Nc*Nc*Nc - 2*Nc*Nc;
+    const double matadd = 2*Nc*Nc;
+    return Layout::vol() * Nd * (2*(Nd-1)*(2*matmul + matadd) + matmul);
+  }
+
+  //! Per link: the links entering the staples once each, the force out
+  double bytes() const
+  {
+    return Layout::vol() * Nd * wordSize() * (1 + 6*(Nd-1) + 1) * 2*Nc*Nc;
+  }
+
+private:
+  WilsonGaugeAct                     S;
+  Handle< GaugeState<P,Q> >          state;
+  multi1d<LatticeColorMatrix>        ds_u;
+};
+
+
+//! Meson correlators of all Ns*Ns gamma matrices
+class MesonContractionKernel : public BenchKernel
+{
+public:
+  MesonContractionKernel()
+  {
+    gaussian(quark);
+  }
+
+  int call()
+  {
+    for(int n=0; n < Ns*Ns; ++n)
+      corr = trace(adj(quark) * Gamma(n) * quark * Gamma(n));
+    return 1;
+  }
+
+  //! Per gamma, the trace of a product of two matrices in spin and color
+  double flops() const
+  {
+    const int N = Nc*Ns;
+    return Layout::vol() * Ns*Ns * 8*N*N;
+  }
+
+  double bytes() const
+  {
+    const int N = Nc*Ns;
+    return Layout::vol() * Ns*Ns * wordSize() * (2*2*N*N + 2);
+  }
+
+private:
+  LatticePropagator  quark;
+  LatticeComplex     corr;
+};
+
+
+//! Momentum projection of a correlator on each time slice
+class SftKernel : public BenchKernel
+{
+public:
+  SftKernel(int mom2_max) : phases(mom2_max, false, Nd-1)
+  {
+    random(corr);
+  }
+
+  int call()
+  {
+    multi2d<DComplex> hsum = phases.sft(corr);
+    return 1;
+  }
+
+  double flops() const {return Layout::vol() * phases.numMom() * 8;}
+  double bytes() const {return Layout::vol() * wordSize() * (2 + 2*phases.numMom());}
+
+private:
+  SftMom          phases;
+  LatticeComplex  corr;
+};
+
+
+//! Make a kernel by name
+BenchKernel* createKernel(const std::string& name,
+			  const Bench_params_t& param,
+			  const multi1d<LatticeColorMatrix>& u)
+{
+  Handle< FermState<T,P,Q> > fs(new PeriodicFermState<T,P,Q>(u));
+
+  CloverFermActParams clov_param;
+  clov_param.Mass       = param.mass;
+  clov_param.clovCoeffR = param.clov_coeff;
+  clov_param.clovCoeffT = param.clov_coeff;
+
+  if (name == "wilson_dslash")
+    return new WilsonDslashKernel(fs);
+  else if (name == "clover_apply")
+    return new CloverApplyKernel(fs, clov_param);
+  else if (name == "clover_invert")
+    return new CloverInvertKernel(fs, clov_param);
+  else if (name == "wilson_mdagm")
+    return new MdagMKernel(new EvenOddPrecWilsonLinOp(fs, param.mass), false);
+  else if (name == "clover_mdagm")
+    return new MdagMKernel(new EvenOddPrecCloverLinOp(fs, clov_param), true);
+  else if (name == "cg_iteration")
+    return new CGKernel(new EvenOddPrecWilsonLinOp(fs, param.mass), param.cg_iters);
+  else if (name == "stout_smear")
+    return new StoutSmearKernel(u, param.stout_rho);
+  else if (name == "gauge_force")
+    return new GaugeForceKernel(u);
+  else if (name == "meson_contractions")
+    return new MesonContractionKernel();
+  else if (name == "sft")
+    return new SftKernel(param.mom2_max);
+
+  QDPIO::cerr << "chroma_bench: unknown kernel " << name << std::endl;
+  QDP_abort(1);
+  return 0;
+}
+
+
+/*
+ * Output
+ */
+
+struct BenchResult_t
+{
+  std::string  name;
+  int          calls;
+  double       units;        // units of work done in the timed calls
+  double       seconds;      // total time of the timed calls
+  double       flops;        // per unit, negative if not modelled
+  double       bytes;        // per unit, negative if not modelled
+};
+
+
+//! A rate, or null if there is no model
+static std::string jsonRate(double per_unit, double units, double seconds)
+{
+  if (per_unit < 0 || seconds <= 0)
+    return "null";
+
+  std::ostringstream os;
+  os << per_unit * units / seconds * 1.0e-9;
+  return os.str();
+}
+
+
+static std::string jsonString(const std::string& s)
+{
+  std::string r = "\"";
+  for(int i=0; i < s.size(); ++i)
+  {
+    if (s[i] == '"' || s[i] == '\\')
+      r += '\\';
+    r += s[i];
+  }
+  return r + "\"";
+}
+
+
+void writeJSON(std::ostream& os, const Bench_input_t& input,
+	       const std::vector<BenchResult_t>& results)
+{
+  os.precision(6);
+
+  os << "{\n";
+  os << "  \"program\": \"chroma_bench\",\n";
+  os << "  \"chroma_version\": " << jsonString(CHROMA_PACKAGE_VERSION) << ",\n";
+  os << "  \"qdp_version\": " << jsonString(QDP_PACKAGE_VERSION) << ",\n";
+  os << "  \"precision\": \"" << ((wordSize() == 4) ? "single" : "double") << "\",\n";
+
+  os << "  \"lattice\": [";
+  for(int mu=0; mu < Nd; ++mu)
+    os << ((mu > 0) ? ", " : "") << Layout::lattSize()[mu];
+  os << "],\n";
+
+  os << "  \"nodes\": " << Layout::numNodes() << ",\n";
+  os << "  \"threads\": " << qdpNumThreads() << ",\n";
+  os << "  \"kernels\": [\n";
+
+  for(int k=0; k < results.size(); ++k)
+  {
+    const BenchResult_t& r = results[k];
+    const double latency = (r.units > 0) ? r.seconds / r.units : 0;
+
+    os << "    {\"name\": " << jsonString(r.name)
+       << ", \"calls\": " << r.calls
+       << ", \"units\": " << r.units
+       << ", \"seconds\": " << r.seconds
+       << ", \"latency_us\": " << latency * 1.0e6
+       << ", \"gflops\": " << jsonRate(r.flops, r.units, r.seconds)
+       << ", \"gbytes_per_sec\": " << jsonRate(r.bytes, r.units, r.seconds)
+       << "}" << ((k+1 < results.size()) ? "," : "") << "\n";
+  }
+
+  os << "  ]\n";
+  os << "}\n";
+}
+
+
+//! Benchmark program for the main kernels
+/*! \defgroup chroma_bench Kernel benchmarks
+ *  \ingroup main
+ *
+ * Input is read from the usual -i file:
+ *
+ *  <chroma_bench>
+ *    <Param>
+ *      <nrow>8 8 8 16</nrow>
+ *      <Kernels>wilson_dslash clover_mdagm cg_iteration</Kernels>  <!-- optional, default all -->
+ *      <NumCalls>20</NumCalls>        <!-- optional -->
+ *      <NumWarmup>2</NumWarmup>       <!-- optional -->
+ *      <CGIters>50</CGIters>          <!-- optional -->
+ *    </Param>
+ *    <JSONFile>bench.json</JSONFile>  <!-- optional, default standard output -->
+ *  </chroma_bench>
+ *
+ * One lattice size is run per invocation since the layout is fixed once made.
+ */
+int main(int argc, char *argv[])
+{
+  Chroma::initialize(&argc, &argv);
+
+  START_CODE();
+
+  Bench_input_t input;
+  XMLReader xml_in;
+  try
+  {
+    xml_in.open(Chroma::getXMLInputFileName());
+    read(xml_in, "/chroma_bench", input);
+  }
+  catch(const std::string& e)
+  {
+    QDPIO::cerr << "CHROMA_BENCH: Caught Exception reading XML: " << e << std::endl;
+    QDP_abort(1);
+  }
+
+  Layout::setLattSize(input.param.nrow);
+  Layout::create();
+
+  XMLFileWriter& xml_out = Chroma::getXMLOutputInstance();
+  push(xml_out, "chroma_bench");
+  write(xml_out, "Input", xml_in);
+  proginfo(xml_out);
+
+  QDP::RNG::setrn(input.rng_seed);
+
+  // A random gauge field
+  multi1d<LatticeColorMatrix> u(Nd);
+  for(int mu=0; mu < Nd; ++mu)
+  {
+    gaussian(u[mu]);
+    reunit(u[mu]);
+  }
+
+  std::vector<BenchResult_t> results;
+
+  for(int k=0; k < input.param.kernels.size(); ++k)
+  {
+    const std::string& name = input.param.kernels[k];
+    QDPIO::cout << "CHROMA_BENCH: " << name << std::endl;
+
+    Handle<BenchKernel> kernel(createKernel(name, input.param, u));
+
+    for(int i=0; i < input.param.num_warmup; ++i)
+      kernel->call();
+
+    double units = 0;
+    StopWatch swatch;
+    swatch.reset();
+    swatch.start();
+
+    for(int i=0; i < input.param.num_calls; ++i)
+      units += kernel->call();
+
+    swatch.stop();
+
+    double seconds = swatch.getTimeInSeconds();
+    QDPInternal::globalSum(seconds);
+    seconds /= (double)Layout::numNodes();
+
+    BenchResult_t r;
+    r.name    = name;
+    r.calls   = input.param.num_calls;
+    r.units   = units;
+    r.seconds = seconds;
+    r.flops   = kernel->flops();
+    r.bytes   = kernel->bytes();
+    results.push_back(r);
+
+    QDPIO::cout << "CHROMA_BENCH: " << name << "  time= " << seconds
+		<< " secs  units= " << units << std::endl;
+  }
+
+  // JSON goes to a file, or to standard output on the primary node
+  if (Layout::primaryNode())
+  {
+    if (input.json_file.empty())
+      writeJSON(std::cout, input, results);
+    else
+    {
+      std::ofstream json(input.json_file.c_str());
+      if (! json)
+      {
+	std::cerr << "CHROMA_BENCH: cannot open " << input.json_file << std::endl;
+	QDP_abort(1);
+      }
+      writeJSON(json, input, results);
+    }
+  }
+
+  pop(xml_out);
+  xml_out.close();
+
+  END_CODE();
+
+  Chroma::finalize();
+  exit(0);
+}
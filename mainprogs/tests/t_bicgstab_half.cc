@@ -0,0 +1,183 @@
+/*! \file
+ *  \brief Test BiCGStab with 16 bit Krylov vectors against BiCGStab
+ *
+ *  On the single precision even-odd clover operator of a weak field both
+ *  solvers must reach the loose residual of an inner solver in a similar
+ *  number of iterations. As the inner solvers of the multi precision
+ *  Richardson iteration they must give the same double precision solution.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <sstream>
+
+#include "chroma.h"
+#include "actions/ferm/linop/eoprec_clover_dumb_linop_w.h"
+
+using namespace Chroma;
+
+typedef LatticeFermion T;
+typedef multi1d<LatticeColorMatrix> Q;
+typedef multi1d<LatticeColorMatrix> P;
+
+typedef LatticeFermionF TF;
+typedef multi1d<LatticeColorMatrixF> QF;
+
+namespace
+{
+  //! Solve M psi = chi in single precision with a BiCGStab of the factory
+  SystemSolverResults_t solveInner(const std::string& inv_type,
+				   Handle< FermState<TF,QF,QF> > state,
+				   Handle< LinearOperator<TF> > M,
+				   TF& psi, const TF& chi)
+  {
+    std::ostringstream os;
+    os << "<InvertParam>"
+       << "<invType>" << inv_type << "</invType>"
+       << "<RsdBiCGStab>1.0e-2</RsdBiCGStab>"
+       << "<MaxBiCGStab>1000</MaxBiCGStab>"
+       << "</InvertParam>";
+
+    std::istringstream is(os.str());
+    XMLReader xml_in(is);
+    Handle< LinOpSystemSolver<TF> > solver(
+      TheLinOpFFermSystemSolverFactory::Instance().createObject(inv_type, xml_in, "/InvertParam", state, M));
+
+    psi = zero;
+    SystemSolverResults_t res = (*solver)(psi, chi);
+
+    const Subset& s = M->subset();
+    TF r;
+    (*M)(r, psi, PLUS);
+    r[s] -= chi;
+    Double rel = sqrt(norm2(r, s) / norm2(chi, s));
+
+    QDPIO::cout << inv_type << ": " << res.n_count << " iterations, |chi - M psi| / |chi| = "
+		<< rel << std::endl;
+
+    res.resid = rel;
+    return res;
+  }
+
+
+  //! Solve A psi = chi by multi precision Richardson with an inner solver
+  SystemSolverResults_t solveOuter(const std::string& inner_type,
+				   const CloverFermActParams& clov_params,
+				   Handle< FermState<T,P,Q> > state,
+				   Handle< LinearOperator<T> > A,
+				   T& psi, const T& chi)
+  {
+    const std::string inv_type = "RICHARDSON_MP_CLOVER_INVERTER";
+
+    XMLBufferWriter xml_buf;
+    push(xml_buf, "InvertParam");
+    write(xml_buf, "invType", inv_type);
+    write(xml_buf, "MaxIter", 100);
+    write(xml_buf, "RsdTarget", Real(1.0e-6));
+    write(xml_buf, "CloverParams", clov_params);
+    push(xml_buf, "InnerSolverParams");
+    write(xml_buf, "invType", inner_type);
+    write(xml_buf, "RsdBiCGStab", Real(0.1));
+    write(xml_buf, "MaxBiCGStab", 1000);
+    pop(xml_buf);
+    pop(xml_buf);
+
+    XMLReader xml_in(xml_buf);
+    Handle< LinOpSystemSolver<T> > solver(
+      TheLinOpFermSystemSolverFactory::Instance().createObject(inv_type, xml_in, "/InvertParam", state, A));
+
+    psi = zero;
+    SystemSolverResults_t res = (*solver)(psi, chi);
+
+    const Subset& s = A->subset();
+    T r;
+    (*A)(r, psi, PLUS);
+    r[s] -= chi;
+    Double rel = sqrt(norm2(r, s) / norm2(chi, s));
+
+    QDPIO::cout << inv_type << " with " << inner_type << ": |chi - A psi| / |chi| = " << rel << std::endl;
+
+    res.resid = rel;
+    return res;
+  }
+}
+
+
+int main(int argc, char *argv[])
+{
+  // Put the machine into a known state
+  Chroma::initialize(&argc, &argv);
+
+  QDPIO::cout << "linkage = " << LinOpSysSolverEnv::registerAll() << std::endl;
+
+  // Setup the layout
+  const int foo[] = {4, 4, 4, 8};
+  multi1d<int> nrow(Nd);
+  nrow = foo;
+  Layout::setLattSize(nrow);
+  Layout::create();
+
+  // Start up a weak field
+  struct Cfg_t config = { CFG_TYPE_WEAK_FIELD, "dummy" };
+  multi1d<LatticeColorMatrix> u(Nd);
+  XMLReader gauge_file_xml, gauge_xml;
+  gaugeStartup(gauge_file_xml, gauge_xml, u, config);
+  unitarityCheck(u);
+
+  CloverFermActParams clov_params;
+  clov_params.clovCoeffR = Real(1.0);
+  clov_params.clovCoeffT = Real(1.0);
+  clov_params.Mass = Real(0.1);
+
+  bool ok = true;
+
+  // The inner solvers on the single precision operator
+  {
+    QF u_single(Nd);
+    for(int mu=0; mu < Nd; ++mu)
+      u_single[mu] = u[mu];
+
+    Handle< FermState<TF,QF,QF> > state(new PeriodicFermState<TF,QF,QF>(u_single));
+    Handle< LinearOperator<TF> > M(new EvenOddPrecDumbCloverFLinOp(state, clov_params));
+
+    TF chi;
+    gaussian(chi, M->subset());
+
+    TF psi, psi_half;
+    SystemSolverResults_t res      = solveInner("BICGSTAB_INVERTER", state, M, psi, chi);
+    SystemSolverResults_t res_half = solveInner("BICGSTAB_HALF_INVERTER", state, M, psi_half, chi);
+
+    // The 16 bit vectors may cost a few more iterations
+    ok = ok && (toDouble(res.resid) < 2.0e-2);
+    ok = ok && (toDouble(res_half.resid) < 2.0e-2);
+    ok = ok && (res_half.n_count <= 2*res.n_count + 5);
+  }
+
+  // As the inner solvers of the defect correction
+  {
+    Handle< FermState<T,P,Q> > state(new PeriodicFermState<T,P,Q>(u));
+    Handle< LinearOperator<T> > A(new EvenOddPrecCloverLinOp(state, clov_params));
+
+    T chi;
+    gaussian(chi, A->subset());
+
+    T psi, psi_half;
+    SystemSolverResults_t res      = solveOuter("BICGSTAB_INVERTER", clov_params, state, A, psi, chi);
+    SystemSolverResults_t res_half = solveOuter("BICGSTAB_HALF_INVERTER", clov_params, state, A, psi_half, chi);
+
+    const Subset& s = A->subset();
+    Double diff = sqrt(norm2(psi_half - psi, s) / norm2(psi, s));
+    QDPIO::cout << "|psi_half - psi| / |psi| = " << diff << std::endl;
+
+    ok = ok && (toDouble(res.resid) < 1.0e-5);
+    ok = ok && (toDouble(res_half.resid) < 1.0e-5);
+    ok = ok && (toDouble(diff) < 1.0e-4);
+  }
+
+  QDPIO::cout << "t_bicgstab_half: " << (ok ? "PASSED" : "FAILED") << std::endl;
+
+  // Time to bolt
+  Chroma::finalize();
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+/*! \file
+ *  \brief Test the batched LDL^dag inversion of the clover blocks
+ *
+ *  The kernel is checked on random hermitian positive definite blocks
+ *  against Gaussian elimination, the clover term through A^-1 A psi = psi
+ *  on a weak field and through its trace log on the free field.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "chroma.h"
+#include "actions/ferm/linop/clover_ldl_w.h"
+
+using namespace Chroma;
+
+typedef LatticeFermion T;
+typedef multi1d<LatticeColorMatrix> Q;
+typedef multi1d<LatticeColorMatrix> P;
+
+namespace
+{
+  typedef std::complex<double> Cplx;
+
+  //! Full 2Nc x 2Nc matrix of a block in the packed layout
+  void unpack(std::vector<Cplx>& a, const double* diag, const double* offd)
+  {
+    const int N = 2*Nc;
+    a.assign(N*N, Cplx(0,0));
+    for(int i=0; i < N; ++i)
+      a[i*N+i] = Cplx(diag[i], 0);
+
+    for(int k=1; k < N; ++k)
+      for(int l=0; l < k; ++l)
+      {
+	const int kl = k*(k-1)/2 + l;
+	a[k*N+l] = Cplx(offd[2*kl], offd[2*kl+1]);
+	a[l*N+k] = std::conj(a[k*N+l]);
+      }
+  }
+
+  //! log |det a| by Gaussian elimination with partial pivoting
+  double refLogDet(std::vector<Cplx> a)
+  {
+    const int N = 2*Nc;
+    double logdet = 0;
+    for(int j=0; j < N; ++j)
+    {
+      int p = j;
+      for(int i=j+1; i < N; ++i)
+	if (std::abs(a[i*N+j]) > std::abs(a[p*N+j]))
+	  p = i;
+      for(int k=0; k < N; ++k)
+	std::swap(a[j*N+k], a[p*N+k]);
+
+      logdet += std::log(std::abs(a[j*N+j]));
+      for(int i=j+1; i < N; ++i)
+      {
+	const Cplx f = a[i*N+j] / a[j*N+j];
+	for(int k=j; k < N; ++k)
+	  a[i*N+k] -= f*a[j*N+k];
+      }
+    }
+    return logdet;
+  }
+
+  //! Invert n random blocks with the kernel and compare
+  bool testKernel(int n)
+  {
+    const int N  = 2*Nc;
+    const int NO = N*(N-1)/2;
+
+    std::vector< std::vector<double> > diag(n, std::vector<double>(N));
+    std::vector< std::vector<double> > offd(n, std::vector<double>(2*NO));
+    std::vector< std::vector<Cplx> >   a(n);
+
+    double* dp[CloverLDLEnv::BlockBatch];
+    double* op[CloverLDLEnv::BlockBatch];
+    double  logdet[CloverLDLEnv::BlockBatch];
+    int     nneg[CloverLDLEnv::BlockBatch];
+
+    // Diagonally dominant, so positive definite
+    for(int b=0; b < n; ++b)
+    {
+      for(int i=0; i < N; ++i)
+	diag[b][i] = N + std::rand() / (double)RAND_MAX;
+      for(int i=0; i < 2*NO; ++i)
+	offd[b][i] = std::rand() / (double)RAND_MAX - 0.5;
+
+      unpack(a[b], &(diag[b][0]), &(offd[b][0]));
+      dp[b] = &(diag[b][0]);
+      op[b] = &(offd[b][0]);
+    }
+
+    CloverLDLEnv::invertBlocks<double>(n, dp, op, logdet, nneg);
+
+    bool ok = true;
+    for(int b=0; b < n; ++b)
+    {
+      std::vector<Cplx> ainv;
+      unpack(ainv, dp[b], op[b]);
+
+      double err = 0;
+      for(int i=0; i < N; ++i)
+	for(int j=0; j < N; ++j)
+	{
+	  Cplx s(0,0);
+	  for(int k=0; k < N; ++k)
+	    s += a[b][i*N+k] * ainv[k*N+j];
+	  err = std::max(err, std::abs(s - Cplx(i == j ? 1 : 0, 0)));
+	}
+
+      const double ref = refLogDet(a[b]);
+      QDPIO::cout << "batch of " << n << ", block " << b << ": |A A^-1 - 1| = " << err
+		  << "  logdet = " << logdet[b] << "  reference = " << ref << std::endl;
+
+      ok = ok && (err < 1.0e-12) && (std::fabs(logdet[b] - ref) < 1.0e-12) && (nneg[b] == 0);
+    }
+    return ok;
+  }
+}
+
+
+int main(int argc, char *argv[])
+{
+  // Put the machine into a known state
+  Chroma::initialize(&argc, &argv);
+
+  // Setup the layout
+  const int foo[] = {4, 4, 4, 4};
+  multi1d<int> nrow(Nd);
+  nrow = foo;
+  Layout::setLattSize(nrow);
+  Layout::create();
+
+  bool ok = true;
+
+  // A full batch and a partial one
+  ok = testKernel(CloverLDLEnv::BlockBatch) && ok;
+  ok = testKernel(3) && ok;
+
+  CloverFermActParams params;
+  params.clovCoeffR = Real(1.92);
+  params.clovCoeffT = Real(0.57);
+  params.Mass = Real(0.1);
+
+  // A^-1 A psi = psi on both checkerboards of a weak field
+  {
+    struct Cfg_t config = { CFG_TYPE_WEAK_FIELD, "dummy" };
+    multi1d<LatticeColorMatrix> u(Nd);
+    XMLReader gauge_file_xml, gauge_xml;
+    gaugeStartup(gauge_file_xml, gauge_xml, u, config);
+    unitarityCheck(u);
+
+    Handle< FermState<T,P,Q> > fs(new PeriodicFermState<T,P,Q>(u));
+
+    CloverTerm clov;
+    clov.create(fs, params);
+
+    CloverTerm invclov;
+    invclov.create(fs, params);
+
+    T psi, chi, eta;
+    gaussian(psi);
+
+    for(int cb=0; cb < 2; ++cb)
+    {
+      invclov.choles(cb);
+
+      chi = zero;
+      eta = zero;
+      clov.apply(chi, psi, PLUS, cb);
+      invclov.apply(eta, chi, PLUS, cb);
+
+      Double rel = sqrt(norm2(eta - psi, rb[cb]) / norm2(psi, rb[cb]));
+      QDPIO::cout << "cb = " << cb << ": |A^-1 A psi - psi| / |psi| = " << rel << std::endl;
+      ok = ok && (toDouble(rel) < 1.0e-5);
+    }
+  }
+
+  // On the free field each block is (Nd + m) times the unit matrix
+  {
+    multi1d<LatticeColorMatrix> u(Nd);
+    for(int mu=0; mu < Nd; ++mu)
+      u[mu] = 1;
+
+    Handle< FermState<T,P,Q> > fs(new PeriodicFermState<T,P,Q>(u));
+
+    CloverTerm invclov;
+    invclov.create(fs, params);
+
+    for(int cb=0; cb < 2; ++cb)
+    {
+      invclov.choles(cb);
+      const double logdet = toDouble(invclov.cholesDet(cb));
+      const double ref = 0.5 * Layout::vol() * 4*Nc * std::log(Nd + toDouble(params.Mass));
+
+      QDPIO::cout << "cb = " << cb << ": tr log A = " << logdet << "  reference = " << ref << std::endl;
+      ok = ok && (std::fabs(logdet - ref) < 1.0e-5 * std::fabs(ref));
+    }
+  }
+
+  QDPIO::cout << "t_clover_ldl: " << (ok ? "PASSED" : "FAILED") << std::endl;
+
+  // Time to bolt
+  Chroma::finalize();
+
+  return ok ? 0 : 1;
+}
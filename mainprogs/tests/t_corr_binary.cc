@@ -0,0 +1,314 @@
+/*! \file
+ *  \brief Test the binary correlator file against the xml correlators
+ *
+ *  The meson and heavy-light baryon correlators of two random propagators
+ *  are written both to xml and, through a small buffer so the background
+ *  writer is used, to a binary correlator file. The file is read back
+ *  and its keys and correlators must match the xml, in the same order.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chroma.h"
+#include "meas/hadron/corr_binary_writer.h"
+#include "meas/hadron/mesons2_w.h"
+#include "meas/hadron/barhqlq_w.h"
+
+using namespace Chroma;
+
+namespace
+{
+  //! The contents of a binary correlator file
+  struct CorrFile
+  {
+    int nmom;
+    std::vector<std::string> hadron, quarks, source, sink;
+    std::vector<int> gamma, length;
+    std::vector< std::vector<int> > mom;
+    std::vector< std::vector<double> > data;
+  };
+
+  //! Sequential reads from a file image
+  class Cursor
+  {
+  public:
+    Cursor(const std::vector<char>& b, size_t p) : buf(b), pos(p), ok(true) {}
+
+    void get(void* p, size_t n)
+    {
+      if (pos + n > buf.size())
+      {
+	ok = false;
+	return;
+      }
+      std::memcpy(p, &(buf[pos]), n);
+      pos += n;
+    }
+
+    int getInt() {int v = 0; get(&v, sizeof(int)); return v;}
+    long long getLong() {long long v = 0; get(&v, sizeof(long long)); return v;}
+
+    //! A string column, decoded
+    void getColumn(std::vector<std::string>& col, long long nrec)
+    {
+      std::vector<std::string> dict(getInt());
+      for(int i=0; ok && i < dict.size(); ++i)
+      {
+	dict[i].resize(getInt());
+	for(int j=0; j < dict[i].size(); ++j)
+	  get(&(dict[i][j]), 1);
+      }
+
+      col.resize(nrec);
+      for(long long r=0; ok && r < nrec; ++r)
+      {
+	int c = getInt();
+	if (c < 0 || c >= dict.size())
+	  ok = false;
+	else
+	  col[r] = dict[c];
+      }
+    }
+
+    const std::vector<char>& buf;
+    size_t pos;
+    bool ok;
+  };
+
+  //! Read a file on the primary node and broadcast it
+  void readFile(const std::string& file_name, std::vector<char>& buf)
+  {
+    if (Layout::primaryNode())
+    {
+      FILE* fp = fopen(file_name.c_str(), "rb");
+      if (fp != 0)
+      {
+	char tmp[4096];
+	size_t n;
+	while ((n = fread(tmp, 1, sizeof(tmp), fp)) > 0)
+	  buf.insert(buf.end(), tmp, tmp + n);
+	fclose(fp);
+      }
+    }
+
+    int size = buf.size();
+    QDPInternal::broadcast(size);
+    buf.resize(size);
+    if (size > 0)
+      QDPInternal::broadcast(&(buf[0]), size);
+  }
+
+  //! Parse the image of a binary correlator file
+  bool parseCorrFile(const std::vector<char>& buf, CorrFile& f)
+  {
+    if (buf.size() < 16 + 16 || std::memcmp(&(buf[0]), "CHCORR01", 8) != 0
+	|| std::memcmp(&(buf[buf.size()-8]), "CHCORIDX", 8) != 0)
+      return false;
+
+    Cursor head(buf, 8);
+    f.nmom = head.getInt();
+
+    Cursor trail(buf, buf.size()-16);
+    long long index = trail.getLong();
+    if (index < 16 || index > buf.size()-16)
+      return false;
+
+    Cursor c(buf, index);
+    long long nrec = c.getLong();
+
+    c.getColumn(f.hadron, nrec);
+    c.getColumn(f.quarks, nrec);
+
+    f.gamma.resize(nrec);
+    for(long long r=0; r < nrec; ++r)
+      f.gamma[r] = c.getInt();
+
+    f.mom.resize(nrec);
+    for(long long r=0; r < nrec; ++r)
+    {
+      f.mom[r].resize(f.nmom);
+      for(int i=0; i < f.nmom; ++i)
+	f.mom[r][i] = c.getInt();
+    }
+
+    c.getColumn(f.source, nrec);
+    c.getColumn(f.sink, nrec);
+
+    f.length.resize(nrec);
+    for(long long r=0; r < nrec; ++r)
+      f.length[r] = c.getInt();
+
+    std::vector<long long> offset(nrec);
+    for(long long r=0; r < nrec; ++r)
+      offset[r] = c.getLong();
+
+    // The index must end at the trailer
+    if (! c.ok || c.pos != buf.size()-16)
+      return false;
+
+    f.data.resize(nrec);
+    for(long long r=0; r < nrec; ++r)
+    {
+      Cursor d(buf, offset[r]);
+      if (offset[r] < 16 || offset[r] + 2*f.length[r]*sizeof(double) > index)
+	return false;
+
+      f.data[r].resize(2*f.length[r]);
+      for(int t=0; t < f.data[r].size(); ++t)
+	d.get(&(f.data[r][t]), sizeof(double));
+    }
+
+    return true;
+  }
+
+
+  //! Compare the correlators of an xml group with the binary records from rec on
+  bool compareGroup(XMLReader& xml, const std::string& group, const std::string& num_tag,
+		    const std::string& corr_tag, const CorrBinaryKey& key,
+		    const CorrFile& f, int& rec)
+  {
+    XMLReader xml_group(xml, group);
+
+    bool ok = true;
+    double max_diff = 0;
+    int ncorr = 0;
+
+    for(int g=1; g <= xml_group.count("elem"); ++g)
+    {
+      std::ostringstream gpath;
+      gpath << "elem[" << g << "]";
+      XMLReader xml_g(xml_group, gpath.str());
+
+      int gamma;
+      read(xml_g, num_tag, gamma);
+
+      for(int m=1; m <= xml_g.count("momenta/elem"); ++m, ++rec, ++ncorr)
+      {
+	std::ostringstream mpath;
+	mpath << "momenta/elem[" << m << "]";
+	XMLReader xml_m(xml_g, mpath.str());
+
+	multi1d<int> mom;
+	multi1d<DComplex> corr;
+	read(xml_m, "sink_mom", mom);
+	read(xml_m, corr_tag, corr);
+
+	if (rec >= f.data.size())
+	  return false;
+
+	ok = ok && (f.hadron[rec] == key.hadron) && (f.quarks[rec] == key.quarks)
+	  && (f.source[rec] == key.source) && (f.sink[rec] == key.sink)
+	  && (f.gamma[rec] == gamma) && (f.length[rec] == corr.size())
+	  && (f.mom[rec].size() == mom.size());
+
+	for(int i=0; ok && i < mom.size(); ++i)
+	  ok = (f.mom[rec][i] == mom[i]);
+
+	if (! ok)
+	  break;
+
+	// The xml holds the correlator to its printed precision
+	double scale = 0;
+	for(int t=0; t < corr.size(); ++t)
+	  scale = std::max(scale, std::sqrt(toDouble(real(conj(corr[t])*corr[t]))));
+
+	for(int t=0; t < corr.size(); ++t)
+	{
+	  double dre = f.data[rec][2*t]   - toDouble(real(corr[t]));
+	  double dim = f.data[rec][2*t+1] - toDouble(imag(corr[t]));
+	  max_diff = std::max(max_diff, std::sqrt(dre*dre + dim*dim) / scale);
+	}
+      }
+    }
+
+    QDPIO::cout << key.hadron << ": " << ncorr << " correlators, max |binary - xml| / |xml| = "
+		<< max_diff << std::endl;
+
+    return ok && (ncorr > 0) && (max_diff < 1.0e-5);
+  }
+}
+
+
+int main(int argc, char *argv[])
+{
+  // Put the machine into a known state
+  Chroma::initialize(&argc, &argv);
+
+  // Setup the layout
+  const int foo[] = {4, 4, 4, 8};
+  multi1d<int> nrow(Nd);
+  nrow = foo;
+  Layout::setLattSize(nrow);
+  Layout::create();
+
+  LatticePropagator quark_prop_1, quark_prop_2;
+  gaussian(quark_prop_1);
+  gaussian(quark_prop_2);
+
+  SftMom phases(1, false, Nd-1);
+  const int t0 = 2;
+  const int bc_spec = -1;
+  const bool time_rev = false;
+
+  CorrBinaryKey meson_key;
+  meson_key.hadron = "Wilson_Mesons";
+  meson_key.quarks = "q1_q2";
+  meson_key.source = "Point";
+  meson_key.sink   = "Point";
+
+  CorrBinaryKey baryon_key(meson_key);
+  baryon_key.hadron = "Wilson_Baryons";
+  baryon_key.sink   = "Shell";
+
+  // The xml correlators
+  XMLBufferWriter xml_buf;
+  push(xml_buf, "t_corr_binary");
+  mesons2(quark_prop_1, quark_prop_2, phases, t0, xml_buf, meson_key.hadron);
+  barhqlq(quark_prop_1, quark_prop_2, phases, t0, bc_spec, time_rev, xml_buf, baryon_key.hadron);
+  pop(xml_buf);
+
+  // The same to the binary file, with a buffer of a few correlators
+  const std::string file_name = "t_corr_binary.bin";
+  {
+    CorrBinaryWriter bin(1024);
+    bin.open(file_name);
+    mesons2(quark_prop_1, quark_prop_2, phases, t0, bin, meson_key);
+    bin.flush();
+    barhqlq(quark_prop_1, quark_prop_2, phases, t0, bc_spec, time_rev, bin, baryon_key);
+    bin.close();
+  }
+
+  std::vector<char> buf;
+  readFile(file_name, buf);
+
+  CorrFile f;
+  bool ok = parseCorrFile(buf, f);
+  if (! ok)
+    QDPIO::cout << "could not read " << file_name << std::endl;
+
+  XMLReader xml(xml_buf);
+  XMLReader xml_top(xml, "/t_corr_binary");
+
+  int rec = 0;
+  ok = ok && (f.nmom == Nd-1);
+  ok = ok && compareGroup(xml_top, meson_key.hadron, "gamma_value", "mesprop", meson_key, f, rec);
+  ok = ok && compareGroup(xml_top, baryon_key.hadron, "baryon_num", "barprop", baryon_key, f, rec);
+  ok = ok && (rec == f.data.size());
+
+  if (Layout::primaryNode())
+    std::remove(file_name.c_str());
+
+  QDPIO::cout << "t_corr_binary: " << (ok ? "PASSED" : "FAILED") << std::endl;
+
+  // Time to bolt
+  Chroma::finalize();
+
+  return ok ? 0 : 1;
+}
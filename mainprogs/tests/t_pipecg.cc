@@ -0,0 +1,109 @@
+/*! \file
+ *  \brief Test the pipelined CG against CG
+ *
+ *  Both solve M^dag M psi = chi for the even-odd preconditioned Wilson
+ *  operator on a weak field, through the MdagM system solver factory.
+ *  The solutions must agree and reach the target residual, and the
+ *  pipelined solver must not need many more iterations.
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <sstream>
+
+#include "chroma.h"
+
+using namespace Chroma;
+
+typedef LatticeFermion T;
+typedef multi1d<LatticeColorMatrix> Q;
+typedef multi1d<LatticeColorMatrix> P;
+
+namespace
+{
+  //! Solve M^dag M psi = chi with a solver of the MdagM factory
+  SystemSolverResults_t solve(const std::string& inv_type,
+			      Handle< FermState<T,P,Q> > state,
+			      Handle< LinearOperator<T> > M,
+			      T& psi, const T& chi)
+  {
+    std::ostringstream os;
+    os << "<InvertParam>"
+       << "<invType>" << inv_type << "</invType>"
+       << "<RsdCG>1.0e-6</RsdCG>"
+       << "<MaxCG>2000</MaxCG>"
+       << "</InvertParam>";
+
+    std::istringstream is(os.str());
+    XMLReader xml_in(is);
+    Handle< MdagMSystemSolver<T> > solver(
+      TheMdagMFermSystemSolverFactory::Instance().createObject(inv_type, xml_in, "/InvertParam", state, M));
+
+    psi = zero;
+    SystemSolverResults_t res = (*solver)(psi, chi);
+
+    // True residual of the normal equations
+    const Subset& s = M->subset();
+    T tmp1, tmp2, r;
+    (*M)(tmp1, psi, PLUS);
+    (*M)(tmp2, tmp1, MINUS);
+    r[s] = chi - tmp2;
+    Double rel = sqrt(norm2(r, s) / norm2(chi, s));
+
+    QDPIO::cout << inv_type << ": " << res.n_count << " iterations, |chi - MdagM psi| / |chi| = "
+		<< rel << std::endl;
+
+    res.resid = rel;
+    return res;
+  }
+}
+
+
+int main(int argc, char *argv[])
+{
+  // Put the machine into a known state
+  Chroma::initialize(&argc, &argv);
+
+  QDPIO::cout << "linkage = " << MdagMSysSolverEnv::registerAll() << std::endl;
+
+  // Setup the layout
+  const int foo[] = {4, 4, 4, 8};
+  multi1d<int> nrow(Nd);
+  nrow = foo;
+  Layout::setLattSize(nrow);
+  Layout::create();
+
+  // Start up a weak field
+  struct Cfg_t config = { CFG_TYPE_WEAK_FIELD, "dummy" };
+  multi1d<LatticeColorMatrix> u(Nd);
+  XMLReader gauge_file_xml, gauge_xml;
+  gaugeStartup(gauge_file_xml, gauge_xml, u, config);
+  unitarityCheck(u);
+
+  Handle< FermState<T,P,Q> > state(new PeriodicFermState<T,P,Q>(u));
+  Handle< LinearOperator<T> > M(new EvenOddPrecWilsonLinOp(state, Real(0.1)));
+
+  T chi;
+  gaussian(chi, M->subset());
+
+  T psi_cg, psi_pipe;
+  SystemSolverResults_t res_cg   = solve("CG_INVERTER", state, M, psi_cg, chi);
+  SystemSolverResults_t res_pipe = solve("PIPELINED_CG_INVERTER", state, M, psi_pipe, chi);
+
+  const Subset& s = M->subset();
+  Double diff = sqrt(norm2(psi_pipe - psi_cg, s) / norm2(psi_cg, s));
+  QDPIO::cout << "|psi_pipe - psi_cg| / |psi_cg| = " << diff << std::endl;
+
+  bool ok = true;
+  ok = ok && (toDouble(res_cg.resid) < 1.0e-5);
+  ok = ok && (toDouble(res_pipe.resid) < 1.0e-5);
+  ok = ok && (toDouble(diff) < 1.0e-4);
+  ok = ok && (res_pipe.n_count <= res_cg.n_count + res_cg.n_count/5 + 5);
+
+  QDPIO::cout << "t_pipecg: " << (ok ? "PASSED" : "FAILED") << std::endl;
+
+  // Time to bolt
+  Chroma::finalize();
+
+  return ok ? 0 : 1;
+}
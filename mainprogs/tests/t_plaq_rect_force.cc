@@ -0,0 +1,208 @@
+/*! \file
+ *  \brief Test the fused plaquette and rectangle force against the separate deriv path
+ *
+ *  The reference is the rectangle force as RectGaugeAct::deriv computed
+ *  it before PlaqRectForce, one deriv_part per ordered pair of
+ *  directions, plus PlaqGaugeAct::deriv for the plaquettes.
+ */
+
+#include <iostream>
+#include <cstdio>
+
+#include "chroma.h"
+
+using namespace Chroma;
+
+typedef multi1d<LatticeColorMatrix>  P;
+typedef multi1d<LatticeColorMatrix>  Q;
+
+namespace
+{
+  //! Force of the rectangles 2 links long in mu and 1 in nu
+  void refDerivPart(int mu, int nu, Real c_munu,
+		    multi1d<LatticeColorMatrix>& ds_u,
+		    const multi1d<LatticeColorMatrix>& u)
+  {
+    LatticeColorMatrix from_left_2link = u[mu]*shift(u[mu], FORWARD, mu);
+    LatticeColorMatrix upper_l = u[nu]*shift(from_left_2link, FORWARD, nu);
+
+    LatticeColorMatrix tmp = shift( adj(upper_l)*from_left_2link, BACKWARD, mu);
+    ds_u[nu] = shift(tmp, BACKWARD, mu);
+
+    tmp = shift(u[nu], FORWARD, mu);
+    LatticeColorMatrix tmp2 = shift(tmp, FORWARD, mu);
+
+    upper_l = tmp2*adj(shift(from_left_2link, FORWARD, nu));
+    ds_u[nu] += adj(upper_l)*adj(from_left_2link);
+
+    LatticeColorMatrix up_staple = upper_l*adj(u[nu]);
+
+    tmp = adj(tmp2)*adj(from_left_2link);
+    LatticeColorMatrix down_staple = tmp*u[nu];
+
+    ds_u[mu] = shift( up_staple*u[mu], BACKWARD, mu);
+
+    tmp2 = shift(down_staple, BACKWARD, nu);
+    ds_u[mu] += shift(tmp2*u[mu], BACKWARD, mu);
+
+    tmp = shift(u[mu], FORWARD, mu);
+    ds_u[mu] += tmp*up_staple;
+    ds_u[mu] += tmp*tmp2;
+
+    ds_u[mu] *= c_munu/Real(-2*Nc);
+    ds_u[nu] *= c_munu/Real(-2*Nc);
+  }
+
+  //! dS/dU of the rectangle action, one orientation at a time
+  void refRectDeriv(multi1d<LatticeColorMatrix>& ds_u,
+		    const multi1d<LatticeColorMatrix>& u,
+		    const Real& coeff_s, const Real& coeff_t1, const Real& coeff_t2,
+		    bool no_temporal_2link, int t_dir)
+  {
+    ds_u.resize(Nd);
+    multi1d<LatticeColorMatrix> ds_tmp(Nd);
+    ds_u = zero;
+    ds_tmp = zero;
+
+    for(int mu=0; mu < Nd; mu++)
+    {
+      for(int nu=0; nu < Nd; nu++)
+      {
+	if (mu == nu)
+	  continue;
+
+	Real c;
+	if (mu == t_dir)
+	  c = coeff_t1;
+	else if (nu == t_dir)
+	  c = coeff_t2;
+	else
+	  c = coeff_s;
+
+	if (mu == t_dir && no_temporal_2link)
+	  continue;
+
+	refDerivPart(mu, nu, c, ds_u, u);
+	ds_tmp[mu] += ds_u[mu];
+	ds_tmp[nu] += ds_u[nu];
+      }
+    }
+
+    for(int mu=0; mu < Nd; mu++)
+      ds_u[mu] = u[mu]*ds_tmp[mu];
+  }
+
+  //! sqrt( |a - b|^2 / |b|^2 ) over all directions
+  Double relDiff(const multi1d<LatticeColorMatrix>& a, const multi1d<LatticeColorMatrix>& b)
+  {
+    Double num = zero;
+    Double den = zero;
+    for(int mu=0; mu < Nd; mu++)
+    {
+      num += norm2(a[mu] - b[mu]);
+      den += norm2(b[mu]);
+    }
+    return sqrt(num / den);
+  }
+}
+
+
+int main(int argc, char *argv[])
+{
+  // Initialise QDP
+  Chroma::initialize(&argc, &argv);
+
+  // Setup a small lattice
+  const int nrow_arr[] = {4, 4, 4, 8};
+  multi1d<int> nrow(Nd);
+  nrow = nrow_arr;
+  Layout::setLattSize(nrow);
+  Layout::create();
+
+  multi1d<LatticeColorMatrix> u(Nd);
+  {
+    XMLReader file_xml;
+    XMLReader config_xml;
+    Cfg_t foo;
+    foo.cfg_type = CFG_TYPE_DISORDERED;
+    gaugeStartup(file_xml, config_xml, u, foo);
+  }
+
+  Handle< GaugeBC<P,Q> > gbc(new PeriodicGaugeBC<P,Q>);
+  Handle< CreateGaugeState<P,Q> > cgs(new CreateSimpleGaugeState<P,Q>(gbc));
+
+  const double tol = 1.0e-5;
+  bool ok = true;
+
+  // Rectangle actions on their own, isotropic and with time treated apart
+  {
+    AnisoParam_t aniso;
+    aniso.t_dir = Nd-1;
+
+    const int ncase = 3;
+    const Real coeff_s[ncase]  = {Real(5.7), Real(1.0), Real(1.0)};
+    const Real coeff_t1[ncase] = {Real(5.7), Real(0.7), Real(0.7)};
+    const Real coeff_t2[ncase] = {Real(5.7), Real(1.3), Real(1.3)};
+    const bool no_t2[ncase]    = {false, false, true};
+
+    for(int i=0; i < ncase; ++i)
+    {
+      RectGaugeAct S_g(cgs, coeff_s[i], coeff_t1[i], coeff_t2[i], no_t2[i], aniso);
+      Handle< GaugeState<P,Q> > state(S_g.createState(u));
+
+      multi1d<LatticeColorMatrix> ds_u;
+      S_g.deriv(ds_u, state);
+
+      multi1d<LatticeColorMatrix> ds_ref;
+      refRectDeriv(ds_ref, state->getLinks(), coeff_s[i], coeff_t1[i], coeff_t2[i], no_t2[i], aniso.t_dir);
+
+      // The spatial and temporal parts make up the whole
+      multi1d<LatticeColorMatrix> ds_spatial, ds_temporal;
+      S_g.derivSpatial(ds_spatial, state);
+      S_g.derivTemporal(ds_temporal, state);
+      for(int mu=0; mu < Nd; mu++)
+	ds_spatial[mu] += ds_temporal[mu];
+
+      Double diff = relDiff(ds_u, ds_ref);
+      Double diff_parts = relDiff(ds_spatial, ds_ref);
+      QDPIO::cout << "RectGaugeAct case " << i << ": |fused - reference| / |reference| = " << diff
+		  << ", spatial + temporal: " << diff_parts << std::endl;
+
+      ok = ok && (toDouble(diff) < tol) && (toDouble(diff_parts) < tol);
+    }
+  }
+
+  // The RG action, plaquettes and rectangles in one pass
+  {
+    const Real beta(2.6);
+    const Real c1(-0.331);
+
+    RGGaugeAct S_g(cgs, beta, c1);
+    Handle< GaugeState<P,Q> > state(S_g.createState(u));
+
+    multi1d<LatticeColorMatrix> ds_u;
+    S_g.deriv(ds_u, state);
+
+    AnisoParam_t aniso;
+    PlaqGaugeAct plaq(cgs, beta, aniso);
+    multi1d<LatticeColorMatrix> ds_ref;
+    plaq.deriv(ds_ref, state);
+
+    multi1d<LatticeColorMatrix> ds_rect;
+    refRectDeriv(ds_rect, state->getLinks(), beta*c1, beta*c1, beta*c1, false, Nd-1);
+    for(int mu=0; mu < Nd; mu++)
+      ds_ref[mu] += ds_rect[mu];
+
+    Double diff = relDiff(ds_u, ds_ref);
+    QDPIO::cout << "RGGaugeAct: |fused - reference| / |reference| = " << diff << std::endl;
+
+    ok = ok && (toDouble(diff) < tol);
+  }
+
+  QDPIO::cout << "t_plaq_rect_force: " << (ok ? "PASSED" : "FAILED") << std::endl;
+
+  // Finish
+  Chroma::finalize();
+
+  return ok ? 0 : 1;
+}
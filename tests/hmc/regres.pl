@@ -25,5 +25,14 @@
 	 log         => "hmc.prec_wilson_repro.candidate.xml",
 	 metric      => "$test_dir/hmc/hmc.prec_wilson_repro.metric.xml" ,
 	 controlfile => "$test_dir/hmc/hmc.prec_wilson_repro.log.xml" ,
-     }
+     },
+#     The control log has to be generated on a built tree first
+#     {
+#	 exec_path   => "$top_builddir/mainprogs/main" , 
+#	 execute     => "hmc" , 
+#	 input       => "$test_dir/hmc/hmc.force_grad.ini.xml" , 
+#	 log         => "hmc.force_grad.candidate.xml",
+#	 metric      => "$test_dir/hmc/hmc.force_grad.metric.xml" ,
+#	 controlfile => "$test_dir/hmc/hmc.force_grad.log.xml" ,
+#     }
      );